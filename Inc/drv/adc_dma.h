@@ -16,16 +16,45 @@ extern "C" {
 #include <stdbool.h>
 
 /**
- * @brief ADC DMA driver for periodic analog channel sampling
- *
- * This driver uses DMA to periodically read ADC channels triggered by
- * a timer at PWM frequency and stores results in a buffer.
+ * @brief ADC driver for periodic analog channel sampling
+ *
+ * A timer running with the PWM, centre-aligned, triggers the ADC once per
+ * period near the top of the count, when all low-side switches are on and
+ * the phase currents are free of switching noise. The current channels
+ * (0-3) are the injected group: converted first, back to back, and read
+ * from the data registers by the end-of-sequence interrupt. The slower
+ * channels (4) are the regular group, converted after them and kept
+ * current in a small buffer by the DMA, without interrupts.
+ *
+ * The interrupt fills two sample sets (slots) in turn and every completion
+ * bumps a sequence counter. While one slot is filled the other holds the
+ * latest complete sample set, so all channels read from it come from the
+ * same trigger.
+ *
+ * Capture mode also copies each sample set into a caller buffer, for runs
+ * of consecutive sample sets at the full rate (noise floors, transients).
+ * The conversion complete callback keeps running meanwhile.
  */
 
 #define ADC_DMA_NUM_CHANNELS  5    /* Number of ADC channels to read */
+#define ADC_DMA_NUM_INJECTED  4    /* Channels 0-3: injected group */
 #define ADC_VREF_MV           3300 /* ADC reference voltage in millivolts */
 #define ADC_OVERSAMPLING_RATIO 4   /* Hardware oversampling: 4x averages */
 
+/**
+ * @brief Latest complete sample set
+ *
+ * values points into the driver's buffer, nothing is copied. The slot stays
+ * untouched until the completion after the next one, i.e. for about
+ * one sample period after seq moves on: fine for the conversion complete
+ * callback and the tasks it runs, too short a guarantee for the main loop,
+ * which should use adc_dma_get_all_channels().
+ */
+struct adc_dma_snapshot {
+	const uint16_t *values;      /* ADC_DMA_NUM_CHANNELS values */
+	uint32_t seq;                /* Sample index, 0 before the first one */
+};
+
 /**
  * @brief Callback function type for ADC conversion complete
  *
@@ -34,11 +63,23 @@ extern "C" {
  */
 typedef void (*adc_dma_callback_t)(uint16_t *values, uint8_t num_channels);
 
+/* Largest capture, in sample sets */
+#define ADC_DMA_CAPTURE_MAX   (65535U / ADC_DMA_NUM_CHANNELS)
+
+/**
+ * @brief Callback function type for capture events, from the ADC interrupt
+ *
+ * @param samples Captured sample sets, ADC_DMA_NUM_CHANNELS values each
+ * @param num_samples Number of sample sets
+ */
+typedef void (*adc_dma_capture_callback_t)(const uint16_t *samples, uint32_t num_samples);
+
 /**
  * @brief Initialize ADC DMA driver
  *
- * Configures ADC2 to read all 5 channels using DMA, triggered by TIM2
- * at PWM frequency (20 kHz).
+ * Configures ADC2 to read the current channels as the injected group and
+ * the rest by DMA, both triggered by TIM2 at PWM frequency (20 kHz). The
+ * PWM timers must be started in step with TIM2, see pwm_sync().
  *
  * @param hadc Pointer to ADC handle (e.g., &hadc2)
  * @param hdma Pointer to DMA handle (e.g., &hdma_adc2)
@@ -61,11 +102,21 @@ int adc_dma_start(void);
  */
 int adc_dma_stop(void);
 
+/**
+ * @brief Get the latest complete sample set
+ *
+ * @param snap Pointer to store the snapshot
+ * @return 0 on success, negative value if not initialized
+ */
+int adc_dma_get_snapshot(struct adc_dma_snapshot *snap);
+
 /**
  * @brief Get latest ADC value for a channel
  *
  * Returns the most recently sampled ADC value for the specified channel.
- * This is a non-blocking read from the DMA buffer.
+ * This is a non-blocking read from the sample buffer. Two calls may return
+ * values of different samples; use adc_dma_get_all_channels() or
+ * adc_dma_get_snapshot() for channels that belong together.
  *
  * @param channel Channel index (0-4 for channels 1,2,3,4,12)
  * @param value Pointer to store the 12-bit ADC value (0-4095)
@@ -76,8 +127,9 @@ int adc_dma_get_channel(uint8_t channel, uint16_t *value);
 /**
  * @brief Get all ADC channel values
  *
- * Copies all current ADC channel values to the provided buffer.
- * This is a non-blocking read from the DMA buffer.
+ * Copies the latest complete sample set to the provided buffer. The copy
+ * is retried if a sample completes meanwhile, so the values always come
+ * from one conversion sequence, from any context.
  *
  * @param values Buffer to store ADC values (must hold ADC_DMA_NUM_CHANNELS values)
  * @param num_channels Number of channels to read (max ADC_DMA_NUM_CHANNELS)
@@ -85,6 +137,37 @@ int adc_dma_get_channel(uint8_t channel, uint16_t *value);
  */
 int adc_dma_get_all_channels(uint16_t *values, uint8_t num_channels);
 
+/**
+ * @brief Start a block capture
+ *
+ * Sample sets are copied into buffer from the next one on. One-shot: the
+ * callback gets the whole buffer once it is full. Circular: the buffer is
+ * refilled until adc_dma_capture_stop(), and the callback gets each half
+ * as it completes, to be processed before the capture comes back to it.
+ *
+ * @param buffer Buffer for num_samples * ADC_DMA_NUM_CHANNELS values
+ * @param num_samples Sample sets, up to ADC_DMA_CAPTURE_MAX, even if circular
+ * @param circular Keep capturing until stopped
+ * @param callback Capture callback, may be NULL
+ * @return 0 on success, negative value if invalid, busy or not started
+ */
+int adc_dma_capture_start(uint16_t *buffer, uint32_t num_samples, bool circular,
+                          adc_dma_capture_callback_t callback);
+
+/**
+ * @brief End a capture
+ *
+ * @return 0 on success, negative value if no capture is running
+ */
+int adc_dma_capture_stop(void);
+
+/**
+ * @brief Check for a capture in progress
+ *
+ * @return true while a capture buffer is being filled
+ */
+bool adc_dma_capture_active(void);
+
 /**
  * @brief Convert ADC raw value to millivolts
  *
@@ -98,18 +181,21 @@ uint32_t adc_dma_raw_to_mv(uint16_t raw_value);
 /**
  * @brief Register callback for conversion complete events
  *
+ * Called from the ADC interrupt for every sample set, with the slot that
+ * has just completed.
+ *
  * @param callback Callback function to call when conversion completes
  */
 void adc_dma_set_callback(adc_dma_callback_t callback);
 
 /**
- * @brief ADC DMA conversion complete callback
+ * @brief Injected sequence complete: publish a sample set
  *
- * This should be called from HAL_ADC_ConvCpltCallback.
+ * This should be called from HAL_ADCEx_InjectedConvCpltCallback.
  *
  * @param hadc Pointer to ADC handle
  */
-void adc_dma_conv_cplt_callback(ADC_HandleTypeDef *hadc);
+void adc_dma_injected_cplt_callback(ADC_HandleTypeDef *hadc);
 
 #ifdef __cplusplus
 }
@@ -6,9 +6,17 @@ extern "C" {
 #endif
 
 #include "stm32g4xx_hal.h"
+#include <stdbool.h>
+
+/* Called from the RX interrupt; return true if the frame was consumed */
+typedef bool (*can_rx_callback_t)(uint32_t id, const uint8_t *data, uint8_t len);
 
 void can_init(FDCAN_HandleTypeDef *hfdcan);
 void can_transmit(uint32_t id, uint8_t *data, uint8_t len);
+void can_set_rx_callback(can_rx_callback_t callback);
+
+/* Send a byte stream as consecutive 8-byte frames, waiting for TX FIFO space */
+int can_write(uint32_t id, const uint8_t *data, uint32_t len, uint32_t timeout_ms);
 
 #ifdef __cplusplus
 }
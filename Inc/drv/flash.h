@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef FLASH_H
+#define FLASH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/**
+ * @brief Internal flash pages reserved for the configuration store
+ *
+ * The linker script keeps the last FLASH_STORE_PAGES pages out of the
+ * code region (_store_start/_store_end). Offsets are relative to the
+ * start of that region.
+ *
+ * The G431 has a single flash bank: while a page is erased (about 20 ms)
+ * or a double word programmed, every fetch from flash stalls, interrupt
+ * handlers included. Only erase and program with the motors stopped.
+ *
+ * The host build replaces this driver with a file-backed emulation, see
+ * hal_shim_flash_open().
+ */
+
+#define FLASH_STORE_PAGE_SIZE    2048U
+#define FLASH_STORE_PAGES        4U   /* Keep in sync with the linker script */
+#define FLASH_STORE_SIZE         (FLASH_STORE_PAGE_SIZE * FLASH_STORE_PAGES)
+
+/* Smallest programmable unit; erased flash reads 0xFF */
+#define FLASH_STORE_WORD         8U
+
+/**
+ * @brief Read from the store region
+ *
+ * @param offset Offset into the region
+ * @param buf Buffer to store the bytes
+ * @param len Number of bytes
+ * @return 0 on success, -1 if out of range
+ */
+int flash_read(uint32_t offset, void *buf, uint32_t len);
+
+/**
+ * @brief Erase one page of the store region
+ *
+ * @param page Page index, 0 to FLASH_STORE_PAGES - 1
+ * @return 0 on success, -1 on failure
+ */
+int flash_erase_page(uint32_t page);
+
+/**
+ * @brief Program erased flash
+ *
+ * @param offset Offset into the region, multiple of FLASH_STORE_WORD
+ * @param data Bytes to write
+ * @param len Number of bytes, multiple of FLASH_STORE_WORD
+ * @return 0 on success, -1 if out of range, misaligned, not erased or
+ *         the flash controller reported an error
+ */
+int flash_program(uint32_t offset, const void *data, uint32_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FLASH_H */
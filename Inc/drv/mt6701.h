@@ -6,6 +6,7 @@ extern "C" {
 #endif
 
 #include "main.h"
+#include <stdbool.h>
 
 /**
  * @brief MT6701 magnetic angle encoder driver
@@ -24,6 +25,21 @@ extern "C" {
 /* Angle resolution */
 #define MT6701_ANGLE_RESOLUTION    16384  /* 14-bit: 2^14 */
 
+/* Blocking read timeout; a 2-byte burst takes well under 1 ms */
+#define MT6701_I2C_TIMEOUT_MS      2
+
+/* Devices that can receive interrupt-driven reads */
+#define MT6701_MAX_DEVICES         2
+
+/**
+ * @brief One angle acquisition
+ */
+typedef struct {
+    uint16_t angle;              /* 14-bit angle (0-16383) */
+    uint32_t timestamp;          /* Caller's time stamp passed to mt6701_start_read() */
+    uint32_t seq;                /* Completed reads since init, 0 = no sample yet */
+} mt6701_sample_t;
+
 /**
  * @brief MT6701 device structure
  */
@@ -31,6 +47,17 @@ typedef struct {
     I2C_HandleTypeDef *hi2c;
     uint8_t i2c_addr;
     const char *name;
+
+    /* Interrupt-driven acquisition */
+    uint8_t rx[2];               /* Burst buffer: registers 0x03, 0x04 */
+    volatile bool busy;          /* Transfer in flight */
+    uint32_t pending_timestamp;  /* Time stamp of the transfer in flight */
+    uint32_t pending_cycles;     /* Cycle count at the start, for profiling */
+    mt6701_sample_t slot[2];     /* Double-buffered latest sample */
+    volatile uint8_t latest;     /* Index of the slot readers use */
+    uint32_t seq;                /* Completed reads */
+    uint32_t errors;             /* Failed reads (NACK, bus error, timeout) */
+    uint32_t overruns;           /* Starts refused while a transfer was in flight */
 } mt6701_t;
 
 /**
@@ -47,6 +74,10 @@ int mt6701_init(mt6701_t *dev, I2C_HandleTypeDef *hi2c, uint8_t addr, const char
 /**
  * @brief Read raw angle value from MT6701
  *
+ * Blocking burst read of both angle registers. Meant for start-up and
+ * diagnostics; control loops use mt6701_start_read() and
+ * mt6701_get_sample() instead.
+ *
  * @param dev Pointer to MT6701 device
  * @param angle Pointer to store 14-bit angle value (0-16383)
  * @return 0 on success, negative value on failure
@@ -71,6 +102,30 @@ int mt6701_read_angle_deg(mt6701_t *dev, float *angle_deg);
  */
 int mt6701_read_angle_rad(mt6701_t *dev, float *angle_rad);
 
+/**
+ * @brief Start an interrupt-driven angle read
+ *
+ * Reads both angle registers in one I2C transaction without blocking. Call
+ * it from a timer interrupt; the result is published from the I2C
+ * completion interrupt.
+ *
+ * @param dev Pointer to MT6701 device
+ * @param timestamp Caller's time stamp stored with the sample
+ * @return 0 on success, negative value if busy or the bus refused
+ */
+int mt6701_start_read(mt6701_t *dev, uint32_t timestamp);
+
+/**
+ * @brief Get the latest completed angle sample
+ *
+ * Constant time, safe against the completion interrupt.
+ *
+ * @param dev Pointer to MT6701 device
+ * @param sample Pointer to store the sample
+ * @return 0 on success, negative value if no read has completed yet
+ */
+int mt6701_get_sample(mt6701_t *dev, mt6701_sample_t *sample);
+
 #ifdef __cplusplus
 }
 #endif
@@ -19,8 +19,16 @@ extern "C" {
  *
  * This driver provides 3-phase PWM control for BLDC motors
  * using STM32 timer peripherals.
+ *
+ * The timers count centre-aligned (up to ARR and back), so every phase
+ * pulse is centred on the bottom of the count and all low-side switches
+ * conduct around the top: the phase currents are sampled there, see
+ * drv/adc_dma.h. Compare values stay duty * ARR.
  */
 
+/* Timer ARR: 20 kHz centre-aligned at 170 MHz, 2 * 4250 ticks per period */
+#define PWM_TIMER_PERIOD     4250U
+
 /**
  * @brief PWM device configuration
  */
@@ -32,6 +40,17 @@ struct pwm_config {
 	uint32_t pwm_frequency_hz;   /* PWM frequency in Hz */
 };
 
+/* Q15 duty cycle: 0 = 0 %, PWM_DUTY_Q15_ONE = 100 % */
+#define PWM_DUTY_Q15_ONE     0x8000U
+
+/**
+ * @brief SVPWM implementation used by pwm_set_vector_svpwm()
+ */
+enum pwm_svpwm_mode {
+	PWM_SVPWM_SECTOR = 0,        /* Sector decode and T0/T1/T2 timing */
+	PWM_SVPWM_MINMAX,            /* Inverse Clarke + min/max zero-sequence */
+};
+
 /**
  * @brief PWM device runtime data
  */
@@ -39,6 +58,8 @@ struct pwm_data {
 	bool initialized;
 	float phase;                 /* Current phase angle in degrees */
 	float duty;                  /* Current duty cycle in percentage */
+	enum pwm_svpwm_mode svpwm_mode; /* SVPWM implementation */
+	uint32_t period;             /* Timer ARR cached by pwm_init() */
 };
 
 /**
@@ -61,6 +82,8 @@ int pwm_init(struct pwm_device *dev);
 /**
  * @brief Set duty cycle for all three phases with independent control
  *
+ * Percentage wrapper around pwm_set_duty_q15() for console commands.
+ *
  * @param dev Pointer to PWM device
  * @param duty_a Duty cycle for phase A (0-100%)
  * @param duty_b Duty cycle for phase B (0-100%)
@@ -69,6 +92,21 @@ int pwm_init(struct pwm_device *dev);
  */
 int pwm_set_duty(struct pwm_device *dev, float duty_a, float duty_b, float duty_c);
 
+/**
+ * @brief Set duty cycle for all three phases from Q15 fractions
+ *
+ * Fast path for the control loops: integer only, uses the period cached at
+ * pwm_init(). The initialized check only exists in DEBUG builds, so callers
+ * must not use it before pwm_init().
+ *
+ * @param dev Pointer to PWM device
+ * @param duty_a Duty cycle for phase A (0-PWM_DUTY_Q15_ONE, larger values clamp)
+ * @param duty_b Duty cycle for phase B (0-PWM_DUTY_Q15_ONE, larger values clamp)
+ * @param duty_c Duty cycle for phase C (0-PWM_DUTY_Q15_ONE, larger values clamp)
+ * @return 0 on success, negative value on failure
+ */
+int pwm_set_duty_q15(struct pwm_device *dev, uint16_t duty_a, uint16_t duty_b, uint16_t duty_c);
+
 /**
  * @brief Set duty cycle for a single phase
  *
@@ -79,6 +117,16 @@ int pwm_set_duty(struct pwm_device *dev, float duty_a, float duty_b, float duty_
  */
 int pwm_set_phase_duty(struct pwm_device *dev, uint8_t phase, float duty);
 
+/**
+ * @brief Check for a zero voltage vector
+ *
+ * All three phases at the same duty: the windings see no voltage.
+ *
+ * @param dev Pointer to PWM device
+ * @return true if the three compare values are equal
+ */
+bool pwm_is_zero_vector(const struct pwm_device *dev);
+
 /**
  * @brief Set three-phase sinusoidal PWM with 120-degree spacing
  *
@@ -110,6 +158,34 @@ int pwm_set_vector(struct pwm_device *dev, float angle_deg, float amplitude);
  */
 int pwm_set_vector_svpwm(struct pwm_device *dev, float angle_deg, float amplitude);
 
+/**
+ * @brief Set Space Vector PWM from a stationary-frame voltage vector
+ *
+ * Fast path for the current loop: min/max zero-sequence injection straight
+ * from alpha/beta, no angle or trig. Phase A lies on the alpha axis. Vectors
+ * longer than 1/sqrt(3) (the linear-region limit) are scaled down keeping
+ * their direction. The initialized check only exists in DEBUG builds.
+ *
+ * @param dev Pointer to PWM device
+ * @param v_alpha Alpha voltage as a fraction of the DC bus
+ * @param v_beta Beta voltage as a fraction of the DC bus
+ * @return 0 on success, negative value on failure
+ */
+int pwm_set_vector_ab(struct pwm_device *dev, float v_alpha, float v_beta);
+
+/**
+ * @brief Select the SVPWM implementation of a device
+ *
+ * Both modes produce the same waveform; compare values may differ by one
+ * count where angle rounding straddles a truncation boundary.
+ * PWM_SVPWM_MINMAX avoids the sector branch and needs less arithmetic.
+ *
+ * @param dev Pointer to PWM device
+ * @param mode SVPWM implementation
+ * @return 0 on success, negative value on failure
+ */
+int pwm_set_svpwm_mode(struct pwm_device *dev, enum pwm_svpwm_mode mode);
+
 /**
  * @brief Disable all PWM outputs (set to 0%)
  *
@@ -126,6 +202,18 @@ int pwm_disable(struct pwm_device *dev);
  */
 int pwm_start(struct pwm_device *dev);
 
+/**
+ * @brief Restart the timers of several devices in phase
+ *
+ * The currents of every motor are sampled on one ADC trigger from TIM2:
+ * the other timers must count in step with it. Call after pwm_start().
+ *
+ * @param devs Devices, the one driving the ADC trigger included
+ * @param count Number of devices
+ * @return 0 on success, negative value if a device is not initialized
+ */
+int pwm_sync(struct pwm_device *const *devs, uint8_t count);
+
 /**
  * @brief Stop PWM generation on all channels
  *
@@ -16,16 +16,34 @@ extern "C" {
 #include <stdint.h>
 
 /**
- * @brief UART input driver with interrupt-based reception
+ * @brief UART input driver with DMA-based reception
  *
- * This driver provides interrupt-based character reception from UART.
- * It uses a circular buffer to store received characters.
+ * The UART receives into a circular DMA buffer without CPU involvement.
+ * Whenever the line goes idle, or the DMA buffer is half or completely
+ * full, the new bytes are published in one go into a circular buffer that
+ * the main loop reads from. Nothing is printed from interrupt context;
+ * losses are counted in struct uart_in_stats instead.
  */
 
 #ifndef UART_IN_BUFFER_SIZE
-#define UART_IN_BUFFER_SIZE 16  /* Must be power of 2 for efficiency */
+#define UART_IN_BUFFER_SIZE 256  /* Must be power of 2 for efficiency */
 #endif
 
+/* DMA receive buffer; must hold what arrives between two interrupts */
+#ifndef UART_IN_DMA_SIZE
+#define UART_IN_DMA_SIZE 128
+#endif
+
+/**
+ * @brief Receive statistics
+ */
+struct uart_in_stats {
+	uint32_t received;   /* Bytes taken from the DMA buffer */
+	uint32_t dropped;    /* Bytes lost because the receive buffer was full */
+	uint32_t overruns;   /* UART overrun errors (bytes lost in hardware) */
+	uint32_t errors;     /* Framing, noise and parity errors */
+};
+
 /**
  * @brief Callback function type for received characters
  *
@@ -78,14 +96,30 @@ uint32_t uart_in_read(uint8_t *buf, uint32_t len);
 void uart_in_flush(void);
 
 /**
- * @brief UART interrupt callback (called from HAL_UART_RxCpltCallback)
+ * @brief Get receive statistics
+ *
+ * @param stats Pointer to store the statistics
+ */
+void uart_in_get_stats(struct uart_in_stats *stats);
+
+/**
+ * @brief UART receive event handler (called from HAL_UARTEx_RxEventCallback)
+ *
+ * Publishes the bytes the DMA wrote since the last event.
+ *
+ * @param huart Pointer to UART handle
+ * @param pos Fill position of the DMA buffer (1..UART_IN_DMA_SIZE)
+ */
+void uart_in_rx_event_handler(UART_HandleTypeDef *huart, uint16_t pos);
+
+/**
+ * @brief UART error handler (called from HAL_UART_ErrorCallback)
  *
- * This function should be called from the HAL UART RX complete callback.
- * It handles the received character and restarts reception.
+ * Counts the error and restarts reception if the HAL aborted it.
  *
  * @param huart Pointer to UART handle
  */
-void uart_in_irq_handler(UART_HandleTypeDef *huart);
+void uart_in_error_handler(UART_HandleTypeDef *huart);
 
 #ifdef __cplusplus
 }
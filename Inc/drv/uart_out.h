@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef UART_OUT_H
+#define UART_OUT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief UART output driver with DMA-based transmission
+ *
+ * Writers copy into a circular buffer and return at once; the buffer is
+ * drained by DMA in contiguous chunks, the next chunk being started from
+ * the transmit complete interrupt. stdout (_write and __io_putchar) is
+ * routed here so diagnostic output does not stall the main loop for the
+ * time it takes to shift the characters out.
+ *
+ * Writes are safe from any context. Interrupt handlers never block: when
+ * the buffer is full they drop, whatever the policy.
+ */
+
+#ifndef UART_OUT_BUFFER_SIZE
+#define UART_OUT_BUFFER_SIZE 1024  /* Must be power of 2 for efficiency */
+#endif
+
+/* Longest time a blocking write waits for buffer space */
+#ifndef UART_OUT_BLOCK_TIMEOUT_MS
+#define UART_OUT_BLOCK_TIMEOUT_MS 100
+#endif
+
+/**
+ * @brief What to do when the transmit buffer is full
+ */
+enum uart_out_policy {
+	UART_OUT_DROP,       /* Discard what does not fit (default) */
+	UART_OUT_BLOCK,      /* Wait for DMA to make room, up to the timeout */
+};
+
+/**
+ * @brief Transmit statistics
+ */
+struct uart_out_stats {
+	uint32_t written;    /* Bytes accepted into the buffer */
+	uint32_t dropped;    /* Bytes discarded because the buffer was full */
+	uint32_t transfers;  /* DMA transfers started */
+	uint32_t errors;     /* DMA transfers that failed */
+};
+
+/**
+ * @brief Initialize UART output driver
+ *
+ * Output written before this call is kept and sent once DMA is available.
+ *
+ * @param huart Pointer to UART handle with a linked TX DMA channel
+ * @return 0 on success, negative value on failure
+ */
+int uart_out_init(UART_HandleTypeDef *huart);
+
+/**
+ * @brief Select the overflow policy
+ *
+ * @param policy UART_OUT_DROP or UART_OUT_BLOCK
+ */
+void uart_out_set_policy(enum uart_out_policy policy);
+
+/**
+ * @brief Queue bytes for transmission
+ *
+ * @param data Bytes to send
+ * @param len Number of bytes
+ * @return Number of bytes queued; the rest were dropped
+ */
+uint32_t uart_out_write(const uint8_t *data, uint32_t len);
+
+/**
+ * @brief Get the number of bytes waiting to be sent
+ *
+ * @return Bytes in the buffer, including the transfer in flight
+ */
+uint32_t uart_out_pending(void);
+
+/**
+ * @brief Wait until everything queued has been sent
+ *
+ * @param timeout_ms Maximum time to wait in milliseconds
+ * @return 0 when the buffer is empty, -1 on timeout
+ */
+int uart_out_flush(uint32_t timeout_ms);
+
+/**
+ * @brief Get transmit statistics
+ *
+ * @param stats Pointer to store the statistics
+ */
+void uart_out_get_stats(struct uart_out_stats *stats);
+
+/**
+ * @brief UART TX complete handler (called from HAL callback)
+ *
+ * @param huart UART handle
+ */
+void uart_out_tx_complete_handler(UART_HandleTypeDef *huart);
+
+/**
+ * @brief UART error handler (called from HAL_UART_ErrorCallback)
+ *
+ * Drops the chunk of a failed DMA transfer so the rest still goes out.
+ *
+ * @param huart UART handle
+ */
+void uart_out_error_handler(UART_HandleTypeDef *huart);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UART_OUT_H */
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef EVENT_H
+#define EVENT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Event mailbox between interrupts and the main loop
+ *
+ * Each event is one bit in a pending mask. Interrupts post with an atomic
+ * OR and the main loop takes with an atomic AND (LDREX/STREX on the
+ * Cortex-M4), so neither side can lose the other's update. Posting an
+ * event that is still pending means the main loop fell behind; this is
+ * counted per event instead of silently merging into one.
+ */
+
+enum event_id {
+	EVENT_RESET,         /* System reset requested */
+	EVENT_ADC,           /* ADC data to handle */
+	EVENT_SCHED,         /* Scheduler released main loop tasks */
+	EVENT_UART_RX,       /* Console input received */
+	EVENT_PROTO_RX,      /* Protocol bytes received over USB or CAN */
+	EVENT_MONITOR,       /* Idle baseline measured, control may start */
+	EVENT_NUM
+};
+
+#define EVENT_BIT(id) (1UL << (id))
+
+/**
+ * @brief Per-event statistics
+ */
+struct event_stats {
+	uint32_t posted;     /* Times event_post() was called */
+	uint32_t overruns;   /* Posts that found the event still pending */
+};
+
+/**
+ * @brief Post an event
+ *
+ * Safe from any context, including nested interrupts.
+ *
+ * @param id Event to post
+ * @return 0 on success, -1 if the event was still pending (overrun) or id is invalid
+ */
+int event_post(enum event_id id);
+
+/**
+ * @brief Take an event if it is pending
+ *
+ * @param id Event to take
+ * @return true if the event was pending; it is cleared
+ */
+bool event_take(enum event_id id);
+
+/**
+ * @brief Take all pending events at once
+ *
+ * @return Mask of EVENT_BIT() values that were pending; all are cleared
+ */
+uint32_t event_take_all(void);
+
+/**
+ * @brief Get the pending events without taking them
+ *
+ * @return Mask of EVENT_BIT() values
+ */
+uint32_t event_pending(void);
+
+/**
+ * @brief Get statistics of an event
+ *
+ * @param id Event
+ * @param stats Pointer to store the statistics
+ */
+void event_get_stats(enum event_id id, struct event_stats *stats);
+
+/**
+ * @brief Clear pending events and statistics
+ *
+ * Not safe against concurrent posters; for start-up and tests.
+ */
+void event_reset(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EVENT_H */
@@ -13,6 +13,7 @@ extern "C" {
 
 #include "main.h"
 #include "drv/pwm.h"
+#include "drv/mt6701.h"
 #include <stdbool.h>
 
 /**
@@ -49,11 +50,43 @@ struct foc_current_config {
 	uint8_t adc_channel_a;       /* ADC channel for phase A current */
 	uint8_t adc_channel_b;       /* ADC channel for phase B current */
 	float current_sensitivity;   /* Current sensor sensitivity (V/A) */
-	float current_offset;        /* Current sensor offset (V) */
+	float current_offset[2];     /* Phase A, B: sensor output at 0 A (V) */
 	float current_limit_a;       /* Maximum allowed current (A) */
+	float scale[2];              /* Phase A, B: amps per ADC count */
+	float bias[2];               /* Phase A, B: amps at ADC count 0 */
+	bool offset_loaded;          /* current_offset restored, skip calibration */
+	bool offset_tracking;        /* Follow offset drift while idle */
 	bool enabled;                /* Current sensing enabled */
 };
 
+/* Offset measurement: sample sets per average (25.6 ms at 20 kHz) */
+#define FOC_OFFSET_SAMPLES     512U
+
+/* Offset measurement: idle sample sets before the first average (50 ms) */
+#define FOC_OFFSET_SETTLE      1000U
+
+/* Offset measurement: encoder speed that still counts as standing (RPM) */
+#define FOC_OFFSET_IDLE_RPM    5.0f
+
+/* Drift tracking: share of each new average taken into the offsets */
+#define FOC_OFFSET_TRACK_GAIN  (1.0f / 32.0f)
+
+/**
+ * @brief Current sensor offset measurement, fed by foc_current_task()
+ *
+ * Sums the raw samples of both phases while the motor is idle (see
+ * foc_current_enable()) and restarts whenever it is not. After a stop the
+ * first FOC_OFFSET_SETTLE idle sample sets are skipped, so braking current
+ * and a stale speed estimate have died away.
+ */
+struct foc_offset_cal {
+	uint32_t sum[2];             /* Phase A, B: ADC counts */
+	uint32_t samples;            /* Sample sets in sum */
+	uint32_t settle;             /* Idle sample sets skipped so far */
+	uint32_t averages;           /* Averages taken, calibration included */
+	volatile bool active;        /* Calibrating: sensing is enabled when done */
+};
+
 /**
  * @brief Current sensing data
  */
@@ -65,6 +98,96 @@ struct foc_current_data {
 	bool overcurrent;            /* Overcurrent flag */
 };
 
+/**
+ * @brief ADC counts to amps, one multiply-add per value
+ *
+ * amps[i] = raw[i] * scale[i] + bias[i]. The iterations are independent,
+ * so the loop vectorises over a whole sample set where the target has
+ * float SIMD; on the Cortex-M4 each one is a single VFMA.
+ *
+ * @param raw ADC counts
+ * @param scale Amps per count, from foc_current_update_scale()
+ * @param bias Amps at count 0, from foc_current_update_scale()
+ * @param amps Pointer to store the currents
+ * @param n Number of values
+ */
+static inline void foc_current_convert(const uint16_t *__restrict raw, const float *__restrict scale,
+                                       const float *__restrict bias, float *__restrict amps,
+                                       uint32_t n)
+{
+	for (uint32_t i = 0; i < n; i++) {
+		amps[i] = (float)raw[i] * scale[i] + bias[i];
+	}
+}
+
+/* Current loop rate: one update per injected ADC sequence (TIM2 TRGO) */
+#define FOC_CURRENT_LOOP_HZ    20000.0f
+
+/**
+ * @brief Torque (current loop) configuration
+ */
+struct foc_torque_config {
+	float kp;                    /* PI proportional gain (V/A) */
+	float ki;                    /* PI integral gain (V/(A s)) */
+	float vbus;                  /* DC bus voltage (V) */
+	bool enabled;                /* Current loop owns the PWM outputs */
+};
+
+/**
+ * @brief Torque (current loop) state, updated at FOC_CURRENT_LOOP_HZ
+ */
+struct foc_torque_data {
+	float id_ref;                /* d-axis current reference (A) */
+	float iq_ref;                /* q-axis current reference (A) */
+	float id;                    /* Measured d-axis current (A) */
+	float iq;                    /* Measured q-axis current (A) */
+	float vd;                    /* d-axis voltage command (V) */
+	float vq;                    /* q-axis voltage command (V) */
+	float id_integral;           /* d-axis PI integrator (V) */
+	float iq_integral;           /* q-axis PI integrator (V) */
+	uint32_t updates;            /* Loop iterations since enable */
+};
+
+/* Speed low-pass coefficient per encoder sample (1.0 = unfiltered) */
+#define FOC_SPEED_FILTER       0.1f
+
+/* Rate of foc_encoder_start(), the time base of the encoder samples */
+#define FOC_ENCODER_HZ         1000.0f
+
+/* Oldest encoder sample (in encoder ticks) the velocity loop will use */
+#define FOC_ENCODER_MAX_AGE    10
+
+/* Time the rotor is held on the d-axis by foc_encoder_align() */
+#define FOC_ALIGN_MS           500
+
+/**
+ * @brief Encoder feedback (MT6701) for closed-loop velocity
+ */
+struct foc_encoder {
+	mt6701_t *dev;               /* Encoder device, NULL if none attached */
+	float offset_deg;            /* Electrical angle at encoder zero (degrees) */
+	uint16_t last_raw;           /* Previous raw angle (14-bit) */
+	uint32_t last_seq;           /* Sequence number of last_raw */
+	uint32_t last_timestamp;     /* Encoder tick of last_raw */
+	bool valid;                  /* last_raw holds a sample */
+	float measured_rpm;          /* Filtered mechanical speed in RPM */
+	float electrical_dps;        /* Electrical speed in degrees/s */
+	uint32_t errors;             /* Updates without a usable sample */
+};
+
+/**
+ * @brief Closed-loop speed PI
+ *
+ * The output is the q-axis current reference (A) when torque mode is
+ * enabled, otherwise the q-axis voltage amplitude (0-100%).
+ */
+struct foc_speed_pi {
+	float kp;                    /* Proportional gain (output per RPM) */
+	float ki;                    /* Integral gain (output per RPM s) */
+	float integral;              /* Integrator (output units) */
+	float output;                /* Last command */
+};
+
 /**
  * @brief FOC motor instance
  */
@@ -74,18 +197,32 @@ struct foc_motor {
 
 	/* Velocity control */
 	struct foc_velocity_config velocity_cfg;
-	float current_rpm;           /* Current velocity in RPM */
+	float current_rpm;           /* Ramped velocity command in RPM */
 	float electrical_angle;      /* Current electrical angle in degrees */
 	float amplitude;             /* PWM amplitude/magnitude (0-100%) */
 
+	/* Closed-loop velocity */
+	struct foc_encoder encoder;
+	struct foc_speed_pi speed_pi;
+
 	/* Current sensing */
 	struct foc_current_config current_cfg;
 	struct foc_current_data current_data;
+	struct foc_offset_cal offset_cal;
+
+	/* Torque (current loop) */
+	struct foc_torque_config torque_cfg;
+	struct foc_torque_data torque_data;
 };
 
 /**
  * @brief Enable velocity control mode
  *
+ * In FOC_VELOCITY_CLOSED_LOOP the speed is measured with the attached
+ * encoder and a PI sets the q-axis command: the current reference when
+ * torque mode is enabled (limited to the current limit), otherwise the
+ * voltage amplitude, for which @p amplitude is then the upper limit.
+ *
  * @param motor Pointer to FOC motor instance
  * @param mode Velocity control mode
  * @param target_rpm Target velocity in RPM
@@ -115,9 +252,38 @@ int foc_velocity_disable(struct foc_motor *motor);
  */
 int foc_velocity_set_target(struct foc_motor *motor, float target_rpm);
 
+/**
+ * @brief Set the PWM amplitude while velocity control runs
+ *
+ * Unlike re-enabling, the ramp, angle and speed loop carry on. In
+ * FOC_VELOCITY_CLOSED_LOOP without torque mode this is the limit of the
+ * speed PI output.
+ *
+ * @param motor Pointer to FOC motor instance
+ * @param amplitude PWM amplitude/magnitude (0-100%)
+ * @return 0 on success, negative value on failure
+ */
+int foc_velocity_set_amplitude(struct foc_motor *motor, float amplitude);
+
+/**
+ * @brief Set the closed-loop speed PI gains
+ *
+ * Units follow the PI output: A/RPM and A/(RPM s) with torque mode,
+ * %/RPM and %/(RPM s) without.
+ *
+ * @param motor Pointer to FOC motor instance
+ * @param kp Proportional gain
+ * @param ki Integral gain
+ * @return 0 on success, negative value on failure
+ */
+int foc_velocity_set_gains(struct foc_motor *motor, float kp, float ki);
+
 /**
  * @brief Get current velocity
  *
+ * Reports the speed measured by the encoder when one is attached (updated
+ * while velocity control is active), otherwise the commanded ramp value.
+ *
  * @param motor Pointer to FOC motor instance
  * @param rpm Pointer to store current velocity in RPM
  * @return 0 on success, negative value on failure
@@ -133,6 +299,39 @@ int foc_velocity_get_current(struct foc_motor *motor, float *rpm);
  */
 void foc_velocity_update(struct foc_motor *motor);
 
+/**
+ * @brief Attach an angle encoder to a motor
+ *
+ * @param motor Pointer to FOC motor instance
+ * @param encoder Initialized MT6701 device (NULL to detach)
+ * @param offset_deg Electrical angle at encoder zero in degrees
+ * @return 0 on success, negative value on failure
+ */
+int foc_encoder_attach(struct foc_motor *motor, mt6701_t *encoder, float offset_deg);
+
+/**
+ * @brief Start the encoder reads of all motors
+ *
+ * Call at FOC_ENCODER_HZ from interrupt context. Each attached encoder
+ * gets a non-blocking burst read stamped with the tick count; the velocity
+ * loop uses the latest sample that completed and extrapolates it by its
+ * age.
+ */
+void foc_encoder_start(void);
+
+/**
+ * @brief Find the encoder offset by locking the rotor to the d-axis
+ *
+ * Applies a stationary voltage vector at 0 degrees for FOC_ALIGN_MS
+ * (blocking), reads the encoder and stores the electrical offset. Velocity
+ * control and torque mode must be disabled.
+ *
+ * @param motor Pointer to FOC motor instance
+ * @param amplitude Alignment vector amplitude (0-100%)
+ * @return 0 on success, negative value on failure
+ */
+int foc_encoder_align(struct foc_motor *motor, float amplitude);
+
 /**
  * @brief Get FOC motor instance by name
  *
@@ -144,11 +343,33 @@ struct foc_motor *foc_get_motor(const char *name);
 /**
  * @brief Periodical FOC task for all motors
  *
- * This function updates velocity control for all motors and should be
- * called from a timer interrupt or periodically from the main loop.
+ * Runs foc_velocity_task() and foc_protection_task() back to back, for
+ * callers that run the whole outer loop at one rate.
  */
 void foc_task(void);
 
+/**
+ * @brief Current loop task for all motors
+ *
+ * Converts the phase currents of every motor with current sensing into
+ * current_data, and runs the torque loop of every motor in torque mode,
+ * on the latest ADC sample set. Call at FOC_CURRENT_LOOP_HZ, right after
+ * each ADC DMA sequence completes.
+ */
+void foc_current_task(void);
+
+/**
+ * @brief Velocity loop task for all motors
+ *
+ * Call at the update rate given to foc_velocity_enable().
+ */
+void foc_velocity_task(void);
+
+/**
+ * @brief Current sensing and overcurrent protection task for all motors
+ */
+void foc_protection_task(void);
+
 /**
  * @brief Configure current sensing for a motor
  *
@@ -156,21 +377,63 @@ void foc_task(void);
  * @param adc_ch_a ADC channel for phase A current (0-4)
  * @param adc_ch_b ADC channel for phase B current (0-4)
  * @param sensitivity Current sensor sensitivity in V/A (e.g., 0.2 for INA181A1 with 0.01Ω shunt)
- * @param offset Current sensor offset voltage in V (0V for unidirectional INA181A1)
+ * @param offset Current sensor offset voltage in V, both phases (0V for unidirectional INA181A1)
  * @param limit_a Maximum allowed current in Amps
  * @return 0 on success, negative value on failure
  */
 int foc_current_config(struct foc_motor *motor, uint8_t adc_ch_a, uint8_t adc_ch_b,
                        float sensitivity, float offset, float limit_a);
 
+/**
+ * @brief Fold sensitivity and offset into scale and bias
+ *
+ * Done by foc_current_config(), the offset measurement and parameter
+ * writes; call it after changing current_sensitivity or current_offset
+ * any other way.
+ *
+ * @param cfg Current sensing configuration
+ */
+void foc_current_update_scale(struct foc_current_config *cfg);
+
 /**
  * @brief Enable current sensing
  *
+ * Unless current_cfg.offset_loaded says stored offsets were restored,
+ * the offset of each phase is measured first: the PWM is set to a 50%
+ * zero vector and foc_current_task() averages FOC_OFFSET_SAMPLES sample
+ * sets per phase. This returns at once; sensing is enabled when the
+ * averages are done, see foc_current_calibrating(). The motor must be
+ * idle and stay so, samples taken while it is not are dropped. Velocity
+ * and torque control refuse to start until then.
+ *
  * @param motor Pointer to FOC motor instance
- * @return 0 on success, negative value on failure
+ * @return 0 on success, negative value if the motor is running
  */
 int foc_current_enable(struct foc_motor *motor);
 
+/**
+ * @brief Check for an offset calibration in progress
+ *
+ * @param motor Pointer to FOC motor instance
+ * @return true until foc_current_enable() has measured the offsets
+ */
+bool foc_current_calibrating(const struct foc_motor *motor);
+
+/**
+ * @brief Follow offset drift while the motor is idle
+ *
+ * With sensing enabled, velocity control disabled, no torque mode, a
+ * zero vector on the PWM and the rotor standing (if an encoder says so),
+ * foc_current_task() keeps averaging the phase samples and moves each
+ * offset by FOC_OFFSET_TRACK_GAIN of the difference, i.e. with a time
+ * constant of about 0.8 s.
+ *
+ * @param motor Pointer to FOC motor instance
+ * @param enable Track or not
+ * @return 0 on success, negative value on failure
+ */
+int foc_current_track_offset(struct foc_motor *motor, bool enable);
+
 /**
  * @brief Disable current sensing
  *
@@ -180,10 +443,11 @@ int foc_current_enable(struct foc_motor *motor);
 int foc_current_disable(struct foc_motor *motor);
 
 /**
- * @brief Update current measurements for a motor
+ * @brief Overcurrent protection for a motor
  *
- * Reads ADC values, converts to currents, and checks limits.
- * Should be called periodically (e.g., from foc_task).
+ * Backs off the current references or the amplitude while the currents
+ * measured by foc_current_task() are over the limit. Should be called
+ * periodically (e.g., from foc_task).
  *
  * @param motor Pointer to FOC motor instance
  */
@@ -215,6 +479,61 @@ bool foc_current_is_overcurrent(struct foc_motor *motor);
  */
 int foc_current_set_limit(struct foc_motor *motor, float limit_a);
 
+/**
+ * @brief Enable torque mode (field-oriented current loop)
+ *
+ * The current loop runs in foc_current_task() on every ADC DMA sample
+ * set: Clarke, Park at motor->electrical_angle, PI on id/iq,
+ * inverse Park and SVPWM. While enabled the loop owns the PWM outputs; an
+ * active velocity mode only advances electrical_angle (current-controlled
+ * open loop). Current sensing must be enabled first.
+ *
+ * @param motor Pointer to FOC motor instance
+ * @param kp Proportional gain in V/A (e.g. Ls * bandwidth)
+ * @param ki Integral gain in V/(A s) (e.g. Rs * bandwidth)
+ * @param vbus DC bus voltage in V
+ * @return 0 on success, negative value on failure
+ */
+int foc_torque_enable(struct foc_motor *motor, float kp, float ki, float vbus);
+
+/**
+ * @brief Disable torque mode and return PWM control to velocity mode
+ *
+ * @param motor Pointer to FOC motor instance
+ * @return 0 on success, negative value on failure
+ */
+int foc_torque_disable(struct foc_motor *motor);
+
+/**
+ * @brief Set the dq current references
+ *
+ * @param motor Pointer to FOC motor instance
+ * @param id_ref d-axis (flux) current in A
+ * @param iq_ref q-axis (torque) current in A
+ * @return 0 on success, negative value on failure
+ */
+int foc_torque_set_target(struct foc_motor *motor, float id_ref, float iq_ref);
+
+/**
+ * @brief Set the d/q current PI gains
+ *
+ * @param motor Pointer to FOC motor instance
+ * @param kp Proportional gain (V/A)
+ * @param ki Integral gain (V/(A s))
+ * @return 0 on success, negative value on failure
+ */
+int foc_torque_set_gains(struct foc_motor *motor, float kp, float ki);
+
+/**
+ * @brief Run one current loop iteration
+ *
+ * Called from the ADC DMA completion callback with the fresh sample set.
+ *
+ * @param motor Pointer to FOC motor instance
+ * @param values ADC values (ADC_DMA_NUM_CHANNELS entries)
+ */
+void foc_torque_update(struct foc_motor *motor, const uint16_t *values);
+
 #ifdef __cplusplus
 }
 #endif
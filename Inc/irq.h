@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef IRQ_H
+#define IRQ_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+
+/**
+ * @brief Mask interrupts and return the previous PRIMASK
+ *
+ * Pairs with irq_restore(), so sections nest and are safe to enter with
+ * interrupts already masked.
+ */
+static inline uint32_t irq_save(void)
+{
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	return primask;
+}
+
+/**
+ * @brief Restore the PRIMASK returned by irq_save()
+ */
+static inline void irq_restore(uint32_t primask)
+{
+	__set_PRIMASK(primask);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IRQ_H */
@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef LOG_H
+#define LOG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @brief Deferred binary logging
+ *
+ * Hot paths (interrupts, foc_task) push a compact record - a message ID,
+ * a time stamp and up to LOG_MAX_ARGS raw 32-bit arguments - into a
+ * lock-free ring, which costs a few hundred cycles and never blocks. The
+ * main loop drains the ring with log_flush(), which looks the format
+ * string up by ID and prints there. Records may be pushed from any
+ * context, including nested interrupts; only one context may drain.
+ *
+ * Messages are declared in LOG_MESSAGES below. Formats may only use 32-bit
+ * integer conversions (%d, %u, %x, %c); pass floats as scaled integers.
+ */
+
+/* Ring capacity in records (power of two) */
+#define LOG_RING_SIZE          64U
+
+/* Maximum arguments per record */
+#define LOG_MAX_ARGS           6U
+
+/* Longest formatted line, including the time stamp prefix */
+#define LOG_LINE_MAX           128U
+
+/**
+ * @brief Message table: X(id, format)
+ */
+#define LOG_MESSAGES(X) \
+	X(LOG_FOC_ADC_RAW,       "motor%u: ADC raw: A=%u B=%u, Voltage: A=%dmV B=%dmV\n") \
+	X(LOG_FOC_OFFSET_CAL,    "motor%u: Current sensing enabled, offsets A=%dmV B=%dmV\n") \
+	X(LOG_FOC_OC_CURRENT,    "motor%u: Overcurrent detected (%d mA), reducing current reference\n") \
+	X(LOG_FOC_OC_AMPLITUDE,  "motor%u: Overcurrent detected (%d mA), reducing amplitude to %d%%\n") \
+	X(LOG_CAN_RX,            "CAN RX: ID=0x%03X DLC=%u Data=%08X %08X\n") \
+	X(LOG_CAN_TX_ERROR,      "CAN TX Error: %d\n")
+
+#define LOG_ENUM(id, fmt) id,
+enum log_id {
+	LOG_MESSAGES(LOG_ENUM)
+	LOG_NUM_IDS
+};
+#undef LOG_ENUM
+
+/**
+ * @brief One log record as stored in the ring
+ */
+struct log_record {
+	uint16_t id;                 /* enum log_id */
+	uint8_t nargs;               /* Valid entries in args */
+	uint32_t timestamp;          /* HAL_GetTick() when pushed */
+	uint32_t args[LOG_MAX_ARGS];
+};
+
+/**
+ * @brief Ring statistics
+ */
+struct log_stats {
+	uint32_t written;            /* Records pushed */
+	uint32_t dropped;            /* Records lost because the ring was full */
+};
+
+/**
+ * @brief Push a record with integer arguments
+ *
+ * Usage: LOG(LOG_CAN_TX_ERROR, status). Arguments are converted to uint32_t;
+ * cast floats to int first.
+ */
+#define LOG(id, ...) \
+	log_write((id), (const uint32_t[]){ 0, ##__VA_ARGS__ } + 1, \
+	          sizeof((const uint32_t[]){ 0, ##__VA_ARGS__ }) / sizeof(uint32_t) - 1U)
+
+/**
+ * @brief Push a record into the ring
+ *
+ * Lock-free and non-blocking; drops the record if the ring is full.
+ *
+ * @param id Message ID
+ * @param args Arguments (may be NULL if nargs is 0)
+ * @param nargs Number of arguments (at most LOG_MAX_ARGS, extra are ignored)
+ * @return 0 on success, -1 if the record was dropped
+ */
+int log_write(enum log_id id, const uint32_t *args, size_t nargs);
+
+/**
+ * @brief Pop the oldest record
+ *
+ * Must only be called from one context (the main loop).
+ *
+ * @param rec Pointer to store the record
+ * @return 0 on success, -1 if the ring is empty
+ */
+int log_read(struct log_record *rec);
+
+/**
+ * @brief Format a record as text
+ *
+ * @param rec Record to format
+ * @param buf Output buffer
+ * @param size Output buffer size
+ * @return Length of the formatted line (as snprintf)
+ */
+int log_format(const struct log_record *rec, char *buf, size_t size);
+
+/**
+ * @brief Drain the ring to stdout
+ *
+ * Formats and prints every pending record, then reports records dropped
+ * since the last call. Call from the main loop.
+ *
+ * @return Number of records printed
+ */
+int log_flush(void);
+
+/**
+ * @brief Get ring statistics
+ *
+ * @param stats Pointer to store the statistics
+ */
+void log_get_stats(struct log_stats *stats);
+
+/**
+ * @brief Empty the ring and clear statistics
+ *
+ * Not safe against concurrent writers; for start-up and tests.
+ */
+void log_reset(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LOG_H */
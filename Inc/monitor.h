@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef MONITOR_H
+#define MONITOR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief CPU load and control tick jitter monitor
+ *
+ * Load: the main loop calls monitor_idle() on every pass that finds no
+ * event pending. monitor_calibrate() measures the cycles one such pass
+ * takes with nothing else running, on the main loop itself: it times
+ * MONITOR_CALIB_ROUNDS rounds of MONITOR_CALIB_SPINS idle passes and keeps
+ * the cheapest. monitor_update() then turns the spins counted over a
+ * window into idle time and reports the rest as load.
+ *
+ * Jitter: monitor_tick() is called from the control tick interrupt with
+ * the cycle count at entry. The deviation of each interval from the
+ * nominal period goes into a histogram of MONITOR_JITTER_BINS bins of
+ * MONITOR_JITTER_BIN_CYCLES, centred on zero; the outer bins also collect
+ * everything beyond them.
+ */
+
+#define MONITOR_JITTER_BINS        16U
+#define MONITOR_JITTER_BIN_CYCLES  64U   /* ~0.38 us at 170 MHz */
+
+/* Calibration: rounds of idle passes, the cheapest round counts */
+#define MONITOR_CALIB_SPINS        4096U
+#define MONITOR_CALIB_ROUNDS       8U
+
+/* CAN frame carrying the monitor report */
+#define MONITOR_CAN_ID             0x110U
+#define MONITOR_CAN_LEN            8U
+
+/**
+ * @brief CPU load figures, in permille
+ */
+struct monitor_load {
+	uint16_t load;               /* Last window */
+	uint16_t peak;               /* Highest window since monitor_reset() */
+	uint32_t windows;            /* Windows measured */
+};
+
+/**
+ * @brief Control tick jitter
+ */
+struct monitor_jitter {
+	uint32_t period;             /* Nominal period (cycles) */
+	uint32_t ticks;              /* Intervals measured */
+	int32_t min;                 /* Earliest arrival (cycles, negative = early) */
+	int32_t max;                 /* Latest arrival (cycles) */
+	uint32_t hist[MONITOR_JITTER_BINS];
+};
+
+/**
+ * @brief Calibration finished hook, called from monitor_idle()
+ */
+typedef void (*monitor_notify_t)(void);
+
+/**
+ * @brief Start measuring the cost of one idle pass
+ *
+ * Returns at once; the main loop's own monitor_idle() calls take the
+ * measurement, so the baseline is exactly the pass it will later count.
+ * Start it with the control interrupts not running yet, or the baseline
+ * includes their time. Load reads 0 until the first calibration is done.
+ *
+ * @param done Called once the baseline is known (may be NULL)
+ * @return 0 on success, -1 if a calibration is already running
+ */
+int monitor_calibrate(monitor_notify_t done);
+
+/**
+ * @brief Check for a calibration in progress
+ *
+ * @return true until the baseline of monitor_calibrate() is known
+ */
+bool monitor_calibrating(void);
+
+/**
+ * @brief Get the calibrated cost of one idle pass
+ *
+ * @return Cycles per idle pass (8.8 fixed point), 0 before calibration
+ */
+uint32_t monitor_get_baseline(void);
+
+/**
+ * @brief Set the nominal control tick period
+ *
+ * @param period_cycles Cycles between ticks
+ */
+void monitor_set_period(uint32_t period_cycles);
+
+/**
+ * @brief Count one idle pass of the main loop
+ */
+void monitor_idle(void);
+
+/**
+ * @brief Close the current load window
+ *
+ * Call periodically from the main loop; the window is the time since the
+ * previous call.
+ *
+ * @return Load of the window in permille
+ */
+uint16_t monitor_update(void);
+
+/**
+ * @brief Record a control tick arrival
+ *
+ * Call from the control tick interrupt.
+ *
+ * @param now Cycle count at interrupt entry
+ */
+void monitor_tick(uint32_t now);
+
+/**
+ * @brief Get the CPU load figures
+ *
+ * @param load Pointer to store the figures
+ */
+void monitor_get_load(struct monitor_load *load);
+
+/**
+ * @brief Get a snapshot of the jitter histogram
+ *
+ * @param jitter Pointer to store the snapshot
+ */
+void monitor_get_jitter(struct monitor_jitter *jitter);
+
+/**
+ * @brief Build the CAN report
+ *
+ * Little endian: load and peak load (permille, u16), earliest and latest
+ * tick arrival (ns, s16, saturated).
+ *
+ * @param data Buffer of MONITOR_CAN_LEN bytes
+ */
+void monitor_pack_can(uint8_t data[MONITOR_CAN_LEN]);
+
+/**
+ * @brief Clear peak load and the jitter histogram
+ *
+ * Keeps the calibration and the nominal period.
+ */
+void monitor_reset(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MONITOR_H */
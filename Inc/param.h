@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef PARAM_H
+#define PARAM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "foc.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Runtime-tunable motor parameters
+ *
+ * One table describes every tunable field of struct foc_motor: ID, name,
+ * type, range and offset into the struct. The ID indexes the table, so
+ * get and set are O(1) from the console, the binary protocol or a
+ * configuration store alike. Values are exchanged as float whatever the
+ * field type.
+ *
+ * Writes are range-checked first and then stored with interrupts masked,
+ * so the control interrupts never see a half-applied update;
+ * param_set_many() applies a group (e.g. kp and ki) the same way, all or
+ * nothing.
+ *
+ * param_save() and param_load() keep writable parameters in the
+ * configuration store (store.h), one float per parameter and axis under
+ * PARAM_STORE_KEY(). IDs are therefore part of the stored format as well
+ * as of the protocol: append new parameters, do not renumber.
+ */
+
+/* Flags */
+#define PARAM_READONLY  (1U << 0)    /* Reported, never written */
+#define PARAM_STOPPED   (1U << 1)    /* Only while velocity control is off */
+
+/*
+ * X(id, name, type, field, min, max, flags)
+ *
+ * velocity_rate_hz is set by foc_velocity_enable() to the rate of the
+ * task that calls foc_velocity_task(), so it is only reported.
+ */
+#define PARAMS(X) \
+	X(PARAM_POLE_PAIRS,          "pole_pairs",          PARAM_U8,  velocity_cfg.pole_pairs,          1.0f,    64.0f,     PARAM_STOPPED)  \
+	X(PARAM_ACCELERATION,        "acceleration",        PARAM_F32, velocity_cfg.acceleration,        1.0f,    100000.0f, 0)              \
+	X(PARAM_VELOCITY_RATE,       "velocity_rate_hz",    PARAM_F32, velocity_cfg.update_rate_hz,      0.0f,    0.0f,      PARAM_READONLY) \
+	X(PARAM_SPEED_KP,            "speed_kp",            PARAM_F32, speed_pi.kp,                      0.0f,    1000.0f,   0)              \
+	X(PARAM_SPEED_KI,            "speed_ki",            PARAM_F32, speed_pi.ki,                      0.0f,    1000.0f,   0)              \
+	X(PARAM_CURRENT_KP,          "current_kp",          PARAM_F32, torque_cfg.kp,                    0.0f,    100.0f,    0)              \
+	X(PARAM_CURRENT_KI,          "current_ki",          PARAM_F32, torque_cfg.ki,                    0.0f,    100000.0f, 0)              \
+	X(PARAM_VBUS,                "vbus",                PARAM_F32, torque_cfg.vbus,                  1.0f,    60.0f,     0)              \
+	X(PARAM_CURRENT_SENSITIVITY, "current_sensitivity", PARAM_F32, current_cfg.current_sensitivity,  0.01f,   10.0f,     0)              \
+	X(PARAM_CURRENT_OFFSET_A,    "current_offset_a",    PARAM_F32, current_cfg.current_offset[0],    -3.3f,   3.3f,      0)              \
+	X(PARAM_CURRENT_LIMIT,       "current_limit",       PARAM_F32, current_cfg.current_limit_a,      0.1f,    50.0f,     0)              \
+	X(PARAM_ENCODER_OFFSET,      "encoder_offset",      PARAM_F32, encoder.offset_deg,               0.0f,    360.0f,    0)              \
+	X(PARAM_CURRENT_OFFSET_B,    "current_offset_b",    PARAM_F32, current_cfg.current_offset[1],    -3.3f,   3.3f,      0)
+
+enum param_id {
+#define PARAM_ENUM(id, name, type, field, min, max, flags) id,
+	PARAMS(PARAM_ENUM)
+#undef PARAM_ENUM
+	PARAM_NUM
+};
+
+/**
+ * @brief Storage type of a parameter
+ */
+enum param_type {
+	PARAM_U8,
+	PARAM_F32,
+};
+
+/**
+ * @brief Table entry
+ */
+struct param_info {
+	const char *name;
+	uint8_t type;                /* enum param_type */
+	uint8_t flags;               /* PARAM_* */
+	uint16_t offset;             /* Into struct foc_motor */
+	float min;
+	float max;
+};
+
+/**
+ * @brief One value of a group write
+ */
+struct param_value {
+	uint16_t id;
+	float value;
+};
+
+/**
+ * @brief Get a parameter's description
+ *
+ * @param id Parameter
+ * @return Entry, NULL if id is out of range
+ */
+const struct param_info *param_info(uint16_t id);
+
+/**
+ * @brief Look a parameter up by name
+ *
+ * @param name Name
+ * @return ID, -1 if there is none
+ */
+int param_find(const char *name);
+
+/**
+ * @brief Read a parameter
+ *
+ * @param motor Motor
+ * @param id Parameter
+ * @param value Pointer to store the value
+ * @return 0 on success, -1 if id is out of range
+ */
+int param_get(const struct foc_motor *motor, uint16_t id, float *value);
+
+/**
+ * @brief Write a parameter
+ *
+ * @param motor Motor
+ * @param id Parameter
+ * @param value New value
+ * @return 0 on success, -1 if id is out of range or read-only or the value
+ *         is out of range (or not an integer for integer types), -2 if the
+ *         motor has to be stopped first
+ */
+int param_set(struct foc_motor *motor, uint16_t id, float value);
+
+/**
+ * @brief Write several parameters at once
+ *
+ * All values are checked before any is stored; the control interrupts see
+ * either none or all of them.
+ *
+ * @param motor Motor
+ * @param values Parameters and values
+ * @param count Number of values
+ * @return 0 on success, else as param_set() for the first bad value
+ */
+int param_set_many(struct foc_motor *motor, const struct param_value *values, uint32_t count);
+
+/* Store key of a saved parameter */
+#define PARAM_STORE_KEY(axis, id)  (0x0100U + (uint16_t)(axis) * 0x40U + (uint16_t)(id))
+
+/**
+ * @brief Save one parameter to the configuration store
+ *
+ * Writes flash, see store.h.
+ *
+ * @param motor Motor
+ * @param axis Axis number, the store key of the motor
+ * @param id Parameter, not read-only
+ * @return 0 on success, -1 if the value is out of range or the store failed
+ */
+int param_save(const struct foc_motor *motor, uint8_t axis, uint16_t id);
+
+/**
+ * @brief Save all writable parameters to the configuration store
+ *
+ * Unchanged values cost no flash writes. Values outside their range
+ * (fields not set up yet) are left out.
+ *
+ * @param motor Motor
+ * @param axis Axis number
+ * @return 0 on success, -1 if any value could not be saved
+ */
+int param_save_all(const struct foc_motor *motor, uint8_t axis);
+
+/**
+ * @brief Apply the saved parameters of an axis
+ *
+ * Values that fail the checks of param_set() are skipped.
+ *
+ * @param motor Motor
+ * @param axis Axis number
+ * @return Number of parameters applied
+ */
+int param_load(struct foc_motor *motor, uint8_t axis);
+
+/**
+ * @brief Check whether a parameter has been saved
+ *
+ * @param axis Axis number
+ * @param id Parameter
+ * @return true if the store holds a value
+ */
+bool param_saved(uint8_t axis, uint16_t id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PARAM_H */
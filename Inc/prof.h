@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef PROF_H
+#define PROF_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+#include <stdint.h>
+
+/**
+ * @brief Cycle-accurate profiling probes
+ *
+ * Each probe accumulates the cycle counts of the code it brackets: call
+ * count, minimum, maximum, last and total (for the average). Times come
+ * from the DWT cycle counter; on the host the shim's DWT follows the
+ * monotonic clock, scaled to SystemCoreClock. The cost of an empty probe,
+ * measured by prof_init(), is subtracted from every sample.
+ *
+ * Probes are declared in PROF_PROBES below and placed with:
+ *
+ *	PROF_START(PROF_SVPWM);
+ *	...
+ *	PROF_STOP(PROF_SVPWM);
+ *
+ * Build with PROF_ENABLE=0 and the probes compile to nothing.
+ */
+
+#ifndef PROF_ENABLE
+#define PROF_ENABLE 1
+#endif
+
+/**
+ * @brief Probe table: X(id, name)
+ */
+#define PROF_PROBES(X) \
+	X(PROF_VELOCITY_UPDATE,  "foc_velocity_update") \
+	X(PROF_CURRENT_UPDATE,   "foc_current_update") \
+	X(PROF_TORQUE_UPDATE,    "foc_torque_update") \
+	X(PROF_SVPWM,            "pwm_set_vector_svpwm") \
+	X(PROF_ENCODER_READ,     "mt6701 I2C read")
+
+#define PROF_ENUM(id, name) id,
+enum prof_id {
+	PROF_PROBES(PROF_ENUM)
+	PROF_NUM_IDS
+};
+#undef PROF_ENUM
+
+/**
+ * @brief Probe statistics (cycles)
+ */
+struct prof_stats {
+	uint32_t count;
+	uint32_t min;
+	uint32_t max;
+	uint32_t last;
+	uint64_t total;
+};
+
+/**
+ * @brief Read the cycle counter
+ */
+static inline uint32_t prof_now(void)
+{
+	return DWT->CYCCNT;
+}
+
+#if PROF_ENABLE
+#define PROF_START(id)           uint32_t prof_start_##id = prof_now()
+#define PROF_STOP(id)            prof_record((id), prof_now() - prof_start_##id)
+/* Span started in another function, e.g. an interrupt-driven transfer */
+#define PROF_STAMP(var)          ((var) = prof_now())
+#define PROF_STOP_FROM(id, var)  prof_record((id), prof_now() - (var))
+#else
+#define PROF_START(id)           ((void)0)
+#define PROF_STOP(id)            ((void)0)
+#define PROF_STAMP(var)          ((void)0)
+#define PROF_STOP_FROM(id, var)  ((void)0)
+#endif
+
+/**
+ * @brief Start the cycle counter and measure the probe overhead
+ *
+ * Also clears all probes.
+ */
+void prof_init(void);
+
+/**
+ * @brief Add one sample to a probe
+ *
+ * Safe from any context.
+ *
+ * @param id Probe ID
+ * @param cycles Measured cycles, probe overhead included
+ */
+void prof_record(enum prof_id id, uint32_t cycles);
+
+/**
+ * @brief Get a probe's statistics
+ *
+ * @param id Probe ID
+ * @param stats Pointer to store the statistics
+ * @return 0 on success, -1 if id is invalid
+ */
+int prof_get(enum prof_id id, struct prof_stats *stats);
+
+/**
+ * @brief Get a probe's name
+ *
+ * @param id Probe ID
+ * @return Name, or NULL if id is invalid
+ */
+const char *prof_name(enum prof_id id);
+
+/**
+ * @brief Clear all probes
+ */
+void prof_reset(void);
+
+/**
+ * @brief Print all probes that have samples to stdout
+ */
+void prof_dump(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PROF_H */
@@ -0,0 +1,397 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef PROTO_H
+#define PROTO_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "scope.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * @brief Binary request/response protocol
+ *
+ * Frames are COBS encoded and delimited by zero bytes on both sides
+ * (00 <cobs> 00), so any byte stream can carry them: the UART next to
+ * the text console, USB CDC next to the telemetry stream, or CAN frames
+ * on PROTO_CAN_RX_ID/PROTO_CAN_TX_ID concatenated into a stream. The
+ * decoded frame is:
+ *
+ *	request:   u8 seq, u8 cmd,                 payload, u16 crc
+ *	response:  u8 seq, u8 cmd | PROTO_RESPONSE, u8 status, payload, u16 crc
+ *
+ * The CRC is CRC-16/CCITT-FALSE over everything before it, little
+ * endian, as are all payload fields. The response echoes the request's
+ * seq. A request that repeats the previous seq and cmd is answered with
+ * the stored response without running it again, so a host can retry a
+ * set command after a lost response; the host must change seq between
+ * distinct requests.
+ *
+ * Each transport is a struct proto_port. Interrupt handlers push received
+ * bytes with proto_port_push() and the main loop decodes them with
+ * proto_port_poll(); transports that already buffer (the UART input
+ * driver) hand bytes straight to proto_port_receive(). Commands run in
+ * the main loop.
+ */
+
+#define PROTO_VERSION            1U
+
+/* Largest request or response payload */
+#define PROTO_MAX_PAYLOAD        128U
+
+/* Decoded frame: seq, cmd, status, payload, crc */
+#define PROTO_MAX_FRAME          (PROTO_MAX_PAYLOAD + 5U)
+
+/* COBS adds one byte per started 254 */
+#define PROTO_MAX_ENCODED        (PROTO_MAX_FRAME + PROTO_MAX_FRAME / 254U + 1U)
+
+/* Receive ring between interrupt and main loop, power of 2 */
+#ifndef PROTO_RX_RING_SIZE
+#define PROTO_RX_RING_SIZE       256U
+#endif
+
+/* CAN identifiers of the byte stream, host to device and back */
+#define PROTO_CAN_RX_ID          0x120U
+#define PROTO_CAN_TX_ID          0x121U
+
+/* Set in the cmd byte of responses */
+#define PROTO_RESPONSE           0x80U
+
+/**
+ * @brief Commands
+ *
+ * Request and response payloads (after the status byte):
+ *
+ *	PING        -                              u8 version, u8 num_regs
+ *	SET_TARGET  u8 axis, u8 mode, f32 value    -
+ *	SET_GAINS   u8 axis, u8 loop, f32 kp, ki   -
+ *	READ_STATE  u8 axis                        PROTO_STATE_SIZE bytes
+ *	READ_REGS   u8 reg[n]                      f32 value[n], one snapshot
+ *	REG_INFO    u8 reg                         u8 type, char name[]
+ *	GET_PARAMS  u8 axis, u8 id[n]              f32 value[n]
+ *	SET_PARAMS  u8 axis, {u8 id, f32 value}[n] -, all applied or none
+ *	PARAM_INFO  u8 id                          u8 type, u8 flags, f32 min,
+ *	                                           f32 max, char name[]
+ *	SAVE_PARAMS u8 axis                        -, writable parameters to flash
+ *
+ * Parameter IDs, types and flags are those of Inc/param.h. SAVE_PARAMS
+ * answers PROTO_ERR_STATE while a motor runs or if the flash write fails.
+ */
+enum proto_cmd {
+	PROTO_CMD_PING = 0x01,
+	PROTO_CMD_SET_TARGET = 0x10,
+	PROTO_CMD_SET_GAINS = 0x11,
+	PROTO_CMD_READ_STATE = 0x20,
+	PROTO_CMD_READ_REGS = 0x21,
+	PROTO_CMD_REG_INFO = 0x22,
+	PROTO_CMD_GET_PARAMS = 0x30,
+	PROTO_CMD_SET_PARAMS = 0x31,
+	PROTO_CMD_PARAM_INFO = 0x32,
+	PROTO_CMD_SAVE_PARAMS = 0x33,
+};
+
+/**
+ * @brief Response status
+ */
+enum proto_status {
+	PROTO_OK = 0,
+	PROTO_ERR_CMD,               /* Unknown command */
+	PROTO_ERR_LEN,               /* Payload size wrong for the command */
+	PROTO_ERR_ARG,               /* Axis, register or value out of range */
+	PROTO_ERR_STATE,             /* Not possible in the current mode */
+};
+
+/**
+ * @brief SET_TARGET modes
+ */
+enum proto_target_mode {
+	PROTO_TARGET_STOP = 0,       /* Velocity control off, value ignored */
+	PROTO_TARGET_VELOCITY,       /* Open-loop velocity, value in RPM */
+	PROTO_TARGET_VELOCITY_CLOSED, /* Closed-loop velocity, value in RPM */
+	PROTO_TARGET_AMPLITUDE,      /* Amplitude in %, keeps the ramp running */
+};
+
+/**
+ * @brief SET_GAINS loops
+ */
+enum proto_loop {
+	PROTO_LOOP_SPEED = 0,        /* Closed-loop speed PI */
+	PROTO_LOOP_CURRENT,          /* d/q current PI */
+};
+
+/* READ_STATE flags */
+#define PROTO_STATE_OVERCURRENT  (1U << 0)
+#define PROTO_STATE_TORQUE       (1U << 1)
+#define PROTO_STATE_ENCODER      (1U << 2)
+
+/**
+ * @brief READ_STATE response
+ */
+struct proto_state {
+	uint8_t mode;                /* enum foc_velocity_mode */
+	uint8_t flags;               /* PROTO_STATE_* */
+	float target_rpm;
+	float ramp_rpm;              /* Ramped velocity command */
+	float measured_rpm;          /* Encoder speed, ramp if no encoder */
+	float amplitude;             /* % */
+	float electrical_angle;      /* Degrees */
+	float ia;
+	float ib;
+	float id;
+	float iq;
+};
+
+#define PROTO_STATE_SIZE         (2U + 9U * 4U)
+
+/**
+ * @brief Receive and transmit statistics of a port
+ */
+struct proto_stats {
+	uint32_t requests;           /* Valid frames handled */
+	uint32_t repeats;            /* Requests answered from the stored response */
+	uint32_t crc_errors;         /* Frames with a bad CRC */
+	uint32_t frame_errors;       /* Bad COBS, too short or too long */
+	uint32_t dropped;            /* Bytes lost, receive ring full */
+	uint32_t tx_errors;          /* Transport refused a response (retried) */
+};
+
+/**
+ * @brief Transport: send bytes
+ *
+ * The buffer belongs to the port. A transport that sends from it
+ * asynchronously needs a busy callback (proto_port_set_busy()), so that
+ * no new response is encoded into it while the transfer runs.
+ *
+ * @return 0 if the bytes were taken, -1 to retry from proto_port_poll()
+ */
+typedef int (*proto_write_t)(const uint8_t *buf, uint16_t len);
+
+/**
+ * @brief Transport: still sending from a buffer
+ *
+ * @return true while a transfer started by the write function reads from buf
+ */
+typedef bool (*proto_busy_t)(const uint8_t *buf);
+
+/**
+ * @brief Bytes outside frames (e.g. console keys)
+ */
+typedef void (*proto_text_t)(uint8_t ch);
+
+/**
+ * @brief Application commands
+ *
+ * Called for commands the protocol does not handle itself (SET_TARGET,
+ * SET_GAINS, READ_STATE and the parameter commands).
+ *
+ * @param cmd Command
+ * @param req Request payload
+ * @param len Request payload size
+ * @param resp Response payload, room for PROTO_MAX_PAYLOAD bytes
+ * @param resp_len Response payload size, 0 on entry
+ * @return enum proto_status
+ */
+typedef uint8_t (*proto_handler_t)(uint8_t cmd, const uint8_t *req, uint16_t len,
+                                   uint8_t *resp, uint16_t *resp_len);
+
+/**
+ * @brief One transport
+ */
+struct proto_port {
+	proto_write_t write;
+	proto_busy_t busy;           /* NULL: write copies the bytes */
+	proto_text_t text;           /* NULL: every byte belongs to a frame */
+
+	/* Filled by proto_port_push(), emptied by proto_port_poll() */
+	uint8_t ring[PROTO_RX_RING_SIZE];
+	volatile uint16_t head;
+	volatile uint16_t tail;
+
+	/* Frame being received, decoded in place */
+	uint8_t rx[PROTO_MAX_ENCODED];
+	uint16_t rx_len;
+	bool in_frame;
+	bool rx_overflow;
+
+	/* Last response, encoded with delimiters */
+	uint8_t tx[PROTO_MAX_ENCODED + 2U];
+	uint16_t tx_len;
+	bool tx_pending;
+	bool have_last;
+	uint8_t last_seq;
+	uint8_t last_cmd;
+
+	struct proto_stats stats;
+};
+
+/**
+ * @brief Set up a port
+ *
+ * With a text callback, bytes between frames go to it and a frame only
+ * starts after a zero byte; the UART console works unchanged next to the
+ * protocol.
+ *
+ * @param port Port
+ * @param write Transport send function
+ * @param text Callback for bytes outside frames, or NULL
+ */
+void proto_port_init(struct proto_port *port, proto_write_t write, proto_text_t text);
+
+/**
+ * @brief Set the transport's busy callback
+ *
+ * While it reports the last response still being sent, or the transport
+ * refused it, proto_port_poll() leaves further requests in the receive
+ * ring. Ports fed by proto_port_receive() need a write that copies.
+ *
+ * @param port Port
+ * @param busy Busy callback, NULL if write copies the bytes
+ */
+void proto_port_set_busy(struct proto_port *port, proto_busy_t busy);
+
+/**
+ * @brief Queue received bytes
+ *
+ * Call from the transport's receive interrupt, one producer per port.
+ *
+ * @param port Port
+ * @param data Bytes
+ * @param len Number of bytes
+ * @return Number of bytes queued; the rest is dropped and counted
+ */
+uint32_t proto_port_push(struct proto_port *port, const uint8_t *data, uint32_t len);
+
+/**
+ * @brief Retry a refused response and handle queued bytes
+ *
+ * Call from the main loop. Requests after one whose response is not out
+ * yet wait in the ring for a later call.
+ *
+ * @param port Port
+ */
+void proto_port_poll(struct proto_port *port);
+
+/**
+ * @brief Handle received bytes directly
+ *
+ * Call from the main loop.
+ *
+ * @param port Port
+ * @param data Bytes
+ * @param len Number of bytes
+ */
+void proto_port_receive(struct proto_port *port, const uint8_t *data, uint32_t len);
+
+/**
+ * @brief Set the application command handler
+ *
+ * @param handler Handler, NULL to answer PROTO_ERR_CMD
+ */
+void proto_set_handler(proto_handler_t handler);
+
+/**
+ * @brief Set the registers served by READ_REGS and REG_INFO
+ *
+ * @param regs Register table, indexed by register number
+ * @param count Number of registers
+ */
+void proto_set_registers(const struct scope_signal *regs, uint8_t count);
+
+/**
+ * @brief CRC-16/CCITT-FALSE
+ *
+ * @param data Bytes
+ * @param len Number of bytes
+ * @return CRC (0x29B1 for "123456789")
+ */
+uint16_t proto_crc16(const uint8_t *data, uint32_t len);
+
+/**
+ * @brief COBS encode
+ *
+ * @param in Bytes to encode
+ * @param len Number of bytes
+ * @param out Buffer for len + len / 254 + 1 bytes, may not overlap in
+ * @return Encoded size, no zero bytes, delimiter not included
+ */
+uint32_t proto_cobs_encode(const uint8_t *in, uint32_t len, uint8_t *out);
+
+/**
+ * @brief COBS decode
+ *
+ * @param in Encoded bytes, delimiter not included
+ * @param len Number of bytes
+ * @param out Buffer for len bytes, may be in (decodes in place)
+ * @return Decoded size, -1 if in is not valid COBS
+ */
+int32_t proto_cobs_decode(const uint8_t *in, uint32_t len, uint8_t *out);
+
+/**
+ * @brief Build a complete frame: CRC, COBS and both delimiters
+ *
+ * @param frame Decoded frame without CRC, room for 2 more bytes
+ * @param len Frame size
+ * @param out Buffer for len + len / 254 + 5 bytes
+ * @return Size written to out
+ */
+uint32_t proto_frame_encode(uint8_t *frame, uint32_t len, uint8_t *out);
+
+/**
+ * @brief Serialise a READ_STATE response
+ *
+ * @param state State
+ * @param buf Buffer for PROTO_STATE_SIZE bytes
+ */
+void proto_pack_state(const struct proto_state *state, uint8_t *buf);
+
+/**
+ * @brief Parse a READ_STATE response
+ *
+ * @param buf PROTO_STATE_SIZE bytes
+ * @param state State
+ */
+void proto_unpack_state(const uint8_t *buf, struct proto_state *state);
+
+/* Little endian payload fields */
+static inline void proto_put_u16(uint8_t *p, uint16_t v)
+{
+	p[0] = v & 0xFF;
+	p[1] = (v >> 8) & 0xFF;
+}
+
+static inline uint16_t proto_get_u16(const uint8_t *p)
+{
+	return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline void proto_put_f32(uint8_t *p, float v)
+{
+	uint32_t u;
+
+	memcpy(&u, &v, sizeof(u));
+	proto_put_u16(p, u & 0xFFFF);
+	proto_put_u16(p + 2, u >> 16);
+}
+
+static inline float proto_get_f32(const uint8_t *p)
+{
+	uint32_t u = proto_get_u16(p) | ((uint32_t)proto_get_u16(p + 2) << 16);
+	float v;
+
+	memcpy(&v, &u, sizeof(v));
+	return v;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PROTO_H */
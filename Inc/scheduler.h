@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Static multi-rate scheduler
+ *
+ * The application declares a table of tasks at compile time, each with a
+ * rate that divides the base tick rate. sched_tick() is called once per
+ * base tick from the interrupt that defines the time base (the ADC DMA
+ * sequence at the PWM rate). Interrupt-context tasks run right there;
+ * main-context tasks are released and run by sched_run() from the main
+ * loop, in table order, so the table should list faster tasks first.
+ *
+ * Every task keeps its execution time in CPU cycles, a count of releases
+ * skipped because the previous one had not run yet (overruns) and a count
+ * of runs that completed after their deadline (misses).
+ */
+
+/* Base tick rate (Hz); every task rate must divide it */
+#ifndef SCHED_TICK_HZ
+#define SCHED_TICK_HZ 20000U
+#endif
+
+/**
+ * @brief Where a task runs
+ */
+enum sched_context {
+	SCHED_ISR,           /* In sched_tick(), from the base tick interrupt */
+	SCHED_MAIN,          /* In sched_run(), from the main loop */
+};
+
+/**
+ * @brief Task table entry
+ *
+ * Declare with SCHED_TASK(); the fields after context are run time state.
+ */
+struct sched_task {
+	const char *name;
+	void (*run)(void);
+	uint32_t period;             /* Base ticks between releases */
+	uint32_t offset;             /* Base tick of the first release */
+	uint32_t deadline_us;        /* Release to completion, 0 for one period */
+	enum sched_context context;
+
+	volatile bool pending;       /* Released, not yet completed */
+	uint32_t countdown;          /* Base ticks to the next release */
+	uint32_t release;            /* Cycle count at the last release */
+	uint32_t deadline;           /* Deadline in cycles */
+	uint32_t runs;
+	uint32_t overruns;           /* Releases skipped: previous still pending */
+	uint32_t misses;             /* Runs completed after the deadline */
+	uint32_t exec_last;          /* Execution time of the last run (cycles) */
+	uint32_t exec_max;           /* Longest execution time (cycles) */
+};
+
+/**
+ * @brief Declare a task running at rate_hz, first released at base tick offset
+ *
+ * Offsets spread tasks of the same or related rates over different ticks.
+ */
+#define SCHED_TASK(name_, fn, rate_hz, offset_, ctx) { \
+	.name = (name_), \
+	.run = (fn), \
+	.period = SCHED_TICK_HZ / (rate_hz), \
+	.offset = (offset_), \
+	.context = (ctx), \
+}
+
+/**
+ * @brief Release hook, called from sched_tick() when main-context tasks were released
+ */
+typedef void (*sched_notify_t)(void);
+
+/**
+ * @brief Install a task table and reset its statistics
+ *
+ * Also starts the cycle counter (DWT CYCCNT) used for timing.
+ *
+ * @param tasks Task table
+ * @param count Number of tasks
+ * @param notify Release hook (may be NULL)
+ * @return 0 on success, negative value if a period or offset is invalid
+ */
+int sched_init(struct sched_task *tasks, size_t count, sched_notify_t notify);
+
+/**
+ * @brief Advance the scheduler by one base tick
+ *
+ * Call from the base tick interrupt only.
+ */
+void sched_tick(void);
+
+/**
+ * @brief Run the released main-context tasks
+ *
+ * Call from the main loop.
+ *
+ * @return Number of tasks run
+ */
+int sched_run(void);
+
+/**
+ * @brief Get the number of base ticks since sched_init()
+ *
+ * @return Tick count
+ */
+uint32_t sched_get_ticks(void);
+
+/**
+ * @brief Get a task of the installed table
+ *
+ * @param index Task index
+ * @return Task, or NULL if index is out of range
+ */
+const struct sched_task *sched_get_task(size_t index);
+
+/**
+ * @brief Convert cycles to microseconds at the current core clock
+ *
+ * @param cycles Cycle count
+ * @return Microseconds
+ */
+uint32_t sched_cycles_to_us(uint32_t cycles);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SCHEDULER_H */
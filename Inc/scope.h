@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef SCOPE_H
+#define SCOPE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Triggered capture of internal signals ("scope mode")
+ *
+ * scope_sample() runs from the control tick interrupt at the full loop
+ * rate and copies up to SCOPE_MAX_CHANNELS signals into a RAM ring. Once
+ * armed the ring keeps the last pre_trigger samples; when the trigger
+ * fires it records the rest of the window and stops. The main loop then
+ * reads the window out in time order with scope_read() at its own pace
+ * and releases it.
+ *
+ * Signals are described by address and type, so sampling is a load and a
+ * conversion per channel and the control code needs no scope hooks. The
+ * trigger signal need not be one of the recorded channels; a rising edge
+ * on a bool (e.g. foc_current_data.overcurrent) with level 0.5 triggers on
+ * the overcurrent edge.
+ */
+
+#define SCOPE_MAX_CHANNELS     4U
+
+/* Ring size in samples, shared by the channels (float each) */
+#ifndef SCOPE_BUFFER_SAMPLES
+#define SCOPE_BUFFER_SAMPLES   2048U
+#endif
+
+/**
+ * @brief Storage type of a signal
+ */
+enum scope_type {
+	SCOPE_F32,
+	SCOPE_U32,
+	SCOPE_U16,
+	SCOPE_BOOL,
+};
+
+/**
+ * @brief A signal that can be recorded or triggered on
+ */
+struct scope_signal {
+	const char *name;
+	enum scope_type type;
+	const volatile void *addr;
+};
+
+/**
+ * @brief Trigger condition
+ */
+enum scope_trigger_mode {
+	SCOPE_TRIG_AUTO,     /* As soon as the pre-trigger samples are in */
+	SCOPE_TRIG_RISING,   /* Trigger signal crosses level upwards */
+	SCOPE_TRIG_FALLING,  /* Trigger signal crosses level downwards */
+	SCOPE_TRIG_MANUAL,   /* Only scope_force() */
+};
+
+/**
+ * @brief Capture state
+ */
+enum scope_state {
+	SCOPE_IDLE,          /* Not capturing, nothing to read */
+	SCOPE_ARMED,         /* Recording, waiting for the trigger */
+	SCOPE_TRIGGERED,     /* Recording the post-trigger part */
+	SCOPE_DONE,          /* Window complete, ready to read */
+};
+
+/**
+ * @brief Capture configuration
+ */
+struct scope_config {
+	const struct scope_signal *channels[SCOPE_MAX_CHANNELS];
+	uint8_t num_channels;
+	uint16_t decimation;         /* Record every Nth tick (0 or 1 = every tick) */
+	uint32_t depth;              /* Samples per channel, 0 = as many as fit */
+	uint32_t pre_trigger;        /* Samples kept from before the trigger */
+	enum scope_trigger_mode mode;
+	const struct scope_signal *trigger;
+	float level;
+};
+
+/**
+ * @brief Set up a capture
+ *
+ * @param cfg Configuration (copied)
+ * @return 0 on success, -1 if invalid or a capture is in progress
+ */
+int scope_configure(const struct scope_config *cfg);
+
+/**
+ * @brief Start recording and wait for the trigger
+ *
+ * @return 0 on success, -1 if not configured or not idle
+ */
+int scope_arm(void);
+
+/**
+ * @brief Trigger now, whatever the trigger mode
+ *
+ * Takes effect on the next sample. Ignored unless armed.
+ */
+void scope_force(void);
+
+/**
+ * @brief Stop recording and discard the window
+ */
+void scope_release(void);
+
+/**
+ * @brief Take one sample
+ *
+ * Call from the control tick interrupt.
+ */
+void scope_sample(void);
+
+/**
+ * @brief Get the capture state
+ *
+ * @return Current state
+ */
+enum scope_state scope_get_state(void);
+
+/**
+ * @brief Get the configured window
+ *
+ * @param depth Samples per channel (may be NULL)
+ * @param pre_trigger Samples before the trigger (may be NULL)
+ * @return Number of channels, 0 if not configured
+ */
+uint8_t scope_get_window(uint32_t *depth, uint32_t *pre_trigger);
+
+/**
+ * @brief Get a recorded channel
+ *
+ * @param index Channel index
+ * @return Signal, or NULL if index is out of range
+ */
+const struct scope_signal *scope_get_channel(uint8_t index);
+
+/**
+ * @brief Read one sample of a completed window
+ *
+ * Index 0 is the oldest sample; the trigger is at index pre_trigger.
+ *
+ * @param index Sample index
+ * @param row Buffer for one value per channel
+ * @return 0 on success, -1 if no window is complete or index is out of range
+ */
+int scope_read(uint32_t index, float *row);
+
+/**
+ * @brief Read a signal's current value
+ *
+ * @param sig Signal
+ * @return Value converted to float
+ */
+float scope_signal_value(const struct scope_signal *sig);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SCOPE_H */
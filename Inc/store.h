@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef STORE_H
+#define STORE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Key/value configuration store in internal flash
+ *
+ * Calibration results and tuned settings that should survive a reset.
+ * The flash region (drv/flash.h) is split into two sectors used in turn.
+ * The active sector holds a header and a log of records; setting a key
+ * appends a new record and the newest record of a key wins. When the
+ * sector is full, the latest value of every key is copied into the other
+ * sector, which then gets a header with the next generation number, so
+ * erases alternate between the sectors and each page is erased once per
+ * two sector fills.
+ *
+ *	header:  u32 magic, u16 version, u16 0, u32 generation, u32 crc
+ *	record:  u16 key, u16 len, u32 crc, u8 value[len], 0xFF pad to 8
+ *
+ * CRCs are CRC-32 (the zlib one). A record torn by a reset fails its CRC
+ * and is skipped, so the key keeps its previous value; a sector whose
+ * copy was interrupted has no valid header and is ignored. Sectors
+ * written with another STORE_VERSION are ignored as well, so changing
+ * the layout starts from an empty store instead of misreading old data.
+ *
+ * store_init() scans the active sector once and keeps an index of the
+ * records in RAM; reads after that are a lookup and a copy.
+ *
+ * Writing stalls the CPU, see drv/flash.h: call store_set() and
+ * store_clear() from the main loop with the motors stopped.
+ */
+
+#define STORE_VERSION            1U
+
+/* Keys the store can hold, and largest value */
+#define STORE_MAX_KEYS           64U
+#define STORE_MAX_VALUE          64U
+
+/* Not a valid key: erased flash */
+#define STORE_KEY_NONE           0xFFFFU
+
+/**
+ * @brief Store statistics
+ */
+struct store_stats {
+	uint32_t generation;         /* Sector copies since the store was formatted */
+	uint32_t used;               /* Bytes used in the active sector */
+	uint32_t size;               /* Sector size */
+	uint16_t keys;               /* Keys stored */
+	uint16_t bad_records;        /* Records skipped by store_init(), bad CRC */
+};
+
+/**
+ * @brief Find the active sector and index its records
+ *
+ * An empty, erased or foreign region is not an error: the store starts
+ * empty and the first store_set() formats it.
+ *
+ * @return 0 on success, -1 if the flash cannot be read
+ */
+int store_init(void);
+
+/**
+ * @brief Read a value
+ *
+ * @param key Key
+ * @param value Buffer to store the value
+ * @param len Expected size
+ * @return 0 on success, -1 if the key is not stored or its size is not len
+ */
+int store_get(uint16_t key, void *value, uint16_t len);
+
+/**
+ * @brief Write a value
+ *
+ * Nothing is written if the stored value is the same.
+ *
+ * @param key Key, not STORE_KEY_NONE
+ * @param value Value
+ * @param len Size, up to STORE_MAX_VALUE
+ * @return 0 on success, -1 if invalid, the store is full or the flash
+ *         failed (the previous value is kept)
+ */
+int store_set(uint16_t key, const void *value, uint16_t len);
+
+/**
+ * @brief Erase all keys
+ *
+ * @return 0 on success, -1 if the flash failed
+ */
+int store_clear(void);
+
+/**
+ * @brief Get store statistics
+ *
+ * @param stats Pointer to store the statistics
+ */
+void store_get_stats(struct store_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* STORE_H */
@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "scope.h"
+#include <stdint.h>
+
+/**
+ * @brief Continuous binary telemetry stream
+ *
+ * telemetry_sample() runs from the control tick interrupt and writes the
+ * selected signals (float32, little endian) straight into one of two
+ * packet buffers. A full packet is handed to the transport (USB CDC on
+ * target) and sampling goes on in the other buffer; the transmit complete
+ * callback starts the next full packet, so the CPU never copies payload.
+ * If both buffers are taken the samples are dropped and counted; the
+ * sample index in the next packet header shows the gap.
+ *
+ * Packet layout (little endian):
+ *
+ *	u16 magic         TELEMETRY_MAGIC
+ *	u8  version       TELEMETRY_VERSION
+ *	u8  num_channels
+ *	u16 seq           Packet counter
+ *	u16 num_samples
+ *	u32 first_sample  Index of the first sample (at the decimated rate)
+ *	f32 values[num_samples][num_channels]
+ */
+
+#define TELEMETRY_MAGIC          0x4D54U  /* "TM" */
+#define TELEMETRY_VERSION        1U
+#define TELEMETRY_HEADER_SIZE    12U
+#define TELEMETRY_MAX_CHANNELS   8U
+
+/* Packet buffer size, two of them */
+#ifndef TELEMETRY_PACKET_SIZE
+#define TELEMETRY_PACKET_SIZE    1024U
+#endif
+
+/**
+ * @brief Transport: start sending a packet
+ *
+ * Called from interrupt context. The buffer stays untouched until
+ * telemetry_tx_complete() is called.
+ *
+ * @return 0 if the transfer was started
+ */
+typedef int (*telemetry_send_t)(uint8_t *buf, uint16_t len);
+
+/**
+ * @brief Stream statistics
+ */
+struct telemetry_stats {
+	uint32_t packets;            /* Packets handed to the transport */
+	uint32_t samples;            /* Samples sent */
+	uint32_t dropped;            /* Samples lost, both buffers taken */
+	uint32_t errors;             /* Packets the transport refused */
+};
+
+/**
+ * @brief Set the transport
+ *
+ * @param send Send function
+ */
+void telemetry_init(telemetry_send_t send);
+
+/**
+ * @brief Select channels and rate
+ *
+ * @param channels Signals to send
+ * @param num_channels Number of signals (1 to TELEMETRY_MAX_CHANNELS)
+ * @param decimation Send every Nth tick (0 or 1 = every tick)
+ * @return 0 on success, -1 if invalid or streaming
+ */
+int telemetry_configure(const struct scope_signal *const *channels, uint8_t num_channels,
+                        uint16_t decimation);
+
+/**
+ * @brief Start streaming
+ *
+ * @return 0 on success, -1 if not configured or no transport
+ */
+int telemetry_start(void);
+
+/**
+ * @brief Stop streaming
+ *
+ * The partly filled packet is discarded; a packet in flight completes.
+ */
+void telemetry_stop(void);
+
+/**
+ * @brief Check whether streaming is on
+ *
+ * @return true while streaming
+ */
+bool telemetry_running(void);
+
+/**
+ * @brief Take one sample
+ *
+ * Call from the control tick interrupt.
+ */
+void telemetry_sample(void);
+
+/**
+ * @brief Transport transmit complete handler
+ *
+ * Call from the transport's completion interrupt. Completions of buffers
+ * that are not telemetry packets are ignored, so the transport may be
+ * shared.
+ *
+ * @param buf Buffer that was sent
+ */
+void telemetry_tx_complete(const uint8_t *buf);
+
+/**
+ * @brief Get stream statistics
+ *
+ * @param stats Pointer to store the statistics
+ */
+void telemetry_get_stats(struct telemetry_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TELEMETRY_H */
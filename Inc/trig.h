@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef TRIG_H
+#define TRIG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/**
+ * @brief Table-based sine/cosine for the modulators and control loops
+ *
+ * Angles are 16-bit binary angles: 0x0000 = 0, 0x4000 = 90 degrees,
+ * 0x8000 = 180 degrees, wrapping naturally at a full turn. Values come from
+ * a 256-entry quarter-wave table with linear interpolation; the maximum
+ * absolute error is below 5e-6.
+ */
+
+/* Full electrical turn in binary angle units */
+#define TRIG_ANGLE_TURN         65536U
+
+/* Binary angle units per degree */
+#define TRIG_ANGLE_PER_DEG      (65536.0f / 360.0f)
+
+/**
+ * @brief Convert degrees to a 16-bit binary angle
+ *
+ * Any finite angle within +-32768 turns is accepted and wrapped.
+ *
+ * @param angle_deg Angle in degrees
+ * @return Binary angle (0-65535)
+ */
+static inline uint16_t trig_deg_to_angle(float angle_deg)
+{
+	float angle = angle_deg * TRIG_ANGLE_PER_DEG;
+
+	/* Round to nearest: truncation would bias every angle by half a step */
+	return (uint16_t)(int32_t)(angle + (angle < 0.0f ? -0.5f : 0.5f));
+}
+
+/**
+ * @brief Sine and cosine of a binary angle
+ *
+ * @param angle Binary angle (0-65535 = 0-360 degrees)
+ * @param sin_out Pointer to store sine (-1 to +1)
+ * @param cos_out Pointer to store cosine (-1 to +1)
+ */
+void trig_sincos(uint16_t angle, float *sin_out, float *cos_out);
+
+/**
+ * @brief Sine of a binary angle
+ *
+ * @param angle Binary angle (0-65535 = 0-360 degrees)
+ * @return Sine (-1 to +1)
+ */
+float trig_sin(uint16_t angle);
+
+/**
+ * @brief Cosine of a binary angle
+ *
+ * @param angle Binary angle (0-65535 = 0-360 degrees)
+ * @return Cosine (-1 to +1)
+ */
+float trig_cos(uint16_t angle);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TRIG_H */
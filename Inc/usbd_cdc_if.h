@@ -110,6 +110,14 @@ uint8_t CDC_Transmit_FS(uint8_t* Buf, uint16_t Len);
 
 /* USER CODE BEGIN EXPORTED_FUNCTIONS */
 
+/* Received data, called from the USB interrupt before the buffer is re-armed */
+typedef void (*CDC_RxCallback_t)(const uint8_t *Buf, uint32_t Len);
+
+void CDC_SetRxCallback_FS(CDC_RxCallback_t Callback);
+
+/* Non-zero while the IN endpoint is still sending from Buf */
+uint8_t CDC_TxBusy_FS(const uint8_t *Buf);
+
 /* USER CODE END EXPORTED_FUNCTIONS */
 
 /**
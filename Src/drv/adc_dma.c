@@ -3,19 +3,18 @@
  *
  * SPDX-License-Identifier: Apache-2.0
  *
- * ADC Timing Analysis (20 kHz trigger):
+ * ADC Timing Analysis (20 kHz trigger at the top of the PWM count):
  * - ADC clock: 42.5 MHz (PCLK/4)
- * - Sampling time: 47.5 cycles
- * - Conversion time: 12.5 cycles (12-bit)
- * - Time per channel: 60 cycles × 23.5ns = 1.41 µs
- * - Time for 5 channels: 7.05 µs
- * - Hardware oversampling: 4x (automatic averaging)
- * - Total conversion time with oversampling: ~28 µs
+ * - Injected, phase currents: 12.5 + 12.5 cycles per channel, no oversampling
+ * - Time for 4 currents: 100 cycles = 2.35 µs, centred on the top of the count
+ * - Regular, bus voltage: 47.5 + 12.5 cycles, 4x oversampling = 5.6 µs,
+ *   after the injected group (which preempts it)
  * - Time between 20kHz triggers: 50 µs
- * - Margin: 22 µs (44% headroom)
+ * - Margin: 42 µs (84% headroom)
  */
 
 #include "drv/adc_dma.h"
+#include "drv/pwm.h"
 #include <stdio.h>
 #include <string.h>
 
@@ -28,8 +27,33 @@ static const uint32_t adc_channels[ADC_DMA_NUM_CHANNELS] = {
 	ADC_CHANNEL_12   /* PB2 */
 };
 
-/* DMA buffer for ADC values */
-static uint16_t adc_buffer[ADC_DMA_NUM_CHANNELS] __attribute__((aligned(4)));
+#define ADC_NUM_REGULAR (ADC_DMA_NUM_CHANNELS - ADC_DMA_NUM_INJECTED)
+
+static const uint32_t injected_ranks[ADC_DMA_NUM_INJECTED] = {
+	ADC_INJECTED_RANK_1,
+	ADC_INJECTED_RANK_2,
+	ADC_INJECTED_RANK_3,
+	ADC_INJECTED_RANK_4
+};
+
+/*
+ * Trigger lead in timer ticks: the injected sequence takes 100 ADC clocks,
+ * 400 timer ticks; starting half of that early centres it on the top.
+ */
+#define ADC_TRIGGER_LEAD 200U
+
+/* Sample sets: two slots, filled in turn by the injected interrupt */
+#define ADC_DMA_SLOTS 2
+
+static uint16_t adc_buffer[ADC_DMA_SLOTS][ADC_DMA_NUM_CHANNELS] __attribute__((aligned(4)));
+
+/* Regular group, kept current by the DMA without interrupts */
+static uint16_t regular_buffer[ADC_NUM_REGULAR] __attribute__((aligned(4)));
+
+/* Completed sample sets. Slot seq & 1 is filled next, so the latest
+ * complete slot is (seq - 1) & 1: one load gives both, no locking.
+ */
+static volatile uint32_t adc_seq;
 
 /* Device handles */
 static ADC_HandleTypeDef *adc_handle = NULL;
@@ -42,9 +66,29 @@ static bool initialized = false;
 /* Optional conversion complete callback */
 static adc_dma_callback_t conv_cplt_callback = NULL;
 
+/* Conversions running */
+static bool running = false;
+
+/* Block capture in progress */
+static struct {
+	uint16_t *buffer;
+	uint32_t num_samples;
+	uint32_t pos;
+	bool circular;
+	adc_dma_capture_callback_t callback;
+	volatile bool active;
+} capture;
+
+static inline const uint16_t *adc_slot(uint32_t seq)
+{
+	return adc_buffer[(seq - 1U) & (ADC_DMA_SLOTS - 1U)];
+}
+
 int adc_dma_init(ADC_HandleTypeDef *hadc, DMA_HandleTypeDef *hdma, TIM_HandleTypeDef *htim)
 {
 	ADC_ChannelConfTypeDef sConfig = {0};
+	ADC_InjectionConfTypeDef sConfigInjected = {0};
+	TIM_OC_InitTypeDef sConfigOC = {0};
 
 	if (!hadc || !hdma || !htim) {
 		printf("adc_dma_init: Invalid handles\n");
@@ -55,7 +99,7 @@ int adc_dma_init(ADC_HandleTypeDef *hadc, DMA_HandleTypeDef *hdma, TIM_HandleTyp
 	dma_handle = hdma;
 	tim_handle = htim;
 
-	/* Reconfigure ADC for DMA with timer trigger */
+	/* Regular group: slow channels by DMA, same timer trigger */
 	adc_handle->Init.ClockPrescaler = ADC_CLOCK_SYNC_PCLK_DIV4;
 	adc_handle->Init.Resolution = ADC_RESOLUTION_12B;
 	adc_handle->Init.DataAlign = ADC_DATAALIGN_RIGHT;
@@ -64,14 +108,14 @@ int adc_dma_init(ADC_HandleTypeDef *hadc, DMA_HandleTypeDef *hdma, TIM_HandleTyp
 	adc_handle->Init.EOCSelection = ADC_EOC_SEQ_CONV; /* End of sequence */
 	adc_handle->Init.LowPowerAutoWait = DISABLE;
 	adc_handle->Init.ContinuousConvMode = DISABLE;    /* Triggered by timer */
-	adc_handle->Init.NbrOfConversion = ADC_DMA_NUM_CHANNELS;
+	adc_handle->Init.NbrOfConversion = ADC_NUM_REGULAR;
 	adc_handle->Init.DiscontinuousConvMode = DISABLE;
 	adc_handle->Init.ExternalTrigConv = ADC_EXTERNALTRIG_T2_TRGO;  /* TIM2 TRGO */
 	adc_handle->Init.ExternalTrigConvEdge = ADC_EXTERNALTRIGCONVEDGE_RISING;
 	adc_handle->Init.DMAContinuousRequests = ENABLE;
 	adc_handle->Init.Overrun = ADC_OVR_DATA_OVERWRITTEN;
 
-	/* Enable hardware oversampling for noise reduction */
+	/* Hardware oversampling for noise reduction; regular group only */
 	adc_handle->Init.OversamplingMode = ENABLE;
 	adc_handle->Init.Oversampling.Ratio = ADC_OVERSAMPLING_RATIO_4;  /* 4x oversampling */
 	adc_handle->Init.Oversampling.RightBitShift = ADC_RIGHTBITSHIFT_2;  /* Divide by 4 (>>2) */
@@ -84,17 +128,12 @@ int adc_dma_init(ADC_HandleTypeDef *hadc, DMA_HandleTypeDef *hdma, TIM_HandleTyp
 	}
 
 	/* Rank values for STM32 HAL */
-	const uint32_t ranks[ADC_DMA_NUM_CHANNELS] = {
+	const uint32_t ranks[ADC_NUM_REGULAR] = {
 		ADC_REGULAR_RANK_1,
-		ADC_REGULAR_RANK_2,
-		ADC_REGULAR_RANK_3,
-		ADC_REGULAR_RANK_4,
-		ADC_REGULAR_RANK_5
 	};
 
-	/* Configure all channels */
-	for (uint8_t i = 0; i < ADC_DMA_NUM_CHANNELS; i++) {
-		sConfig.Channel = adc_channels[i];
+	for (uint8_t i = 0; i < ADC_NUM_REGULAR; i++) {
+		sConfig.Channel = adc_channels[ADC_DMA_NUM_INJECTED + i];
 		sConfig.Rank = ranks[i];
 		sConfig.SamplingTime = ADC_SAMPLETIME_47CYCLES_5;  /* Slower sampling for accuracy */
 		sConfig.SingleDiff = ADC_SINGLE_ENDED;
@@ -102,7 +141,30 @@ int adc_dma_init(ADC_HandleTypeDef *hadc, DMA_HandleTypeDef *hdma, TIM_HandleTyp
 		sConfig.Offset = 0;
 
 		if (HAL_ADC_ConfigChannel(adc_handle, &sConfig) != HAL_OK) {
-			printf("adc_dma_init: Channel %lu config failed\n", adc_channels[i]);
+			printf("adc_dma_init: Channel %lu config failed\n", sConfig.Channel);
+			return -1;
+		}
+	}
+
+	/* Injected group: phase currents, short sampling, no oversampling */
+	sConfigInjected.InjectedSamplingTime = ADC_SAMPLETIME_12CYCLES_5;
+	sConfigInjected.InjectedSingleDiff = ADC_SINGLE_ENDED;
+	sConfigInjected.InjectedOffsetNumber = ADC_OFFSET_NONE;
+	sConfigInjected.InjectedOffset = 0;
+	sConfigInjected.InjectedNbrOfConversion = ADC_DMA_NUM_INJECTED;
+	sConfigInjected.InjectedDiscontinuousConvMode = DISABLE;
+	sConfigInjected.AutoInjectedConv = DISABLE;
+	sConfigInjected.QueueInjectedContext = DISABLE;
+	sConfigInjected.ExternalTrigInjecConv = ADC_EXTERNALTRIGINJEC_T2_TRGO;
+	sConfigInjected.ExternalTrigInjecConvEdge = ADC_EXTERNALTRIGINJECCONV_EDGE_RISING;
+	sConfigInjected.InjecOversamplingMode = DISABLE;
+
+	for (uint8_t i = 0; i < ADC_DMA_NUM_INJECTED; i++) {
+		sConfigInjected.InjectedChannel = adc_channels[i];
+		sConfigInjected.InjectedRank = injected_ranks[i];
+
+		if (HAL_ADCEx_InjectedConfigChannel(adc_handle, &sConfigInjected) != HAL_OK) {
+			printf("adc_dma_init: Injected channel %lu config failed\n", adc_channels[i]);
 			return -1;
 		}
 	}
@@ -113,13 +175,13 @@ int adc_dma_init(ADC_HandleTypeDef *hadc, DMA_HandleTypeDef *hdma, TIM_HandleTyp
 		return -1;
 	}
 
-	/* Configure timer for 20kHz update rate
+	/* Configure timer for 20kHz, centre-aligned like the PWM timers
 	 * Assuming system clock is 170MHz, APB1 timer clock = 170MHz
-	 * For 20kHz: Period = 170MHz / 20kHz = 8500 - 1 = 8499
+	 * For 20kHz: up and down, Period = 170MHz / 20kHz / 2 = 4250
 	 */
 	tim_handle->Init.Prescaler = 0;
-	tim_handle->Init.CounterMode = TIM_COUNTERMODE_UP;
-	tim_handle->Init.Period = 8499;  /* 20 kHz at 170 MHz clock */
+	tim_handle->Init.CounterMode = TIM_COUNTERMODE_CENTERALIGNED1;
+	tim_handle->Init.Period = PWM_TIMER_PERIOD;  /* 20 kHz at 170 MHz clock */
 	tim_handle->Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
 	tim_handle->Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_ENABLE;
 
@@ -128,9 +190,20 @@ int adc_dma_init(ADC_HandleTypeDef *hadc, DMA_HandleTypeDef *hdma, TIM_HandleTyp
 		return -1;
 	}
 
-	/* Configure timer to generate TRGO on update event */
+	/* Channel 4, no output: OC4REF rises once per period, near the top */
+	sConfigOC.OCMode = TIM_OCMODE_PWM2;
+	sConfigOC.Pulse = PWM_TIMER_PERIOD - ADC_TRIGGER_LEAD;
+	sConfigOC.OCPolarity = TIM_OCPOLARITY_HIGH;
+	sConfigOC.OCFastMode = TIM_OCFAST_DISABLE;
+
+	if (HAL_TIM_PWM_ConfigChannel(tim_handle, &sConfigOC, TIM_CHANNEL_4) != HAL_OK) {
+		printf("adc_dma_init: Timer trigger channel config failed\n");
+		return -1;
+	}
+
+	/* The update event comes at the top and the bottom: trigger on OC4REF */
 	TIM_MasterConfigTypeDef sMasterConfig = {0};
-	sMasterConfig.MasterOutputTrigger = TIM_TRGO_UPDATE;
+	sMasterConfig.MasterOutputTrigger = TIM_TRGO_OC4REF;
 	sMasterConfig.MasterOutputTrigger2 = TIM_TRGO2_RESET;
 	sMasterConfig.MasterSlaveMode = TIM_MASTERSLAVEMODE_DISABLE;
 
@@ -141,9 +214,12 @@ int adc_dma_init(ADC_HandleTypeDef *hadc, DMA_HandleTypeDef *hdma, TIM_HandleTyp
 
 	/* Clear buffer */
 	memset(adc_buffer, 0, sizeof(adc_buffer));
+	memset(regular_buffer, 0, sizeof(regular_buffer));
+	adc_seq = 0;
 
 	initialized = true;
-	printf("ADC DMA initialized: %d channels, trigger: TIM2@20kHz\n", ADC_DMA_NUM_CHANNELS);
+	printf("ADC DMA initialized: %d injected + %d regular channels, trigger: TIM2@20kHz\n",
+	       ADC_DMA_NUM_INJECTED, ADC_NUM_REGULAR);
 
 	return 0;
 }
@@ -155,11 +231,20 @@ int adc_dma_start(void)
 		return -1;
 	}
 
-	/* Start ADC DMA */
-	if (HAL_ADC_Start_DMA(adc_handle, (uint32_t *)adc_buffer, ADC_DMA_NUM_CHANNELS) != HAL_OK) {
+	/* Regular group: the buffer always holds the latest values, no interrupts */
+	if (HAL_ADC_Start_DMA(adc_handle, (uint32_t *)regular_buffer, ADC_NUM_REGULAR) != HAL_OK) {
 		printf("adc_dma_start: Failed to start ADC DMA\n");
 		return -1;
 	}
+	__HAL_DMA_DISABLE_IT(dma_handle, DMA_IT_TC | DMA_IT_HT);
+
+	/* Injected group: one interrupt per sample set */
+	if (HAL_ADCEx_InjectedStart_IT(adc_handle) != HAL_OK) {
+		printf("adc_dma_start: Failed to start injected conversions\n");
+		HAL_ADC_Stop_DMA(adc_handle);
+		return -1;
+	}
+	running = true;
 
 	/* Start the timer to trigger conversions */
 	if (HAL_TIM_Base_Start(tim_handle) != HAL_OK) {
@@ -181,13 +266,30 @@ int adc_dma_stop(void)
 	/* Stop timer */
 	HAL_TIM_Base_Stop(tim_handle);
 
-	/* Stop ADC DMA */
+	/* Stop both groups, and any capture with them */
+	HAL_ADCEx_InjectedStop_IT(adc_handle);
 	HAL_ADC_Stop_DMA(adc_handle);
+	capture.active = false;
+	running = false;
 
 	printf("ADC DMA stopped\n");
 	return 0;
 }
 
+int adc_dma_get_snapshot(struct adc_dma_snapshot *snap)
+{
+	uint32_t seq;
+
+	if (!snap || !initialized) {
+		return -1;
+	}
+
+	seq = adc_seq;
+	snap->values = adc_slot(seq);
+	snap->seq = seq;
+	return 0;
+}
+
 int adc_dma_get_channel(uint8_t channel, uint16_t *value)
 {
 	if (!value || channel >= ADC_DMA_NUM_CHANNELS) {
@@ -198,12 +300,14 @@ int adc_dma_get_channel(uint8_t channel, uint16_t *value)
 		return -1;
 	}
 
-	*value = adc_buffer[channel];
+	*value = adc_slot(adc_seq)[channel];
 	return 0;
 }
 
 int adc_dma_get_all_channels(uint16_t *values, uint8_t num_channels)
 {
+	uint32_t seq;
+
 	if (!values || num_channels > ADC_DMA_NUM_CHANNELS) {
 		return -1;
 	}
@@ -212,10 +316,84 @@ int adc_dma_get_all_channels(uint16_t *values, uint8_t num_channels)
 		return -1;
 	}
 
-	memcpy(values, adc_buffer, num_channels * sizeof(uint16_t));
+	/* Once seq moves on, the next interrupt refills the slot being copied */
+	do {
+		seq = adc_seq;
+		memcpy(values, adc_slot(seq), num_channels * sizeof(uint16_t));
+	} while (seq != adc_seq);
+
+	return 0;
+}
+
+int adc_dma_capture_start(uint16_t *buffer, uint32_t num_samples, bool circular,
+                          adc_dma_capture_callback_t callback)
+{
+	if (!buffer || num_samples == 0 || num_samples > ADC_DMA_CAPTURE_MAX ||
+	    (circular && num_samples % 2 != 0)) {
+		return -1;
+	}
+
+	if (!running || capture.active) {
+		return -1;
+	}
+
+	capture.buffer = buffer;
+	capture.num_samples = num_samples;
+	capture.pos = 0;
+	capture.circular = circular;
+	capture.callback = callback;
+	capture.active = true;
+
 	return 0;
 }
 
+int adc_dma_capture_stop(void)
+{
+	if (!capture.active) {
+		return -1;
+	}
+
+	capture.active = false;
+	return 0;
+}
+
+bool adc_dma_capture_active(void)
+{
+	return capture.active;
+}
+
+/**
+ * @brief Append a sample set to the capture buffer
+ */
+static void adc_dma_capture_sample(const uint16_t *values)
+{
+	uint32_t n = capture.num_samples;
+
+	memcpy(&capture.buffer[capture.pos * ADC_DMA_NUM_CHANNELS], values,
+	       ADC_DMA_NUM_CHANNELS * sizeof(uint16_t));
+	capture.pos++;
+
+	if (capture.circular) {
+		if (capture.pos == n / 2U || capture.pos == n) {
+			if (capture.pos == n) {
+				capture.pos = 0;
+			}
+			if (capture.callback) {
+				capture.callback(&capture.buffer[(capture.pos ? 0 : n / 2U) *
+				                                 ADC_DMA_NUM_CHANNELS], n / 2U);
+			}
+		}
+		return;
+	}
+
+	if (capture.pos == n) {
+		capture.active = false;
+		if (capture.callback) {
+			capture.callback(capture.buffer, n);
+		}
+	}
+}
+
 uint32_t adc_dma_raw_to_mv(uint16_t raw_value)
 {
 	return ((uint32_t)raw_value * ADC_VREF_MV) / 4096;
@@ -226,24 +404,41 @@ void adc_dma_set_callback(adc_dma_callback_t callback)
 	conv_cplt_callback = callback;
 }
 
-void adc_dma_conv_cplt_callback(ADC_HandleTypeDef *hadc)
+void adc_dma_injected_cplt_callback(ADC_HandleTypeDef *hadc)
 {
+	uint16_t *slot;
+
 	if (hadc != adc_handle) {
 		return;
 	}
 
+	/* Fill the slot readers are not using, then publish it */
+	slot = adc_buffer[adc_seq & (ADC_DMA_SLOTS - 1U)];
+	for (uint8_t i = 0; i < ADC_DMA_NUM_INJECTED; i++) {
+		slot[i] = (uint16_t)HAL_ADCEx_InjectedGetValue(hadc, injected_ranks[i]);
+	}
+	/* Converted after the currents: on the target, from the previous trigger */
+	for (uint8_t i = 0; i < ADC_NUM_REGULAR; i++) {
+		slot[ADC_DMA_NUM_INJECTED + i] = regular_buffer[i];
+	}
+	adc_seq++;
+
+	if (capture.active) {
+		adc_dma_capture_sample(slot);
+	}
+
 	/* Call user callback if registered */
 	if (conv_cplt_callback) {
-		conv_cplt_callback(adc_buffer, ADC_DMA_NUM_CHANNELS);
+		conv_cplt_callback(slot, ADC_DMA_NUM_CHANNELS);
 	}
 }
 
 /**
- * @brief HAL ADC conversion complete callback
+ * @brief HAL ADC injected conversion complete callback
  *
- * This is called by HAL when DMA transfer completes.
+ * This is called by HAL at the end of each injected sequence.
  */
-void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef *hadc)
+void HAL_ADCEx_InjectedConvCpltCallback(ADC_HandleTypeDef *hadc)
 {
-	adc_dma_conv_cplt_callback(hadc);
+	adc_dma_injected_cplt_callback(hadc);
 }
@@ -1,7 +1,27 @@
 #include "drv/can.h"
+#include "log.h"
 #include <stdio.h>
 
 static FDCAN_HandleTypeDef *hcan = NULL;
+static can_rx_callback_t rx_callback = NULL;
+
+/**
+ * @brief Convert a length of 0-8 bytes to the DLC code
+ */
+static uint32_t can_dlc_code(uint8_t len)
+{
+    switch (len) {
+        case 0: return FDCAN_DLC_BYTES_0;
+        case 1: return FDCAN_DLC_BYTES_1;
+        case 2: return FDCAN_DLC_BYTES_2;
+        case 3: return FDCAN_DLC_BYTES_3;
+        case 4: return FDCAN_DLC_BYTES_4;
+        case 5: return FDCAN_DLC_BYTES_5;
+        case 6: return FDCAN_DLC_BYTES_6;
+        case 7: return FDCAN_DLC_BYTES_7;
+        default: return FDCAN_DLC_BYTES_8;
+    }
+}
 
 void can_init(FDCAN_HandleTypeDef *hfdcan)
 {
@@ -70,19 +90,7 @@ void can_transmit(uint32_t id, uint8_t *data, uint8_t len)
     FDCAN_TxHeaderTypeDef TxHeader;
 
     /* Convert length to DLC code */
-    uint32_t dlc_code;
-    switch (len) {
-        case 0: dlc_code = FDCAN_DLC_BYTES_0; break;
-        case 1: dlc_code = FDCAN_DLC_BYTES_1; break;
-        case 2: dlc_code = FDCAN_DLC_BYTES_2; break;
-        case 3: dlc_code = FDCAN_DLC_BYTES_3; break;
-        case 4: dlc_code = FDCAN_DLC_BYTES_4; break;
-        case 5: dlc_code = FDCAN_DLC_BYTES_5; break;
-        case 6: dlc_code = FDCAN_DLC_BYTES_6; break;
-        case 7: dlc_code = FDCAN_DLC_BYTES_7; break;
-        case 8: dlc_code = FDCAN_DLC_BYTES_8; break;
-        default: dlc_code = FDCAN_DLC_BYTES_8; break;
-    }
+    uint32_t dlc_code = can_dlc_code(len);
 
     TxHeader.Identifier = id;
     TxHeader.IdType = FDCAN_STANDARD_ID;
@@ -96,10 +104,54 @@ void can_transmit(uint32_t id, uint8_t *data, uint8_t len)
 
     HAL_StatusTypeDef status = HAL_FDCAN_AddMessageToTxFifoQ(hcan, &TxHeader, data);
     if (status != HAL_OK) {
-        printf("CAN TX Error: %d\n", status);
-    } else {
-        printf("CAN TX OK: ID=0x%lX DLC=%d\n", id, len);
+        LOG(LOG_CAN_TX_ERROR, status);
+    }
+}
+
+void can_set_rx_callback(can_rx_callback_t callback)
+{
+    rx_callback = callback;
+}
+
+int can_write(uint32_t id, const uint8_t *data, uint32_t len, uint32_t timeout_ms)
+{
+    FDCAN_TxHeaderTypeDef TxHeader;
+    uint32_t start = HAL_GetTick();
+
+    if (hcan == NULL) {
+        return -1;
+    }
+
+    TxHeader.Identifier = id;
+    TxHeader.IdType = FDCAN_STANDARD_ID;
+    TxHeader.TxFrameType = FDCAN_DATA_FRAME;
+    TxHeader.ErrorStateIndicator = FDCAN_ESI_ACTIVE;
+    TxHeader.BitRateSwitch = FDCAN_BRS_OFF;
+    TxHeader.FDFormat = FDCAN_CLASSIC_CAN;
+    TxHeader.TxEventFifoControl = FDCAN_NO_TX_EVENTS;
+    TxHeader.MessageMarker = 0;
+
+    while (len > 0) {
+        uint8_t n = len < 8 ? (uint8_t)len : 8;
+
+        TxHeader.DataLength = can_dlc_code(n);
+
+        while (HAL_FDCAN_GetTxFifoFreeLevel(hcan) == 0) {
+            if (HAL_GetTick() - start > timeout_ms) {
+                LOG(LOG_CAN_TX_ERROR, HAL_TIMEOUT);
+                return -1;
+            }
+        }
+
+        if (HAL_FDCAN_AddMessageToTxFifoQ(hcan, &TxHeader, (uint8_t *)data) != HAL_OK) {
+            LOG(LOG_CAN_TX_ERROR, HAL_ERROR);
+            return -1;
+        }
+        data += n;
+        len -= n;
     }
+
+    return 0;
 }
 
 void HAL_FDCAN_RxFifo0Callback(FDCAN_HandleTypeDef *hfdcan, uint32_t RxFifo0ITs)
@@ -109,16 +161,23 @@ void HAL_FDCAN_RxFifo0Callback(FDCAN_HandleTypeDef *hfdcan, uint32_t RxFifo0ITs)
         uint8_t RxData[8];
 
         if (HAL_FDCAN_GetRxMessage(hfdcan, FDCAN_RX_FIFO0, &RxHeader, RxData) == HAL_OK) {
-            /* Print CAN packet information */
-            printf("CAN RX: ID=0x%03lX DLC=%lu Data=",
-                   RxHeader.Identifier,
-                   RxHeader.DataLength >> 16);
-
             uint8_t dlc = RxHeader.DataLength >> 16;
-            for (uint8_t i = 0; i < dlc; i++) {
-                printf("%02X ", RxData[i]);
+
+            if (rx_callback && rx_callback(RxHeader.Identifier, RxData, dlc > 8 ? 8 : dlc)) {
+                return;
             }
-            printf("\n");
+
+            /* Deferred: formatted by log_flush() in the main loop */
+            uint8_t bytes[8] = {0};
+            for (uint8_t i = 0; i < dlc && i < 8; i++) {
+                bytes[i] = RxData[i];
+            }
+
+            LOG(LOG_CAN_RX, RxHeader.Identifier, dlc,
+                ((uint32_t)bytes[0] << 24) | ((uint32_t)bytes[1] << 16) |
+                ((uint32_t)bytes[2] << 8) | bytes[3],
+                ((uint32_t)bytes[4] << 24) | ((uint32_t)bytes[5] << 16) |
+                ((uint32_t)bytes[6] << 8) | bytes[7]);
         }
     }
 }
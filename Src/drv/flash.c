@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "drv/flash.h"
+#include "main.h"
+#include <stdbool.h>
+#include <string.h>
+
+/* Store region, from the linker script */
+extern const uint8_t _store_start[];
+extern const uint8_t _store_end[];
+
+static bool flash_range_ok(uint32_t offset, uint32_t len)
+{
+	return offset <= FLASH_STORE_SIZE && len <= FLASH_STORE_SIZE - offset &&
+	       (uint32_t)(_store_end - _store_start) == FLASH_STORE_SIZE;
+}
+
+int flash_read(uint32_t offset, void *buf, uint32_t len)
+{
+	if (!buf || !flash_range_ok(offset, len)) {
+		return -1;
+	}
+
+	/* Memory mapped */
+	memcpy(buf, &_store_start[offset], len);
+	return 0;
+}
+
+int flash_erase_page(uint32_t page)
+{
+	FLASH_EraseInitTypeDef erase = {0};
+	uint32_t page_error = 0;
+	HAL_StatusTypeDef status;
+
+	if (page >= FLASH_STORE_PAGES || !flash_range_ok(0, FLASH_STORE_SIZE)) {
+		return -1;
+	}
+
+	erase.TypeErase = FLASH_TYPEERASE_PAGES;
+	erase.Banks = FLASH_BANK_1;
+	erase.Page = ((uint32_t)_store_start - FLASH_BASE) / FLASH_PAGE_SIZE + page;
+	erase.NbPages = 1;
+
+	HAL_FLASH_Unlock();
+	__HAL_FLASH_CLEAR_FLAG(FLASH_FLAG_ALL_ERRORS);
+	status = HAL_FLASHEx_Erase(&erase, &page_error);
+	HAL_FLASH_Lock();
+
+	return status == HAL_OK ? 0 : -1;
+}
+
+int flash_program(uint32_t offset, const void *data, uint32_t len)
+{
+	const uint8_t *src = data;
+	uint64_t word;
+	uint32_t addr;
+	int ret = 0;
+
+	if (!data || !flash_range_ok(offset, len) ||
+	    offset % FLASH_STORE_WORD != 0 || len % FLASH_STORE_WORD != 0) {
+		return -1;
+	}
+
+	/* The controller refuses to program a double word twice */
+	for (uint32_t i = 0; i < len; i += FLASH_STORE_WORD) {
+		memcpy(&word, &_store_start[offset + i], sizeof(word));
+		if (word != UINT64_MAX) {
+			return -1;
+		}
+	}
+
+	HAL_FLASH_Unlock();
+	__HAL_FLASH_CLEAR_FLAG(FLASH_FLAG_ALL_ERRORS);
+	for (uint32_t i = 0; i < len; i += FLASH_STORE_WORD) {
+		memcpy(&word, &src[i], sizeof(word));
+		addr = (uint32_t)&_store_start[offset + i];
+		if (HAL_FLASH_Program(FLASH_TYPEPROGRAM_DOUBLEWORD, addr, word) != HAL_OK) {
+			ret = -1;
+			break;
+		}
+	}
+	HAL_FLASH_Lock();
+
+	return ret;
+}
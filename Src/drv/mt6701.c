@@ -1,11 +1,48 @@
 #include "drv/mt6701.h"
+#include "prof.h"
 #include <stdio.h>
+#include <string.h>
 #include <math.h>
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
 
+/* Devices served by the I2C completion callbacks */
+static mt6701_t *mt6701_devices[MT6701_MAX_DEVICES];
+
+static void mt6701_register(mt6701_t *dev)
+{
+    for (int i = 0; i < MT6701_MAX_DEVICES; i++) {
+        if (mt6701_devices[i] == dev) {
+            return;
+        }
+    }
+    for (int i = 0; i < MT6701_MAX_DEVICES; i++) {
+        if (!mt6701_devices[i] || mt6701_devices[i]->hi2c == dev->hi2c) {
+            mt6701_devices[i] = dev;
+            return;
+        }
+    }
+    printf("%s: Too many MT6701 devices, interrupt reads disabled\n", dev->name);
+}
+
+static mt6701_t *mt6701_find(I2C_HandleTypeDef *hi2c)
+{
+    for (int i = 0; i < MT6701_MAX_DEVICES; i++) {
+        if (mt6701_devices[i] && mt6701_devices[i]->hi2c == hi2c) {
+            return mt6701_devices[i];
+        }
+    }
+    return NULL;
+}
+
+/* Angle[13:6] in 0x03, Angle[5:0] in bits [7:2] of 0x04, bits [1:0] are status */
+static inline uint16_t mt6701_decode(const uint8_t data[2])
+{
+    return ((uint16_t)data[0] << 6) | ((data[1] >> 2) & 0x3F);
+}
+
 int mt6701_init(mt6701_t *dev, I2C_HandleTypeDef *hi2c, uint8_t addr, const char *name)
 {
     HAL_StatusTypeDef ret;
@@ -18,6 +55,13 @@ int mt6701_init(mt6701_t *dev, I2C_HandleTypeDef *hi2c, uint8_t addr, const char
     dev->hi2c = hi2c;
     dev->i2c_addr = addr;
     dev->name = name;
+    dev->busy = false;
+    dev->latest = 0;
+    dev->seq = 0;
+    dev->errors = 0;
+    dev->overruns = 0;
+    memset(dev->slot, 0, sizeof(dev->slot));
+    mt6701_register(dev);
 
     /* Try to read a register to verify device is present and responding */
     ret = HAL_I2C_Mem_Read(dev->hi2c, dev->i2c_addr << 1, MT6701_REG_ANGLE_H,
@@ -36,34 +80,20 @@ int mt6701_init(mt6701_t *dev, I2C_HandleTypeDef *hi2c, uint8_t addr, const char
 
 int mt6701_read_angle_raw(mt6701_t *dev, uint16_t *angle)
 {
-    HAL_StatusTypeDef ret;
     uint8_t data[2];
 
-    if (!dev || !angle) {
+    if (!dev || !angle || dev->busy) {
         return -1;
     }
 
-    /* Read angle high byte (register 0x03) */
-    ret = HAL_I2C_Mem_Read(dev->hi2c, dev->i2c_addr << 1, MT6701_REG_ANGLE_H,
-                          I2C_MEMADD_SIZE_8BIT, &data[0], 1, 100);
-    if (ret != HAL_OK) {
-        printf("%s: Failed to read angle high byte: %d\n", dev->name, ret);
+    /* Registers 0x03 and 0x04 in one transaction: both halves of the same angle */
+    if (HAL_I2C_Mem_Read(dev->hi2c, dev->i2c_addr << 1, MT6701_REG_ANGLE_H,
+                         I2C_MEMADD_SIZE_8BIT, data, 2, MT6701_I2C_TIMEOUT_MS) != HAL_OK) {
+        dev->errors++;
         return -1;
     }
 
-    /* Read angle low byte (register 0x04) */
-    ret = HAL_I2C_Mem_Read(dev->hi2c, dev->i2c_addr << 1, MT6701_REG_ANGLE_L,
-                          I2C_MEMADD_SIZE_8BIT, &data[1], 1, 100);
-    if (ret != HAL_OK) {
-        printf("%s: Failed to read angle low byte: %d\n", dev->name, ret);
-        return -1;
-    }
-
-    /* Combine into 14-bit angle value
-     * Register 0x03: Angle[13:6]
-     * Register 0x04: Angle[5:0] in bits [7:2], bits [1:0] are status
-     */
-    *angle = ((uint16_t)data[0] << 6) | ((data[1] >> 2) & 0x3F);
+    *angle = mt6701_decode(data);
 
     return 0;
 }
@@ -111,3 +141,84 @@ int mt6701_read_angle_rad(mt6701_t *dev, float *angle_rad)
 
     return 0;
 }
+
+int mt6701_start_read(mt6701_t *dev, uint32_t timestamp)
+{
+    if (!dev || !dev->hi2c) {
+        return -1;
+    }
+
+    if (dev->busy) {
+        dev->overruns++;
+        return -1;
+    }
+
+    dev->busy = true;
+    dev->pending_timestamp = timestamp;
+    PROF_STAMP(dev->pending_cycles);
+    if (HAL_I2C_Mem_Read_IT(dev->hi2c, dev->i2c_addr << 1, MT6701_REG_ANGLE_H,
+                            I2C_MEMADD_SIZE_8BIT, dev->rx, 2) != HAL_OK) {
+        dev->busy = false;
+        dev->errors++;
+        return -1;
+    }
+
+    return 0;
+}
+
+int mt6701_get_sample(mt6701_t *dev, mt6701_sample_t *sample)
+{
+    const mt6701_sample_t *slot;
+
+    if (!dev || !sample) {
+        return -1;
+    }
+
+    /* The completion interrupt only writes the slot readers are not using;
+     * retry in the unlikely case two reads completed during the copy.
+     */
+    do {
+        slot = &dev->slot[dev->latest];
+        *sample = *slot;
+    } while (sample->seq != ((volatile const mt6701_sample_t *)slot)->seq);
+
+    return sample->seq ? 0 : -1;
+}
+
+/**
+ * @brief I2C memory read complete callback: publish the new sample
+ */
+void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef *hi2c)
+{
+    mt6701_t *dev = mt6701_find(hi2c);
+    mt6701_sample_t *slot;
+
+    if (!dev || !dev->busy) {
+        return;
+    }
+
+    slot = &dev->slot[dev->latest ^ 1];
+    slot->angle = mt6701_decode(dev->rx);
+    slot->timestamp = dev->pending_timestamp;
+    slot->seq = ++dev->seq;
+    dev->latest ^= 1;
+    dev->busy = false;
+
+    /* Start to completion, I2C transfer and interrupt latency included */
+    PROF_STOP_FROM(PROF_ENCODER_READ, dev->pending_cycles);
+}
+
+/**
+ * @brief I2C error callback: drop the transfer, keep the last sample
+ */
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c)
+{
+    mt6701_t *dev = mt6701_find(hi2c);
+
+    if (!dev || !dev->busy) {
+        return;
+    }
+
+    dev->errors++;
+    dev->busy = false;
+}
@@ -5,11 +5,14 @@
  */
 
 #include "drv/pwm.h"
+#include "trig.h"
+#include "prof.h"
 #include <stdio.h>
 #include <string.h>
 #include <math.h>
 
-#define M_PI_F 3.14159265358979323846f
+#define SQRT3_F      1.732050808f
+#define SQRT3_2_F    0.866025404f  /* sqrt(3)/2 */
 
 /* External timer handles (declared in main.c) */
 extern TIM_HandleTypeDef htim2;
@@ -37,12 +40,14 @@ static struct pwm_data pwm_motor0_data = {
 	.initialized = false,
 	.phase = 0.0f,
 	.duty = 0.0f,
+	.svpwm_mode = PWM_SVPWM_SECTOR,
 };
 
 static struct pwm_data pwm_motor1_data = {
 	.initialized = false,
 	.phase = 0.0f,
 	.duty = 0.0f,
+	.svpwm_mode = PWM_SVPWM_SECTOR,
 };
 
 /* Device instances */
@@ -68,6 +73,33 @@ static inline float clamp_float(float value, float min, float max)
 	return value;
 }
 
+/**
+ * @brief Write normalized (0-1) phase duties using the cached period
+ */
+static inline void pwm_write_normalized(struct pwm_device *dev, float duty_a, float duty_b,
+                                        float duty_c)
+{
+	const struct pwm_config *config = dev->config;
+	float period = (float)dev->data->period;
+
+	duty_a = clamp_float(duty_a, 0.0f, 1.0f);
+	duty_b = clamp_float(duty_b, 0.0f, 1.0f);
+	duty_c = clamp_float(duty_c, 0.0f, 1.0f);
+
+	__HAL_TIM_SET_COMPARE(config->htim, config->channel_a, (uint32_t)(duty_a * period));
+	__HAL_TIM_SET_COMPARE(config->htim, config->channel_b, (uint32_t)(duty_b * period));
+	__HAL_TIM_SET_COMPARE(config->htim, config->channel_c, (uint32_t)(duty_c * period));
+}
+
+/**
+ * @brief Convert a duty percentage to Q15
+ */
+static inline uint16_t percent_to_q15(float duty)
+{
+	duty = clamp_float(duty, 0.0f, 100.0f);
+	return (uint16_t)(duty * ((float)PWM_DUTY_Q15_ONE / 100.0f) + 0.5f);
+}
+
 int pwm_init(struct pwm_device *dev)
 {
 	const struct pwm_config *config = dev->config;
@@ -83,8 +115,8 @@ int pwm_init(struct pwm_device *dev)
 	/* TIM2 is already configured by adc_dma_init, so we skip base init for TIM2 */
 	if (config->htim->Instance != TIM2) {
 		config->htim->Init.Prescaler = 0;
-		config->htim->Init.CounterMode = TIM_COUNTERMODE_UP;
-		config->htim->Init.Period = 8499;  /* 20 kHz at 170 MHz */
+		config->htim->Init.CounterMode = TIM_COUNTERMODE_CENTERALIGNED1;
+		config->htim->Init.Period = PWM_TIMER_PERIOD;  /* 20 kHz at 170 MHz */
 		config->htim->Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
 		config->htim->Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_ENABLE;
 
@@ -123,6 +155,7 @@ int pwm_init(struct pwm_device *dev)
 	__HAL_TIM_SET_COMPARE(config->htim, config->channel_b, 0);
 	__HAL_TIM_SET_COMPARE(config->htim, config->channel_c, 0);
 
+	data->period = period;
 	data->initialized = true;
 	printf("%s: PWM initialized (period: %lu, freq: %lu Hz)\n",
 		dev->name, period, config->pwm_frequency_hz);
@@ -160,6 +193,36 @@ int pwm_start(struct pwm_device *dev)
 	return 0;
 }
 
+int pwm_sync(struct pwm_device *const *devs, uint8_t count)
+{
+	uint32_t primask;
+
+	for (uint8_t i = 0; i < count; i++) {
+		if (!devs[i]->data->initialized) {
+			return -1;
+		}
+	}
+
+	/*
+	 * Stopped at the bottom, then restarted back to back. CEN is cleared
+	 * directly: __HAL_TIM_DISABLE() leaves the counter running while any
+	 * channel output is enabled. At 0 a centre-aligned counter counts up
+	 * next, whichever direction it was stopped in.
+	 */
+	primask = __get_PRIMASK();
+	__disable_irq();
+	for (uint8_t i = 0; i < count; i++) {
+		devs[i]->config->htim->Instance->CR1 &= ~TIM_CR1_CEN;
+		__HAL_TIM_SET_COUNTER(devs[i]->config->htim, 0);
+	}
+	for (uint8_t i = 0; i < count; i++) {
+		__HAL_TIM_ENABLE(devs[i]->config->htim);
+	}
+	__set_PRIMASK(primask);
+
+	return 0;
+}
+
 int pwm_stop(struct pwm_device *dev)
 {
 	const struct pwm_config *config = dev->config;
@@ -181,31 +244,35 @@ int pwm_stop(struct pwm_device *dev)
 
 int pwm_set_duty(struct pwm_device *dev, float duty_a, float duty_b, float duty_c)
 {
-	const struct pwm_config *config = dev->config;
-	struct pwm_data *data = dev->data;
-
-	if (!data->initialized) {
+	if (!dev->data->initialized) {
 		printf("%s: Device not initialized\n", dev->name);
 		return -1;
 	}
 
-	/* Clamp duty cycles to 0-100% */
-	duty_a = clamp_float(duty_a, 0.0f, 100.0f);
-	duty_b = clamp_float(duty_b, 0.0f, 100.0f);
-	duty_c = clamp_float(duty_c, 0.0f, 100.0f);
+	return pwm_set_duty_q15(dev, percent_to_q15(duty_a), percent_to_q15(duty_b),
+	                        percent_to_q15(duty_c));
+}
 
-	/* Get timer period */
-	uint32_t period = __HAL_TIM_GET_AUTORELOAD(config->htim);
+int pwm_set_duty_q15(struct pwm_device *dev, uint16_t duty_a, uint16_t duty_b, uint16_t duty_c)
+{
+	const struct pwm_config *config = dev->config;
+	uint32_t period = dev->data->period;
 
-	/* Convert duty cycle percentage to compare value */
-	uint32_t compare_a = (uint32_t)((duty_a / 100.0f) * period);
-	uint32_t compare_b = (uint32_t)((duty_b / 100.0f) * period);
-	uint32_t compare_c = (uint32_t)((duty_c / 100.0f) * period);
+#ifdef DEBUG
+	if (!dev->data->initialized) {
+		printf("%s: Device not initialized\n", dev->name);
+		return -1;
+	}
+#endif
+
+	if (duty_a > PWM_DUTY_Q15_ONE) duty_a = PWM_DUTY_Q15_ONE;
+	if (duty_b > PWM_DUTY_Q15_ONE) duty_b = PWM_DUTY_Q15_ONE;
+	if (duty_c > PWM_DUTY_Q15_ONE) duty_c = PWM_DUTY_Q15_ONE;
 
-	/* Set PWM duty cycles */
-	__HAL_TIM_SET_COMPARE(config->htim, config->channel_a, compare_a);
-	__HAL_TIM_SET_COMPARE(config->htim, config->channel_b, compare_b);
-	__HAL_TIM_SET_COMPARE(config->htim, config->channel_c, compare_c);
+	/* period < 2^16, so duty * period fits in 32 bits */
+	__HAL_TIM_SET_COMPARE(config->htim, config->channel_a, (duty_a * period) >> 15);
+	__HAL_TIM_SET_COMPARE(config->htim, config->channel_b, (duty_b * period) >> 15);
+	__HAL_TIM_SET_COMPARE(config->htim, config->channel_c, (duty_c * period) >> 15);
 
 	return 0;
 }
@@ -225,14 +292,8 @@ int pwm_set_phase_duty(struct pwm_device *dev, uint8_t phase, float duty)
 		return -1;
 	}
 
-	/* Clamp duty cycle to 0-100% */
-	duty = clamp_float(duty, 0.0f, 100.0f);
-
-	/* Get timer period */
-	uint32_t period = __HAL_TIM_GET_AUTORELOAD(config->htim);
-
 	/* Convert duty cycle percentage to compare value */
-	uint32_t compare = (uint32_t)((duty / 100.0f) * period);
+	uint32_t compare = ((uint32_t)percent_to_q15(duty) * data->period) >> 15;
 
 	/* Set the appropriate PWM channel */
 	switch (phase) {
@@ -252,11 +313,19 @@ int pwm_set_phase_duty(struct pwm_device *dev, uint8_t phase, float duty)
 	return 0;
 }
 
-int pwm_set_vector(struct pwm_device *dev, float angle_deg, float amplitude)
+bool pwm_is_zero_vector(const struct pwm_device *dev)
 {
 	const struct pwm_config *config = dev->config;
+	uint32_t compare_a = __HAL_TIM_GET_COMPARE(config->htim, config->channel_a);
+
+	return compare_a == __HAL_TIM_GET_COMPARE(config->htim, config->channel_b) &&
+	       compare_a == __HAL_TIM_GET_COMPARE(config->htim, config->channel_c);
+}
+
+int pwm_set_vector(struct pwm_device *dev, float angle_deg, float amplitude)
+{
 	struct pwm_data *data = dev->data;
-	float angle_rad;
+	float sin_th, cos_th, half;
 	float duty_a, duty_b, duty_c;
 	float sine_a, sine_b, sine_c;
 
@@ -272,42 +341,27 @@ int pwm_set_vector(struct pwm_device *dev, float angle_deg, float amplitude)
 	while (angle_deg < 0.0f) angle_deg += 360.0f;
 	while (angle_deg >= 360.0f) angle_deg -= 360.0f;
 
-	/* Convert to radians */
-	angle_rad = angle_deg * M_PI_F / 180.0f;
-
 	/* Calculate three-phase sinusoidal values with 120-degree spacing
 	 * Phase A: sin(θ)
-	 * Phase B: sin(θ - 120°)
-	 * Phase C: sin(θ + 120°)
+	 * Phase B: sin(θ - 120°) = -sin(θ)/2 - cos(θ)·√3/2
+	 * Phase C: sin(θ + 120°) = -sin(θ)/2 + cos(θ)·√3/2
+	 * so a single table lookup serves all three phases.
 	 */
-	sine_a = sinf(angle_rad);
-	sine_b = sinf(angle_rad - 2.0f * M_PI_F / 3.0f);  /* -120 degrees */
-	sine_c = sinf(angle_rad + 2.0f * M_PI_F / 3.0f);  /* +120 degrees */
+	trig_sincos(trig_deg_to_angle(angle_deg), &sin_th, &cos_th);
+	sine_a = sin_th;
+	sine_b = -0.5f * sin_th - SQRT3_2_F * cos_th;
+	sine_c = -0.5f * sin_th + SQRT3_2_F * cos_th;
 
-	/* Convert sine values (-1 to +1) to duty cycles (0 to 100%)
-	 * Using bipolar modulation: duty = 50% + (sine * amplitude/2)
+	/* Convert sine values (-1 to +1) to normalized duty cycles (0 to 1)
+	 * Using bipolar modulation: duty = 0.5 + (sine * amplitude/2)
 	 */
-	duty_a = 50.0f + (sine_a * amplitude / 2.0f);
-	duty_b = 50.0f + (sine_b * amplitude / 2.0f);
-	duty_c = 50.0f + (sine_c * amplitude / 2.0f);
-
-	/* Clamp to valid range */
-	duty_a = clamp_float(duty_a, 0.0f, 100.0f);
-	duty_b = clamp_float(duty_b, 0.0f, 100.0f);
-	duty_c = clamp_float(duty_c, 0.0f, 100.0f);
-
-	/* Get timer period */
-	uint32_t period = __HAL_TIM_GET_AUTORELOAD(config->htim);
-
-	/* Convert duty cycles to compare values */
-	uint32_t compare_a = (uint32_t)((duty_a / 100.0f) * period);
-	uint32_t compare_b = (uint32_t)((duty_b / 100.0f) * period);
-	uint32_t compare_c = (uint32_t)((duty_c / 100.0f) * period);
+	half = amplitude * 0.005f;
+	duty_a = 0.5f + sine_a * half;
+	duty_b = 0.5f + sine_b * half;
+	duty_c = 0.5f + sine_c * half;
 
 	/* Set PWM outputs */
-	__HAL_TIM_SET_COMPARE(config->htim, config->channel_a, compare_a);
-	__HAL_TIM_SET_COMPARE(config->htim, config->channel_b, compare_b);
-	__HAL_TIM_SET_COMPARE(config->htim, config->channel_c, compare_c);
+	pwm_write_normalized(dev, duty_a, duty_b, duty_c);
 
 	/* Store current values */
 	data->phase = angle_deg;
@@ -316,35 +370,19 @@ int pwm_set_vector(struct pwm_device *dev, float angle_deg, float amplitude)
 	return 0;
 }
 
-int pwm_set_vector_svpwm(struct pwm_device *dev, float angle_deg, float amplitude)
+/**
+ * @brief SVPWM phase duties from sector timing (SimpleFOC algorithm)
+ *
+ * SVPWM divides the space into 6 sectors (60 degrees each).
+ * For each sector, we use two adjacent base vectors and one zero vector.
+ * This maximizes DC bus utilization and reduces harmonics.
+ */
+static void svpwm_sector(float angle_deg, float Uout, float *Ta, float *Tb, float *Tc)
 {
-	const struct pwm_config *config = dev->config;
-	struct pwm_data *data = dev->data;
-	float duty_a, duty_b, duty_c;
 	int sector;
 	float angle_sector;
 	float T1, T2, T0;
-	float Ta, Tb, Tc;
-	float Uout;
-
-	if (!data->initialized) {
-		printf("%s: Device not initialized\n", dev->name);
-		return -1;
-	}
-
-	/* Clamp amplitude to 0-100% */
-	amplitude = clamp_float(amplitude, 0.0f, 100.0f);
-
-	/* Normalize angle to 0-360 degrees */
-	while (angle_deg < 0.0f) angle_deg += 360.0f;
-	while (angle_deg >= 360.0f) angle_deg -= 360.0f;
-
-	/* Space Vector PWM Implementation (SimpleFOC algorithm)
-	 *
-	 * SVPWM divides the space into 6 sectors (60 degrees each).
-	 * For each sector, we use two adjacent base vectors and one zero vector.
-	 * This maximizes DC bus utilization and reduces harmonics.
-	 */
+	float sin_sector, cos_sector;
 
 	/* Determine sector (0-5) based on angle */
 	sector = (int)(angle_deg / 60.0f);
@@ -352,26 +390,16 @@ int pwm_set_vector_svpwm(struct pwm_device *dev, float angle_deg, float amplitud
 
 	/* Calculate angle within sector (0-60 degrees) */
 	angle_sector = angle_deg - (sector * 60.0f);
-	float angle_sector_rad = angle_sector * M_PI_F / 180.0f;
-
-	/* Calculate normalized output voltage (0-1)
-	 * SVPWM can utilize up to sqrt(3)/2 ≈ 0.866 of DC bus in linear region
-	 * We scale amplitude accordingly: Uout = amplitude / 100 / sqrt(3)
-	 */
-	Uout = (amplitude / 100.0f) / 1.732050808f;  /* 1/sqrt(3) */
-
-	/* Clamp to maximum achievable voltage in SVPWM */
-	if (Uout > 0.577350269f) {  /* 1/sqrt(3) */
-		Uout = 0.577350269f;
-	}
+	trig_sincos(trig_deg_to_angle(angle_sector), &sin_sector, &cos_sector);
 
 	/* Calculate switching times for sector vectors
 	 * T1: Time for first adjacent vector
 	 * T2: Time for second adjacent vector
 	 * T0: Time for zero vector (split between start and end)
+	 * sin(60° - a) = cos(a)·√3/2 - sin(a)/2
 	 */
-	T1 = 1.732050808f * Uout * sinf(M_PI_F / 3.0f - angle_sector_rad);
-	T2 = 1.732050808f * Uout * sinf(angle_sector_rad);
+	T1 = SQRT3_F * Uout * (SQRT3_2_F * cos_sector - 0.5f * sin_sector);
+	T2 = SQRT3_F * Uout * sin_sector;
 	T0 = 1.0f - T1 - T2;
 
 	/* Handle over-modulation - clamp to linear region */
@@ -386,67 +414,166 @@ int pwm_set_vector_svpwm(struct pwm_device *dev, float angle_deg, float amplitud
 	 */
 	switch (sector) {
 	case 0:  /* 0-60 degrees */
-		Ta = T1 + T2 + T0 / 2.0f;
-		Tb = T2 + T0 / 2.0f;
-		Tc = T0 / 2.0f;
+		*Ta = T1 + T2 + T0 / 2.0f;
+		*Tb = T2 + T0 / 2.0f;
+		*Tc = T0 / 2.0f;
 		break;
 	case 1:  /* 60-120 degrees */
-		Ta = T1 + T0 / 2.0f;
-		Tb = T1 + T2 + T0 / 2.0f;
-		Tc = T0 / 2.0f;
+		*Ta = T1 + T0 / 2.0f;
+		*Tb = T1 + T2 + T0 / 2.0f;
+		*Tc = T0 / 2.0f;
 		break;
 	case 2:  /* 120-180 degrees */
-		Ta = T0 / 2.0f;
-		Tb = T1 + T2 + T0 / 2.0f;
-		Tc = T2 + T0 / 2.0f;
+		*Ta = T0 / 2.0f;
+		*Tb = T1 + T2 + T0 / 2.0f;
+		*Tc = T2 + T0 / 2.0f;
 		break;
 	case 3:  /* 180-240 degrees */
-		Ta = T0 / 2.0f;
-		Tb = T1 + T0 / 2.0f;
-		Tc = T1 + T2 + T0 / 2.0f;
+		*Ta = T0 / 2.0f;
+		*Tb = T1 + T0 / 2.0f;
+		*Tc = T1 + T2 + T0 / 2.0f;
 		break;
 	case 4:  /* 240-300 degrees */
-		Ta = T2 + T0 / 2.0f;
-		Tb = T0 / 2.0f;
-		Tc = T1 + T2 + T0 / 2.0f;
+		*Ta = T2 + T0 / 2.0f;
+		*Tb = T0 / 2.0f;
+		*Tc = T1 + T2 + T0 / 2.0f;
 		break;
 	case 5:  /* 300-360 degrees */
-		Ta = T1 + T2 + T0 / 2.0f;
-		Tb = T0 / 2.0f;
-		Tc = T1 + T0 / 2.0f;
+		*Ta = T1 + T2 + T0 / 2.0f;
+		*Tb = T0 / 2.0f;
+		*Tc = T1 + T0 / 2.0f;
 		break;
 	default:
-		Ta = Tb = Tc = 0.5f;
+		*Ta = *Tb = *Tc = 0.5f;
 		break;
 	}
+}
+
+/**
+ * @brief SVPWM phase duties from min/max zero-sequence injection
+ *
+ * Inverse Clarke of the voltage vector gives the three sinusoidal phase
+ * voltages; shifting them by -(max + min) / 2 centres the vector in the
+ * carrier exactly like the symmetric zero-vector split of the sector
+ * method, so line-to-line voltages are identical. No sector decode, and
+ * min/max compile to conditional selects.
+ *
+ * @param v_alpha Alpha voltage as a fraction of the bus
+ * @param v_beta Beta voltage as a fraction of the bus
+ */
+static void svpwm_minmax_ab(float v_alpha, float v_beta, float *Ta, float *Tb, float *Tc)
+{
+	float va, vb, vc, vmax, vmin, offset;
+
+	/* Phase A on the alpha axis, B and C at -120 and +120 degrees */
+	va = v_alpha;
+	vb = -0.5f * v_alpha + SQRT3_2_F * v_beta;
+	vc = -va - vb;
+
+	vmax = va > vb ? va : vb;
+	vmax = vmax > vc ? vmax : vc;
+	vmin = va < vb ? va : vb;
+	vmin = vmin < vc ? vmin : vc;
+	offset = 0.5f - 0.5f * (vmax + vmin);
+
+	*Ta = va + offset;
+	*Tb = vb + offset;
+	*Tc = vc + offset;
+}
+
+static void svpwm_minmax(float angle_deg, float Uout, float *Ta, float *Tb, float *Tc)
+{
+	float sin_th, cos_th;
+
+	trig_sincos(trig_deg_to_angle(angle_deg), &sin_th, &cos_th);
+	svpwm_minmax_ab(Uout * cos_th, Uout * sin_th, Ta, Tb, Tc);
+}
+
+int pwm_set_svpwm_mode(struct pwm_device *dev, enum pwm_svpwm_mode mode)
+{
+	struct pwm_data *data = dev->data;
+
+	if (mode != PWM_SVPWM_SECTOR && mode != PWM_SVPWM_MINMAX) {
+		printf("%s: Invalid SVPWM mode %d\n", dev->name, mode);
+		return -1;
+	}
 
-	/* Convert normalized duty cycles (0-1) to percentage (0-100%) */
-	duty_a = Ta * 100.0f;
-	duty_b = Tb * 100.0f;
-	duty_c = Tc * 100.0f;
+	data->svpwm_mode = mode;
+	return 0;
+}
 
-	/* Clamp to valid range */
-	duty_a = clamp_float(duty_a, 0.0f, 100.0f);
-	duty_b = clamp_float(duty_b, 0.0f, 100.0f);
-	duty_c = clamp_float(duty_c, 0.0f, 100.0f);
+int pwm_set_vector_svpwm(struct pwm_device *dev, float angle_deg, float amplitude)
+{
+	struct pwm_data *data = dev->data;
+	float Ta, Tb, Tc;
+	float Uout;
 
-	/* Get timer period */
-	uint32_t period = __HAL_TIM_GET_AUTORELOAD(config->htim);
+	if (!data->initialized) {
+		printf("%s: Device not initialized\n", dev->name);
+		return -1;
+	}
+
+	PROF_START(PROF_SVPWM);
+
+	/* Clamp amplitude to 0-100% */
+	amplitude = clamp_float(amplitude, 0.0f, 100.0f);
+
+	/* Normalize angle to 0-360 degrees */
+	while (angle_deg < 0.0f) angle_deg += 360.0f;
+	while (angle_deg >= 360.0f) angle_deg -= 360.0f;
+
+	/* Calculate normalized output voltage (0-1)
+	 * SVPWM can utilize up to sqrt(3)/2 ≈ 0.866 of DC bus in linear region
+	 * We scale amplitude accordingly: Uout = amplitude / 100 / sqrt(3)
+	 */
+	Uout = (amplitude / 100.0f) / SQRT3_F;
+
+	/* Clamp to maximum achievable voltage in SVPWM */
+	if (Uout > 0.577350269f) {  /* 1/sqrt(3) */
+		Uout = 0.577350269f;
+	}
 
-	/* Convert duty cycles to compare values */
-	uint32_t compare_a = (uint32_t)((duty_a / 100.0f) * period);
-	uint32_t compare_b = (uint32_t)((duty_b / 100.0f) * period);
-	uint32_t compare_c = (uint32_t)((duty_c / 100.0f) * period);
+	if (data->svpwm_mode == PWM_SVPWM_MINMAX) {
+		svpwm_minmax(angle_deg, Uout, &Ta, &Tb, &Tc);
+	} else {
+		svpwm_sector(angle_deg, Uout, &Ta, &Tb, &Tc);
+	}
 
 	/* Set PWM outputs */
-	__HAL_TIM_SET_COMPARE(config->htim, config->channel_a, compare_a);
-	__HAL_TIM_SET_COMPARE(config->htim, config->channel_b, compare_b);
-	__HAL_TIM_SET_COMPARE(config->htim, config->channel_c, compare_c);
+	pwm_write_normalized(dev, Ta, Tb, Tc);
 
 	/* Store current values */
 	data->phase = angle_deg;
 	data->duty = amplitude;
 
+	PROF_STOP(PROF_SVPWM);
+
+	return 0;
+}
+
+int pwm_set_vector_ab(struct pwm_device *dev, float v_alpha, float v_beta)
+{
+	float Ta, Tb, Tc;
+	float mag_sq = v_alpha * v_alpha + v_beta * v_beta;
+
+#ifdef DEBUG
+	if (!dev->data->initialized) {
+		printf("%s: Device not initialized\n", dev->name);
+		return -1;
+	}
+#endif
+
+	/* Limit to the inscribed circle of the hexagon (linear region) */
+	if (mag_sq > 1.0f / 3.0f) {
+		float scale = 0.577350269f / sqrtf(mag_sq);
+
+		v_alpha *= scale;
+		v_beta *= scale;
+	}
+
+	svpwm_minmax_ab(v_alpha, v_beta, &Ta, &Tb, &Tc);
+	pwm_write_normalized(dev, Ta, Tb, Tc);
+
 	return 0;
 }
 
@@ -16,8 +16,11 @@ static volatile uint32_t rx_tail = 0;  /* Read index */
 /* UART handle */
 static UART_HandleTypeDef *uart_handle = NULL;
 
-/* Single byte buffer for interrupt reception */
-static uint8_t rx_byte;
+/* Circular DMA buffer and how far into it we have published */
+static uint8_t rx_dma[UART_IN_DMA_SIZE];
+static uint32_t rx_dma_pos = 0;
+
+static struct uart_in_stats rx_stats;
 
 /* Optional callback for received characters */
 static uart_in_rx_callback_t rx_callback = NULL;
@@ -50,8 +53,32 @@ static void buffer_put(uint8_t ch)
 		rx_head = next_head;
 	} else {
 		/* Buffer overflow - character is lost */
-		printf("UART RX buffer overflow\n");
+		rx_stats.dropped++;
+	}
+}
+
+/**
+ * @brief Publish DMA buffer bytes [from, to) into the circular buffer
+ */
+static void publish(uint32_t from, uint32_t to)
+{
+	for (uint32_t i = from; i < to; i++) {
+		buffer_put(rx_dma[i]);
+
+		if (rx_callback) {
+			rx_callback(rx_dma[i]);
+		}
 	}
+	rx_stats.received += to - from;
+}
+
+/**
+ * @brief Start circular DMA reception with idle-line detection
+ */
+static HAL_StatusTypeDef start_reception(void)
+{
+	rx_dma_pos = 0;
+	return HAL_UARTEx_ReceiveToIdle_DMA(uart_handle, rx_dma, UART_IN_DMA_SIZE);
 }
 
 /**
@@ -80,9 +107,10 @@ int uart_in_init(UART_HandleTypeDef *huart)
 	/* Clear buffer */
 	rx_head = 0;
 	rx_tail = 0;
+	memset(&rx_stats, 0, sizeof(rx_stats));
 
-	/* Start reception in interrupt mode */
-	if (HAL_UART_Receive_IT(uart_handle, &rx_byte, 1) != HAL_OK) {
+	/* Start reception in circular DMA mode */
+	if (start_reception() != HAL_OK) {
 		printf("uart_in_init: Failed to start UART reception\n");
 		return -1;
 	}
@@ -119,34 +147,62 @@ uint32_t uart_in_read(uint8_t *buf, uint32_t len)
 
 void uart_in_flush(void)
 {
-	rx_head = 0;
-	rx_tail = 0;
+	/* The head belongs to the interrupt: only move the tail */
+	rx_tail = rx_head;
 }
 
-void uart_in_irq_handler(UART_HandleTypeDef *huart)
+void uart_in_get_stats(struct uart_in_stats *stats)
 {
-	if (huart != uart_handle) {
+	if (stats) {
+		*stats = rx_stats;
+	}
+}
+
+void uart_in_rx_event_handler(UART_HandleTypeDef *huart, uint16_t pos)
+{
+	if (huart != uart_handle || pos > UART_IN_DMA_SIZE) {
 		return;
 	}
 
-	/* Add received byte to buffer */
-	buffer_put(rx_byte);
+	/* The DMA wraps by itself; pos only ever runs ahead of rx_dma_pos */
+	if (pos > rx_dma_pos) {
+		publish(rx_dma_pos, pos);
+		rx_dma_pos = pos;
+	}
 
-	/* Call user callback if registered */
-	if (rx_callback) {
-		rx_callback(rx_byte);
+	if (rx_dma_pos == UART_IN_DMA_SIZE) {
+		rx_dma_pos = 0;
 	}
+}
 
-	/* Restart reception for next byte */
-	HAL_UART_Receive_IT(uart_handle, &rx_byte, 1);
+void uart_in_error_handler(UART_HandleTypeDef *huart)
+{
+	if (huart != uart_handle) {
+		return;
+	}
+
+	if (huart->ErrorCode & HAL_UART_ERROR_ORE) {
+		rx_stats.overruns++;
+	}
+	if (huart->ErrorCode & (HAL_UART_ERROR_FE | HAL_UART_ERROR_NE | HAL_UART_ERROR_PE)) {
+		rx_stats.errors++;
+	}
+
+	/* Errors during DMA reception abort it: keep what arrived and restart */
+	if (huart->RxState == HAL_UART_STATE_READY) {
+		uart_in_rx_event_handler(huart, (uint16_t)(UART_IN_DMA_SIZE -
+		                         __HAL_DMA_GET_COUNTER(huart->hdmarx)));
+		start_reception();
+	}
 }
 
 /**
- * @brief HAL UART RX Complete Callback
+ * @brief HAL UART RX Event Callback
  *
- * This is called by HAL_UART_IRQHandler when reception is complete.
+ * Called by the HAL at DMA half and full transfer and on an idle line,
+ * with the number of bytes the DMA buffer holds at that point.
  */
-void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart)
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size)
 {
-	uart_in_irq_handler(huart);
+	uart_in_rx_event_handler(huart, Size);
 }
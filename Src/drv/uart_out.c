@@ -0,0 +1,222 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "drv/uart_out.h"
+#include "irq.h"
+
+#define UART_OUT_BUFFER_MASK (UART_OUT_BUFFER_SIZE - 1U)
+
+#if (UART_OUT_BUFFER_SIZE & UART_OUT_BUFFER_MASK) != 0
+#error "UART_OUT_BUFFER_SIZE must be a power of two"
+#endif
+
+/* Bytes copied per critical section, bounds the interrupt latency we add */
+#define UART_OUT_COPY_CHUNK 32U
+
+/*
+ * Circular buffer. Head and tail are free-running byte counts, so the full
+ * buffer can be used and head - tail is the fill level. Writers advance the
+ * head, the TX complete interrupt advances the tail past what was sent.
+ */
+static uint8_t tx_buffer[UART_OUT_BUFFER_SIZE];
+static volatile uint32_t tx_head = 0;
+static volatile uint32_t tx_tail = 0;
+static volatile uint32_t tx_len = 0;  /* Bytes in the DMA transfer in flight */
+
+/* UART handle */
+static UART_HandleTypeDef *uart_handle = NULL;
+
+static enum uart_out_policy tx_policy = UART_OUT_DROP;
+static struct uart_out_stats tx_stats;
+
+/**
+ * @brief Check whether the caller may wait for DMA
+ *
+ * Not from an interrupt handler, and not with interrupts masked since the
+ * tick and the TX complete interrupt would never arrive.
+ */
+static inline bool can_block(void)
+{
+	return __get_IPSR() == 0 && __get_PRIMASK() == 0;
+}
+
+/**
+ * @brief Start DMA on the next contiguous run of the buffer
+ *
+ * Must be called with interrupts masked.
+ */
+static void tx_start(void)
+{
+	uint32_t index, count;
+
+	if (!uart_handle || tx_len != 0 || tx_head == tx_tail) {
+		return;
+	}
+
+	index = tx_tail & UART_OUT_BUFFER_MASK;
+	count = tx_head - tx_tail;
+	if (count > UART_OUT_BUFFER_SIZE - index) {
+		count = UART_OUT_BUFFER_SIZE - index;
+	}
+
+	/* On failure the data stays queued and the next write retries */
+	if (HAL_UART_Transmit_DMA(uart_handle, &tx_buffer[index], (uint16_t)count) == HAL_OK) {
+		tx_len = count;
+		tx_stats.transfers++;
+	}
+}
+
+int uart_out_init(UART_HandleTypeDef *huart)
+{
+	uint32_t primask;
+
+	if (!huart) {
+		return -1;
+	}
+
+	primask = irq_save();
+	uart_handle = huart;
+	tx_len = 0;
+	tx_start();
+	irq_restore(primask);
+
+	return 0;
+}
+
+void uart_out_set_policy(enum uart_out_policy policy)
+{
+	tx_policy = policy;
+}
+
+uint32_t uart_out_write(const uint8_t *data, uint32_t len)
+{
+	uint32_t queued = 0, waited = 0;
+	uint32_t primask, space, count;
+	bool block = tx_policy == UART_OUT_BLOCK && can_block();
+
+	if (!data) {
+		return 0;
+	}
+
+	while (queued < len) {
+		primask = irq_save();
+
+		space = UART_OUT_BUFFER_SIZE - (tx_head - tx_tail);
+		count = len - queued;
+		if (count > space) {
+			count = space;
+		}
+		if (count > UART_OUT_COPY_CHUNK) {
+			count = UART_OUT_COPY_CHUNK;
+		}
+
+		for (uint32_t i = 0; i < count; i++) {
+			tx_buffer[(tx_head + i) & UART_OUT_BUFFER_MASK] = data[queued + i];
+		}
+		tx_head += count;
+		tx_stats.written += count;
+		tx_start();
+
+		irq_restore(primask);
+		queued += count;
+
+		if (count == 0) {
+			/* Full: wait for the transfer in flight to free some space */
+			if (!block || waited >= UART_OUT_BLOCK_TIMEOUT_MS) {
+				break;
+			}
+			HAL_Delay(1);
+			waited++;
+		}
+	}
+
+	if (queued < len) {
+		primask = irq_save();
+		tx_stats.dropped += len - queued;
+		irq_restore(primask);
+	}
+
+	return queued;
+}
+
+uint32_t uart_out_pending(void)
+{
+	return tx_head - tx_tail;
+}
+
+int uart_out_flush(uint32_t timeout_ms)
+{
+	uint32_t waited = 0;
+
+	while (uart_out_pending() != 0) {
+		if (!can_block() || waited >= timeout_ms) {
+			return -1;
+		}
+		HAL_Delay(1);
+		waited++;
+	}
+
+	return 0;
+}
+
+void uart_out_get_stats(struct uart_out_stats *stats)
+{
+	uint32_t primask;
+
+	if (!stats) {
+		return;
+	}
+
+	primask = irq_save();
+	*stats = tx_stats;
+	irq_restore(primask);
+}
+
+void uart_out_tx_complete_handler(UART_HandleTypeDef *huart)
+{
+	uint32_t primask;
+
+	if (huart != uart_handle) {
+		return;
+	}
+
+	primask = irq_save();
+	tx_tail += tx_len;
+	tx_len = 0;
+	tx_start();
+	irq_restore(primask);
+}
+
+/**
+ * @brief HAL UART TX Complete Callback
+ *
+ * Raised from the USART interrupt once the last byte of a DMA transfer has
+ * left the shift register.
+ */
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+	uart_out_tx_complete_handler(huart);
+}
+
+void uart_out_error_handler(UART_HandleTypeDef *huart)
+{
+	uint32_t primask;
+
+	if (huart != uart_handle || !(huart->ErrorCode & HAL_UART_ERROR_DMA)) {
+		return;
+	}
+
+	/* A failed transfer leaves the transmitter idle: skip the chunk */
+	primask = irq_save();
+	if (tx_len != 0 && huart->gState == HAL_UART_STATE_READY) {
+		tx_stats.errors++;
+		tx_stats.dropped += tx_len;
+		tx_tail += tx_len;
+		tx_len = 0;
+		tx_start();
+	}
+	irq_restore(primask);
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "event.h"
+#include <string.h>
+
+static uint32_t event_mask;
+static uint32_t event_posted[EVENT_NUM];
+static uint32_t event_overruns[EVENT_NUM];
+
+int event_post(enum event_id id)
+{
+	uint32_t bit, prev;
+
+	if ((unsigned int)id >= EVENT_NUM) {
+		return -1;
+	}
+
+	bit = EVENT_BIT(id);
+	prev = __atomic_fetch_or(&event_mask, bit, __ATOMIC_RELEASE);
+	__atomic_fetch_add(&event_posted[id], 1U, __ATOMIC_RELAXED);
+
+	if (prev & bit) {
+		/* Not taken since the last post */
+		__atomic_fetch_add(&event_overruns[id], 1U, __ATOMIC_RELAXED);
+		return -1;
+	}
+
+	return 0;
+}
+
+bool event_take(enum event_id id)
+{
+	uint32_t bit;
+
+	if ((unsigned int)id >= EVENT_NUM) {
+		return false;
+	}
+
+	bit = EVENT_BIT(id);
+
+	/* Cheap check first: no atomic write while nothing is pending */
+	if (!(__atomic_load_n(&event_mask, __ATOMIC_RELAXED) & bit)) {
+		return false;
+	}
+
+	return (__atomic_fetch_and(&event_mask, ~bit, __ATOMIC_ACQUIRE) & bit) != 0;
+}
+
+uint32_t event_take_all(void)
+{
+	return __atomic_exchange_n(&event_mask, 0U, __ATOMIC_ACQUIRE);
+}
+
+uint32_t event_pending(void)
+{
+	return __atomic_load_n(&event_mask, __ATOMIC_RELAXED);
+}
+
+void event_get_stats(enum event_id id, struct event_stats *stats)
+{
+	if (!stats || (unsigned int)id >= EVENT_NUM) {
+		return;
+	}
+
+	stats->posted = __atomic_load_n(&event_posted[id], __ATOMIC_RELAXED);
+	stats->overruns = __atomic_load_n(&event_overruns[id], __ATOMIC_RELAXED);
+}
+
+void event_reset(void)
+{
+	event_mask = 0;
+	memset(event_posted, 0, sizeof(event_posted));
+	memset(event_overruns, 0, sizeof(event_overruns));
+}
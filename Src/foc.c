@@ -7,11 +7,16 @@
 #include "foc.h"
 #include "drv/pwm.h"
 #include "drv/adc_dma.h"
+#include "trig.h"
+#include "log.h"
+#include "prof.h"
 #include <stdio.h>
 #include <string.h>
 #include <math.h>
 
 #define M_PI_F 3.14159265358979323846f
+#define SQRT3_F 1.732050808f
+#define FOC_CURRENT_LOOP_DT (1.0f / FOC_CURRENT_LOOP_HZ)
 
 /* Motor instances */
 static struct foc_motor foc_motor0 = {
@@ -27,15 +32,26 @@ static struct foc_motor foc_motor0 = {
 	.current_rpm = 0.0f,
 	.electrical_angle = 0.0f,
 	.amplitude = 0.0f,
+	.encoder = {
+		.dev = NULL,
+	},
+	.speed_pi = {
+		.kp = 0.05f,              /* Voltage-mode gains: %/RPM */
+		.ki = 2.0f,               /* %/(RPM s) */
+	},
 	.current_cfg = {
 		.enabled = false,         /* Disabled by default */
 		.adc_channel_a = 0,
 		.adc_channel_b = 1,
 		.current_sensitivity = 1.2f,
-		.current_offset = 0.0f,   /* Unidirectional sensor, no offset */
+		.current_offset = {0.0f, 0.0f},  /* Unidirectional sensor, no offset */
 		.current_limit_a = 2.0f,  /* 2A default limit */
 	},
 	.current_data = {0},
+	.torque_cfg = {
+		.enabled = false,
+	},
+	.torque_data = {0},
 };
 
 static struct foc_motor foc_motor1 = {
@@ -51,17 +67,61 @@ static struct foc_motor foc_motor1 = {
 	.current_rpm = 0.0f,
 	.electrical_angle = 0.0f,
 	.amplitude = 0.0f,
+	.encoder = {
+		.dev = NULL,
+	},
+	.speed_pi = {
+		.kp = 0.05f,              /* Voltage-mode gains: %/RPM */
+		.ki = 2.0f,               /* %/(RPM s) */
+	},
 	.current_cfg = {
 		.enabled = false,         /* Disabled by default */
 		.adc_channel_a = 2,
 		.adc_channel_b = 3,
 		.current_sensitivity = 1.2f,  /* 1200mV/A */
-		.current_offset = 0.0f,   /* Unidirectional sensor, no offset */
+		.current_offset = {0.0f, 0.0f},  /* Unidirectional sensor, no offset */
 		.current_limit_a = 2.0f,  /* 2A default limit */
 	},
 	.current_data = {0},
+	.torque_cfg = {
+		.enabled = false,
+	},
+	.torque_data = {0},
 };
 
+/**
+ * @brief Motor number for log records (motorN)
+ */
+static inline uint32_t foc_motor_index(const struct foc_motor *motor)
+{
+	return motor == &foc_motor1 ? 1U : 0U;
+}
+
+/**
+ * @brief PI step with integrator clamping (anti-windup)
+ */
+static inline float foc_pi(float error, float kp, float ki, float dt, float *integral,
+                           float limit)
+{
+	float out;
+
+	*integral += ki * error * dt;
+	if (*integral > limit) {
+		*integral = limit;
+	} else if (*integral < -limit) {
+		*integral = -limit;
+	}
+
+	out = kp * error + *integral;
+	if (out > limit) {
+		out = limit;
+	} else if (out < -limit) {
+		out = -limit;
+	}
+
+	return out;
+}
+
 int foc_velocity_enable(struct foc_motor *motor, enum foc_velocity_mode mode,
                        float target_rpm, float amplitude, float update_rate_hz,
                        uint8_t pole_pairs)
@@ -86,15 +146,30 @@ int foc_velocity_enable(struct foc_motor *motor, enum foc_velocity_mode mode,
 		return -1;
 	}
 
+	if (mode == FOC_VELOCITY_CLOSED_LOOP && !motor->encoder.dev) {
+		printf("%s: Closed loop needs an encoder (foc_encoder_attach)\n", motor->name);
+		return -1;
+	}
+
+	/* No overcurrent protection until the offsets are known */
+	if (motor->offset_cal.active) {
+		printf("%s: Current offsets still being measured\n", motor->name);
+		return -1;
+	}
+
 	/* Configure velocity control */
 	motor->velocity_cfg.mode = mode;
 	motor->velocity_cfg.target_rpm = target_rpm;
 	motor->velocity_cfg.update_rate_hz = update_rate_hz;
 	motor->velocity_cfg.pole_pairs = pole_pairs;
-	motor->velocity_cfg.acceleration = 1000.0f;
 	motor->current_rpm = 0.0f;
 	motor->electrical_angle = 0.0f;
 	motor->amplitude = amplitude;
+	motor->encoder.valid = false;
+	motor->encoder.measured_rpm = 0.0f;
+	motor->encoder.electrical_dps = 0.0f;
+	motor->speed_pi.integral = 0.0f;
+	motor->speed_pi.output = 0.0f;
 
 	printf("%s: Velocity control enabled - mode=%d, target=%d RPM, rate=%d Hz, poles=%u\n",
 		motor->name, mode, (int)target_rpm, (int)update_rate_hz, pole_pairs);
@@ -109,9 +184,21 @@ int foc_velocity_disable(struct foc_motor *motor)
 		return -1;
 	}
 
+	/* Stop the speed loop from leaving a torque command behind */
+	if (motor->velocity_cfg.mode == FOC_VELOCITY_CLOSED_LOOP && motor->torque_cfg.enabled) {
+		motor->torque_data.iq_ref = 0.0f;
+	}
+
+	/* Zero voltage, unless the current loop keeps driving the outputs */
+	if (motor->velocity_cfg.mode != FOC_VELOCITY_DISABLED && !motor->torque_cfg.enabled) {
+		pwm_set_vector_ab(motor->pwm_dev, 0.0f, 0.0f);
+	}
+
 	motor->velocity_cfg.mode = FOC_VELOCITY_DISABLED;
 	motor->current_rpm = 0.0f;
 	motor->electrical_angle = 0.0f;
+	motor->encoder.measured_rpm = 0.0f;
+	motor->encoder.electrical_dps = 0.0f;
 
 	printf("%s: Velocity control disabled\n", motor->name);
 	return 0;
@@ -133,26 +220,190 @@ int foc_velocity_set_target(struct foc_motor *motor, float target_rpm)
 	return 0;
 }
 
+int foc_velocity_set_amplitude(struct foc_motor *motor, float amplitude)
+{
+	if (!motor || !motor->pwm_dev) {
+		printf("FOC: Motor not initialized\n");
+		return -1;
+	}
+
+	if (amplitude < 0.0f || amplitude > 100.0f) {
+		printf("%s: Invalid amplitude: %d%%\n", motor->name, (int)amplitude);
+		return -1;
+	}
+
+	motor->amplitude = amplitude;
+	return 0;
+}
+
 int foc_velocity_get_current(struct foc_motor *motor, float *rpm)
 {
 	if (!motor || !rpm) {
 		return -1;
 	}
 
-	*rpm = motor->current_rpm;
+	*rpm = motor->encoder.dev ? motor->encoder.measured_rpm : motor->current_rpm;
 	return 0;
 }
 
-void foc_velocity_update(struct foc_motor *motor)
+int foc_velocity_set_gains(struct foc_motor *motor, float kp, float ki)
+{
+	if (!motor) {
+		printf("FOC: Motor not initialized\n");
+		return -1;
+	}
+
+	if (kp < 0.0f || ki < 0.0f) {
+		printf("%s: Invalid speed loop gains\n", motor->name);
+		return -1;
+	}
+
+	motor->speed_pi.kp = kp;
+	motor->speed_pi.ki = ki;
+	motor->speed_pi.integral = 0.0f;
+	return 0;
+}
+
+/**
+ * @brief Wrap an angle in degrees to 0-360
+ */
+static inline float foc_wrap_deg(float angle)
+{
+	while (angle >= 360.0f) {
+		angle -= 360.0f;
+	}
+	while (angle < 0.0f) {
+		angle += 360.0f;
+	}
+	return angle;
+}
+
+/* Ticks of foc_encoder_start(), the time base of the encoder samples */
+static volatile uint32_t foc_encoder_tick;
+
+/**
+ * @brief Take the latest encoder sample: measured speed and rotor angle
+ *
+ * @return Rotor electrical angle in degrees, or negative without a usable sample
+ */
+static float foc_encoder_update(struct foc_motor *motor)
+{
+	struct foc_encoder *enc = &motor->encoder;
+	uint8_t pole_pairs = motor->velocity_cfg.pole_pairs;
+	mt6701_sample_t sample;
+	uint32_t age, ticks;
+	int32_t delta;
+	float rpm;
+
+	if (mt6701_get_sample(enc->dev, &sample) == 0) {
+		age = foc_encoder_tick - sample.timestamp;
+	} else {
+		age = UINT32_MAX;
+	}
+
+	/* No read completed yet, or the encoder stopped answering */
+	if (age > FOC_ENCODER_MAX_AGE) {
+		enc->errors++;
+		enc->valid = false;
+		return -1.0f;
+	}
+
+	if (sample.seq != enc->last_seq) {
+		ticks = sample.timestamp - enc->last_timestamp;
+
+		if (enc->valid && ticks > 0) {
+			/* Shortest signed step on the 14-bit circle */
+			delta = ((int32_t)sample.angle - (int32_t)enc->last_raw) &
+			        (MT6701_ANGLE_RESOLUTION - 1);
+			if (delta >= MT6701_ANGLE_RESOLUTION / 2) {
+				delta -= MT6701_ANGLE_RESOLUTION;
+			}
+
+			/* One count per tick is 60 / 16384 * rate RPM (3.7 RPM at 1 kHz) */
+			rpm = (float)delta * 60.0f * FOC_ENCODER_HZ /
+			      ((float)MT6701_ANGLE_RESOLUTION * (float)ticks);
+			enc->measured_rpm += FOC_SPEED_FILTER * (rpm - enc->measured_rpm);
+			enc->electrical_dps = enc->measured_rpm * (float)pole_pairs * 6.0f;
+		}
+		enc->last_raw = sample.angle;
+		enc->last_seq = sample.seq;
+		enc->last_timestamp = sample.timestamp;
+		enc->valid = true;
+	}
+
+	/* The sample was taken at its tick; move it on to now */
+	return foc_wrap_deg((float)sample.angle * (360.0f / (float)MT6701_ANGLE_RESOLUTION) *
+	                    (float)pole_pairs + enc->offset_deg +
+	                    enc->electrical_dps * (float)age / FOC_ENCODER_HZ);
+}
+
+void foc_encoder_start(void)
+{
+	uint32_t tick = ++foc_encoder_tick;
+
+	if (foc_motor0.encoder.dev) {
+		mt6701_start_read(foc_motor0.encoder.dev, tick);
+	}
+	if (foc_motor1.encoder.dev) {
+		mt6701_start_read(foc_motor1.encoder.dev, tick);
+	}
+}
+
+/**
+ * @brief Closed-loop speed PI on the encoder measurement
+ */
+static void foc_velocity_closed_loop(struct foc_motor *motor, float angle)
+{
+	struct foc_speed_pi *pi = &motor->speed_pi;
+	float dt = 1.0f / motor->velocity_cfg.update_rate_hz;
+	float error, limit;
+
+	error = motor->current_rpm - motor->encoder.measured_rpm;
+
+	if (motor->torque_cfg.enabled) {
+		/* q-axis current, field on the rotor d-axis */
+		limit = motor->current_cfg.current_limit_a;
+		pi->output = foc_pi(error, pi->kp, pi->ki, dt, &pi->integral, limit);
+		motor->electrical_angle = angle;
+		motor->torque_data.iq_ref = pi->output;
+		return;
+	}
+
+	/* q-axis voltage: the vector leads (or trails) the rotor by 90 degrees */
+	limit = motor->amplitude;
+	pi->output = foc_pi(error, pi->kp, pi->ki, dt, &pi->integral, limit);
+	motor->electrical_angle = angle;
+
+	if (pi->output >= 0.0f) {
+		pwm_set_vector_svpwm(motor->pwm_dev, foc_wrap_deg(angle + 90.0f), pi->output);
+	} else {
+		pwm_set_vector_svpwm(motor->pwm_dev, foc_wrap_deg(angle - 90.0f), -pi->output);
+	}
+}
+
+static void foc_velocity_step(struct foc_motor *motor)
 {
 	struct foc_velocity_config *cfg = &motor->velocity_cfg;
 	float rpm_step, mechanical_rpm, electrical_rpm;
 	float angle_step_deg;
+	float rotor_angle = -1.0f;
 
-	if (!motor || !motor->pwm_dev || cfg->mode == FOC_VELOCITY_DISABLED) {
+	if (!motor || !motor->pwm_dev) {
+		return;
+	}
+
+	if (cfg->mode == FOC_VELOCITY_DISABLED) {
+		/* Keep measuring: offset tracking waits for the rotor to stand */
+		if (motor->encoder.dev) {
+			foc_encoder_update(motor);
+		}
 		return;
 	}
 
+	if (motor->encoder.dev) {
+		rotor_angle = foc_encoder_update(motor);
+	}
+
 	/* Calculate RPM acceleration step per update */
 	rpm_step = cfg->acceleration / cfg->update_rate_hz;
 
@@ -169,6 +420,14 @@ void foc_velocity_update(struct foc_motor *motor)
 		}
 	}
 
+	if (cfg->mode == FOC_VELOCITY_CLOSED_LOOP) {
+		/* Hold the last command if the encoder could not be read */
+		if (rotor_angle >= 0.0f) {
+			foc_velocity_closed_loop(motor, rotor_angle);
+		}
+		return;
+	}
+
 	/* Convert mechanical RPM to electrical RPM
 	 * Electrical RPM = Mechanical RPM × pole_pairs
 	 */
@@ -181,15 +440,12 @@ void foc_velocity_update(struct foc_motor *motor)
 	 */
 	angle_step_deg = (electrical_rpm * 360.0f) / (60.0f * cfg->update_rate_hz);
 
-	/* Update electrical angle */
-	motor->electrical_angle += angle_step_deg;
+	/* Update electrical angle, normalized to 0-360 degrees */
+	motor->electrical_angle = foc_wrap_deg(motor->electrical_angle + angle_step_deg);
 
-	/* Normalize angle to 0-360 degrees */
-	while (motor->electrical_angle >= 360.0f) {
-		motor->electrical_angle -= 360.0f;
-	}
-	while (motor->electrical_angle < 0.0f) {
-		motor->electrical_angle += 360.0f;
+	/* In torque mode the current loop drives the outputs at this angle */
+	if (motor->torque_cfg.enabled) {
+		return;
 	}
 
 	/* Update PWM vector with current angle and amplitude using SVPWM
@@ -199,6 +455,73 @@ void foc_velocity_update(struct foc_motor *motor)
 	pwm_set_vector_svpwm(motor->pwm_dev, motor->electrical_angle, motor->amplitude);
 }
 
+void foc_velocity_update(struct foc_motor *motor)
+{
+	PROF_START(PROF_VELOCITY_UPDATE);
+	foc_velocity_step(motor);
+	PROF_STOP(PROF_VELOCITY_UPDATE);
+}
+
+int foc_encoder_attach(struct foc_motor *motor, mt6701_t *encoder, float offset_deg)
+{
+	if (!motor) {
+		printf("FOC: Motor not initialized\n");
+		return -1;
+	}
+
+	if (motor->velocity_cfg.mode == FOC_VELOCITY_CLOSED_LOOP) {
+		printf("%s: Cannot change encoder in closed loop\n", motor->name);
+		return -1;
+	}
+
+	motor->encoder.dev = encoder;
+	motor->encoder.offset_deg = foc_wrap_deg(offset_deg);
+	motor->encoder.valid = false;
+	motor->encoder.measured_rpm = 0.0f;
+	motor->encoder.electrical_dps = 0.0f;
+	motor->encoder.errors = 0;
+	return 0;
+}
+
+int foc_encoder_align(struct foc_motor *motor, float amplitude)
+{
+	uint16_t raw;
+	float mech_deg;
+
+	if (!motor || !motor->pwm_dev || !motor->encoder.dev) {
+		printf("FOC: Motor or encoder not initialized\n");
+		return -1;
+	}
+
+	if (motor->velocity_cfg.mode != FOC_VELOCITY_DISABLED || motor->torque_cfg.enabled) {
+		printf("%s: Disable velocity and torque control before alignment\n", motor->name);
+		return -1;
+	}
+
+	/* Lock the rotor d-axis onto electrical 0 degrees */
+	pwm_set_vector_svpwm(motor->pwm_dev, 0.0f, amplitude);
+	HAL_Delay(FOC_ALIGN_MS);
+
+	/* The bus may be busy with a read started by foc_encoder_start() */
+	for (int tries = 0; mt6701_read_angle_raw(motor->encoder.dev, &raw) != 0; tries++) {
+		if (tries == 3) {
+			pwm_set_vector_svpwm(motor->pwm_dev, 0.0f, 0.0f);
+			printf("%s: Encoder read failed during alignment\n", motor->name);
+			return -1;
+		}
+		HAL_Delay(1);
+	}
+	pwm_set_vector_svpwm(motor->pwm_dev, 0.0f, 0.0f);
+
+	mech_deg = (float)raw * (360.0f / (float)MT6701_ANGLE_RESOLUTION);
+	motor->encoder.offset_deg = foc_wrap_deg(fmodf(-mech_deg * (float)motor->velocity_cfg.pole_pairs,
+	                                               360.0f));
+
+	printf("%s: Encoder aligned, raw=%u offset=%d deg\n",
+	       motor->name, raw, (int)motor->encoder.offset_deg);
+	return 0;
+}
+
 struct foc_motor *foc_get_motor(const char *name)
 {
 	if (strcmp(name, "motor0") == 0) {
@@ -220,11 +543,20 @@ struct foc_motor *foc_get_motor(const char *name)
 }
 
 void foc_task(void)
+{
+	foc_velocity_task();
+	foc_protection_task();
+}
+
+void foc_velocity_task(void)
 {
 	/* Update velocity control for all motors */
 	foc_velocity_update(&foc_motor0);
 	foc_velocity_update(&foc_motor1);
+}
 
+void foc_protection_task(void)
+{
 	/* Update current sensing for all motors */
 	foc_current_update(&foc_motor0);
 	foc_current_update(&foc_motor1);
@@ -246,8 +578,10 @@ int foc_current_config(struct foc_motor *motor, uint8_t adc_ch_a, uint8_t adc_ch
 	motor->current_cfg.adc_channel_a = adc_ch_a;
 	motor->current_cfg.adc_channel_b = adc_ch_b;
 	motor->current_cfg.current_sensitivity = sensitivity;
-	motor->current_cfg.current_offset = offset;
+	motor->current_cfg.current_offset[0] = offset;
+	motor->current_cfg.current_offset[1] = offset;
 	motor->current_cfg.current_limit_a = limit_a;
+	foc_current_update_scale(&motor->current_cfg);
 
 	printf("%s: Current sensing configured - ch_a=%u, ch_b=%u, sens=%d mV/A, limit=%d A\n",
 		motor->name, adc_ch_a, adc_ch_b, (int)(sensitivity * 1000), (int)limit_a);
@@ -255,100 +589,195 @@ int foc_current_config(struct foc_motor *motor, uint8_t adc_ch_a, uint8_t adc_ch
 	return 0;
 }
 
-int foc_current_enable(struct foc_motor *motor)
+void foc_current_update_scale(struct foc_current_config *cfg)
 {
-	uint16_t adc_raw_a, adc_raw_b;
-	float voltage_a, voltage_b;
+	/* amps = (raw * VREF / 4096 - offset) / sensitivity */
+	float scale = ((float)ADC_VREF_MV / 4096000.0f) / cfg->current_sensitivity;
 
-	if (!motor) {
-		printf("FOC: Motor not initialized\n");
-		return -1;
+	for (int i = 0; i < 2; i++) {
+		cfg->scale[i] = scale;
+		cfg->bias[i] = -cfg->current_offset[i] / cfg->current_sensitivity;
 	}
+}
 
-	/* Calibrate offset by reading ADC when motor is stopped */
-	/* Wait a bit for ADC to stabilize */
-	HAL_Delay(50);
+/**
+ * @brief Motor at rest with no voltage across the windings
+ *
+ * A rotor still coasting would drive current through the zero vector;
+ * the encoder, if attached and answering, rules that out.
+ */
+static bool foc_current_idle(const struct foc_motor *motor)
+{
+	const struct foc_encoder *enc = &motor->encoder;
 
-	if (adc_dma_get_channel(motor->current_cfg.adc_channel_a, &adc_raw_a) == 0 &&
-	    adc_dma_get_channel(motor->current_cfg.adc_channel_b, &adc_raw_b) == 0) {
+	return motor->pwm_dev && motor->velocity_cfg.mode == FOC_VELOCITY_DISABLED &&
+	       !motor->torque_cfg.enabled && pwm_is_zero_vector(motor->pwm_dev) &&
+	       (!enc->dev || !enc->valid || fabsf(enc->measured_rpm) < FOC_OFFSET_IDLE_RPM);
+}
 
-		voltage_a = (float)adc_dma_raw_to_mv(adc_raw_a) / 1000.0f;
-		voltage_b = (float)adc_dma_raw_to_mv(adc_raw_b) / 1000.0f;
+/**
+ * @brief Offset samples wanted from foc_current_task()
+ */
+static inline bool foc_offset_sampling(const struct foc_motor *motor)
+{
+	return motor->offset_cal.active ||
+	       (motor->current_cfg.offset_tracking && motor->current_cfg.enabled);
+}
 
-		/* Use average of both channels as offset */
-		motor->current_cfg.current_offset = (voltage_a + voltage_b) / 2.0f;
+static void foc_offset_restart(struct foc_offset_cal *cal)
+{
+	cal->sum[0] = 0;
+	cal->sum[1] = 0;
+	cal->samples = 0;
+	cal->settle = 0;
+}
 
-		printf("%s: Current sensing enabled, calibrated offset=%dmV (A=%dmV B=%dmV)\n",
-		       motor->name, (int)(motor->current_cfg.current_offset * 1000),
-		       (int)(voltage_a * 1000), (int)(voltage_b * 1000));
-	} else {
-		printf("%s: Current sensing enabled (calibration failed, using default offset)\n",
-		       motor->name);
+/**
+ * @brief Average the phase samples into the offsets, from foc_current_task()
+ *
+ * The calibration takes the first average as is; drift tracking moves the
+ * offsets part of the way to each later one. An average only counts if
+ * the motor stayed idle for all of it, and the settling time before it.
+ */
+static void foc_offset_update(struct foc_motor *motor, const uint16_t *values)
+{
+	struct foc_current_config *cfg = &motor->current_cfg;
+	struct foc_offset_cal *cal = &motor->offset_cal;
+	float mean;
+
+	if (!foc_current_idle(motor)) {
+		foc_offset_restart(cal);
+		return;
 	}
 
-	motor->current_cfg.enabled = true;
-	motor->current_data.overcurrent = false;
+	if (cal->settle < FOC_OFFSET_SETTLE) {
+		cal->settle++;
+		return;
+	}
 
-	return 0;
+	cal->sum[0] += values[cfg->adc_channel_a];
+	cal->sum[1] += values[cfg->adc_channel_b];
+	if (++cal->samples < FOC_OFFSET_SAMPLES) {
+		return;
+	}
+
+	for (int i = 0; i < 2; i++) {
+		mean = (float)cal->sum[i] * ((float)ADC_VREF_MV / 4096000.0f / FOC_OFFSET_SAMPLES);
+		if (cal->active) {
+			cfg->current_offset[i] = mean;
+		} else {
+			cfg->current_offset[i] += (mean - cfg->current_offset[i]) * FOC_OFFSET_TRACK_GAIN;
+		}
+	}
+	foc_offset_restart(cal);
+	cal->settle = FOC_OFFSET_SETTLE;
+	cal->averages++;
+	foc_current_update_scale(cfg);
+
+	if (cal->active) {
+		cal->active = false;
+		motor->current_data.overcurrent = false;
+		cfg->enabled = true;
+		LOG(LOG_FOC_OFFSET_CAL, foc_motor_index(motor),
+		    (int)(cfg->current_offset[0] * 1000.0f), (int)(cfg->current_offset[1] * 1000.0f));
+	}
 }
 
-int foc_current_disable(struct foc_motor *motor)
+int foc_current_enable(struct foc_motor *motor)
 {
 	if (!motor) {
 		printf("FOC: Motor not initialized\n");
 		return -1;
 	}
 
+	/* Restored from the configuration store, no need to measure */
+	if (motor->current_cfg.offset_loaded) {
+		printf("%s: Current sensing enabled, stored offsets A=%dmV B=%dmV\n", motor->name,
+		       (int)(motor->current_cfg.current_offset[0] * 1000),
+		       (int)(motor->current_cfg.current_offset[1] * 1000));
+		foc_current_update_scale(&motor->current_cfg);
+		motor->current_cfg.enabled = true;
+		motor->current_data.overcurrent = false;
+		return 0;
+	}
+
+	if (!motor->pwm_dev || motor->velocity_cfg.mode != FOC_VELOCITY_DISABLED ||
+	    motor->torque_cfg.enabled) {
+		printf("%s: Stop the motor to calibrate the current offsets\n", motor->name);
+		return -1;
+	}
+
+	/* Zero vector: the amplifiers see the switching, but no current flows */
+	motor->offset_cal.active = false;
 	motor->current_cfg.enabled = false;
-	printf("%s: Current sensing disabled\n", motor->name);
+	pwm_set_duty(motor->pwm_dev, 50.0f, 50.0f, 50.0f);
+
+	/* foc_current_task() takes it from here */
+	foc_offset_restart(&motor->offset_cal);
+	motor->offset_cal.active = true;
+
+	printf("%s: Calibrating current offsets over %u samples\n", motor->name,
+	       FOC_OFFSET_SAMPLES);
 	return 0;
 }
 
-void foc_current_update(struct foc_motor *motor)
+bool foc_current_calibrating(const struct foc_motor *motor)
 {
-	struct foc_current_config *cfg;
-	struct foc_current_data *data;
-	uint16_t adc_raw_a, adc_raw_b;
-	float voltage_a, voltage_b;
+	return motor && motor->offset_cal.active;
+}
 
-	if (!motor || !motor->current_cfg.enabled) {
-		return;
+int foc_current_track_offset(struct foc_motor *motor, bool enable)
+{
+	if (!motor) {
+		printf("FOC: Motor not initialized\n");
+		return -1;
 	}
 
-	cfg = &motor->current_cfg;
-	data = &motor->current_data;
+	/* Stop the task from adding to the sums while they are cleared */
+	motor->current_cfg.offset_tracking = false;
+	foc_offset_restart(&motor->offset_cal);
+	motor->current_cfg.offset_tracking = enable;
+	return 0;
+}
 
-	/* Read ADC values for phase A and B */
-	if (adc_dma_get_channel(cfg->adc_channel_a, &adc_raw_a) != 0) {
-		return;
-	}
-	if (adc_dma_get_channel(cfg->adc_channel_b, &adc_raw_b) != 0) {
-		return;
+int foc_current_disable(struct foc_motor *motor)
+{
+	if (!motor) {
+		printf("FOC: Motor not initialized\n");
+		return -1;
 	}
 
-	/* Convert ADC to voltage */
-	voltage_a = (float)adc_dma_raw_to_mv(adc_raw_a) / 1000.0f;  /* Convert mV to V */
-	voltage_b = (float)adc_dma_raw_to_mv(adc_raw_b) / 1000.0f;
+	motor->offset_cal.active = false;
+	motor->current_cfg.enabled = false;
+	printf("%s: Current sensing disabled\n", motor->name);
+	return 0;
+}
 
-	/* Debug: Print raw ADC values once per second */
-	static uint32_t last_debug = 0;
-	uint32_t now = HAL_GetTick();
-	if (now - last_debug > 1000) {
-		printf("%s: ADC raw: A=%u B=%u, Voltage: A=%dmV B=%dmV, Offset=%dmV\n",
-		       motor->name, adc_raw_a, adc_raw_b,
-		       (int)(voltage_a * 1000), (int)(voltage_b * 1000),
-		       (int)(cfg->current_offset * 1000));
-		last_debug = now;
-	}
+/**
+ * @brief Phase currents and overcurrent flag from one sample set
+ *
+ * Runs from foc_current_task() for every sample set, so current_data
+ * follows the ADC rate; foc_current_update() acts on the flag.
+ */
+static void foc_current_measure(struct foc_motor *motor, const uint16_t *values)
+{
+	const struct foc_current_config *cfg = &motor->current_cfg;
+	struct foc_current_data *data = &motor->current_data;
+	uint16_t raw[2];
+	float amps[2];
+
+	raw[0] = values[cfg->adc_channel_a];
+	raw[1] = values[cfg->adc_channel_b];
 
-	/* Convert voltage to current
-	 * Current = (Voltage - Offset) / Sensitivity
+	/* Convert ADC counts to current
+	 * Current = (Voltage - Offset) / Sensitivity, folded into scale and bias
 	 * Hardware: INA181A1 (gain=20) + 0.01Ω shunt resistor
 	 * Sensitivity = 20 × 0.01Ω = 0.2 V/A (200mV/A)
-	 * Offset is auto-calibrated at enable time (~1.6V typical)
+	 * Offsets are calibrated per phase at enable time (~1.6V typical)
 	 */
-	data->phase_a_current = (voltage_a - cfg->current_offset) / cfg->current_sensitivity;
-	data->phase_b_current = (voltage_b - cfg->current_offset) / cfg->current_sensitivity;
+	foc_current_convert(raw, cfg->scale, cfg->bias, amps, 2);
+	data->phase_a_current = amps[0];
+	data->phase_b_current = amps[1];
 
 	/* Calculate phase C current using Kirchhoff's law
 	 * Ia + Ib + Ic = 0, therefore Ic = -(Ia + Ib)
@@ -362,24 +791,60 @@ void foc_current_update(struct foc_motor *motor)
 	                         data->phase_b_current * data->phase_b_current +
 	                         data->phase_c_current * data->phase_c_current) / 3.0f);
 
-	/* Check overcurrent condition - only apply protection during active control */
-	if (fabsf(data->magnitude) > cfg->current_limit_a) {
-		data->overcurrent = true;
+	data->overcurrent = fabsf(data->magnitude) > cfg->current_limit_a;
+}
 
-		/* Only reduce amplitude if motor is actively running (velocity control active) */
-		if (motor->velocity_cfg.mode != FOC_VELOCITY_DISABLED && motor->amplitude > 0.0f) {
+static void foc_current_step(struct foc_motor *motor)
+{
+	struct foc_current_data *data;
+	uint16_t values[ADC_DMA_NUM_CHANNELS];
+
+	if (!motor || !motor->current_cfg.enabled) {
+		return;
+	}
+
+	data = &motor->current_data;
+
+	/* Debug: log raw ADC values once per second */
+	static uint32_t last_debug = 0;
+	uint32_t now = HAL_GetTick();
+	if (now - last_debug > 1000 &&
+	    adc_dma_get_all_channels(values, ADC_DMA_NUM_CHANNELS) == 0) {
+		uint16_t raw_a = values[motor->current_cfg.adc_channel_a];
+		uint16_t raw_b = values[motor->current_cfg.adc_channel_b];
+
+		LOG(LOG_FOC_ADC_RAW, foc_motor_index(motor), raw_a, raw_b,
+		    (int)adc_dma_raw_to_mv(raw_a), (int)adc_dma_raw_to_mv(raw_b));
+		last_debug = now;
+	}
+
+	/* Overcurrent on the latest sample set - only apply protection during active control */
+	if (data->overcurrent) {
+		if (motor->torque_cfg.enabled) {
+			/* Current loop active: back off the references instead */
+			motor->torque_data.id_ref *= 0.9f;
+			motor->torque_data.iq_ref *= 0.9f;
+			LOG(LOG_FOC_OC_CURRENT, foc_motor_index(motor),
+			    (int)(data->magnitude * 1000.0f));
+		} else if (motor->velocity_cfg.mode != FOC_VELOCITY_DISABLED && motor->amplitude > 0.0f) {
+			/* Only reduce amplitude if motor is actively running (velocity control active) */
 			motor->amplitude *= 0.9f;  /* Reduce by 10% */
 			if (motor->amplitude < 1.0f) {
 				motor->amplitude = 0.0f;
 			}
-			printf("%s: Overcurrent detected (%d mA), reducing amplitude to %d%%\n",
-			       motor->name, (int)(data->magnitude * 1000.0f), (int)motor->amplitude);
+			LOG(LOG_FOC_OC_AMPLITUDE, foc_motor_index(motor),
+			    (int)(data->magnitude * 1000.0f), (int)motor->amplitude);
 		}
-	} else {
-		data->overcurrent = false;
 	}
 }
 
+void foc_current_update(struct foc_motor *motor)
+{
+	PROF_START(PROF_CURRENT_UPDATE);
+	foc_current_step(motor);
+	PROF_STOP(PROF_CURRENT_UPDATE);
+}
+
 int foc_current_get(struct foc_motor *motor, float *current_a)
 {
 	if (!motor) {
@@ -419,3 +884,186 @@ int foc_current_set_limit(struct foc_motor *motor, float limit_a)
 
 	return 0;
 }
+
+void foc_current_task(void)
+{
+	struct adc_dma_snapshot snap;
+	bool offset0 = foc_offset_sampling(&foc_motor0);
+	bool offset1 = foc_offset_sampling(&foc_motor1);
+
+	if (!foc_motor0.current_cfg.enabled && !foc_motor1.current_cfg.enabled &&
+	    !foc_motor0.torque_cfg.enabled && !foc_motor1.torque_cfg.enabled &&
+	    !offset0 && !offset1) {
+		return;
+	}
+
+	/* Runs right after the sample completes: use the slot in place */
+	if (adc_dma_get_snapshot(&snap) != 0) {
+		return;
+	}
+
+	if (offset0) {
+		foc_offset_update(&foc_motor0, snap.values);
+	}
+	if (offset1) {
+		foc_offset_update(&foc_motor1, snap.values);
+	}
+
+	if (foc_motor0.current_cfg.enabled) {
+		foc_current_measure(&foc_motor0, snap.values);
+	}
+	if (foc_motor1.current_cfg.enabled) {
+		foc_current_measure(&foc_motor1, snap.values);
+	}
+
+	if (foc_motor0.torque_cfg.enabled) {
+		foc_torque_update(&foc_motor0, snap.values);
+	}
+	if (foc_motor1.torque_cfg.enabled) {
+		foc_torque_update(&foc_motor1, snap.values);
+	}
+}
+
+int foc_torque_enable(struct foc_motor *motor, float kp, float ki, float vbus)
+{
+	if (!motor || !motor->pwm_dev) {
+		printf("FOC: Motor not initialized\n");
+		return -1;
+	}
+
+	if (motor->offset_cal.active) {
+		printf("%s: Current offsets still being measured\n", motor->name);
+		return -1;
+	}
+
+	if (!motor->current_cfg.enabled) {
+		printf("%s: Current sensing not enabled\n", motor->name);
+		return -1;
+	}
+
+	if (kp < 0.0f || ki < 0.0f || vbus <= 0.0f) {
+		printf("%s: Invalid torque loop parameters\n", motor->name);
+		return -1;
+	}
+
+	motor->torque_cfg.enabled = false;
+	motor->torque_cfg.kp = kp;
+	motor->torque_cfg.ki = ki;
+	motor->torque_cfg.vbus = vbus;
+	memset(&motor->torque_data, 0, sizeof(motor->torque_data));
+
+	/* foc_current_task() picks the motor up from the next ADC sequence */
+	motor->torque_cfg.enabled = true;
+
+	printf("%s: Torque mode enabled - kp=%d mV/A, ki=%d V/As, vbus=%d mV\n",
+	       motor->name, (int)(kp * 1000.0f), (int)ki, (int)(vbus * 1000.0f));
+	return 0;
+}
+
+int foc_torque_disable(struct foc_motor *motor)
+{
+	if (!motor || !motor->pwm_dev) {
+		printf("FOC: Motor not initialized\n");
+		return -1;
+	}
+
+	motor->torque_cfg.enabled = false;
+	motor->torque_data.id_ref = 0.0f;
+	motor->torque_data.iq_ref = 0.0f;
+
+	/* Zero voltage until velocity mode (if any) takes over again */
+	pwm_set_vector_ab(motor->pwm_dev, 0.0f, 0.0f);
+
+	printf("%s: Torque mode disabled\n", motor->name);
+	return 0;
+}
+
+int foc_torque_set_target(struct foc_motor *motor, float id_ref, float iq_ref)
+{
+	if (!motor) {
+		return -1;
+	}
+
+	if (!motor->torque_cfg.enabled) {
+		printf("%s: Torque mode not enabled\n", motor->name);
+		return -1;
+	}
+
+	motor->torque_data.id_ref = id_ref;
+	motor->torque_data.iq_ref = iq_ref;
+	return 0;
+}
+
+int foc_torque_set_gains(struct foc_motor *motor, float kp, float ki)
+{
+	if (!motor) {
+		printf("FOC: Motor not initialized\n");
+		return -1;
+	}
+
+	if (kp < 0.0f || ki < 0.0f) {
+		printf("%s: Invalid torque loop gains\n", motor->name);
+		return -1;
+	}
+
+	motor->torque_cfg.kp = kp;
+	motor->torque_cfg.ki = ki;
+	return 0;
+}
+
+void foc_torque_update(struct foc_motor *motor, const uint16_t *values)
+{
+	const struct foc_current_config *ccfg = &motor->current_cfg;
+	const struct foc_torque_config *cfg = &motor->torque_cfg;
+	struct foc_torque_data *data = &motor->torque_data;
+	uint16_t raw[2];
+	float amps[2], ia, ib, i_alpha, i_beta, sin_th, cos_th;
+	float v_limit, vq_limit, v_alpha, v_beta, inv_vbus;
+
+	PROF_START(PROF_TORQUE_UPDATE);
+
+	/* Phase currents from this sample set */
+	raw[0] = values[ccfg->adc_channel_a];
+	raw[1] = values[ccfg->adc_channel_b];
+	foc_current_convert(raw, ccfg->scale, ccfg->bias, amps, 2);
+	ia = amps[0];
+	ib = amps[1];
+
+	/* Clarke (ia + ib + ic = 0) */
+	i_alpha = ia;
+	i_beta = (ia + 2.0f * ib) / SQRT3_F;
+
+	/* Closed loop: advance the 1 kHz encoder angle at the measured speed */
+	if (motor->velocity_cfg.mode == FOC_VELOCITY_CLOSED_LOOP) {
+		motor->electrical_angle = foc_wrap_deg(motor->electrical_angle +
+		                                       motor->encoder.electrical_dps * FOC_CURRENT_LOOP_DT);
+	}
+
+	/* Park to the rotor (or open-loop field) frame */
+	trig_sincos(trig_deg_to_angle(motor->electrical_angle), &sin_th, &cos_th);
+	data->id = i_alpha * cos_th + i_beta * sin_th;
+	data->iq = -i_alpha * sin_th + i_beta * cos_th;
+
+	/*
+	 * PI on each axis, the vector limited to the linear SVPWM circle. The
+	 * d axis goes first and q gets what is left, so |v| never reaches
+	 * pwm_set_vector_ab()'s own limit and both integrators are clamped to
+	 * the voltage actually applied.
+	 */
+	v_limit = cfg->vbus / SQRT3_F;
+	data->vd = foc_pi(data->id_ref - data->id, cfg->kp, cfg->ki, FOC_CURRENT_LOOP_DT,
+	                  &data->id_integral, v_limit);
+	vq_limit = sqrtf(fmaxf(v_limit * v_limit - data->vd * data->vd, 0.0f));
+	data->vq = foc_pi(data->iq_ref - data->iq, cfg->kp, cfg->ki, FOC_CURRENT_LOOP_DT,
+	                  &data->iq_integral, vq_limit);
+
+	/* Inverse Park, normalised to the bus */
+	inv_vbus = 1.0f / cfg->vbus;
+	v_alpha = (data->vd * cos_th - data->vq * sin_th) * inv_vbus;
+	v_beta = (data->vd * sin_th + data->vq * cos_th) * inv_vbus;
+
+	pwm_set_vector_ab(motor->pwm_dev, v_alpha, v_beta);
+	data->updates++;
+
+	PROF_STOP(PROF_TORQUE_UPDATE);
+}
@@ -8,7 +8,6 @@ extern I2C_HandleTypeDef hi2c1;
 extern I2C_HandleTypeDef hi2c2;
 extern TIM_HandleTypeDef htim2;
 extern TIM_HandleTypeDef htim3;
-extern TIM_HandleTypeDef htim4;
 extern UART_HandleTypeDef huart2;
 
 void SystemClock_Config(void)
@@ -73,6 +72,14 @@ void MX_DMA_Init(void)
 
     HAL_NVIC_SetPriority(DMA1_Channel1_IRQn, 0, 0);
     HAL_NVIC_EnableIRQ(DMA1_Channel1_IRQn);
+
+    /* USART2 RX: same priority as the USART2 interrupt, both publish input */
+    HAL_NVIC_SetPriority(DMA1_Channel3_IRQn, 6, 0);
+    HAL_NVIC_EnableIRQ(DMA1_Channel3_IRQn);
+
+    /* USART2 TX: lowest priority, console output is never urgent */
+    HAL_NVIC_SetPriority(DMA1_Channel2_IRQn, 15, 0);
+    HAL_NVIC_EnableIRQ(DMA1_Channel2_IRQn);
 }
 
 void MX_ADC2_Init(void)
@@ -265,19 +272,6 @@ void MX_TIM3_Init(void)
     HAL_TIM_MspPostInit(&htim3);
 }
 
-void MX_TIM4_Init(void)
-{
-    htim4.Instance = TIM4;
-    htim4.Init.Prescaler = 169;  /* 170 MHz / 170 = 1 MHz */
-    htim4.Init.CounterMode = TIM_COUNTERMODE_UP;
-    htim4.Init.Period = 999;     /* 1 MHz / 1000 = 1 kHz (1ms period) */
-    htim4.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
-    htim4.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_ENABLE;
-    if (HAL_TIM_Base_Init(&htim4) != HAL_OK) {
-        Error_Handler();
-    }
-}
-
 void MX_UCPD1_Init(void)
 {
     LL_GPIO_InitTypeDef GPIO_InitStruct = {0};
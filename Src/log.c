@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "log.h"
+#include "main.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#define LOG_RING_MASK (LOG_RING_SIZE - 1U)
+
+#if (LOG_RING_SIZE & LOG_RING_MASK) != 0
+#error "LOG_RING_SIZE must be a power of two"
+#endif
+
+/**
+ * @brief Ring slot
+ *
+ * Bounded multi-producer queue: a slot may be written at position pos when
+ * its sequence equals pos and read once it equals pos + 1. Sequences are
+ * stored relative to the slot index so the zeroed ring needs no init.
+ */
+struct log_slot {
+	uint32_t seq;
+	struct log_record rec;
+};
+
+#define LOG_FORMAT(id, fmt) [id] = fmt,
+static const char *const log_formats[LOG_NUM_IDS] = {
+	LOG_MESSAGES(LOG_FORMAT)
+};
+#undef LOG_FORMAT
+
+static struct log_slot log_ring[LOG_RING_SIZE];
+static uint32_t log_head;            /* Next position to claim (writers) */
+static uint32_t log_tail;            /* Next position to read (drain only) */
+static uint32_t log_written;
+static uint32_t log_dropped;
+static uint32_t log_dropped_reported;
+
+int log_write(enum log_id id, const uint32_t *args, size_t nargs)
+{
+	struct log_slot *slot;
+	uint32_t pos, index;
+	int32_t diff;
+
+	pos = __atomic_load_n(&log_head, __ATOMIC_RELAXED);
+	for (;;) {
+		index = pos & LOG_RING_MASK;
+		slot = &log_ring[index];
+		diff = (int32_t)(__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) + index - pos);
+
+		if (diff == 0) {
+			/* Free for this position: claim it (pos is reloaded on failure) */
+			if (__atomic_compare_exchange_n(&log_head, &pos, pos + 1U, true,
+			                                __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+				break;
+			}
+		} else if (diff < 0) {
+			/* Not yet drained since the last lap: full */
+			__atomic_fetch_add(&log_dropped, 1U, __ATOMIC_RELAXED);
+			return -1;
+		} else {
+			/* Another writer claimed it first */
+			pos = __atomic_load_n(&log_head, __ATOMIC_RELAXED);
+		}
+	}
+
+	if (nargs > LOG_MAX_ARGS) {
+		nargs = LOG_MAX_ARGS;
+	}
+
+	slot->rec.id = (uint16_t)id;
+	slot->rec.nargs = (uint8_t)nargs;
+	slot->rec.timestamp = HAL_GetTick();
+	for (size_t i = 0; i < nargs; i++) {
+		slot->rec.args[i] = args[i];
+	}
+
+	/* Publish to the reader */
+	__atomic_store_n(&slot->seq, pos + 1U - index, __ATOMIC_RELEASE);
+	__atomic_fetch_add(&log_written, 1U, __ATOMIC_RELAXED);
+
+	return 0;
+}
+
+int log_read(struct log_record *rec)
+{
+	uint32_t index = log_tail & LOG_RING_MASK;
+	struct log_slot *slot = &log_ring[index];
+
+	if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) + index != log_tail + 1U) {
+		return -1;
+	}
+
+	*rec = slot->rec;
+
+	/* Hand the slot back to the writers for the next lap */
+	__atomic_store_n(&slot->seq, log_tail + LOG_RING_SIZE - index, __ATOMIC_RELEASE);
+	log_tail++;
+
+	return 0;
+}
+
+int log_format(const struct log_record *rec, char *buf, size_t size)
+{
+	unsigned int a[LOG_MAX_ARGS] = {0};
+	int len;
+
+	len = snprintf(buf, size, "[%u.%03u] ", (unsigned int)(rec->timestamp / 1000U),
+	               (unsigned int)(rec->timestamp % 1000U));
+	if (len < 0 || (size_t)len >= size) {
+		return len;
+	}
+
+	if (rec->id >= LOG_NUM_IDS) {
+		return len + snprintf(buf + len, size - len, "log: unknown id %u\n",
+		                      (unsigned int)rec->id);
+	}
+
+	/* Missing arguments print as 0 */
+	for (size_t i = 0; i < rec->nargs && i < LOG_MAX_ARGS; i++) {
+		a[i] = (unsigned int)rec->args[i];
+	}
+
+	return len + snprintf(buf + len, size - len, log_formats[rec->id],
+	                      a[0], a[1], a[2], a[3], a[4], a[5]);
+}
+
+int log_flush(void)
+{
+	struct log_record rec;
+	char line[LOG_LINE_MAX];
+	uint32_t dropped;
+	int count = 0;
+
+	while (log_read(&rec) == 0) {
+		log_format(&rec, line, sizeof(line));
+		printf("%s", line);
+		count++;
+	}
+
+	dropped = __atomic_load_n(&log_dropped, __ATOMIC_RELAXED);
+	if (dropped != log_dropped_reported) {
+		printf("log: %u records dropped\n", (unsigned int)(dropped - log_dropped_reported));
+		log_dropped_reported = dropped;
+	}
+
+	return count;
+}
+
+void log_get_stats(struct log_stats *stats)
+{
+	if (!stats) {
+		return;
+	}
+
+	stats->written = __atomic_load_n(&log_written, __ATOMIC_RELAXED);
+	stats->dropped = __atomic_load_n(&log_dropped, __ATOMIC_RELAXED);
+}
+
+void log_reset(void)
+{
+	memset(log_ring, 0, sizeof(log_ring));
+	log_head = 0;
+	log_tail = 0;
+	log_written = 0;
+	log_dropped = 0;
+	log_dropped_reported = 0;
+}
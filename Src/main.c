@@ -1,25 +1,40 @@
 #include "main.h"
 #include "usb_device.h"
+#include "usbd_cdc_if.h"
 #include "drv/i2c_scan.h"
 #include "drv/uart_in.h"
+#include "drv/uart_out.h"
 #include "drv/adc_dma.h"
 #include "drv/can.h"
 #include "drv/pwm.h"
 #include "drv/mt6701.h"
+#include "event.h"
 #include "foc.h"
+#include "irq.h"
+#include "log.h"
+#include "monitor.h"
+#include "param.h"
+#include "prof.h"
+#include "proto.h"
+#include "scheduler.h"
+#include "scope.h"
+#include "store.h"
+#include "telemetry.h"
+#include <math.h>
 #include <stdio.h>
+#include <string.h>
 
 ADC_HandleTypeDef hadc2;
 DMA_HandleTypeDef hdma_adc2;
+DMA_HandleTypeDef hdma_usart2_rx;
+DMA_HandleTypeDef hdma_usart2_tx;
 FDCAN_HandleTypeDef hfdcan1;
 I2C_HandleTypeDef hi2c1;
 I2C_HandleTypeDef hi2c2;
 TIM_HandleTypeDef htim2;
 TIM_HandleTypeDef htim3;
-TIM_HandleTypeDef htim4;
 UART_HandleTypeDef huart2;
 
-static MainCommands command = 0;
 static struct pwm_device *pwm_dev[2];
 static struct foc_motor *motor[2];
 static mt6701_t encoder_motor0;
@@ -30,11 +45,111 @@ static float angle = 0.0f;
 static float target_rpm = 0.0f;
 static float amplitude = 5.0f;  /* Start with low amplitude to prevent overcurrent */
 static bool velocity_mode = false;
+static volatile bool angle_changed = false;
+
+/* Velocity command limit, console and protocol */
+#define MAX_RPM 500.0f
+
+/* Binary protocol, one port per transport */
+static struct proto_port proto_uart;
+static struct proto_port proto_usb;
+static struct proto_port proto_can;
+
+/* Signals for scope and telemetry, motor 1 (the one with current sensing) */
+enum {
+    SIG_IA, SIG_IB, SIG_IC, SIG_ID, SIG_IQ, SIG_ANGLE,
+    SIG_CCR_A, SIG_CCR_B, SIG_CCR_C, SIG_ENCODER, SIG_OVERCURRENT,
+    SIG_ANGLE0, SIG_NUM
+};
+static struct scope_signal scope_signals[SIG_NUM];
+static uint32_t scope_stream_row;
+
+/* Next row of the info report, console 'i' */
+#define INFO_IDLE UINT32_MAX
+static uint32_t info_row = INFO_IDLE;
+
+/* ADC noise capture, console 'n': 12.8 ms at the PWM rate */
+#define NOISE_SAMPLES 256
+static uint16_t noise_buf[NOISE_SAMPLES * ADC_DMA_NUM_CHANNELS];
+
+/* Motor 1 offsets measured at this start, to be saved once known */
+static bool offset_unsaved;
+
+/* Velocity loop rate, matches the velocity task below */
+#define VELOCITY_RATE_HZ 2000
+
+static void position_task(void);
+static void telemetry_task(void);
+static void housekeeping_task(void);
+
+/*
+ * Task table, one base tick per ADC DMA sequence (PWM rate). Offsets keep
+ * the main-loop tasks off each other's ticks; faster tasks come first.
+ */
+static struct sched_task tasks[] = {
+    SCHED_TASK("current",      foc_current_task,    SCHED_TICK_HZ,    0, SCHED_ISR),
+    SCHED_TASK("scope",        scope_sample,        SCHED_TICK_HZ,    0, SCHED_ISR),
+    SCHED_TASK("stream",       telemetry_sample,    SCHED_TICK_HZ,    0, SCHED_ISR),
+    SCHED_TASK("encoder",      foc_encoder_start,   1000,             0, SCHED_ISR),
+    SCHED_TASK("velocity",     foc_velocity_task,   VELOCITY_RATE_HZ, 1, SCHED_MAIN),
+    SCHED_TASK("protection",   foc_protection_task, 1000,             2, SCHED_MAIN),
+    SCHED_TASK("position",     position_task,       500,              3, SCHED_MAIN),
+    SCHED_TASK("telemetry",    telemetry_task,      100,              4, SCHED_MAIN),
+    SCHED_TASK("housekeeping", housekeeping_task,   10,               5, SCHED_MAIN),
+};
+
+/**
+ * @brief Console input callback
+ * Called from the UART interrupts for each received character
+ */
+static void uart_rx_notify(uint8_t ch)
+{
+    (void)ch;
+    event_post(EVENT_UART_RX);
+}
+
+/**
+ * @brief ADC DMA sequence complete callback, the scheduler base tick
+ */
+static void adc_tick(uint16_t *values, uint8_t num_channels)
+{
+    (void)values;
+    (void)num_channels;
+    monitor_tick(prof_now());
+    sched_tick();
+}
+
+/**
+ * @brief Scheduler release hook
+ * Called from sched_tick() when main loop tasks are due
+ */
+static void sched_notify(void)
+{
+    event_post(EVENT_SCHED);
+}
+
+/**
+ * @brief Idle calibration done hook
+ * Called from monitor_idle() in the main loop
+ */
+static void monitor_notify(void)
+{
+    event_post(EVENT_MONITOR);
+}
+
+/**
+ * @brief Telemetry transport: USB CDC
+ */
+static int cdc_send(uint8_t *buf, uint16_t len)
+{
+    return CDC_Transmit_FS(buf, len) == USBD_OK ? 0 : -1;
+}
 
 static void init(void)
 {
     HAL_Init();
     SystemClock_Config();
+    prof_init();
 
     MX_GPIO_Init();
     MX_DMA_Init();
@@ -44,15 +159,18 @@ static void init(void)
     MX_I2C2_Init();
     MX_TIM2_Init();
     MX_TIM3_Init();
-    MX_TIM4_Init();
     MX_UCPD1_Init();
     MX_USART2_UART_Init();
+    uart_out_init(&huart2);
     MX_USB_Device_Init();
     MX_FDCAN1_Init();
 
     adc_dma_init(&hadc2, &hdma_adc2, &htim2);
+    adc_dma_set_callback(adc_tick);
 
     uart_in_init(&huart2);
+    uart_in_set_callback(uart_rx_notify);
+    telemetry_init(cdc_send);
     can_init(&hfdcan1);
 
     /* Initialize MT6701 encoders */
@@ -60,6 +178,626 @@ static void init(void)
     mt6701_init(&encoder_motor1, &hi2c1, MT6701_I2C_ADDR, "encoder_motor1");
 }
 
+/**
+ * @brief Fill in the scope signal table once the motors exist
+ *
+ * Currents, the overcurrent flag and the compare values change on every
+ * ADC sample; the angle does in closed-loop torque mode and otherwise at
+ * the velocity rate, the encoder at 1 kHz.
+ */
+static void scope_init_signals(void)
+{
+    struct foc_motor *m = motor[1];
+
+    scope_signals[SIG_IA] = (struct scope_signal){"ia", SCOPE_F32, &m->current_data.phase_a_current};
+    scope_signals[SIG_IB] = (struct scope_signal){"ib", SCOPE_F32, &m->current_data.phase_b_current};
+    scope_signals[SIG_IC] = (struct scope_signal){"ic", SCOPE_F32, &m->current_data.phase_c_current};
+    scope_signals[SIG_ID] = (struct scope_signal){"id", SCOPE_F32, &m->torque_data.id};
+    scope_signals[SIG_IQ] = (struct scope_signal){"iq", SCOPE_F32, &m->torque_data.iq};
+    scope_signals[SIG_ANGLE] = (struct scope_signal){"angle", SCOPE_F32, &m->electrical_angle};
+    scope_signals[SIG_CCR_A] = (struct scope_signal){"ccr_a", SCOPE_U32, &htim3.Instance->CCR2};
+    scope_signals[SIG_CCR_B] = (struct scope_signal){"ccr_b", SCOPE_U32, &htim3.Instance->CCR3};
+    scope_signals[SIG_CCR_C] = (struct scope_signal){"ccr_c", SCOPE_U32, &htim3.Instance->CCR4};
+    scope_signals[SIG_ENCODER] = (struct scope_signal){"encoder", SCOPE_U16, &m->encoder.last_raw};
+    scope_signals[SIG_OVERCURRENT] = (struct scope_signal){"overcurrent", SCOPE_BOOL,
+                                                           &m->current_data.overcurrent};
+    scope_signals[SIG_ANGLE0] = (struct scope_signal){"angle0", SCOPE_F32,
+                                                      &motor[0]->electrical_angle};
+}
+
+/**
+ * @brief Protocol transport: console UART, next to the text output
+ */
+static int uart_proto_write(const uint8_t *buf, uint16_t len)
+{
+    return uart_out_write(buf, len) == len ? 0 : -1;
+}
+
+/**
+ * @brief Protocol transport: USB CDC
+ *
+ * Shares the IN endpoint with the telemetry stream; while that runs a
+ * response mostly finds the endpoint busy and waits for a gap, so use the
+ * UART or CAN for commands then. Telemetry transmits from interrupts, so
+ * the TxState check and the start of the transfer run with them masked.
+ */
+static int usb_proto_write(const uint8_t *buf, uint16_t len)
+{
+    uint32_t primask = irq_save();
+    uint8_t ret = CDC_Transmit_FS((uint8_t *)buf, len);
+
+    irq_restore(primask);
+    return ret == USBD_OK ? 0 : -1;
+}
+
+/**
+ * @brief Protocol transport: USB CDC sends from the port's buffer
+ */
+static bool usb_proto_busy(const uint8_t *buf)
+{
+    return CDC_TxBusy_FS(buf) != 0;
+}
+
+/**
+ * @brief Protocol transport: CAN byte stream on PROTO_CAN_TX_ID
+ */
+static int can_proto_write(const uint8_t *buf, uint16_t len)
+{
+    return can_write(PROTO_CAN_TX_ID, buf, len, 10);
+}
+
+/**
+ * @brief USB CDC receive hook (USB interrupt)
+ */
+static void usb_proto_rx(const uint8_t *buf, uint32_t len)
+{
+    proto_port_push(&proto_usb, buf, len);
+    event_post(EVENT_PROTO_RX);
+}
+
+/**
+ * @brief CAN receive hook (FDCAN interrupt), takes the protocol stream
+ */
+static bool can_proto_rx(uint32_t id, const uint8_t *data, uint8_t len)
+{
+    if (id != PROTO_CAN_RX_ID) {
+        return false;
+    }
+    proto_port_push(&proto_can, data, len);
+    event_post(EVENT_PROTO_RX);
+    return true;
+}
+
+/**
+ * @brief SET_TARGET for one axis
+ *
+ * A new target in the current velocity mode keeps the ramp running; only
+ * a mode change restarts it.
+ */
+static uint8_t proto_set_target(struct foc_motor *m, uint8_t mode, float value)
+{
+    enum foc_velocity_mode vmode = mode == PROTO_TARGET_VELOCITY_CLOSED ?
+                                   FOC_VELOCITY_CLOSED_LOOP : FOC_VELOCITY_OPEN_LOOP;
+    int ret;
+
+    switch (mode) {
+        case PROTO_TARGET_STOP:
+            ret = m->velocity_cfg.mode == FOC_VELOCITY_DISABLED ? 0 : foc_velocity_disable(m);
+            break;
+
+        case PROTO_TARGET_VELOCITY:
+        case PROTO_TARGET_VELOCITY_CLOSED:
+            if (!(fabsf(value) <= MAX_RPM)) {
+                return PROTO_ERR_ARG;
+            }
+            if (m->velocity_cfg.mode == vmode) {
+                ret = foc_velocity_set_target(m, value);
+            } else {
+                ret = foc_velocity_enable(m, vmode, value, amplitude, VELOCITY_RATE_HZ,
+                                          m->velocity_cfg.pole_pairs);
+            }
+            break;
+
+        case PROTO_TARGET_AMPLITUDE:
+            if (m->velocity_cfg.mode == FOC_VELOCITY_DISABLED) {
+                return PROTO_ERR_STATE;
+            }
+            if (!(value >= 0.0f && value <= 100.0f)) {
+                return PROTO_ERR_ARG;
+            }
+            ret = foc_velocity_set_amplitude(m, value);
+            break;
+
+        default:
+            return PROTO_ERR_ARG;
+    }
+
+    /* Keep the console's view in step */
+    velocity_mode = motor[0]->velocity_cfg.mode != FOC_VELOCITY_DISABLED ||
+                    motor[1]->velocity_cfg.mode != FOC_VELOCITY_DISABLED;
+
+    return ret == 0 ? PROTO_OK : PROTO_ERR_STATE;
+}
+
+/**
+ * @brief READ_STATE for one axis
+ */
+static void proto_read_state(struct foc_motor *m, uint8_t *resp)
+{
+    struct proto_state s = {
+        .mode = m->velocity_cfg.mode,
+        .target_rpm = m->velocity_cfg.target_rpm,
+        .ramp_rpm = m->current_rpm,
+        .amplitude = m->amplitude,
+        .electrical_angle = m->electrical_angle,
+        .ia = m->current_data.phase_a_current,
+        .ib = m->current_data.phase_b_current,
+        .id = m->torque_data.id,
+        .iq = m->torque_data.iq,
+    };
+
+    foc_velocity_get_current(m, &s.measured_rpm);
+    if (m->current_data.overcurrent) {
+        s.flags |= PROTO_STATE_OVERCURRENT;
+    }
+    if (m->torque_cfg.enabled) {
+        s.flags |= PROTO_STATE_TORQUE;
+    }
+    if (m->encoder.dev && m->encoder.valid) {
+        s.flags |= PROTO_STATE_ENCODER;
+    }
+
+    proto_pack_state(&s, resp);
+}
+
+/**
+ * @brief PARAM_INFO
+ */
+static uint8_t proto_param_info(const uint8_t *req, uint16_t len, uint8_t *resp,
+                                uint16_t *resp_len)
+{
+    const struct param_info *p;
+    size_t name_len;
+
+    if (len != 1) {
+        return PROTO_ERR_LEN;
+    }
+    p = param_info(req[0]);
+    if (!p) {
+        return PROTO_ERR_ARG;
+    }
+
+    name_len = strnlen(p->name, PROTO_MAX_PAYLOAD - 10);
+    resp[0] = p->type;
+    resp[1] = p->flags;
+    proto_put_f32(&resp[2], p->min);
+    proto_put_f32(&resp[6], p->max);
+    memcpy(&resp[10], p->name, name_len);
+    *resp_len = 10 + name_len;
+    return PROTO_OK;
+}
+
+/**
+ * @brief GET_PARAMS and SET_PARAMS on one axis
+ */
+static uint8_t proto_params(uint8_t cmd, struct foc_motor *m, const uint8_t *req, uint16_t len,
+                            uint8_t *resp, uint16_t *resp_len)
+{
+    struct param_value values[PROTO_MAX_PAYLOAD / 5];
+    uint16_t count;
+    int ret;
+
+    if (cmd == PROTO_CMD_GET_PARAMS) {
+        if (len == 0 || len > PROTO_MAX_PAYLOAD / 4) {
+            return PROTO_ERR_LEN;
+        }
+        for (uint16_t i = 0; i < len; i++) {
+            float v;
+
+            if (param_get(m, req[i], &v) != 0) {
+                return PROTO_ERR_ARG;
+            }
+            proto_put_f32(&resp[i * 4], v);
+        }
+        *resp_len = len * 4;
+        return PROTO_OK;
+    }
+
+    /* All or nothing */
+    count = len / 5;
+    if (count == 0 || len % 5 != 0) {
+        return PROTO_ERR_LEN;
+    }
+    for (uint16_t i = 0; i < count; i++) {
+        values[i].id = req[i * 5];
+        values[i].value = proto_get_f32(&req[i * 5 + 1]);
+    }
+    ret = param_set_many(m, values, count);
+
+    return ret == 0 ? PROTO_OK : ret == -2 ? PROTO_ERR_STATE : PROTO_ERR_ARG;
+}
+
+/**
+ * @brief Flash writes stall the control interrupts: only with both motors off
+ */
+static bool motors_stopped(void)
+{
+    return motor[0]->velocity_cfg.mode == FOC_VELOCITY_DISABLED &&
+           motor[1]->velocity_cfg.mode == FOC_VELOCITY_DISABLED;
+}
+
+/**
+ * @brief Protocol commands that act on an axis, and parameter info
+ */
+static uint8_t proto_command(uint8_t cmd, const uint8_t *req, uint16_t len,
+                             uint8_t *resp, uint16_t *resp_len)
+{
+    static const uint16_t req_len[] = {
+        [PROTO_CMD_SET_TARGET] = 6, [PROTO_CMD_SET_GAINS] = 10, [PROTO_CMD_READ_STATE] = 1,
+        [PROTO_CMD_SAVE_PARAMS] = 1,
+    };
+    struct foc_motor *m;
+    float kp, ki;
+    int ret;
+
+    if (cmd == PROTO_CMD_PARAM_INFO) {
+        return proto_param_info(req, len, resp, resp_len);
+    }
+    if (cmd != PROTO_CMD_SET_TARGET && cmd != PROTO_CMD_SET_GAINS &&
+        cmd != PROTO_CMD_READ_STATE && cmd != PROTO_CMD_GET_PARAMS &&
+        cmd != PROTO_CMD_SET_PARAMS && cmd != PROTO_CMD_SAVE_PARAMS) {
+        return PROTO_ERR_CMD;
+    }
+
+    /* Axis first */
+    if (len < 1) {
+        return PROTO_ERR_LEN;
+    }
+    if (req[0] >= 2) {
+        return PROTO_ERR_ARG;
+    }
+    m = motor[req[0]];
+
+    if (cmd == PROTO_CMD_GET_PARAMS || cmd == PROTO_CMD_SET_PARAMS) {
+        return proto_params(cmd, m, &req[1], len - 1, resp, resp_len);
+    }
+    if (len != req_len[cmd]) {
+        return PROTO_ERR_LEN;
+    }
+
+    switch (cmd) {
+        case PROTO_CMD_SET_TARGET:
+            return proto_set_target(m, req[1], proto_get_f32(&req[2]));
+
+        case PROTO_CMD_SET_GAINS:
+            kp = proto_get_f32(&req[2]);
+            ki = proto_get_f32(&req[6]);
+            if (!isfinite(kp) || !isfinite(ki)) {
+                return PROTO_ERR_ARG;
+            }
+            if (req[1] == PROTO_LOOP_SPEED) {
+                ret = foc_velocity_set_gains(m, kp, ki);
+            } else if (req[1] == PROTO_LOOP_CURRENT) {
+                ret = foc_torque_set_gains(m, kp, ki);
+            } else {
+                return PROTO_ERR_ARG;
+            }
+            return ret == 0 ? PROTO_OK : PROTO_ERR_ARG;
+
+        case PROTO_CMD_SAVE_PARAMS:
+            if (!motors_stopped() || param_save_all(m, req[0]) != 0) {
+                return PROTO_ERR_STATE;
+            }
+            return PROTO_OK;
+
+        default:
+            proto_read_state(m, resp);
+            *resp_len = PROTO_STATE_SIZE;
+            return PROTO_OK;
+    }
+}
+
+/**
+ * @brief Start or stop the 20 kHz telemetry stream over USB
+ */
+static void stream_toggle(void)
+{
+    /* Signals that change on every sample; the encoder and motor 0 are slower */
+    static const uint8_t sigs[] = {
+        SIG_IA, SIG_IB, SIG_IC, SIG_ID, SIG_IQ, SIG_ANGLE, SIG_CCR_A, SIG_CCR_B,
+    };
+    const struct scope_signal *chans[sizeof(sigs)];
+    struct telemetry_stats stats;
+
+    if (telemetry_running()) {
+        telemetry_stop();
+        telemetry_get_stats(&stats);
+        printf("Telemetry stopped: %lu packets, %lu samples, %lu dropped\n",
+               (unsigned long)stats.packets, (unsigned long)stats.samples,
+               (unsigned long)stats.dropped);
+        return;
+    }
+
+    printf("Telemetry over USB:");
+    for (size_t i = 0; i < sizeof(sigs); i++) {
+        chans[i] = &scope_signals[sigs[i]];
+        printf(" %s", chans[i]->name);
+    }
+    printf("\n");
+
+    if (telemetry_configure(chans, sizeof(sigs), 1) != 0 || telemetry_start() != 0) {
+        printf("Telemetry start failed\n");
+    }
+}
+
+/**
+ * @brief ADC capture complete, from the ADC interrupt
+ */
+static void noise_done(const uint16_t *samples, uint32_t num_samples)
+{
+    (void)samples;
+    (void)num_samples;
+    event_post(EVENT_ADC);
+}
+
+/**
+ * @brief Capture a block of raw ADC samples with the motors idle
+ */
+static void noise_start(void)
+{
+    if (!motors_stopped()) {
+        printf("Stop the motors first\n");
+        return;
+    }
+
+    if (adc_dma_capture_start(noise_buf, NOISE_SAMPLES, false, noise_done) != 0) {
+        printf("ADC capture failed\n");
+    }
+}
+
+/**
+ * @brief Per-channel mean and noise of the captured block, in mV
+ */
+static void noise_report(void)
+{
+    printf("ADC noise over %d samples (mV):\n", NOISE_SAMPLES);
+    for (int ch = 0; ch < ADC_DMA_NUM_CHANNELS; ch++) {
+        uint16_t min = 0xFFFF, max = 0;
+        float sum = 0.0f, sum_sq = 0.0f, mean, rms;
+
+        for (int i = 0; i < NOISE_SAMPLES; i++) {
+            uint16_t v = noise_buf[i * ADC_DMA_NUM_CHANNELS + ch];
+
+            sum += v;
+            sum_sq += (float)v * v;
+            min = v < min ? v : min;
+            max = v > max ? v : max;
+        }
+        mean = sum / NOISE_SAMPLES;
+        rms = sqrtf(fmaxf(sum_sq / NOISE_SAMPLES - mean * mean, 0.0f));
+
+        printf("  ch%d: mean %lu, rms %d.%02d, p-p %lu\n", ch,
+               (unsigned long)adc_dma_raw_to_mv((uint16_t)(mean + 0.5f)),
+               (int)(rms * ADC_VREF_MV / 4096.0f),
+               (int)(rms * ADC_VREF_MV / 40.96f) % 100,
+               (unsigned long)adc_dma_raw_to_mv(max - min));
+    }
+}
+
+/**
+ * @brief Arm the scope: phase currents, angle and phase A compare,
+ * triggered on the overcurrent edge with a quarter of pre-trigger
+ */
+static void scope_start(void)
+{
+    struct scope_config cfg = {
+        .channels = {
+            &scope_signals[SIG_IA], &scope_signals[SIG_IB],
+            &scope_signals[SIG_ANGLE], &scope_signals[SIG_CCR_A],
+        },
+        .num_channels = 4,
+        .decimation = 1,
+        .depth = 0,
+        .pre_trigger = SCOPE_BUFFER_SAMPLES / 4 / 4,
+        .mode = SCOPE_TRIG_RISING,
+        .trigger = &scope_signals[SIG_OVERCURRENT],
+        .level = 0.5f,
+    };
+
+    if (scope_configure(&cfg) != 0 || scope_arm() != 0) {
+        printf("Scope busy\n");
+        return;
+    }
+    scope_stream_row = 0;
+    printf("Scope armed, waiting for overcurrent (S to trigger)\n");
+}
+
+/**
+ * @brief Stream a completed capture as CSV, values x1000
+ *
+ * A few rows per call, as long as the UART buffer is less than half full,
+ * so nothing is dropped and the main loop is never held up.
+ */
+static void scope_stream(void)
+{
+    uint32_t depth, pre;
+    uint8_t n;
+    float row[SCOPE_MAX_CHANNELS];
+
+    if (scope_get_state() != SCOPE_DONE) {
+        return;
+    }
+    n = scope_get_window(&depth, &pre);
+
+    if (scope_stream_row == 0) {
+        printf("scope: %lu samples at %lu Hz, trigger at %lu\nn",
+               (unsigned long)depth, (unsigned long)SCHED_TICK_HZ, (unsigned long)pre);
+        for (uint8_t c = 0; c < n; c++) {
+            printf(",%s", scope_get_channel(c)->name);
+        }
+        printf("\n");
+    }
+
+    while (scope_stream_row < depth && uart_out_pending() < UART_OUT_BUFFER_SIZE / 2) {
+        scope_read(scope_stream_row, row);
+        printf("%ld", (long)scope_stream_row - (long)pre);
+        for (uint8_t c = 0; c < n; c++) {
+            printf(",%ld", (long)(row[c] * 1000.0f));
+        }
+        printf("\n");
+        scope_stream_row++;
+    }
+
+    if (scope_stream_row >= depth) {
+        printf("scope: end\n");
+        scope_release();
+    }
+}
+
+/**
+ * @brief Print one row of the info report
+ *
+ * @return false past the last row
+ */
+static bool info_print(uint32_t row)
+{
+    const size_t num_tasks = sizeof(tasks) / sizeof(tasks[0]);
+
+    switch (row) {
+    case 0: {
+        printf("\n=== Motor Control Info ===\n");
+        printf("Mode: %s\n", velocity_mode ? "Velocity" : "Position");
+        printf("Amplitude: %d%%\n", (int)amplitude);
+
+        if (velocity_mode) {
+            float rpm0, rpm1;
+            foc_velocity_get_current(motor[0], &rpm0);
+            foc_velocity_get_current(motor[1], &rpm1);
+            printf("Target RPM: %d\n", (int)target_rpm);
+            printf("Motor 0 current RPM: %d\n", (int)rpm0);
+            printf("Motor 1 current RPM: %d\n", (int)rpm1);
+        } else {
+            printf("Position angle: %d deg\n", (int)angle);
+        }
+
+        /* Print current sensing info */
+        float current_a = 0.0f;
+        foc_current_get(motor[1], &current_a);
+        printf("Motor 1 current: %d mA (limit: %d A)\n",
+               (int)(current_a * 1000),
+               (int)motor[1]->current_cfg.current_limit_a);
+        return true;
+    }
+
+    case 1: {
+        /* Latest encoder samples (read by the 1 kHz encoder task) */
+        mt6701_sample_t enc0, enc1;
+        if (mt6701_get_sample(&encoder_motor0, &enc0) == 0 &&
+            mt6701_get_sample(&encoder_motor1, &enc1) == 0) {
+            printf("Encoder 0: %d deg (seq %lu, errors %lu)\n",
+                   (int)(enc0.angle * 360UL / MT6701_ANGLE_RESOLUTION),
+                   (unsigned long)enc0.seq, (unsigned long)encoder_motor0.errors);
+            printf("Encoder 1: %d deg (seq %lu, errors %lu)\n",
+                   (int)(enc1.angle * 360UL / MT6701_ANGLE_RESOLUTION),
+                   (unsigned long)enc1.seq, (unsigned long)encoder_motor1.errors);
+        }
+
+        struct uart_out_stats uart_stats;
+        uart_out_get_stats(&uart_stats);
+        printf("UART TX: %lu bytes, %lu dropped\n",
+               (unsigned long)uart_stats.written, (unsigned long)uart_stats.dropped);
+        return true;
+    }
+
+    case 2: {
+        struct monitor_load load;
+        struct monitor_jitter jitter;
+        uint32_t ns_per_bin = MONITOR_JITTER_BIN_CYCLES * 1000U / (SystemCoreClock / 1000000U);
+        monitor_get_load(&load);
+        monitor_get_jitter(&jitter);
+        printf("CPU load: %u.%u%% (peak %u.%u%%)\n",
+               load.load / 10, load.load % 10, load.peak / 10, load.peak % 10);
+        printf("Tick jitter: %ld..%ld ns over %lu ticks, %lu ns bins:\n ",
+               (long)jitter.min * 1000 / (long)(SystemCoreClock / 1000000U),
+               (long)jitter.max * 1000 / (long)(SystemCoreClock / 1000000U),
+               (unsigned long)jitter.ticks, (unsigned long)ns_per_bin);
+        for (uint32_t b = 0; b < MONITOR_JITTER_BINS; b++) {
+            printf(" %lu", (unsigned long)jitter.hist[b]);
+        }
+        printf("\n");
+        return true;
+    }
+
+    case 3:
+        printf("Scheduler: %lu ticks\n", (unsigned long)sched_get_ticks());
+        return true;
+
+    default:
+        break;
+    }
+
+    /* One row per scheduler task */
+    row -= 4;
+    if (row < num_tasks) {
+        const struct sched_task *task = sched_get_task(row);
+        printf("  %-12s %5lu Hz: %lu runs, %lu overruns, %lu misses, exec %lu/%lu us\n",
+               task->name, (unsigned long)(SCHED_TICK_HZ / task->period),
+               (unsigned long)task->runs, (unsigned long)task->overruns,
+               (unsigned long)task->misses,
+               (unsigned long)sched_cycles_to_us(task->exec_last),
+               (unsigned long)sched_cycles_to_us(task->exec_max));
+        return true;
+    }
+
+    if (row == num_tasks) {
+        struct uart_in_stats uart_rx_stats;
+        uart_in_get_stats(&uart_rx_stats);
+        printf("UART RX: %lu bytes, %lu dropped, %lu overruns, %lu errors\n",
+               (unsigned long)uart_rx_stats.received,
+               (unsigned long)uart_rx_stats.dropped,
+               (unsigned long)uart_rx_stats.overruns,
+               (unsigned long)uart_rx_stats.errors);
+        const struct proto_port *ports[] = {&proto_uart, &proto_usb, &proto_can};
+        const char *port_names[] = {"UART", "USB", "CAN"};
+        for (size_t p = 0; p < 3; p++) {
+            printf("Protocol %s: %lu requests, %lu repeats, %lu CRC errors, "
+                   "%lu frame errors, %lu dropped\n", port_names[p],
+                   (unsigned long)ports[p]->stats.requests,
+                   (unsigned long)ports[p]->stats.repeats,
+                   (unsigned long)ports[p]->stats.crc_errors,
+                   (unsigned long)ports[p]->stats.frame_errors,
+                   (unsigned long)ports[p]->stats.dropped);
+        }
+        return true;
+    }
+
+    if (row == num_tasks + 1) {
+        struct store_stats store_st;
+        store_get_stats(&store_st);
+        printf("Store: %u keys, %lu/%lu bytes used, generation %lu, %u bad records\n",
+               store_st.keys, (unsigned long)store_st.used, (unsigned long)store_st.size,
+               (unsigned long)store_st.generation, store_st.bad_records);
+        printf("========================\n\n");
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Stream the info report, console 'i'
+ *
+ * The whole report is larger than the UART buffer. Like scope_stream(), a
+ * row only goes out while the buffer is less than half full, and the rest
+ * waits for the next call.
+ */
+static void info_stream(void)
+{
+    while (info_row != INFO_IDLE && uart_out_pending() < UART_OUT_BUFFER_SIZE / 2) {
+        info_row = info_print(info_row) ? info_row + 1 : INFO_IDLE;
+    }
+}
+
 static void pwm_init_devices(void)
 {
     pwm_dev[0] = pwm_get_device("pwm_motor0");
@@ -74,38 +812,338 @@ static void pwm_init_devices(void)
     /* Initialize FOC motor instances */
     motor[0] = foc_get_motor("motor0");
     motor[1] = foc_get_motor("motor1");
+
+    /* Encoder feedback: speed reporting and FOC_VELOCITY_CLOSED_LOOP */
+    foc_encoder_attach(motor[0], &encoder_motor0, 0.0f);
+    foc_encoder_attach(motor[1], &encoder_motor1, 0.0f);
+}
+
+/**
+ * @brief Position task (500 Hz)
+ * Applies the angle set from the console in position mode
+ */
+static void position_task(void)
+{
+    if (!angle_changed) {
+        return;
+    }
+    angle_changed = false;
+
+    if (!velocity_mode) {
+        pwm_set_vector(pwm_dev[0], angle, amplitude);
+        pwm_set_vector(pwm_dev[1], angle, amplitude);
+    }
+}
+
+/**
+ * @brief Telemetry task (100 Hz)
+ * Prints what the interrupts and the control tasks logged and streams
+ * out scope captures and the info report
+ */
+static void telemetry_task(void)
+{
+    log_flush();
+    scope_stream();
+    info_stream();
+
+    /* Responses the transports refused earlier */
+    proto_port_poll(&proto_uart);
+    proto_port_poll(&proto_usb);
+    proto_port_poll(&proto_can);
 }
 
-void set_event(MainCommands cmd)
+/**
+ * @brief Housekeeping task (10 Hz)
+ */
+static void housekeeping_task(void)
 {
-    command |= cmd;
+    static uint32_t reports;
+    uint8_t report[MONITOR_CAN_LEN];
+
+    HAL_GPIO_TogglePin(GPIOC, GPIO_PIN_6);
+
+    /* CPU load over the last 100 ms, reported over CAN once a second */
+    monitor_update();
+    if (++reports >= 10) {
+        reports = 0;
+        monitor_pack_can(report);
+        can_transmit(MONITOR_CAN_ID, report, MONITOR_CAN_LEN);
+    }
+
+    /*
+     * First start: keep the measured offsets so the next one skips the
+     * calibration. The motors are idle, so the flash stall is harmless.
+     */
+    if (offset_unsaved && motor[1]->current_cfg.enabled && motors_stopped()) {
+        offset_unsaved = false;
+        param_save(motor[1], 1, PARAM_CURRENT_OFFSET_A);
+        param_save(motor[1], 1, PARAM_CURRENT_OFFSET_B);
+    }
+
+    /* ADC testing */
+    //uint16_t adc_values[5];
+    //adc_dma_get_all_channels(adc_values, 5);
+    // printf("ADC Values: %u %u %u %u %u\n",
+    //        adc_values[0], adc_values[1],
+    //        adc_values[2], adc_values[3],
+    //        adc_values[4]);
+
+    /* MT6701 testing */
+    // float angle0, angle1;
+    // mt6701_read_angle_deg(&encoder_motor0, &angle0);
+    // mt6701_read_angle_deg(&encoder_motor1, &angle1);
+    // printf("Encoder angles: motor0=%d deg, motor1=%d deg\n", (int)angle0, (int)angle1);
+
+    /* Send CAN frame with ADC1 value */
+    // uint8_t can_data[2];
+    // can_data[0] = (adc_values[0] >> 8) & 0xFF;  /* ADC1 high byte */
+    // can_data[1] = adc_values[0] & 0xFF;         /* ADC1 low byte */
+    // can_transmit(0x100, can_data, 2);
+}
+
+/**
+ * @brief UART error callback
+ * USART2 is shared by the console input and output drivers
+ */
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
+{
+    uart_in_error_handler(huart);
+    uart_out_error_handler(huart);
 }
 
 /**
- * @brief Timer period elapsed callback
- * Called from TIM4 interrupt at 1kHz
+ * @brief Handle one console key press
  */
-void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
+static void handle_key(uint8_t ch)
 {
-    if (htim->Instance == TIM4) {
-        /* Set event to trigger PWM velocity control update at 1kHz */
-        set_event(CMD_PWM);
+    switch (ch) {
+        case '+':
+            /* Increase velocity by 10 RPM */
+            target_rpm += 10.0f;
+            if (target_rpm > MAX_RPM) target_rpm = MAX_RPM;  /* Limit max RPM */
+
+            if (!velocity_mode) {
+                /* Enable velocity mode on first velocity command */
+                foc_velocity_enable(motor[0], FOC_VELOCITY_OPEN_LOOP,
+                                  target_rpm, amplitude, VELOCITY_RATE_HZ,
+                                  motor[0]->velocity_cfg.pole_pairs);
+                foc_velocity_enable(motor[1], FOC_VELOCITY_OPEN_LOOP,
+                                  target_rpm, amplitude, VELOCITY_RATE_HZ,
+                                  motor[1]->velocity_cfg.pole_pairs);
+                velocity_mode = true;
+                printf("Velocity mode enabled (amplitude: %d%%)\n", (int)amplitude);
+            } else {
+                foc_velocity_set_target(motor[0], target_rpm);
+                foc_velocity_set_target(motor[1], target_rpm);
+            }
+            printf("Target velocity: %d RPM\n", (int)target_rpm);
+            break;
+
+        case '-':
+            /* Decrease velocity by 10 RPM */
+            target_rpm -= 10.0f;
+            if (target_rpm < -MAX_RPM) target_rpm = -MAX_RPM;  /* Limit min RPM */
+
+            if (!velocity_mode) {
+                /* Enable velocity mode on first velocity command */
+                foc_velocity_enable(motor[0], FOC_VELOCITY_OPEN_LOOP,
+                                  target_rpm, amplitude, VELOCITY_RATE_HZ,
+                                  motor[0]->velocity_cfg.pole_pairs);
+                foc_velocity_enable(motor[1], FOC_VELOCITY_OPEN_LOOP,
+                                  target_rpm, amplitude, VELOCITY_RATE_HZ,
+                                  motor[1]->velocity_cfg.pole_pairs);
+                velocity_mode = true;
+                printf("Velocity mode enabled (amplitude: %d%%)\n", (int)amplitude);
+            } else {
+                foc_velocity_set_target(motor[0], target_rpm);
+                foc_velocity_set_target(motor[1], target_rpm);
+            }
+            printf("Target velocity: %d RPM\n", (int)target_rpm);
+            break;
+
+        case '>':
+            /* Increase amplitude by 5% */
+            amplitude += 5.0f;
+            if (amplitude > 100.0f) amplitude = 100.0f;
+            printf("Amplitude: %d%%\n", (int)amplitude);
+
+            /* Update amplitude if in velocity mode, the ramp carries on */
+            if (velocity_mode) {
+                foc_velocity_set_amplitude(motor[0], amplitude);
+                foc_velocity_set_amplitude(motor[1], amplitude);
+            }
+            break;
+
+        case '<':
+            /* Decrease amplitude by 5% */
+            amplitude -= 5.0f;
+            if (amplitude < 0.0f) amplitude = 0.0f;
+            printf("Amplitude: %d%%\n", (int)amplitude);
+
+            /* Update amplitude if in velocity mode, the ramp carries on */
+            if (velocity_mode) {
+                foc_velocity_set_amplitude(motor[0], amplitude);
+                foc_velocity_set_amplitude(motor[1], amplitude);
+            }
+            break;
+
+        case 'p':
+        case 'P':
+            /* Toggle position/velocity mode */
+            if (velocity_mode) {
+                foc_velocity_disable(motor[0]);
+                foc_velocity_disable(motor[1]);
+                velocity_mode = false;
+                target_rpm = 0.0f;
+                printf("Position mode enabled\n");
+            } else {
+                foc_velocity_enable(motor[0], FOC_VELOCITY_OPEN_LOOP,
+                                  target_rpm, amplitude, VELOCITY_RATE_HZ,
+                                  motor[0]->velocity_cfg.pole_pairs);
+                foc_velocity_enable(motor[1], FOC_VELOCITY_OPEN_LOOP,
+                                  target_rpm, amplitude, VELOCITY_RATE_HZ,
+                                  motor[1]->velocity_cfg.pole_pairs);
+                velocity_mode = true;
+                printf("Velocity mode enabled (amplitude: %d%%)\n", (int)amplitude);
+            }
+            break;
+
+        case 'i':
+        case 'I':
+            /* Print info, streamed out by the telemetry task */
+            info_row = 0;
+            info_stream();
+            break;
+
+        case 'c':
+            /* Print profiling probes (cycles) */
+            prof_dump();
+            break;
+
+        case 'C':
+            prof_reset();
+            printf("Profiling probes cleared\n");
+            break;
+
+        case 't':
+            stream_toggle();
+            break;
+
+        case 's':
+            /* Scope capture at the full loop rate */
+            scope_start();
+            break;
+
+        case 'S':
+            scope_force();
+            break;
+
+        case 'n':
+            /* Raw ADC samples at the full rate, motors stopped */
+            noise_start();
+            break;
+
+        case 'w':
+            /* Save the parameters of both motors to flash */
+            if (!motors_stopped()) {
+                printf("Stop the motors first\n");
+                break;
+            }
+            if (param_save_all(motor[0], 0) == 0 && param_save_all(motor[1], 1) == 0) {
+                printf("Parameters saved\n");
+            } else {
+                printf("Saving parameters failed\n");
+            }
+            break;
+
+        default:
+            /* In position mode, use angle control */
+            if (!velocity_mode) {
+                angle += 10.0f;
+                if (angle >= 360.0f) {
+                    angle -= 360.0f;
+                }
+                /* Applied by the position task */
+                angle_changed = true;
+                printf("Position: %d deg (amplitude: %d%%)\n", (int)angle, (int)amplitude);
+            }
+            break;
+    }
+}
+
+/**
+ * @brief Start the binary protocol on the UART, USB and CAN
+ * Console keys keep working: the UART port passes bytes outside frames on
+ */
+static void proto_init_ports(void)
+{
+    proto_port_init(&proto_uart, uart_proto_write, handle_key);
+    proto_port_init(&proto_usb, usb_proto_write, NULL);
+    proto_port_set_busy(&proto_usb, usb_proto_busy);
+    proto_port_init(&proto_can, can_proto_write, NULL);
+    proto_set_handler(proto_command);
+    proto_set_registers(scope_signals, SIG_NUM);
+
+    CDC_SetRxCallback_FS(usb_proto_rx);
+    can_set_rx_callback(can_proto_rx);
+}
+
+/**
+ * @brief Restore the saved parameters of both motors
+ */
+static void config_load(void)
+{
+    int n;
+
+    if (store_init() != 0) {
+        printf("Store: flash read failed\n");
+        return;
+    }
+
+    for (int i = 0; i < 2; i++) {
+        n = param_load(motor[i], i);
+        if (n > 0) {
+            printf("%s: %d saved parameters loaded\n", motor[i]->name, n);
+        }
+
+        /* Saved offsets replace the calibration in foc_current_enable() */
+        motor[i]->current_cfg.offset_loaded = param_saved(i, PARAM_CURRENT_OFFSET_A) &&
+                                              param_saved(i, PARAM_CURRENT_OFFSET_B);
     }
 }
 
+/**
+ * @brief Start the control tick, once the idle baseline is known
+ */
+static void control_start(void)
+{
+    if (sched_init(tasks, sizeof(tasks) / sizeof(tasks[0]), sched_notify) != 0) {
+        Error_Handler();
+    }
+    adc_dma_start();
+
+    /*
+     * Enable current sensing for motor1 (after the ADC is started). The
+     * offsets are measured in the background, housekeeping saves them.
+     */
+    if (foc_current_enable(motor[1]) == 0 && !motor[1]->current_cfg.offset_loaded) {
+        offset_unsaved = true;
+    }
+    foc_current_track_offset(motor[1], true);
+}
+
 int main(void)
 +{
-    static uint32_t cnt = 0;
-
     init();
     pwm_init_devices();
+    scope_init_signals();
+    proto_init_ports();
+    config_load();
 
     /* Start PWM on both motors */
     pwm_start(pwm_dev[0]);
     pwm_start(pwm_dev[1]);
-
-    /* Start TIM4 interrupt for velocity control at 1kHz */
-    HAL_TIM_Base_Start_IT(&htim4);
+    pwm_sync(pwm_dev, 2);
 
     printf("hello\n");
     printf("Commands:\n");
@@ -115,204 +1153,60 @@ int main(void)
     printf("  < : Decrease amplitude by 5%%\n");
     printf("  p : Toggle position/velocity mode\n");
     printf("  i : Print info\n");
+    printf("  c : Print profiling probes (C clears them)\n");
+    printf("  s : Scope capture on overcurrent (S triggers it now)\n");
+    printf("  t : Toggle 20 kHz binary telemetry over USB\n");
+    printf("  n : Measure ADC noise (motors stopped)\n");
+    printf("  w : Save parameters to flash (motors stopped)\n");
+    printf("Binary protocol (host/tools/foc_cmd) on this UART, USB and CAN 0x%03X\n",
+           PROTO_CAN_RX_ID);
 
     i2c_scan(&hi2c1, "I2C1");
     i2c_scan(&hi2c2, "I2C2");
 
-    adc_dma_start();
-
-    /* Enable current sensing for motor1 (after ADC DMA is started) */
-    foc_current_enable(motor[1]);
+    /*
+     * Idle baseline, measured by the loop below on its own idle passes
+     * before the control interrupts start; EVENT_MONITOR starts them.
+     */
+    uart_out_flush(100);
+    monitor_set_period(SystemCoreClock / SCHED_TICK_HZ);
+    monitor_calibrate(monitor_notify);
 
     while (1) {
-        if (uart_in_available() > 0) {
-            uint8_t ch;
-            uart_in_getchar(&ch);
-
-            switch (ch) {
-                case '+':
-                    /* Increase velocity by 10 RPM */
-                    target_rpm += 10.0f;
-                    if (target_rpm > 500.0f) target_rpm = 500.0f;  /* Limit max RPM */
-
-                    if (!velocity_mode) {
-                        /* Enable velocity mode on first velocity command */
-                        foc_velocity_enable(motor[0], FOC_VELOCITY_OPEN_LOOP,
-                                          target_rpm, amplitude, 1000.0f, 7);
-                        foc_velocity_enable(motor[1], FOC_VELOCITY_OPEN_LOOP,
-                                          target_rpm, amplitude, 1000.0f, 7);
-                        velocity_mode = true;
-                        printf("Velocity mode enabled (amplitude: %d%%)\n", (int)amplitude);
-                    } else {
-                        foc_velocity_set_target(motor[0], target_rpm);
-                        foc_velocity_set_target(motor[1], target_rpm);
-                    }
-                    printf("Target velocity: %d RPM\n", (int)target_rpm);
-                    break;
-
-                case '-':
-                    /* Decrease velocity by 10 RPM */
-                    target_rpm -= 10.0f;
-                    if (target_rpm < -500.0f) target_rpm = -500.0f;  /* Limit min RPM */
-
-                    if (!velocity_mode) {
-                        /* Enable velocity mode on first velocity command */
-                        foc_velocity_enable(motor[0], FOC_VELOCITY_OPEN_LOOP,
-                                          target_rpm, amplitude, 1000.0f, 7);
-                        foc_velocity_enable(motor[1], FOC_VELOCITY_OPEN_LOOP,
-                                          target_rpm, amplitude, 1000.0f, 7);
-                        velocity_mode = true;
-                        printf("Velocity mode enabled (amplitude: %d%%)\n", (int)amplitude);
-                    } else {
-                        foc_velocity_set_target(motor[0], target_rpm);
-                        foc_velocity_set_target(motor[1], target_rpm);
-                    }
-                    printf("Target velocity: %d RPM\n", (int)target_rpm);
-                    break;
-
-                case '>':
-                    /* Increase amplitude by 5% */
-                    amplitude += 5.0f;
-                    if (amplitude > 100.0f) amplitude = 100.0f;
-                    printf("Amplitude: %d%%\n", (int)amplitude);
-
-                    /* Update amplitude if in velocity mode */
-                    if (velocity_mode) {
-                        foc_velocity_disable(motor[0]);
-                        foc_velocity_disable(motor[1]);
-                        foc_velocity_enable(motor[0], FOC_VELOCITY_OPEN_LOOP,
-                                          target_rpm, amplitude, 1000.0f, 7);
-                        foc_velocity_enable(motor[1], FOC_VELOCITY_OPEN_LOOP,
-                                          target_rpm, amplitude, 1000.0f, 7);
-                    }
-                    break;
-
-                case '<':
-                    /* Decrease amplitude by 5% */
-                    amplitude -= 5.0f;
-                    if (amplitude < 0.0f) amplitude = 0.0f;
-                    printf("Amplitude: %d%%\n", (int)amplitude);
-
-                    /* Update amplitude if in velocity mode */
-                    if (velocity_mode) {
-                        foc_velocity_disable(motor[0]);
-                        foc_velocity_disable(motor[1]);
-                        foc_velocity_enable(motor[0], FOC_VELOCITY_OPEN_LOOP,
-                                          target_rpm, amplitude, 1000.0f, 7);
-                        foc_velocity_enable(motor[1], FOC_VELOCITY_OPEN_LOOP,
-                                          target_rpm, amplitude, 1000.0f, 7);
-                    }
-                    break;
-
-                case 'p':
-                case 'P':
-                    /* Toggle position/velocity mode */
-                    if (velocity_mode) {
-                        foc_velocity_disable(motor[0]);
-                        foc_velocity_disable(motor[1]);
-                        velocity_mode = false;
-                        target_rpm = 0.0f;
-                        printf("Position mode enabled\n");
-                    } else {
-                        foc_velocity_enable(motor[0], FOC_VELOCITY_OPEN_LOOP,
-                                          target_rpm, amplitude, 1000.0f, 7);
-                        foc_velocity_enable(motor[1], FOC_VELOCITY_OPEN_LOOP,
-                                          target_rpm, amplitude, 1000.0f, 7);
-                        velocity_mode = true;
-                        printf("Velocity mode enabled (amplitude: %d%%)\n", (int)amplitude);
-                    }
-                    break;
-
-                case 'i':
-                case 'I':
-                    /* Print info */
-                    printf("\n=== Motor Control Info ===\n");
-                    printf("Mode: %s\n", velocity_mode ? "Velocity" : "Position");
-                    printf("Amplitude: %d%%\n", (int)amplitude);
-
-                    if (velocity_mode) {
-                        float rpm0, rpm1;
-                        foc_velocity_get_current(motor[0], &rpm0);
-                        foc_velocity_get_current(motor[1], &rpm1);
-                        printf("Target RPM: %d\n", (int)target_rpm);
-                        printf("Motor 0 current RPM: %d\n", (int)rpm0);
-                        printf("Motor 1 current RPM: %d\n", (int)rpm1);
-                    } else {
-                        printf("Position angle: %d deg\n", (int)angle);
-                    }
-
-                    /* Print current sensing info */
-                    float current_a = 0.0f;
-                    foc_current_get(motor[1], &current_a);
-                    printf("Motor 1 current: %d mA (limit: %d A)\n",
-                           (int)(current_a * 1000),
-                           (int)motor[1]->current_cfg.current_limit_a);
-
-                    /* Read encoder angles */
-                    float angle0, angle1;
-                    if (mt6701_read_angle_deg(&encoder_motor0, &angle0) == 0 &&
-                        mt6701_read_angle_deg(&encoder_motor1, &angle1) == 0) {
-                        printf("Encoder 0: %d deg\n", (int)angle0);
-                        printf("Encoder 1: %d deg\n", (int)angle1);
-                    }
-                    printf("========================\n\n");
-                    break;
-
-                default:
-                    /* In position mode, use angle control */
-                    if (!velocity_mode) {
-                        angle += 10.0f;
-                        if (angle >= 360.0f) {
-                            angle -= 360.0f;
-                        }
-                        pwm_set_vector(pwm_dev[0], angle, amplitude);
-                        pwm_set_vector(pwm_dev[1], angle, amplitude);
-                        printf("Position: %d deg (amplitude: %d%%)\n", (int)angle, (int)amplitude);
-                    }
-                    break;
-            }
+        if (event_pending() == 0) {
+            monitor_idle();
+            continue;
         }
 
-        if (command & CMD_RESET) {
-            command &= ~CMD_RESET;
-            NVIC_SystemReset();
+        if (event_take(EVENT_UART_RX)) {
+            uint8_t buf[32];
+            uint32_t n;
+
+            /* Console keys and protocol frames */
+            while ((n = uart_in_read(buf, sizeof(buf))) > 0) {
+                proto_port_receive(&proto_uart, buf, n);
+            }
         }
 
-        if (command & CMD_ADC) {
-            command &= ~CMD_ADC;
+        if (event_take(EVENT_PROTO_RX)) {
+            proto_port_poll(&proto_usb);
+            proto_port_poll(&proto_can);
+        }
 
-            // Handle ADC command
+        if (event_take(EVENT_RESET)) {
+            NVIC_SystemReset();
         }
 
-        if (cnt++ >= 350000) {
-            cnt = 0;
-            HAL_GPIO_TogglePin(GPIOC, GPIO_PIN_6);
-
-            /* ADC testing */
-            //uint16_t adc_values[5];
-            //adc_dma_get_all_channels(adc_values, 5);
-            // printf("ADC Values: %u %u %u %u %u\n",
-            //        adc_values[0], adc_values[1],
-            //        adc_values[2], adc_values[3],
-            //        adc_values[4]);
-
-            /* MT6701 testing */
-            // float angle0, angle1;
-            // mt6701_read_angle_deg(&encoder_motor0, &angle0);
-            // mt6701_read_angle_deg(&encoder_motor1, &angle1);
-            // printf("Encoder angles: motor0=%d deg, motor1=%d deg\n", (int)angle0, (int)angle1);
-
-            /* Send CAN frame with ADC1 value */
-            // uint8_t can_data[2];
-            // can_data[0] = (adc_values[0] >> 8) & 0xFF;  /* ADC1 high byte */
-            // can_data[1] = adc_values[0] & 0xFF;         /* ADC1 low byte */
-            // can_transmit(0x100, can_data, 2);
+        if (event_take(EVENT_ADC)) {
+            noise_report();
+        }
 
+        if (event_take(EVENT_MONITOR)) {
+            control_start();
         }
 
-        if (command & CMD_PWM) {
-            command &= ~CMD_PWM;
-            foc_task();
+        if (event_take(EVENT_SCHED)) {
+            sched_run();
         }
     }
 }
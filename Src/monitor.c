@@ -0,0 +1,246 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "monitor.h"
+#include "main.h"
+#include "irq.h"
+#include <string.h>
+
+/* Load accounting (main loop only) */
+static volatile uint32_t idle_spins;
+static uint32_t cycles_per_spin_q8;
+
+/* Calibration: idle_spins value that ends the current round */
+static uint32_t calib_end;
+static struct {
+	monitor_notify_t done;
+	uint32_t start;
+	uint32_t round;
+	uint32_t best;
+	bool active;
+} calib;
+static uint32_t window_start;
+static uint32_t window_spins;
+static struct monitor_load load_stats;
+
+/* Tick jitter (written from the tick interrupt) */
+static struct monitor_jitter jitter;
+static uint32_t tick_last;
+static bool tick_started;
+
+static inline uint32_t cycles(void)
+{
+	return DWT->CYCCNT;
+}
+
+static void window_restart(void)
+{
+	window_start = cycles();
+	window_spins = idle_spins;
+}
+
+int monitor_calibrate(monitor_notify_t done)
+{
+	if (calib.active) {
+		return -1;
+	}
+
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+	calib.done = done;
+	calib.round = 0;
+	calib.best = UINT32_MAX;
+	calib.active = true;
+
+	/* The first idle pass opens round 1, so every round has the same ends */
+	calib_end = idle_spins + 1U;
+
+	return 0;
+}
+
+bool monitor_calibrating(void)
+{
+	return calib.active;
+}
+
+uint32_t monitor_get_baseline(void)
+{
+	return cycles_per_spin_q8;
+}
+
+/**
+ * @brief End of a calibration round, from monitor_idle()
+ *
+ * Rounds are timed between two calls of this, leaving its own time
+ * out; the cheapest round is the one nothing interrupted.
+ */
+static void calib_round(void)
+{
+	uint32_t q8;
+
+	/* idle_spins wrapped onto a stale calib_end */
+	if (!calib.active) {
+		return;
+	}
+
+	if (calib.round > 0) {
+		q8 = (uint32_t)(((uint64_t)(cycles() - calib.start) << 8) / MONITOR_CALIB_SPINS);
+		if (q8 < calib.best) {
+			calib.best = q8;
+		}
+	}
+
+	if (calib.round++ < MONITOR_CALIB_ROUNDS) {
+		calib_end = idle_spins + MONITOR_CALIB_SPINS;
+		calib.start = cycles();
+		return;
+	}
+
+	cycles_per_spin_q8 = calib.best;
+	calib.active = false;
+	window_restart();
+	if (calib.done) {
+		calib.done();
+	}
+}
+
+void monitor_set_period(uint32_t period_cycles)
+{
+	uint32_t primask = irq_save();
+
+	jitter.period = period_cycles;
+	tick_started = false;
+	irq_restore(primask);
+}
+
+void monitor_idle(void)
+{
+	/* The same compare with or without a calibration running */
+	if (++idle_spins == calib_end) {
+		calib_round();
+	}
+}
+
+uint16_t monitor_update(void)
+{
+	uint32_t now = cycles();
+	uint32_t elapsed = now - window_start;
+	uint64_t idle;
+	uint16_t load = 0;
+
+	if (elapsed == 0 || cycles_per_spin_q8 == 0) {
+		return 0;
+	}
+
+	idle = ((uint64_t)(idle_spins - window_spins) * cycles_per_spin_q8) >> 8;
+	if (idle < elapsed) {
+		load = (uint16_t)(1000U - (uint32_t)(idle * 1000U / elapsed));
+	}
+
+	load_stats.load = load;
+	if (load > load_stats.peak) {
+		load_stats.peak = load;
+	}
+	load_stats.windows++;
+
+	window_start = now;
+	window_spins = idle_spins;
+
+	return load;
+}
+
+void monitor_tick(uint32_t now)
+{
+	int32_t err;
+	int32_t bin;
+
+	if (tick_started && jitter.period > 0) {
+		err = (int32_t)(now - tick_last - jitter.period);
+
+		/* Floor division so bin 0 above the centre starts at zero */
+		if (err >= 0) {
+			bin = err / (int32_t)MONITOR_JITTER_BIN_CYCLES;
+		} else {
+			bin = -((-err + (int32_t)MONITOR_JITTER_BIN_CYCLES - 1) /
+			        (int32_t)MONITOR_JITTER_BIN_CYCLES);
+		}
+		bin += MONITOR_JITTER_BINS / 2;
+		if (bin < 0) {
+			bin = 0;
+		} else if (bin >= (int32_t)MONITOR_JITTER_BINS) {
+			bin = MONITOR_JITTER_BINS - 1;
+		}
+		jitter.hist[bin]++;
+
+		if (jitter.ticks == 0 || err < jitter.min) {
+			jitter.min = err;
+		}
+		if (jitter.ticks == 0 || err > jitter.max) {
+			jitter.max = err;
+		}
+		jitter.ticks++;
+	}
+
+	tick_last = now;
+	tick_started = true;
+}
+
+void monitor_get_load(struct monitor_load *load)
+{
+	*load = load_stats;
+}
+
+void monitor_get_jitter(struct monitor_jitter *out)
+{
+	uint32_t primask = irq_save();
+
+	*out = jitter;
+	irq_restore(primask);
+}
+
+static int16_t cycles_to_ns_sat(int32_t c)
+{
+	int64_t ns = (int64_t)c * 1000 / (int64_t)(SystemCoreClock / 1000000U);
+
+	if (ns > INT16_MAX) {
+		return INT16_MAX;
+	} else if (ns < INT16_MIN) {
+		return INT16_MIN;
+	}
+	return (int16_t)ns;
+}
+
+void monitor_pack_can(uint8_t data[MONITOR_CAN_LEN])
+{
+	struct monitor_jitter j;
+	uint16_t fields[4];
+
+	monitor_get_jitter(&j);
+	fields[0] = load_stats.load;
+	fields[1] = load_stats.peak;
+	fields[2] = (uint16_t)cycles_to_ns_sat(j.min);
+	fields[3] = (uint16_t)cycles_to_ns_sat(j.max);
+
+	for (int i = 0; i < 4; i++) {
+		data[2 * i] = fields[i] & 0xFF;
+		data[2 * i + 1] = (fields[i] >> 8) & 0xFF;
+	}
+}
+
+void monitor_reset(void)
+{
+	uint32_t primask = irq_save();
+	uint32_t period = jitter.period;
+
+	memset(&jitter, 0, sizeof(jitter));
+	jitter.period = period;
+	tick_started = false;
+	irq_restore(primask);
+
+	memset(&load_stats, 0, sizeof(load_stats));
+	window_restart();
+}
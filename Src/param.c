@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "param.h"
+#include "store.h"
+#include "main.h"
+#include "irq.h"
+#include <stddef.h>
+#include <string.h>
+
+#define PARAM_SIZE_PARAM_U8   sizeof(uint8_t)
+#define PARAM_SIZE_PARAM_F32  sizeof(float)
+
+#define PARAM_FIELD_SIZE(field) sizeof(((struct foc_motor *)0)->field)
+
+/* A field of the wrong size for its type does not build */
+#define PARAM_CHECK(id, name, type, field, min, max, flags) \
+	_Static_assert(PARAM_FIELD_SIZE(field) == PARAM_SIZE_##type, #id " type");
+PARAMS(PARAM_CHECK)
+#undef PARAM_CHECK
+
+_Static_assert(PARAM_NUM <= 0x40, "PARAM_STORE_KEY() has room for 64 parameters");
+
+static const struct param_info params[PARAM_NUM] = {
+#define PARAM_ENTRY(id, name, type, field, min, max, flags) \
+	[id] = {name, type, flags, offsetof(struct foc_motor, field), min, max},
+	PARAMS(PARAM_ENTRY)
+#undef PARAM_ENTRY
+};
+
+const struct param_info *param_info(uint16_t id)
+{
+	return id < PARAM_NUM ? &params[id] : NULL;
+}
+
+int param_find(const char *name)
+{
+	for (int id = 0; id < PARAM_NUM; id++) {
+		if (strcmp(params[id].name, name) == 0) {
+			return id;
+		}
+	}
+
+	return -1;
+}
+
+int param_get(const struct foc_motor *motor, uint16_t id, float *value)
+{
+	const uint8_t *field;
+
+	if (!motor || !value || id >= PARAM_NUM) {
+		return -1;
+	}
+
+	field = (const uint8_t *)motor + params[id].offset;
+	if (params[id].type == PARAM_U8) {
+		*value = (float)*(const volatile uint8_t *)field;
+	} else {
+		*value = *(const volatile float *)field;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Check that a value may be stored
+ */
+static int param_check(const struct foc_motor *motor, uint16_t id, float value)
+{
+	const struct param_info *p;
+
+	if (id >= PARAM_NUM) {
+		return -1;
+	}
+	p = &params[id];
+
+	/* Written as !(in range) so that NaN fails too */
+	if ((p->flags & PARAM_READONLY) || !(value >= p->min && value <= p->max)) {
+		return -1;
+	}
+	if (p->type == PARAM_U8 && value != (float)(uint8_t)value) {
+		return -1;
+	}
+	if ((p->flags & PARAM_STOPPED) && motor->velocity_cfg.mode != FOC_VELOCITY_DISABLED) {
+		return -2;
+	}
+
+	return 0;
+}
+
+static void param_store(struct foc_motor *motor, uint16_t id, float value)
+{
+	uint8_t *field = (uint8_t *)motor + params[id].offset;
+
+	if (params[id].type == PARAM_U8) {
+		*(volatile uint8_t *)field = (uint8_t)value;
+	} else {
+		*(volatile float *)field = value;
+	}
+}
+
+int param_set(struct foc_motor *motor, uint16_t id, float value)
+{
+	struct param_value v = {id, value};
+
+	return param_set_many(motor, &v, 1);
+}
+
+int param_set_many(struct foc_motor *motor, const struct param_value *values, uint32_t count)
+{
+	uint32_t primask;
+	int ret;
+
+	if (!motor || (!values && count)) {
+		return -1;
+	}
+
+	for (uint32_t i = 0; i < count; i++) {
+		ret = param_check(motor, values[i].id, values[i].value);
+		if (ret != 0) {
+			return ret;
+		}
+	}
+
+	primask = irq_save();
+	for (uint32_t i = 0; i < count; i++) {
+		param_store(motor, values[i].id, values[i].value);
+	}
+	foc_current_update_scale(&motor->current_cfg);
+	irq_restore(primask);
+
+	return 0;
+}
+
+int param_save(const struct foc_motor *motor, uint8_t axis, uint16_t id)
+{
+	float value;
+
+	/* What param_load() would refuse is not worth the flash */
+	if (id >= PARAM_NUM || (params[id].flags & PARAM_READONLY) ||
+	    param_get(motor, id, &value) != 0 ||
+	    !(value >= params[id].min && value <= params[id].max)) {
+		return -1;
+	}
+
+	return store_set(PARAM_STORE_KEY(axis, id), &value, sizeof(value));
+}
+
+int param_save_all(const struct foc_motor *motor, uint8_t axis)
+{
+	float value;
+	int ret = 0;
+
+	for (uint16_t id = 0; id < PARAM_NUM; id++) {
+		if (params[id].flags & PARAM_READONLY) {
+			continue;
+		}
+
+		/* Not set up yet, e.g. vbus before torque mode */
+		if (param_get(motor, id, &value) != 0 ||
+		    !(value >= params[id].min && value <= params[id].max)) {
+			continue;
+		}
+
+		if (param_save(motor, axis, id) != 0) {
+			ret = -1;
+		}
+	}
+
+	return ret;
+}
+
+int param_load(struct foc_motor *motor, uint8_t axis)
+{
+	float value;
+	int count = 0;
+
+	for (uint16_t id = 0; id < PARAM_NUM; id++) {
+		if (store_get(PARAM_STORE_KEY(axis, id), &value, sizeof(value)) == 0 &&
+		    param_set(motor, id, value) == 0) {
+			count++;
+		}
+	}
+
+	return count;
+}
+
+bool param_saved(uint8_t axis, uint16_t id)
+{
+	float value;
+
+	return store_get(PARAM_STORE_KEY(axis, id), &value, sizeof(value)) == 0;
+}
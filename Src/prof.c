@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "prof.h"
+#include "irq.h"
+#include <stdio.h>
+#include <string.h>
+
+#define PROF_NAME(id, name) [id] = name,
+static const char *const prof_names[PROF_NUM_IDS] = {
+	PROF_PROBES(PROF_NAME)
+};
+#undef PROF_NAME
+
+static struct prof_stats prof_probes[PROF_NUM_IDS];
+static uint32_t prof_overhead;
+
+void prof_init(void)
+{
+	uint32_t start, cycles, best = UINT32_MAX;
+
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+	/* Cost of reading the counter twice, as an empty probe does */
+	for (int i = 0; i < 8; i++) {
+		start = prof_now();
+		cycles = prof_now() - start;
+		if (cycles < best) {
+			best = cycles;
+		}
+	}
+	prof_overhead = best;
+
+	prof_reset();
+}
+
+void prof_record(enum prof_id id, uint32_t cycles)
+{
+	struct prof_stats *p;
+	uint32_t primask;
+
+	if ((unsigned int)id >= PROF_NUM_IDS) {
+		return;
+	}
+	p = &prof_probes[id];
+	cycles = cycles > prof_overhead ? cycles - prof_overhead : 0;
+
+	primask = irq_save();
+	if (p->count == 0 || cycles < p->min) {
+		p->min = cycles;
+	}
+	if (cycles > p->max) {
+		p->max = cycles;
+	}
+	p->last = cycles;
+	p->total += cycles;
+	p->count++;
+	irq_restore(primask);
+}
+
+int prof_get(enum prof_id id, struct prof_stats *stats)
+{
+	uint32_t primask;
+
+	if ((unsigned int)id >= PROF_NUM_IDS || !stats) {
+		return -1;
+	}
+
+	primask = irq_save();
+	*stats = prof_probes[id];
+	irq_restore(primask);
+
+	return 0;
+}
+
+const char *prof_name(enum prof_id id)
+{
+	if ((unsigned int)id >= PROF_NUM_IDS) {
+		return NULL;
+	}
+
+	return prof_names[id];
+}
+
+void prof_reset(void)
+{
+	uint32_t primask = irq_save();
+
+	memset(prof_probes, 0, sizeof(prof_probes));
+	irq_restore(primask);
+}
+
+void prof_dump(void)
+{
+	struct prof_stats s;
+	uint32_t cycles_per_us = SystemCoreClock / 1000000U;
+
+#if !PROF_ENABLE
+	printf("Profiling disabled (PROF_ENABLE=0)\n");
+	return;
+#endif
+
+	printf("%-22s %8s %7s %7s %7s %7s %8s\n",
+	       "probe", "calls", "min", "avg", "max", "last", "max(us)");
+	for (int id = 0; id < PROF_NUM_IDS; id++) {
+		prof_get((enum prof_id)id, &s);
+		if (s.count == 0) {
+			continue;
+		}
+		printf("%-22s %8lu %7lu %7lu %7lu %7lu %8lu\n", prof_names[id],
+		       (unsigned long)s.count, (unsigned long)s.min,
+		       (unsigned long)(s.total / s.count), (unsigned long)s.max,
+		       (unsigned long)s.last, (unsigned long)(s.max / cycles_per_us));
+	}
+}
@@ -0,0 +1,364 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "proto.h"
+#include "main.h"
+#include "irq.h"
+
+static proto_handler_t handler;
+static const struct scope_signal *regs;
+static uint8_t num_regs;
+
+/* CRC-16/CCITT-FALSE, a nibble at a time */
+static const uint16_t crc_table[16] = {
+	0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+	0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+};
+
+uint16_t proto_crc16(const uint8_t *data, uint32_t len)
+{
+	uint16_t crc = 0xFFFF;
+
+	for (uint32_t i = 0; i < len; i++) {
+		crc = (uint16_t)(crc << 4) ^ crc_table[(crc >> 12) ^ (data[i] >> 4)];
+		crc = (uint16_t)(crc << 4) ^ crc_table[(crc >> 12) ^ (data[i] & 0x0F)];
+	}
+
+	return crc;
+}
+
+uint32_t proto_cobs_encode(const uint8_t *in, uint32_t len, uint8_t *out)
+{
+	uint32_t code_pos = 0;
+	uint32_t o = 1;
+	uint8_t code = 1;
+
+	for (uint32_t i = 0; i < len; i++) {
+		if (in[i] == 0) {
+			out[code_pos] = code;
+			code_pos = o++;
+			code = 1;
+			continue;
+		}
+		out[o++] = in[i];
+		if (++code == 0xFF) {
+			out[code_pos] = code;
+			code_pos = o++;
+			code = 1;
+		}
+	}
+	out[code_pos] = code;
+
+	return o;
+}
+
+int32_t proto_cobs_decode(const uint8_t *in, uint32_t len, uint8_t *out)
+{
+	uint32_t i = 0;
+	uint32_t o = 0;
+
+	/* The output never overtakes the input, so in == out works */
+	while (i < len) {
+		uint8_t code = in[i++];
+
+		if (code == 0 || i + code - 1U > len) {
+			return -1;
+		}
+		for (uint8_t k = 1; k < code; k++) {
+			if (in[i] == 0) {
+				return -1;
+			}
+			out[o++] = in[i++];
+		}
+		if (code != 0xFF && i < len) {
+			out[o++] = 0;
+		}
+	}
+
+	return (int32_t)o;
+}
+
+uint32_t proto_frame_encode(uint8_t *frame, uint32_t len, uint8_t *out)
+{
+	uint32_t n;
+
+	proto_put_u16(&frame[len], proto_crc16(frame, len));
+
+	out[0] = 0;
+	n = proto_cobs_encode(frame, len + 2U, &out[1]);
+	out[n + 1U] = 0;
+
+	return n + 2U;
+}
+
+void proto_pack_state(const struct proto_state *s, uint8_t *buf)
+{
+	buf[0] = s->mode;
+	buf[1] = s->flags;
+	proto_put_f32(&buf[2], s->target_rpm);
+	proto_put_f32(&buf[6], s->ramp_rpm);
+	proto_put_f32(&buf[10], s->measured_rpm);
+	proto_put_f32(&buf[14], s->amplitude);
+	proto_put_f32(&buf[18], s->electrical_angle);
+	proto_put_f32(&buf[22], s->ia);
+	proto_put_f32(&buf[26], s->ib);
+	proto_put_f32(&buf[30], s->id);
+	proto_put_f32(&buf[34], s->iq);
+}
+
+void proto_unpack_state(const uint8_t *buf, struct proto_state *s)
+{
+	s->mode = buf[0];
+	s->flags = buf[1];
+	s->target_rpm = proto_get_f32(&buf[2]);
+	s->ramp_rpm = proto_get_f32(&buf[6]);
+	s->measured_rpm = proto_get_f32(&buf[10]);
+	s->amplitude = proto_get_f32(&buf[14]);
+	s->electrical_angle = proto_get_f32(&buf[18]);
+	s->ia = proto_get_f32(&buf[22]);
+	s->ib = proto_get_f32(&buf[26]);
+	s->id = proto_get_f32(&buf[30]);
+	s->iq = proto_get_f32(&buf[34]);
+}
+
+void proto_set_handler(proto_handler_t h)
+{
+	handler = h;
+}
+
+void proto_set_registers(const struct scope_signal *table, uint8_t count)
+{
+	regs = table;
+	num_regs = table ? count : 0;
+}
+
+void proto_port_init(struct proto_port *port, proto_write_t write, proto_text_t text)
+{
+	memset(port, 0, sizeof(*port));
+	port->write = write;
+	port->text = text;
+	port->in_frame = !text;
+}
+
+void proto_port_set_busy(struct proto_port *port, proto_busy_t busy)
+{
+	port->busy = busy;
+}
+
+/**
+ * @brief READ_REGS: all values from the same instant
+ */
+static uint8_t proto_read_regs(const uint8_t *req, uint16_t len, uint8_t *resp,
+                               uint16_t *resp_len)
+{
+	uint32_t primask;
+
+	if (len == 0 || len > PROTO_MAX_PAYLOAD / 4U) {
+		return PROTO_ERR_LEN;
+	}
+	for (uint16_t i = 0; i < len; i++) {
+		if (req[i] >= num_regs) {
+			return PROTO_ERR_ARG;
+		}
+	}
+
+	/* No control tick in between, a few hundred cycles at most */
+	primask = irq_save();
+	for (uint16_t i = 0; i < len; i++) {
+		proto_put_f32(&resp[i * 4U], scope_signal_value(&regs[req[i]]));
+	}
+	irq_restore(primask);
+
+	*resp_len = len * 4U;
+	return PROTO_OK;
+}
+
+static uint8_t proto_execute(uint8_t cmd, const uint8_t *req, uint16_t len, uint8_t *resp,
+                             uint16_t *resp_len)
+{
+	size_t name_len;
+
+	switch (cmd) {
+	case PROTO_CMD_PING:
+		if (len != 0) {
+			return PROTO_ERR_LEN;
+		}
+		resp[0] = PROTO_VERSION;
+		resp[1] = num_regs;
+		*resp_len = 2;
+		return PROTO_OK;
+
+	case PROTO_CMD_READ_REGS:
+		return proto_read_regs(req, len, resp, resp_len);
+
+	case PROTO_CMD_REG_INFO:
+		if (len != 1) {
+			return PROTO_ERR_LEN;
+		}
+		if (req[0] >= num_regs) {
+			return PROTO_ERR_ARG;
+		}
+		name_len = strnlen(regs[req[0]].name, PROTO_MAX_PAYLOAD - 1U);
+		resp[0] = regs[req[0]].type;
+		memcpy(&resp[1], regs[req[0]].name, name_len);
+		*resp_len = 1U + name_len;
+		return PROTO_OK;
+
+	default:
+		return handler ? handler(cmd, req, len, resp, resp_len) : PROTO_ERR_CMD;
+	}
+}
+
+static void proto_send(struct proto_port *port)
+{
+	port->tx_pending = port->write(port->tx, port->tx_len) != 0;
+	if (port->tx_pending) {
+		port->stats.tx_errors++;
+	}
+}
+
+/**
+ * @brief Handle a received frame
+ *
+ * @return true if it was a valid request
+ */
+static bool proto_frame(struct proto_port *port)
+{
+	static uint8_t frame[PROTO_MAX_FRAME];
+	uint16_t resp_len = 0;
+	uint8_t seq, cmd;
+	int32_t n;
+
+	if (port->rx_overflow) {
+		port->stats.frame_errors++;
+		return false;
+	}
+
+	n = proto_cobs_decode(port->rx, port->rx_len, port->rx);
+	if (n < 4) {
+		port->stats.frame_errors++;
+		return false;
+	}
+	if (proto_crc16(port->rx, n - 2) != proto_get_u16(&port->rx[n - 2])) {
+		port->stats.crc_errors++;
+		return false;
+	}
+
+	seq = port->rx[0];
+	cmd = port->rx[1];
+
+	/* Retry of a request whose response got lost: do not run it twice */
+	if (port->have_last && seq == port->last_seq && cmd == port->last_cmd) {
+		port->stats.repeats++;
+		proto_send(port);
+		return true;
+	}
+	port->stats.requests++;
+
+	frame[0] = seq;
+	frame[1] = cmd | PROTO_RESPONSE;
+	frame[2] = proto_execute(cmd, &port->rx[2], (uint16_t)(n - 4), &frame[3], &resp_len);
+	port->tx_len = (uint16_t)proto_frame_encode(frame, 3U + resp_len, port->tx);
+	port->have_last = true;
+	port->last_seq = seq;
+	port->last_cmd = cmd;
+	proto_send(port);
+
+	return true;
+}
+
+/**
+ * @brief Handle one received byte
+ */
+static void proto_byte(struct proto_port *port, uint8_t b)
+{
+	if (!port->in_frame) {
+		if (b == 0) {
+			port->in_frame = true;
+		} else {
+			port->text(b);
+		}
+		return;
+	}
+
+	if (b != 0) {
+		if (port->rx_len < sizeof(port->rx)) {
+			port->rx[port->rx_len++] = b;
+		} else {
+			port->rx_overflow = true;
+		}
+		return;
+	}
+
+	/* Back-to-back delimiters are an empty frame, skip them */
+	if (port->rx_len == 0 && !port->rx_overflow) {
+		return;
+	}
+
+	/*
+	 * Only a valid frame hands the port back to the text callback: a
+	 * broken one may have ended at the leading delimiter of the next.
+	 * Runaway input (a stray zero on the console) does too.
+	 */
+	if ((proto_frame(port) || port->rx_overflow) && port->text) {
+		port->in_frame = false;
+	}
+	port->rx_len = 0;
+	port->rx_overflow = false;
+}
+
+void proto_port_receive(struct proto_port *port, const uint8_t *data, uint32_t len)
+{
+	for (uint32_t i = 0; i < len; i++) {
+		proto_byte(port, data[i]);
+	}
+}
+
+uint32_t proto_port_push(struct proto_port *port, const uint8_t *data, uint32_t len)
+{
+	uint16_t head = port->head;
+	uint16_t tail = __atomic_load_n(&port->tail, __ATOMIC_ACQUIRE);
+	uint16_t next;
+	uint32_t i;
+
+	for (i = 0; i < len; i++) {
+		next = (head + 1U) & (PROTO_RX_RING_SIZE - 1U);
+		if (next == tail) {
+			port->stats.dropped += len - i;
+			break;
+		}
+		port->ring[head] = data[i];
+		head = next;
+	}
+	__atomic_store_n(&port->head, head, __ATOMIC_RELEASE);
+
+	return i;
+}
+
+/**
+ * @brief The last response still needs port->tx
+ */
+static inline bool proto_tx_busy(const struct proto_port *port)
+{
+	return port->tx_pending || (port->busy && port->busy(port->tx));
+}
+
+void proto_port_poll(struct proto_port *port)
+{
+	uint16_t head = __atomic_load_n(&port->head, __ATOMIC_ACQUIRE);
+	uint16_t tail = port->tail;
+
+	if (port->tx_pending) {
+		port->tx_pending = port->write(port->tx, port->tx_len) != 0;
+	}
+
+	/* Only a frame delimiter can encode a new response into port->tx */
+	while (tail != head && !(port->ring[tail] == 0 && proto_tx_busy(port))) {
+		proto_byte(port, port->ring[tail]);
+		tail = (tail + 1U) & (PROTO_RX_RING_SIZE - 1U);
+	}
+	__atomic_store_n(&port->tail, tail, __ATOMIC_RELEASE);
+}
@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "scheduler.h"
+#include "main.h"
+#include <stdio.h>
+
+static struct sched_task *sched_tasks;
+static size_t sched_count;
+static sched_notify_t sched_notify;
+static volatile uint32_t sched_ticks;
+
+static inline uint32_t sched_cycles(void)
+{
+	return DWT->CYCCNT;
+}
+
+/**
+ * @brief Run one task and account for its time
+ */
+static void sched_exec(struct sched_task *t, uint32_t release)
+{
+	uint32_t start, end;
+
+	start = sched_cycles();
+	t->run();
+	end = sched_cycles();
+
+	t->exec_last = end - start;
+	if (t->exec_last > t->exec_max) {
+		t->exec_max = t->exec_last;
+	}
+	if (end - release > t->deadline) {
+		t->misses++;
+	}
+	t->runs++;
+}
+
+int sched_init(struct sched_task *tasks, size_t count, sched_notify_t notify)
+{
+	uint32_t cycles_per_tick;
+
+	if (!tasks && count > 0) {
+		return -1;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		struct sched_task *t = &tasks[i];
+
+		if (!t->run || t->period == 0 || t->offset >= t->period) {
+			printf("sched: invalid task %s\n", t->name ? t->name : "?");
+			return -1;
+		}
+	}
+
+	/* Cycle counter for execution times and deadlines */
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+	cycles_per_tick = SystemCoreClock / SCHED_TICK_HZ;
+
+	for (size_t i = 0; i < count; i++) {
+		struct sched_task *t = &tasks[i];
+
+		t->pending = false;
+		t->countdown = t->offset;
+		t->release = 0;
+		if (t->deadline_us > 0) {
+			t->deadline = t->deadline_us * (SystemCoreClock / 1000000U);
+		} else {
+			t->deadline = t->period * cycles_per_tick;
+		}
+		t->runs = 0;
+		t->overruns = 0;
+		t->misses = 0;
+		t->exec_last = 0;
+		t->exec_max = 0;
+	}
+
+	sched_tasks = tasks;
+	sched_count = count;
+	sched_notify = notify;
+	sched_ticks = 0;
+
+	return 0;
+}
+
+void sched_tick(void)
+{
+	uint32_t now = sched_cycles();
+	bool released = false;
+
+	sched_ticks++;
+
+	for (size_t i = 0; i < sched_count; i++) {
+		struct sched_task *t = &sched_tasks[i];
+
+		if (t->countdown > 0) {
+			t->countdown--;
+			continue;
+		}
+		t->countdown = t->period - 1U;
+
+		if (t->context == SCHED_ISR) {
+			sched_exec(t, now);
+		} else if (__atomic_load_n(&t->pending, __ATOMIC_ACQUIRE)) {
+			/* The main loop has not got to the previous release yet */
+			t->overruns++;
+		} else {
+			t->release = now;
+			__atomic_store_n(&t->pending, true, __ATOMIC_RELEASE);
+			released = true;
+		}
+	}
+
+	if (released && sched_notify) {
+		sched_notify();
+	}
+}
+
+int sched_run(void)
+{
+	int count = 0;
+
+	for (size_t i = 0; i < sched_count; i++) {
+		struct sched_task *t = &sched_tasks[i];
+
+		if (t->context != SCHED_MAIN || !__atomic_load_n(&t->pending, __ATOMIC_ACQUIRE)) {
+			continue;
+		}
+
+		sched_exec(t, t->release);
+
+		/* Only now may the next release go through */
+		__atomic_store_n(&t->pending, false, __ATOMIC_RELEASE);
+		count++;
+	}
+
+	return count;
+}
+
+uint32_t sched_get_ticks(void)
+{
+	return sched_ticks;
+}
+
+const struct sched_task *sched_get_task(size_t index)
+{
+	if (index >= sched_count) {
+		return NULL;
+	}
+
+	return &sched_tasks[index];
+}
+
+uint32_t sched_cycles_to_us(uint32_t cycles)
+{
+	return cycles / (SystemCoreClock / 1000000U);
+}
@@ -0,0 +1,222 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "scope.h"
+#include <string.h>
+
+static float scope_buf[SCOPE_BUFFER_SAMPLES];
+static struct scope_config cfg;
+static bool configured;
+static uint32_t depth;
+
+/* Capture state; the interrupt only runs while ARMED or TRIGGERED */
+static volatile enum scope_state state;
+static volatile bool force;
+static uint32_t pos;                 /* Next row to write */
+static uint32_t filled;              /* Rows written since arming */
+static uint32_t remaining;           /* Post-trigger rows still to write */
+static uint32_t trigger_row;
+static uint16_t decim_count;
+static float prev_level;
+static bool have_prev;
+
+float scope_signal_value(const struct scope_signal *sig)
+{
+	switch (sig->type) {
+	case SCOPE_F32:
+		return *(const volatile float *)sig->addr;
+	case SCOPE_U32:
+		return (float)*(const volatile uint32_t *)sig->addr;
+	case SCOPE_U16:
+		return (float)*(const volatile uint16_t *)sig->addr;
+	case SCOPE_BOOL:
+		return *(const volatile bool *)sig->addr ? 1.0f : 0.0f;
+	}
+
+	return 0.0f;
+}
+
+int scope_configure(const struct scope_config *config)
+{
+	uint32_t d;
+
+	if (!config || state == SCOPE_ARMED || state == SCOPE_TRIGGERED) {
+		return -1;
+	}
+	if (config->num_channels == 0 || config->num_channels > SCOPE_MAX_CHANNELS) {
+		return -1;
+	}
+	for (uint8_t i = 0; i < config->num_channels; i++) {
+		if (!config->channels[i] || !config->channels[i]->addr) {
+			return -1;
+		}
+	}
+	if ((config->mode == SCOPE_TRIG_RISING || config->mode == SCOPE_TRIG_FALLING) &&
+	    (!config->trigger || !config->trigger->addr)) {
+		return -1;
+	}
+
+	d = config->depth ? config->depth : SCOPE_BUFFER_SAMPLES / config->num_channels;
+	if (d == 0 || d * config->num_channels > SCOPE_BUFFER_SAMPLES ||
+	    config->pre_trigger >= d) {
+		return -1;
+	}
+
+	cfg = *config;
+	depth = d;
+	configured = true;
+	state = SCOPE_IDLE;
+
+	return 0;
+}
+
+int scope_arm(void)
+{
+	if (!configured || state == SCOPE_ARMED || state == SCOPE_TRIGGERED) {
+		return -1;
+	}
+
+	pos = 0;
+	filled = 0;
+	remaining = 0;
+	trigger_row = 0;
+	decim_count = 0;
+	have_prev = false;
+	force = false;
+
+	/* Everything above is in place before the interrupt sees ARMED */
+	__atomic_store_n(&state, SCOPE_ARMED, __ATOMIC_RELEASE);
+
+	return 0;
+}
+
+void scope_force(void)
+{
+	if (state == SCOPE_ARMED) {
+		force = true;
+	}
+}
+
+void scope_release(void)
+{
+	state = SCOPE_IDLE;
+}
+
+/**
+ * @brief Check the trigger condition on the sample just taken
+ */
+static bool scope_triggered(void)
+{
+	float v;
+	bool edge = false;
+
+	if (cfg.mode == SCOPE_TRIG_RISING || cfg.mode == SCOPE_TRIG_FALLING) {
+		v = scope_signal_value(cfg.trigger);
+		if (have_prev) {
+			if (cfg.mode == SCOPE_TRIG_RISING) {
+				edge = prev_level < cfg.level && v >= cfg.level;
+			} else {
+				edge = prev_level > cfg.level && v <= cfg.level;
+			}
+		}
+		prev_level = v;
+		have_prev = true;
+	}
+
+	/* Edges before the pre-trigger part is full are missed on purpose */
+	if (filled <= cfg.pre_trigger) {
+		return false;
+	}
+
+	return force || edge || cfg.mode == SCOPE_TRIG_AUTO;
+}
+
+void scope_sample(void)
+{
+	enum scope_state s = __atomic_load_n(&state, __ATOMIC_ACQUIRE);
+	float *row;
+
+	if (s != SCOPE_ARMED && s != SCOPE_TRIGGERED) {
+		return;
+	}
+
+	if (cfg.decimation > 1) {
+		if (++decim_count < cfg.decimation) {
+			return;
+		}
+		decim_count = 0;
+	}
+
+	row = &scope_buf[pos * cfg.num_channels];
+	for (uint8_t i = 0; i < cfg.num_channels; i++) {
+		row[i] = scope_signal_value(cfg.channels[i]);
+	}
+
+	if (s == SCOPE_ARMED) {
+		if (filled < depth) {
+			filled++;
+		}
+		if (scope_triggered()) {
+			trigger_row = pos;
+			remaining = depth - cfg.pre_trigger - 1U;
+			s = remaining ? SCOPE_TRIGGERED : SCOPE_DONE;
+		}
+	} else if (--remaining == 0) {
+		s = SCOPE_DONE;
+	}
+
+	if (++pos >= depth) {
+		pos = 0;
+	}
+
+	/* scope_release() from the main loop wins over a late update */
+	if (state != SCOPE_IDLE) {
+		__atomic_store_n(&state, s, __ATOMIC_RELEASE);
+	}
+}
+
+enum scope_state scope_get_state(void)
+{
+	return __atomic_load_n(&state, __ATOMIC_ACQUIRE);
+}
+
+uint8_t scope_get_window(uint32_t *d, uint32_t *pre_trigger)
+{
+	if (!configured) {
+		return 0;
+	}
+	if (d) {
+		*d = depth;
+	}
+	if (pre_trigger) {
+		*pre_trigger = cfg.pre_trigger;
+	}
+
+	return cfg.num_channels;
+}
+
+const struct scope_signal *scope_get_channel(uint8_t index)
+{
+	if (!configured || index >= cfg.num_channels) {
+		return NULL;
+	}
+
+	return cfg.channels[index];
+}
+
+int scope_read(uint32_t index, float *row)
+{
+	uint32_t r;
+
+	if (scope_get_state() != SCOPE_DONE || index >= depth || !row) {
+		return -1;
+	}
+
+	r = (trigger_row + depth - cfg.pre_trigger + index) % depth;
+	memcpy(row, &scope_buf[r * cfg.num_channels], cfg.num_channels * sizeof(float));
+
+	return 0;
+}
@@ -0,0 +1,354 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "store.h"
+#include "drv/flash.h"
+#include <string.h>
+
+#define STORE_MAGIC          0x53434F46U  /* "FOCS" */
+#define SECTOR_SIZE          (FLASH_STORE_SIZE / 2U)
+#define SECTOR_PAGES         (FLASH_STORE_PAGES / 2U)
+#define HEADER_SIZE          16U
+#define RECORD_HEADER_SIZE   8U
+#define NO_SECTOR            (-1)
+
+/* Record size in flash, padded to whole double words */
+#define RECORD_SIZE(len) \
+	(RECORD_HEADER_SIZE + (((uint32_t)(len) + FLASH_STORE_WORD - 1U) & ~(FLASH_STORE_WORD - 1U)))
+
+struct store_entry {
+	uint16_t key;
+	uint16_t len;
+	uint32_t offset;             /* Of the record, into the flash region */
+};
+
+static struct store_entry entries[STORE_MAX_KEYS];
+static uint16_t num_entries;
+static int8_t active = NO_SECTOR;
+static uint32_t generation;
+static uint32_t write_pos;           /* Next record, into the active sector */
+static uint16_t bad_records;
+
+/* Record being checked, written or copied */
+static uint8_t record[RECORD_SIZE(STORE_MAX_VALUE)];
+
+/* Record offsets in the sector being filled by store_copy() */
+static uint32_t copy_offset[STORE_MAX_KEYS];
+
+/* CRC-32 (reflected 0xEDB88320), a nibble at a time */
+static const uint32_t crc_table[16] = {
+	0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+	0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+	0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+	0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+};
+
+static uint32_t crc32_update(uint32_t crc, const uint8_t *data, uint32_t len)
+{
+	crc = ~crc;
+	for (uint32_t i = 0; i < len; i++) {
+		crc ^= data[i];
+		crc = (crc >> 4) ^ crc_table[crc & 0x0F];
+		crc = (crc >> 4) ^ crc_table[crc & 0x0F];
+	}
+
+	return ~crc;
+}
+
+static inline void put_u16(uint8_t *p, uint16_t v)
+{
+	p[0] = v & 0xFF;
+	p[1] = (v >> 8) & 0xFF;
+}
+
+static inline void put_u32(uint8_t *p, uint32_t v)
+{
+	put_u16(p, v & 0xFFFF);
+	put_u16(p + 2, v >> 16);
+}
+
+static inline uint16_t get_u16(const uint8_t *p)
+{
+	return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t get_u32(const uint8_t *p)
+{
+	return get_u16(p) | ((uint32_t)get_u16(p + 2) << 16);
+}
+
+/**
+ * @brief CRC of the record in the buffer: key, len and value
+ */
+static uint32_t record_crc(uint16_t len)
+{
+	return crc32_update(crc32_update(0, record, 4), &record[RECORD_HEADER_SIZE], len);
+}
+
+static struct store_entry *store_find(uint16_t key)
+{
+	for (uint16_t i = 0; i < num_entries; i++) {
+		if (entries[i].key == key) {
+			return &entries[i];
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief Read a sector header
+ *
+ * @return true if the sector holds a store of this version
+ */
+static bool store_header(uint8_t sector, uint32_t *gen)
+{
+	uint8_t h[HEADER_SIZE];
+
+	if (flash_read(sector * SECTOR_SIZE, h, sizeof(h)) != 0) {
+		return false;
+	}
+	if (get_u32(&h[0]) != STORE_MAGIC || get_u16(&h[4]) != STORE_VERSION ||
+	    get_u32(&h[12]) != crc32_update(0, h, 12)) {
+		return false;
+	}
+
+	*gen = get_u32(&h[8]);
+	return true;
+}
+
+/**
+ * @brief Index the records of the active sector and find the end of the log
+ */
+static int store_scan(void)
+{
+	uint32_t base = (uint32_t)active * SECTOR_SIZE;
+	uint32_t pos = HEADER_SIZE;
+	struct store_entry *e;
+	uint16_t key, len;
+
+	while (pos + RECORD_HEADER_SIZE <= SECTOR_SIZE) {
+		if (flash_read(base + pos, record, RECORD_HEADER_SIZE) != 0) {
+			return -1;
+		}
+		key = get_u16(&record[0]);
+		len = get_u16(&record[2]);
+
+		/* Erased: end of the log */
+		if (key == STORE_KEY_NONE && len == 0xFFFF && get_u32(&record[4]) == 0xFFFFFFFFU) {
+			break;
+		}
+
+		/* Nothing after a broken length can be found, the sector counts as full */
+		if (len > STORE_MAX_VALUE || pos + RECORD_SIZE(len) > SECTOR_SIZE) {
+			bad_records++;
+			pos = SECTOR_SIZE;
+			break;
+		}
+
+		if (flash_read(base + pos + RECORD_HEADER_SIZE, &record[RECORD_HEADER_SIZE],
+		               len) != 0) {
+			return -1;
+		}
+		if (key == STORE_KEY_NONE || get_u32(&record[4]) != record_crc(len)) {
+			bad_records++;
+		} else if ((e = store_find(key)) != NULL) {
+			e->len = len;
+			e->offset = base + pos;
+		} else if (num_entries < STORE_MAX_KEYS) {
+			entries[num_entries].key = key;
+			entries[num_entries].len = len;
+			entries[num_entries].offset = base + pos;
+			num_entries++;
+		}
+
+		pos += RECORD_SIZE(len);
+	}
+
+	write_pos = pos;
+	return 0;
+}
+
+int store_init(void)
+{
+	uint32_t gen[2];
+	bool valid[2];
+
+	num_entries = 0;
+	active = NO_SECTOR;
+	generation = 0;
+	write_pos = 0;
+	bad_records = 0;
+
+	valid[0] = store_header(0, &gen[0]);
+	valid[1] = store_header(1, &gen[1]);
+
+	/* After the first copy both are valid; the newer one is current */
+	if (valid[0] && valid[1]) {
+		active = (int32_t)(gen[1] - gen[0]) > 0 ? 1 : 0;
+	} else if (valid[0] || valid[1]) {
+		active = valid[0] ? 0 : 1;
+	} else {
+		return 0;
+	}
+	generation = gen[active];
+
+	return store_scan();
+}
+
+/**
+ * @brief Program the record in the buffer
+ */
+static int store_write(uint32_t offset, uint16_t key, uint16_t len)
+{
+	uint32_t size = RECORD_SIZE(len);
+
+	put_u16(&record[0], key);
+	put_u16(&record[2], len);
+	put_u32(&record[4], record_crc(len));
+	memset(&record[RECORD_HEADER_SIZE + len], 0xFF, size - RECORD_HEADER_SIZE - len);
+
+	return flash_program(offset, record, size);
+}
+
+/**
+ * @brief Move the latest value of every key into the other sector
+ *
+ * The old sector stays valid until the new header is written, so a reset
+ * in between loses nothing. With no active sector this formats sector 0.
+ */
+static int store_copy(void)
+{
+	uint8_t target = active == 0 ? 1 : 0;
+	uint32_t base = target * SECTOR_SIZE;
+	uint32_t pos = HEADER_SIZE;
+	uint8_t h[HEADER_SIZE];
+
+	for (uint32_t p = 0; p < SECTOR_PAGES; p++) {
+		if (flash_erase_page(target * SECTOR_PAGES + p) != 0) {
+			return -1;
+		}
+	}
+
+	for (uint16_t i = 0; i < num_entries; i++) {
+		if (flash_read(entries[i].offset + RECORD_HEADER_SIZE, &record[RECORD_HEADER_SIZE],
+		               entries[i].len) != 0 ||
+		    store_write(base + pos, entries[i].key, entries[i].len) != 0) {
+			return -1;
+		}
+		copy_offset[i] = base + pos;
+		pos += RECORD_SIZE(entries[i].len);
+	}
+
+	/* Written last: only now does the new sector count */
+	put_u32(&h[0], STORE_MAGIC);
+	put_u16(&h[4], STORE_VERSION);
+	put_u16(&h[6], 0);
+	put_u32(&h[8], generation + 1U);
+	put_u32(&h[12], crc32_update(0, h, 12));
+	if (flash_program(base, h, sizeof(h)) != 0) {
+		return -1;
+	}
+
+	/* The old sector is erased by the next copy, keeping erases alternating */
+	for (uint16_t i = 0; i < num_entries; i++) {
+		entries[i].offset = copy_offset[i];
+	}
+	active = (int8_t)target;
+	generation++;
+	write_pos = pos;
+
+	return 0;
+}
+
+int store_get(uint16_t key, void *value, uint16_t len)
+{
+	struct store_entry *e = store_find(key);
+
+	if (!e || e->len != len || (len && !value)) {
+		return -1;
+	}
+
+	return flash_read(e->offset + RECORD_HEADER_SIZE, value, len);
+}
+
+int store_set(uint16_t key, const void *value, uint16_t len)
+{
+	struct store_entry *e;
+	uint32_t offset;
+
+	if (key == STORE_KEY_NONE || len > STORE_MAX_VALUE || (len && !value)) {
+		return -1;
+	}
+
+	e = store_find(key);
+	if (e && e->len == len) {
+		if (flash_read(e->offset + RECORD_HEADER_SIZE, &record[RECORD_HEADER_SIZE], len) != 0) {
+			return -1;
+		}
+		if (memcmp(&record[RECORD_HEADER_SIZE], value, len) == 0) {
+			return 0;
+		}
+	}
+	if (!e && num_entries >= STORE_MAX_KEYS) {
+		return -1;
+	}
+
+	if (active == NO_SECTOR || write_pos + RECORD_SIZE(len) > SECTOR_SIZE) {
+		if (store_copy() != 0) {
+			return -1;
+		}
+		if (write_pos + RECORD_SIZE(len) > SECTOR_SIZE) {
+			return -1;
+		}
+	}
+
+	offset = (uint32_t)active * SECTOR_SIZE + write_pos;
+	memcpy(&record[RECORD_HEADER_SIZE], value, len);
+
+	/* A failed write may have left part of the record: skip its space */
+	write_pos += RECORD_SIZE(len);
+	if (store_write(offset, key, len) != 0) {
+		return -1;
+	}
+
+	if (!e) {
+		e = &entries[num_entries++];
+		e->key = key;
+	}
+	e->len = len;
+	e->offset = offset;
+
+	return 0;
+}
+
+int store_clear(void)
+{
+	int ret = 0;
+
+	for (uint32_t p = 0; p < FLASH_STORE_PAGES; p++) {
+		if (flash_erase_page(p) != 0) {
+			ret = -1;
+		}
+	}
+
+	num_entries = 0;
+	active = NO_SECTOR;
+	generation = 0;
+	write_pos = 0;
+	bad_records = 0;
+
+	return ret;
+}
+
+void store_get_stats(struct store_stats *stats)
+{
+	stats->generation = generation;
+	stats->used = active == NO_SECTOR ? 0 : write_pos;
+	stats->size = SECTOR_SIZE;
+	stats->keys = num_entries;
+	stats->bad_records = bad_records;
+}
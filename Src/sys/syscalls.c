@@ -29,14 +29,15 @@
 #include <sys/time.h>
 #include <sys/times.h>
 #include "main.h"
+#include "drv/uart_out.h"
 
 /* Variables */
-extern UART_HandleTypeDef huart2;
-
 int __io_putchar(int ch)
 {
-    HAL_UART_Transmit(&huart2, (uint8_t *)&ch, 1, 100);
-    return ch;
+  uint8_t c = (uint8_t)ch;
+
+  uart_out_write(&c, 1);
+  return ch;
 }
 
 extern int __io_getchar(void) __attribute__((weak));
@@ -82,12 +83,9 @@ __attribute__((weak)) int _read(int file, char *ptr, int len)
 __attribute__((weak)) int _write(int file, char *ptr, int len)
 {
   (void)file;
-  int DataIdx;
 
-  for (DataIdx = 0; DataIdx < len; DataIdx++)
-  {
-    __io_putchar(*ptr++);
-  }
+  /* Queued for DMA; what does not fit is counted as dropped, not retried */
+  uart_out_write((const uint8_t *)ptr, (uint32_t)len);
   return len;
 }
 
@@ -0,0 +1,226 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "telemetry.h"
+#include "main.h"
+#include "irq.h"
+#include <string.h>
+
+#define NO_BUF (-1)
+
+static uint8_t packet[2][TELEMETRY_PACKET_SIZE] __attribute__((aligned(4)));
+
+static telemetry_send_t send_fn;
+static const struct scope_signal *channels[TELEMETRY_MAX_CHANNELS];
+static uint8_t num_channels;
+static uint16_t decimation;
+static uint16_t samples_per_packet;
+static volatile bool running;
+
+/* Buffer roles, changed from the tick and transport interrupts */
+static int8_t fill_buf = NO_BUF;     /* Being filled, NO_BUF if none free */
+static int8_t tx_buf = NO_BUF;       /* With the transport */
+static int8_t ready_buf = NO_BUF;    /* Full, waiting for the transport */
+static uint16_t fill_count;          /* Samples in fill_buf */
+static uint16_t decim_count;
+static uint32_t sample_index;
+static uint16_t seq;
+static struct telemetry_stats stats;
+
+static inline void put_u16(uint8_t *p, uint16_t v)
+{
+	p[0] = v & 0xFF;
+	p[1] = (v >> 8) & 0xFF;
+}
+
+static inline void put_u32(uint8_t *p, uint32_t v)
+{
+	put_u16(p, v & 0xFFFF);
+	put_u16(p + 2, v >> 16);
+}
+
+/**
+ * @brief Hand a full buffer to the transport, with interrupts masked
+ */
+static void send_buf(int8_t b)
+{
+	uint16_t len = TELEMETRY_HEADER_SIZE + samples_per_packet * num_channels * 4U;
+
+	put_u16(&packet[b][4], seq++);
+	if (send_fn(packet[b], len) == 0) {
+		tx_buf = b;
+		stats.packets++;
+		stats.samples += samples_per_packet;
+	} else {
+		stats.errors++;
+		stats.dropped += samples_per_packet;
+	}
+}
+
+/**
+ * @brief First buffer not with the transport, NO_BUF if both are taken
+ */
+static int8_t free_buf(void)
+{
+	for (int8_t b = 0; b < 2; b++) {
+		if (b != tx_buf && b != ready_buf) {
+			return b;
+		}
+	}
+
+	return NO_BUF;
+}
+
+void telemetry_init(telemetry_send_t send)
+{
+	send_fn = send;
+}
+
+int telemetry_configure(const struct scope_signal *const *chans, uint8_t n, uint16_t decim)
+{
+	if (running || !chans || n == 0 || n > TELEMETRY_MAX_CHANNELS) {
+		return -1;
+	}
+	for (uint8_t i = 0; i < n; i++) {
+		if (!chans[i] || !chans[i]->addr) {
+			return -1;
+		}
+		channels[i] = chans[i];
+	}
+
+	num_channels = n;
+	decimation = decim;
+	samples_per_packet = (TELEMETRY_PACKET_SIZE - TELEMETRY_HEADER_SIZE) / (n * 4U);
+
+	return 0;
+}
+
+int telemetry_start(void)
+{
+	uint32_t primask;
+
+	if (!send_fn || num_channels == 0) {
+		return -1;
+	}
+
+	primask = irq_save();
+	if (!running) {
+		/* A packet may still be in flight from the last run */
+		fill_buf = free_buf();
+		fill_count = 0;
+		decim_count = 0;
+		sample_index = 0;
+		seq = 0;
+		memset(&stats, 0, sizeof(stats));
+		running = true;
+	}
+	irq_restore(primask);
+
+	return 0;
+}
+
+void telemetry_stop(void)
+{
+	uint32_t primask = irq_save();
+
+	running = false;
+	ready_buf = NO_BUF;
+	irq_restore(primask);
+}
+
+bool telemetry_running(void)
+{
+	return running;
+}
+
+void telemetry_sample(void)
+{
+	uint8_t *p;
+	uint32_t primask;
+	float v;
+
+	if (!running) {
+		return;
+	}
+
+	if (decimation > 1) {
+		if (++decim_count < decimation) {
+			return;
+		}
+		decim_count = 0;
+	}
+
+	primask = irq_save();
+
+	if (fill_buf == NO_BUF) {
+		stats.dropped++;
+		sample_index++;
+		irq_restore(primask);
+		return;
+	}
+
+	p = packet[fill_buf];
+	if (fill_count == 0) {
+		put_u16(&p[0], TELEMETRY_MAGIC);
+		p[2] = TELEMETRY_VERSION;
+		p[3] = num_channels;
+		put_u16(&p[6], samples_per_packet);
+		put_u32(&p[8], sample_index);
+	}
+
+	p += TELEMETRY_HEADER_SIZE + fill_count * num_channels * 4U;
+	for (uint8_t i = 0; i < num_channels; i++) {
+		v = scope_signal_value(channels[i]);
+		memcpy(p, &v, sizeof(v));
+		p += sizeof(v);
+	}
+	sample_index++;
+
+	if (++fill_count >= samples_per_packet) {
+		if (tx_buf == NO_BUF) {
+			send_buf(fill_buf);
+		} else {
+			ready_buf = fill_buf;
+		}
+		fill_buf = free_buf();
+		fill_count = 0;
+	}
+
+	irq_restore(primask);
+}
+
+void telemetry_tx_complete(const uint8_t *buf)
+{
+	uint32_t primask = irq_save();
+
+	/* Some other transfer on the shared transport */
+	if (tx_buf == NO_BUF || buf != packet[tx_buf]) {
+		irq_restore(primask);
+		return;
+	}
+
+	tx_buf = NO_BUF;
+	if (ready_buf != NO_BUF) {
+		int8_t b = ready_buf;
+
+		ready_buf = NO_BUF;
+		send_buf(b);
+	}
+	if (running && fill_buf == NO_BUF) {
+		fill_buf = free_buf();
+		fill_count = 0;
+	}
+
+	irq_restore(primask);
+}
+
+void telemetry_get_stats(struct telemetry_stats *out)
+{
+	uint32_t primask = irq_save();
+
+	*out = stats;
+	irq_restore(primask);
+}
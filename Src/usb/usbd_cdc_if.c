@@ -18,6 +18,7 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include "usbd_cdc_if.h"
+#include "telemetry.h"
 
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
@@ -71,6 +72,9 @@ uint8_t UserRxBufferFS[APP_RX_DATA_SIZE];
 /** Data to send over USB CDC are stored in this buffer   */
 uint8_t UserTxBufferFS[APP_TX_DATA_SIZE];
 
+/** Application receive hook, see CDC_SetRxCallback_FS() */
+static CDC_RxCallback_t RxCallbackFS = NULL;
+
 /**
   * @}
   */
@@ -220,6 +224,10 @@ static int8_t CDC_Control_FS(uint8_t cmd, uint8_t* pbuf, uint16_t length)
   */
 static int8_t CDC_Receive_FS(uint8_t* Buf, uint32_t *Len)
 {
+  if (RxCallbackFS != NULL)
+  {
+    RxCallbackFS(Buf, *Len);
+  }
   USBD_CDC_SetRxBuffer(&hUsbDeviceFS, &Buf[0]);
   USBD_CDC_ReceivePacket(&hUsbDeviceFS);
   return (USBD_OK);
@@ -248,6 +256,31 @@ uint8_t CDC_Transmit_FS(uint8_t* Buf, uint16_t Len)
   return result;
 }
 
+/**
+  * @brief  CDC_TxBusy_FS
+  *         Check whether a transfer started by CDC_Transmit_FS still
+  *         reads from a buffer.
+  * @param  Buf: Buffer passed to CDC_Transmit_FS
+  * @retval 1 while the IN transfer from Buf runs, else 0
+  */
+uint8_t CDC_TxBusy_FS(const uint8_t *Buf)
+{
+  USBD_CDC_HandleTypeDef *hcdc = (USBD_CDC_HandleTypeDef*)hUsbDeviceFS.pClassData;
+
+  return hcdc != NULL && hcdc->TxState != 0 && hcdc->TxBuffer == Buf;
+}
+
+/**
+  * @brief  CDC_SetRxCallback_FS
+  *         Register the function that takes received data.
+  * @param  Callback: Called from CDC_Receive_FS, NULL to discard data
+  * @retval None
+  */
+void CDC_SetRxCallback_FS(CDC_RxCallback_t Callback)
+{
+  RxCallbackFS = Callback;
+}
+
 /**
   * @brief  CDC_TransmitCplt_FS
   *         Data transmitted callback
@@ -263,9 +296,11 @@ uint8_t CDC_Transmit_FS(uint8_t* Buf, uint16_t Len)
 static int8_t CDC_TransmitCplt_FS(uint8_t *Buf, uint32_t *Len, uint8_t epnum)
 {
   uint8_t result = USBD_OK;
-  UNUSED(Buf);
   UNUSED(Len);
   UNUSED(epnum);
+
+  /* Start the next telemetry packet, if one is waiting */
+  telemetry_tx_complete(Buf);
   return result;
 }
 
@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+/**
+ * @brief Minimal timing helpers for the host benchmarks
+ *
+ * Host nanoseconds are not Cortex-M4 cycles, but the ratio between two
+ * implementations measured here is a useful first estimate. Results are
+ * written to bench_sink so the compiler cannot drop the work.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+static volatile float bench_sink;
+
+static inline double bench_now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+/*
+ * Run `body` `iters` times with the loop index in `i`, print and evaluate to
+ * the mean nanoseconds per iteration.
+ */
+#define BENCH_RUN(label, iters, body) ({ \
+	uint32_t _n = (iters); \
+	double _t0 = bench_now_ns(); \
+	for (uint32_t i = 0; i < _n; i++) { \
+		body; \
+	} \
+	double _ns = (bench_now_ns() - _t0) / (double)_n; \
+	printf("  %-36s %8.2f ns/op\n", (label), _ns); \
+	_ns; \
+})
+
+#endif /* BENCH_H */
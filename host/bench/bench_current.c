@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * ADC counts to amps: millivolts and two divides vs folded scale/bias.
+ */
+
+#include "bench.h"
+#include "hal_shim.h"
+#include "foc.h"
+#include "drv/adc_dma.h"
+
+#define ITERS      4000000U
+#define SETS       256U
+
+/* Current channels of a sample set: both phases of both motors */
+#define CHANNELS   ADC_DMA_NUM_INJECTED
+
+static uint16_t samples[SETS][CHANNELS];
+
+/* Per channel conversion of foc_current_update() before scale/bias */
+static inline float amps_divide(uint16_t raw, const struct foc_current_config *cfg)
+{
+	float voltage = (float)adc_dma_raw_to_mv(raw) / 1000.0f;
+
+	return (voltage - cfg->current_offset[0]) / cfg->current_sensitivity;
+}
+
+int main(void)
+{
+	struct foc_motor *motor;
+	struct foc_current_config *cfg;
+	float scale[CHANNELS], bias[CHANNELS], amps[CHANNELS];
+	double slow, fast;
+
+	hal_shim_reset();
+	motor = foc_get_motor("motor0");
+	foc_current_config(motor, 0, 1, 0.2f, 1.65f, 2.0f);
+	cfg = &motor->current_cfg;
+
+	for (uint32_t s = 0; s < SETS; s++) {
+		for (uint32_t ch = 0; ch < CHANNELS; ch++) {
+			samples[s][ch] = (uint16_t)((s * 97U + ch * 1021U) & 0xFFFU);
+		}
+	}
+	for (uint32_t ch = 0; ch < CHANNELS; ch++) {
+		scale[ch] = cfg->scale[ch & 1];
+		bias[ch] = cfg->bias[ch & 1];
+	}
+
+	printf("\n%d current channels per sample set:\n", CHANNELS);
+	slow = BENCH_RUN("raw_to_mv, / 1000, - offset, / sens", ITERS, {
+		const uint16_t *raw = samples[i % SETS];
+		float sum = 0.0f;
+
+		for (uint32_t ch = 0; ch < CHANNELS; ch++) {
+			sum += amps_divide(raw[ch], cfg);
+		}
+		bench_sink = sum;
+	});
+	fast = BENCH_RUN("foc_current_convert", ITERS, {
+		foc_current_convert(samples[i % SETS], scale, bias, amps, CHANNELS);
+		bench_sink = amps[0] + amps[1] + amps[2] + amps[3];
+	});
+	printf("  per conversion %.2f ns vs %.2f ns, speed-up %.2fx\n",
+	       slow / CHANNELS, fast / CHANNELS, slow / fast);
+
+	return 0;
+}
@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Sector vs min/max SVPWM, float percentage vs Q15 duty.
+ */
+
+#include "bench.h"
+#include "hal_shim.h"
+#include "drv/pwm.h"
+
+#define ITERS      4000000U
+
+int main(void)
+{
+	struct pwm_device *pwm0;
+	double slow, fast;
+
+	hal_shim_reset();
+	htim2.Init.Period = 8499;
+	HAL_TIM_Base_Init(&htim2);
+	pwm0 = pwm_get_device("pwm_motor0");
+	pwm_init(pwm0);
+	pwm_start(pwm0);
+
+	printf("\npwm_set_vector_svpwm:\n");
+
+	pwm_set_svpwm_mode(pwm0, PWM_SVPWM_SECTOR);
+	slow = BENCH_RUN("PWM_SVPWM_SECTOR", ITERS, {
+		pwm_set_vector_svpwm(pwm0, (float)(i % 3600) * 0.1f, 80.0f);
+	});
+
+	pwm_set_svpwm_mode(pwm0, PWM_SVPWM_MINMAX);
+	fast = BENCH_RUN("PWM_SVPWM_MINMAX", ITERS, {
+		pwm_set_vector_svpwm(pwm0, (float)(i % 3600) * 0.1f, 80.0f);
+	});
+
+	printf("  speed-up %.2fx\n", slow / fast);
+
+	printf("\nthree phase duty write:\n");
+	slow = BENCH_RUN("pwm_set_duty (float %)", ITERS, {
+		float d = (float)(i & 0xFF) * 0.39f;
+		pwm_set_duty(pwm0, d, 100.0f - d, 50.0f);
+	});
+	fast = BENCH_RUN("pwm_set_duty_q15", ITERS, {
+		uint16_t d = (uint16_t)((i & 0xFF) << 7);
+		pwm_set_duty_q15(pwm0, d, PWM_DUTY_Q15_ONE - d, PWM_DUTY_Q15_ONE / 2);
+	});
+	printf("  speed-up %.2fx\n", slow / fast);
+
+	return 0;
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Table trig vs libm, alone and inside the two modulators.
+ */
+
+#include "bench.h"
+#include "hal_shim.h"
+#include "trig.h"
+#include "drv/pwm.h"
+#include <math.h>
+
+#define ITERS      4000000U
+#define M_PI_F     3.14159265358979323846f
+
+/* Per-update trig work of pwm_set_vector before the table: three sinf() */
+static inline void sine3_libm(float angle_deg, float out[3])
+{
+	float rad = angle_deg * M_PI_F / 180.0f;
+
+	out[0] = sinf(rad);
+	out[1] = sinf(rad - 2.0f * M_PI_F / 3.0f);
+	out[2] = sinf(rad + 2.0f * M_PI_F / 3.0f);
+}
+
+static inline void sine3_table(float angle_deg, float out[3])
+{
+	float s, c;
+
+	trig_sincos(trig_deg_to_angle(angle_deg), &s, &c);
+	out[0] = s;
+	out[1] = -0.5f * s - 0.866025404f * c;
+	out[2] = -0.5f * s + 0.866025404f * c;
+}
+
+int main(void)
+{
+	struct pwm_device *pwm0;
+	float out[3], s, c;
+	double libm, table;
+
+	hal_shim_reset();
+	htim2.Init.Period = 8499;
+	HAL_TIM_Base_Init(&htim2);
+	pwm0 = pwm_get_device("pwm_motor0");
+	pwm_init(pwm0);
+	pwm_start(pwm0);
+
+	printf("\nsin+cos of one angle:\n");
+	libm = BENCH_RUN("sinf + cosf", ITERS, {
+		float rad = (float)(i & 0xFFFF) * (2.0f * M_PI_F / 65536.0f);
+		bench_sink = sinf(rad) + cosf(rad);
+	});
+	table = BENCH_RUN("trig_sincos", ITERS, {
+		trig_sincos((uint16_t)i, &s, &c);
+		bench_sink = s + c;
+	});
+	printf("  speed-up %.2fx\n", libm / table);
+
+	printf("\nthree phase sines (pwm_set_vector):\n");
+	libm = BENCH_RUN("3x sinf", ITERS, {
+		sine3_libm((float)(i % 3600) * 0.1f, out);
+		bench_sink = out[0] + out[1] + out[2];
+	});
+	table = BENCH_RUN("trig_sincos + rotation", ITERS, {
+		sine3_table((float)(i % 3600) * 0.1f, out);
+		bench_sink = out[0] + out[1] + out[2];
+	});
+	printf("  speed-up %.2fx\n", libm / table);
+
+	printf("\nfull modulator calls:\n");
+	BENCH_RUN("pwm_set_vector", ITERS, {
+		pwm_set_vector(pwm0, (float)(i % 3600) * 0.1f, 80.0f);
+	});
+	BENCH_RUN("pwm_set_vector_svpwm", ITERS, {
+		pwm_set_vector_svpwm(pwm0, (float)(i % 3600) * 0.1f, 80.0f);
+	});
+
+	return 0;
+}
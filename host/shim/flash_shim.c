@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Stand-in for Src/drv/flash.c. The store region is memory mapped on
+ * target, which the HAL shim cannot fake, so the host build replaces the
+ * driver: the region lives in RAM, optionally mirrored to a file so it
+ * survives between runs like the real flash does between resets.
+ */
+
+#include "hal_shim.h"
+#include "drv/flash.h"
+#include <stdio.h>
+#include <string.h>
+
+static uint8_t flash_mem[FLASH_STORE_SIZE];
+static uint32_t erase_count[FLASH_STORE_PAGES];
+static FILE *flash_file;
+static int32_t ops_left = -1;
+static bool opened;
+
+/**
+ * @brief Write a range through to the backing file
+ */
+static int flash_sync(uint32_t offset, uint32_t len)
+{
+	if (!flash_file) {
+		return 0;
+	}
+	if (fseek(flash_file, (long)offset, SEEK_SET) != 0 ||
+	    fwrite(&flash_mem[offset], 1, len, flash_file) != len || fflush(flash_file) != 0) {
+		return -1;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Account for one erase or double word program
+ *
+ * @return false once the simulated power cut has happened
+ */
+static bool flash_op(void)
+{
+	if (ops_left == 0) {
+		return false;
+	}
+	if (ops_left > 0) {
+		ops_left--;
+	}
+
+	return true;
+}
+
+int hal_shim_flash_open(const char *path)
+{
+	if (flash_file) {
+		fclose(flash_file);
+		flash_file = NULL;
+	}
+	memset(flash_mem, 0xFF, sizeof(flash_mem));
+	memset(erase_count, 0, sizeof(erase_count));
+	ops_left = -1;
+	opened = true;
+
+	if (!path) {
+		return 0;
+	}
+
+	/* An existing image is loaded, a new one starts erased */
+	flash_file = fopen(path, "r+b");
+	if (flash_file) {
+		if (fread(flash_mem, 1, sizeof(flash_mem), flash_file) != sizeof(flash_mem)) {
+			memset(flash_mem, 0xFF, sizeof(flash_mem));
+		}
+	} else {
+		flash_file = fopen(path, "w+b");
+		if (!flash_file) {
+			return -1;
+		}
+	}
+
+	return flash_sync(0, sizeof(flash_mem));
+}
+
+void hal_shim_flash_fail_after(int32_t ops)
+{
+	ops_left = ops;
+}
+
+uint32_t hal_shim_flash_erase_count(uint32_t page)
+{
+	return page < FLASH_STORE_PAGES ? erase_count[page] : 0;
+}
+
+int flash_read(uint32_t offset, void *buf, uint32_t len)
+{
+	if (!opened) {
+		hal_shim_flash_open(NULL);
+	}
+	if (!buf || offset > FLASH_STORE_SIZE || len > FLASH_STORE_SIZE - offset) {
+		return -1;
+	}
+
+	memcpy(buf, &flash_mem[offset], len);
+	return 0;
+}
+
+int flash_erase_page(uint32_t page)
+{
+	if (!opened) {
+		hal_shim_flash_open(NULL);
+	}
+	if (page >= FLASH_STORE_PAGES || !flash_op()) {
+		return -1;
+	}
+
+	memset(&flash_mem[page * FLASH_STORE_PAGE_SIZE], 0xFF, FLASH_STORE_PAGE_SIZE);
+	erase_count[page]++;
+	return flash_sync(page * FLASH_STORE_PAGE_SIZE, FLASH_STORE_PAGE_SIZE);
+}
+
+int flash_program(uint32_t offset, const void *data, uint32_t len)
+{
+	const uint8_t *src = data;
+	uint32_t done;
+
+	if (!opened) {
+		hal_shim_flash_open(NULL);
+	}
+	if (!data || offset > FLASH_STORE_SIZE || len > FLASH_STORE_SIZE - offset ||
+	    offset % FLASH_STORE_WORD != 0 || len % FLASH_STORE_WORD != 0) {
+		return -1;
+	}
+	for (uint32_t i = 0; i < len; i++) {
+		if (flash_mem[offset + i] != 0xFF) {
+			return -1;
+		}
+	}
+
+	/* One double word at a time, as the controller does */
+	for (done = 0; done < len; done += FLASH_STORE_WORD) {
+		if (!flash_op()) {
+			break;
+		}
+		memcpy(&flash_mem[offset + done], &src[done], FLASH_STORE_WORD);
+	}
+
+	if (flash_sync(offset, done) != 0 || done < len) {
+		return -1;
+	}
+	return 0;
+}
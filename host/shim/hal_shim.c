@@ -0,0 +1,786 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "hal_shim.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define TIM_DIER_UIE  0x0001U
+
+/* Peripheral "registers" */
+TIM_TypeDef hal_shim_tim2;
+TIM_TypeDef hal_shim_tim3;
+ADC_TypeDef hal_shim_adc2;
+I2C_TypeDef hal_shim_i2c1;
+I2C_TypeDef hal_shim_i2c2;
+USART_TypeDef hal_shim_usart2;
+CoreDebug_Type hal_shim_core_debug;
+
+uint32_t SystemCoreClock = 170000000U;
+
+/* Handles that main.c owns on target */
+ADC_HandleTypeDef hadc2;
+DMA_HandleTypeDef hdma_adc2;
+TIM_HandleTypeDef htim2;
+TIM_HandleTypeDef htim3;
+I2C_HandleTypeDef hi2c1;
+I2C_HandleTypeDef hi2c2;
+UART_HandleTypeDef huart2;
+DMA_HandleTypeDef hdma_usart2_rx;
+DMA_HandleTypeDef hdma_usart2_tx;
+
+/* Cycle counter: value last handed out, to notice writes to CYCCNT */
+static DWT_Type dwt;
+static uint32_t dwt_last;
+static uint32_t dwt_offset;
+static bool dwt_manual;
+
+static uint32_t tick_ms;
+static uint32_t tim_running_writes[2];
+static hal_shim_delay_hook_t delay_hook;
+
+/* ADC: regular group DMA transfer and injected group state */
+static struct {
+	ADC_HandleTypeDef *hadc;
+	uint16_t *buffer;
+	uint32_t length;
+	uint32_t pos;
+	bool running;
+	uint32_t dma_it;             /* DMA_IT_xx still enabled */
+	uint32_t injected_ranks;     /* Injected conversions per trigger, 0 if unused */
+	uint16_t jdr[4];             /* Injected data registers */
+	bool injected_running;
+} adc_dma;
+
+/* Fake I2C devices, one per bus */
+struct i2c_bus {
+	uint8_t addr;
+	uint8_t regs[256];
+	uint32_t transactions;
+	/* Interrupt-driven transfer in flight */
+	bool pending;
+	uint16_t dev_addr;
+	uint16_t mem_addr;
+	uint8_t *data;
+	uint16_t size;
+};
+
+static struct i2c_bus i2c_bus1;
+static struct i2c_bus i2c_bus2;
+
+/* UART transmitter: DMA transfer in flight and captured output */
+#define UART_CAPTURE_SIZE 65536U
+
+static struct {
+	const uint8_t *data;
+	uint16_t size;
+	uint8_t out[UART_CAPTURE_SIZE];
+	uint32_t out_len;
+} uart_tx;
+
+/* UART receiver: circular DMA buffer and write position */
+static struct {
+	uint8_t *data;
+	uint16_t size;
+	uint16_t pos;
+} uart_rx;
+
+static struct i2c_bus *i2c_bus_get(I2C_HandleTypeDef *hi2c)
+{
+	if (hi2c->Instance == I2C1) {
+		return &i2c_bus1;
+	} else if (hi2c->Instance == I2C2) {
+		return &i2c_bus2;
+	}
+
+	return NULL;
+}
+
+void hal_shim_reset(void)
+{
+	memset(&hal_shim_tim2, 0, sizeof(hal_shim_tim2));
+	memset(&hal_shim_tim3, 0, sizeof(hal_shim_tim3));
+	memset(tim_running_writes, 0, sizeof(tim_running_writes));
+	memset(&hadc2, 0, sizeof(hadc2));
+	memset(&hdma_adc2, 0, sizeof(hdma_adc2));
+	memset(&htim2, 0, sizeof(htim2));
+	memset(&htim3, 0, sizeof(htim3));
+	memset(&hi2c1, 0, sizeof(hi2c1));
+	memset(&hi2c2, 0, sizeof(hi2c2));
+	memset(&adc_dma, 0, sizeof(adc_dma));
+	memset(&i2c_bus1, 0, sizeof(i2c_bus1));
+	memset(&i2c_bus2, 0, sizeof(i2c_bus2));
+	memset(&huart2, 0, sizeof(huart2));
+	memset(&uart_tx, 0, sizeof(uart_tx));
+	memset(&uart_rx, 0, sizeof(uart_rx));
+	memset(&hdma_usart2_rx, 0, sizeof(hdma_usart2_rx));
+	memset(&hdma_usart2_tx, 0, sizeof(hdma_usart2_tx));
+
+	htim2.Instance = TIM2;
+	htim3.Instance = TIM3;
+	hadc2.Instance = ADC2;
+	hadc2.DMA_Handle = &hdma_adc2;
+	hdma_adc2.Init.Mode = DMA_CIRCULAR;
+	hi2c1.Instance = I2C1;
+	hi2c2.Instance = I2C2;
+	huart2.Instance = USART2;
+	huart2.gState = HAL_UART_STATE_READY;
+	huart2.RxState = HAL_UART_STATE_READY;
+	huart2.hdmarx = &hdma_usart2_rx;
+	huart2.hdmatx = &hdma_usart2_tx;
+	hdma_usart2_rx.Init.Mode = DMA_CIRCULAR;
+
+	memset(&dwt, 0, sizeof(dwt));
+	memset(&hal_shim_core_debug, 0, sizeof(hal_shim_core_debug));
+	dwt_last = 0;
+	dwt_manual = false;
+
+	tick_ms = 0;
+	delay_hook = NULL;
+}
+
+void hal_shim_set_tick(uint32_t ms)
+{
+	tick_ms = ms;
+}
+
+void hal_shim_advance_ms(uint32_t ms)
+{
+	tick_ms += ms;
+}
+
+void hal_shim_dwt_manual(bool manual)
+{
+	/* Carry the count over either way */
+	hal_shim_dwt();
+	dwt_manual = manual;
+}
+
+void hal_shim_advance_cycles(uint32_t cycles)
+{
+	if ((dwt.CTRL & DWT_CTRL_CYCCNTENA_Msk) &&
+	    (hal_shim_core_debug.DEMCR & CoreDebug_DEMCR_TRCENA_Msk)) {
+		dwt.CYCCNT += cycles;
+		dwt_last = dwt.CYCCNT;
+	}
+}
+
+void hal_shim_set_delay_hook(hal_shim_delay_hook_t hook)
+{
+	delay_hook = hook;
+}
+
+/**
+ * @brief One regular conversion moved by the DMA
+ */
+static void adc_dma_transfer(uint16_t value)
+{
+	if (!adc_dma.running) {
+		return;
+	}
+
+	adc_dma.buffer[adc_dma.pos++] = value;
+
+	if (adc_dma.pos == adc_dma.length / 2 && (adc_dma.dma_it & DMA_IT_HT)) {
+		HAL_ADC_ConvHalfCpltCallback(adc_dma.hadc);
+	}
+
+	if (adc_dma.pos == adc_dma.length) {
+		adc_dma.pos = 0;
+		if (adc_dma.hadc->DMA_Handle &&
+		    adc_dma.hadc->DMA_Handle->Init.Mode != DMA_CIRCULAR) {
+			adc_dma.running = false;
+		}
+		if (adc_dma.dma_it & DMA_IT_TC) {
+			HAL_ADC_ConvCpltCallback(adc_dma.hadc);
+		}
+	}
+}
+
+int hal_shim_adc_push(const uint16_t *values, uint32_t count)
+{
+	uint32_t set;
+
+	/* Regular group only: every value is one DMA transfer */
+	if (adc_dma.injected_ranks == 0) {
+		if (!adc_dma.running) {
+			return -1;
+		}
+		for (uint32_t i = 0; i < count && adc_dma.running; i++) {
+			adc_dma_transfer(values[i]);
+		}
+		return 0;
+	}
+
+	set = adc_dma.injected_ranks + adc_dma.hadc->Init.NbrOfConversion;
+	if ((!adc_dma.running && !adc_dma.injected_running) || count % set != 0) {
+		return -1;
+	}
+
+	for (uint32_t i = 0; i < count; i += set) {
+		for (uint32_t r = 0; r < adc_dma.injected_ranks; r++) {
+			adc_dma.jdr[r] = values[i + r];
+		}
+		for (uint32_t r = adc_dma.injected_ranks; r < set; r++) {
+			adc_dma_transfer(values[i + r]);
+		}
+		if (adc_dma.injected_running) {
+			HAL_ADCEx_InjectedConvCpltCallback(adc_dma.hadc);
+		}
+	}
+
+	return 0;
+}
+
+bool hal_shim_adc_running(void)
+{
+	return adc_dma.running;
+}
+
+bool hal_shim_pwm_enabled(TIM_HandleTypeDef *htim, uint32_t channel)
+{
+	return (htim->Instance->CCER & (1U << channel)) != 0;
+}
+
+void hal_shim_tim_elapse(TIM_HandleTypeDef *htim)
+{
+	if ((htim->Instance->CR1 & TIM_CR1_CEN) && (htim->Instance->DIER & TIM_DIER_UIE)) {
+		HAL_TIM_PeriodElapsedCallback(htim);
+	}
+}
+
+static uint32_t *tim_running_writes_get(const TIM_TypeDef *tim)
+{
+	return &tim_running_writes[tim == TIM3];
+}
+
+void hal_shim_tim_set_counter(TIM_TypeDef *tim, uint32_t counter)
+{
+	if (tim->CR1 & TIM_CR1_CEN) {
+		(*tim_running_writes_get(tim))++;
+	}
+	tim->CNT = counter;
+}
+
+uint32_t hal_shim_tim_running_writes(TIM_HandleTypeDef *htim)
+{
+	return *tim_running_writes_get(htim->Instance);
+}
+
+void hal_shim_i2c_attach(I2C_HandleTypeDef *hi2c, uint8_t addr)
+{
+	struct i2c_bus *bus = i2c_bus_get(hi2c);
+
+	if (bus) {
+		memset(bus->regs, 0, sizeof(bus->regs));
+		bus->addr = addr;
+	}
+}
+
+void hal_shim_i2c_set_reg(I2C_HandleTypeDef *hi2c, uint8_t reg, uint8_t value)
+{
+	struct i2c_bus *bus = i2c_bus_get(hi2c);
+
+	if (bus) {
+		bus->regs[reg] = value;
+	}
+}
+
+bool hal_shim_i2c_complete(I2C_HandleTypeDef *hi2c)
+{
+	struct i2c_bus *bus = i2c_bus_get(hi2c);
+
+	if (!bus || !bus->pending) {
+		return false;
+	}
+
+	bus->pending = false;
+	if (bus->addr == 0 || (bus->dev_addr >> 1) != bus->addr) {
+		hi2c->ErrorCode = HAL_I2C_ERROR_AF;
+		HAL_I2C_ErrorCallback(hi2c);
+		return true;
+	}
+
+	for (uint16_t i = 0; i < bus->size; i++) {
+		bus->data[i] = bus->regs[(bus->mem_addr + i) & 0xFF];
+	}
+	HAL_I2C_MemRxCpltCallback(hi2c);
+	return true;
+}
+
+uint32_t hal_shim_i2c_transactions(I2C_HandleTypeDef *hi2c)
+{
+	struct i2c_bus *bus = i2c_bus_get(hi2c);
+
+	return bus ? bus->transactions : 0;
+}
+
+static void uart_capture(const uint8_t *data, uint32_t size)
+{
+	for (uint32_t i = 0; i < size && uart_tx.out_len < UART_CAPTURE_SIZE; i++) {
+		uart_tx.out[uart_tx.out_len++] = data[i];
+	}
+}
+
+bool hal_shim_uart_tx_complete(UART_HandleTypeDef *huart)
+{
+	if (huart->Instance != USART2 || huart->gState != HAL_UART_STATE_BUSY_TX) {
+		return false;
+	}
+
+	uart_capture(uart_tx.data, uart_tx.size);
+	uart_tx.data = NULL;
+	uart_tx.size = 0;
+	huart->gState = HAL_UART_STATE_READY;
+	HAL_UART_TxCpltCallback(huart);
+	return true;
+}
+
+uint32_t hal_shim_uart_tx_pending(UART_HandleTypeDef *huart)
+{
+	return huart->gState == HAL_UART_STATE_BUSY_TX ? uart_tx.size : 0;
+}
+
+uint32_t hal_shim_uart_rx_push(UART_HandleTypeDef *huart, const uint8_t *data, uint32_t len)
+{
+	if (huart->Instance != USART2 || huart->RxState != HAL_UART_STATE_BUSY_RX) {
+		return 0;
+	}
+
+	for (uint32_t i = 0; i < len; i++) {
+		uart_rx.data[uart_rx.pos++] = data[i];
+
+		if (uart_rx.pos == uart_rx.size / 2U) {
+			HAL_UARTEx_RxEventCallback(huart, uart_rx.size / 2U);
+		} else if (uart_rx.pos == uart_rx.size) {
+			uart_rx.pos = 0;
+			HAL_UARTEx_RxEventCallback(huart, uart_rx.size);
+		}
+	}
+
+	/* Idle line: reported unless the counter has just reloaded */
+	if (len > 0 && uart_rx.pos != 0) {
+		HAL_UARTEx_RxEventCallback(huart, uart_rx.pos);
+	}
+
+	return len;
+}
+
+void hal_shim_uart_rx_error(UART_HandleTypeDef *huart, uint32_t error)
+{
+	huart->ErrorCode = error;
+	huart->RxState = HAL_UART_STATE_READY;
+	HAL_UART_ErrorCallback(huart);
+}
+
+uint32_t hal_shim_uart_take_output(UART_HandleTypeDef *huart, uint8_t *buf, uint32_t size)
+{
+	uint32_t count = uart_tx.out_len < size ? uart_tx.out_len : size;
+
+	if (huart->Instance != USART2) {
+		return 0;
+	}
+
+	memcpy(buf, uart_tx.out, count);
+	memmove(uart_tx.out, uart_tx.out + count, uart_tx.out_len - count);
+	uart_tx.out_len -= count;
+	return count;
+}
+
+/* ------------------------------------------------------------------------ */
+/* Core                                                                      */
+/* ------------------------------------------------------------------------ */
+
+static uint32_t dwt_host_cycles(void)
+{
+	struct timespec ts;
+	uint64_t ns;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	ns = (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+	return (uint32_t)(ns * (SystemCoreClock / 1000000U) / 1000U);
+}
+
+DWT_Type *hal_shim_dwt(void)
+{
+	uint32_t raw;
+
+	if (dwt_manual) {
+		/* Only writes and hal_shim_advance_cycles() move it */
+		dwt_last = dwt.CYCCNT;
+		return &dwt;
+	}
+
+	raw = dwt_host_cycles();
+
+	if (dwt.CYCCNT != dwt_last) {
+		/* Written since the last access */
+		dwt_offset = dwt.CYCCNT - raw;
+	}
+	if ((dwt.CTRL & DWT_CTRL_CYCCNTENA_Msk) &&
+	    (hal_shim_core_debug.DEMCR & CoreDebug_DEMCR_TRCENA_Msk)) {
+		dwt.CYCCNT = raw + dwt_offset;
+	} else {
+		/* Stopped: hold the count */
+		dwt_offset = dwt.CYCCNT - raw;
+	}
+	dwt_last = dwt.CYCCNT;
+
+	return &dwt;
+}
+
+/* ------------------------------------------------------------------------ */
+/* System                                                                    */
+/* ------------------------------------------------------------------------ */
+
+uint32_t HAL_GetTick(void)
+{
+	return tick_ms;
+}
+
+void HAL_Delay(uint32_t Delay)
+{
+	for (uint32_t i = 0; i < Delay; i++) {
+		tick_ms++;
+		if (delay_hook) {
+			delay_hook();
+		}
+	}
+}
+
+void Error_Handler(void)
+{
+	fprintf(stderr, "Error_Handler called\n");
+	abort();
+}
+
+/* ------------------------------------------------------------------------ */
+/* Timers                                                                    */
+/* ------------------------------------------------------------------------ */
+
+HAL_StatusTypeDef HAL_TIM_Base_Init(TIM_HandleTypeDef *htim)
+{
+	if (!htim || !htim->Instance) {
+		return HAL_ERROR;
+	}
+
+	htim->Instance->PSC = htim->Init.Prescaler;
+	htim->Instance->ARR = htim->Init.Period;
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_Base_Start(TIM_HandleTypeDef *htim)
+{
+	htim->Instance->CR1 |= TIM_CR1_CEN;
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_Base_Stop(TIM_HandleTypeDef *htim)
+{
+	htim->Instance->CR1 &= ~TIM_CR1_CEN;
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_Base_Start_IT(TIM_HandleTypeDef *htim)
+{
+	htim->Instance->DIER |= TIM_DIER_UIE;
+	htim->Instance->CR1 |= TIM_CR1_CEN;
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_PWM_Init(TIM_HandleTypeDef *htim)
+{
+	return HAL_TIM_Base_Init(htim);
+}
+
+HAL_StatusTypeDef HAL_TIM_PWM_ConfigChannel(TIM_HandleTypeDef *htim,
+                                            const TIM_OC_InitTypeDef *sConfig,
+                                            uint32_t Channel)
+{
+	__HAL_TIM_SET_COMPARE(htim, Channel, sConfig->Pulse);
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_PWM_Start(TIM_HandleTypeDef *htim, uint32_t Channel)
+{
+	htim->Instance->CCER |= 1U << Channel;
+	htim->Instance->CR1 |= TIM_CR1_CEN;
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_PWM_Stop(TIM_HandleTypeDef *htim, uint32_t Channel)
+{
+	htim->Instance->CCER &= ~(1U << Channel);
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIMEx_MasterConfigSynchronization(TIM_HandleTypeDef *htim,
+                                                        const TIM_MasterConfigTypeDef *sMasterConfig)
+{
+	return HAL_OK;
+}
+
+__attribute__((weak)) void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
+{
+}
+
+/* ------------------------------------------------------------------------ */
+/* ADC                                                                       */
+/* ------------------------------------------------------------------------ */
+
+HAL_StatusTypeDef HAL_ADC_Init(ADC_HandleTypeDef *hadc)
+{
+	return (hadc && hadc->Instance) ? HAL_OK : HAL_ERROR;
+}
+
+HAL_StatusTypeDef HAL_ADC_ConfigChannel(ADC_HandleTypeDef *hadc,
+                                        const ADC_ChannelConfTypeDef *sConfig)
+{
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_ADCEx_Calibration_Start(ADC_HandleTypeDef *hadc, uint32_t SingleDiff)
+{
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_ADC_Start_DMA(ADC_HandleTypeDef *hadc, uint32_t *pData, uint32_t Length)
+{
+	if (adc_dma.running || !pData || Length == 0) {
+		return HAL_ERROR;
+	}
+
+	adc_dma.hadc = hadc;
+	adc_dma.buffer = (uint16_t *)pData;
+	adc_dma.length = Length;
+	adc_dma.pos = 0;
+	adc_dma.running = true;
+	adc_dma.dma_it = DMA_IT_TC | DMA_IT_HT;
+	return HAL_OK;
+}
+
+/* As on the G4: stops both groups */
+HAL_StatusTypeDef HAL_ADC_Stop_DMA(ADC_HandleTypeDef *hadc)
+{
+	adc_dma.running = false;
+	adc_dma.injected_running = false;
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_ADCEx_InjectedConfigChannel(ADC_HandleTypeDef *hadc,
+                                                  const ADC_InjectionConfTypeDef *pConfigInjected)
+{
+	if (pConfigInjected->InjectedNbrOfConversion > 4 ||
+	    pConfigInjected->InjectedRank > pConfigInjected->InjectedNbrOfConversion) {
+		return HAL_ERROR;
+	}
+
+	adc_dma.injected_ranks = pConfigInjected->InjectedNbrOfConversion;
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_ADCEx_InjectedStart_IT(ADC_HandleTypeDef *hadc)
+{
+	if (adc_dma.injected_running || adc_dma.injected_ranks == 0) {
+		return HAL_ERROR;
+	}
+
+	adc_dma.hadc = hadc;
+	adc_dma.injected_running = true;
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_ADCEx_InjectedStop_IT(ADC_HandleTypeDef *hadc)
+{
+	adc_dma.injected_running = false;
+	return HAL_OK;
+}
+
+uint32_t HAL_ADCEx_InjectedGetValue(const ADC_HandleTypeDef *hadc, uint32_t InjectedRank)
+{
+	if (InjectedRank < 1 || InjectedRank > 4) {
+		return 0;
+	}
+
+	return adc_dma.jdr[InjectedRank - 1];
+}
+
+__attribute__((weak)) void HAL_ADCEx_InjectedConvCpltCallback(ADC_HandleTypeDef *hadc)
+{
+}
+
+__attribute__((weak)) void HAL_ADC_ConvHalfCpltCallback(ADC_HandleTypeDef *hadc)
+{
+}
+
+__attribute__((weak)) void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef *hadc)
+{
+}
+
+/* ------------------------------------------------------------------------ */
+/* I2C                                                                       */
+/* ------------------------------------------------------------------------ */
+
+HAL_StatusTypeDef HAL_I2C_Mem_Read(I2C_HandleTypeDef *hi2c, uint16_t DevAddress,
+                                   uint16_t MemAddress, uint16_t MemAddSize,
+                                   uint8_t *pData, uint16_t Size, uint32_t Timeout)
+{
+	struct i2c_bus *bus = i2c_bus_get(hi2c);
+
+	if (!bus) {
+		return HAL_ERROR;
+	}
+
+	if (bus->pending) {
+		return HAL_BUSY;
+	}
+
+	bus->transactions++;
+	if (bus->addr == 0 || (DevAddress >> 1) != bus->addr) {
+		hi2c->ErrorCode = HAL_I2C_ERROR_AF;
+		return HAL_ERROR;
+	}
+
+	for (uint16_t i = 0; i < Size; i++) {
+		pData[i] = bus->regs[(MemAddress + i) & 0xFF];
+	}
+
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Read_IT(I2C_HandleTypeDef *hi2c, uint16_t DevAddress,
+                                      uint16_t MemAddress, uint16_t MemAddSize,
+                                      uint8_t *pData, uint16_t Size)
+{
+	struct i2c_bus *bus = i2c_bus_get(hi2c);
+
+	if (!bus) {
+		return HAL_ERROR;
+	}
+
+	if (bus->pending) {
+		return HAL_BUSY;
+	}
+
+	/* Address NACK is only seen once the transfer runs, as on target */
+	bus->transactions++;
+	bus->pending = true;
+	bus->dev_addr = DevAddress;
+	bus->mem_addr = MemAddress;
+	bus->data = pData;
+	bus->size = Size;
+	hi2c->ErrorCode = HAL_I2C_ERROR_NONE;
+
+	return HAL_OK;
+}
+
+uint32_t HAL_I2C_GetError(I2C_HandleTypeDef *hi2c)
+{
+	return hi2c->ErrorCode;
+}
+
+__attribute__((weak)) void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef *hi2c)
+{
+}
+
+__attribute__((weak)) void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c)
+{
+}
+
+HAL_StatusTypeDef HAL_I2C_IsDeviceReady(I2C_HandleTypeDef *hi2c, uint16_t DevAddress,
+                                        uint32_t Trials, uint32_t Timeout)
+{
+	struct i2c_bus *bus = i2c_bus_get(hi2c);
+
+	if (!bus || bus->addr == 0 || (DevAddress >> 1) != bus->addr) {
+		return HAL_ERROR;
+	}
+
+	return HAL_OK;
+}
+
+/* ------------------------------------------------------------------------ */
+/* UART                                                                      */
+/* ------------------------------------------------------------------------ */
+
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart, const uint8_t *pData,
+                                    uint16_t Size, uint32_t Timeout)
+{
+	if (huart->Instance != USART2) {
+		return HAL_ERROR;
+	}
+	if (huart->gState != HAL_UART_STATE_READY) {
+		return HAL_BUSY;
+	}
+
+	uart_capture(pData, Size);
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart, const uint8_t *pData,
+                                        uint16_t Size)
+{
+	if (huart->Instance != USART2 || !pData || Size == 0) {
+		return HAL_ERROR;
+	}
+	if (huart->gState != HAL_UART_STATE_READY) {
+		return HAL_BUSY;
+	}
+
+	uart_tx.data = pData;
+	uart_tx.size = Size;
+	huart->gState = HAL_UART_STATE_BUSY_TX;
+	huart->ErrorCode = HAL_UART_ERROR_NONE;
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_DMA(UART_HandleTypeDef *huart, uint8_t *pData,
+                                               uint16_t Size)
+{
+	if (huart->Instance != USART2 || !pData || Size == 0) {
+		return HAL_ERROR;
+	}
+	if (huart->RxState != HAL_UART_STATE_READY) {
+		return HAL_BUSY;
+	}
+
+	uart_rx.data = pData;
+	uart_rx.size = Size;
+	uart_rx.pos = 0;
+	huart->RxState = HAL_UART_STATE_BUSY_RX;
+	huart->ErrorCode = HAL_UART_ERROR_NONE;
+	return HAL_OK;
+}
+
+void hal_shim_dma_disable_it(DMA_HandleTypeDef *hdma, uint32_t it)
+{
+	if (adc_dma.hadc && hdma == adc_dma.hadc->DMA_Handle) {
+		adc_dma.dma_it &= ~it;
+	}
+}
+
+uint32_t hal_shim_dma_get_counter(DMA_HandleTypeDef *hdma)
+{
+	if (hdma == &hdma_usart2_rx) {
+		return (uint32_t)(uart_rx.size - uart_rx.pos);
+	}
+
+	return 0;
+}
+
+__attribute__((weak)) void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+}
+
+__attribute__((weak)) void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size)
+{
+}
+
+__attribute__((weak)) void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
+{
+}
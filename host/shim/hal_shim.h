@@ -0,0 +1,282 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef HAL_SHIM_H
+#define HAL_SHIM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "stm32g4xx_hal.h"
+#include <stdbool.h>
+
+/**
+ * @brief Test-side control of the host HAL shim
+ *
+ * The shim replaces the peripherals the control core talks to. Tests use
+ * these functions to reset the fake hardware, move time forward and play
+ * the role of the ADC DMA engine.
+ */
+
+/* Handles that main.c owns on target */
+extern ADC_HandleTypeDef hadc2;
+extern DMA_HandleTypeDef hdma_adc2;
+extern TIM_HandleTypeDef htim2;
+extern TIM_HandleTypeDef htim3;
+extern I2C_HandleTypeDef hi2c1;
+extern I2C_HandleTypeDef hi2c2;
+extern UART_HandleTypeDef huart2;
+extern DMA_HandleTypeDef hdma_usart2_rx;
+extern DMA_HandleTypeDef hdma_usart2_tx;
+
+/**
+ * @brief Delay hook type
+ *
+ * Called from HAL_Delay() once per elapsed millisecond, after the tick has
+ * been advanced, so a plant model can keep running while firmware waits.
+ */
+typedef void (*hal_shim_delay_hook_t)(void);
+
+/**
+ * @brief Reset all fake peripherals and bind the handles to their instances
+ *
+ * Mirrors what MX_*_Init() would do on target: timers, ADC and DMA handles
+ * get their Instance pointers, registers are zeroed and the tick is 0.
+ */
+void hal_shim_reset(void);
+
+/**
+ * @brief Set the value returned by HAL_GetTick()
+ *
+ * @param ms Tick value in milliseconds
+ */
+void hal_shim_set_tick(uint32_t ms);
+
+/**
+ * @brief Advance the millisecond tick
+ *
+ * @param ms Number of milliseconds to add
+ */
+void hal_shim_advance_ms(uint32_t ms);
+
+/**
+ * @brief Stop the cycle counter following the host clock
+ *
+ * While manual, DWT->CYCCNT holds its value and only moves with
+ * hal_shim_advance_cycles() or writes, so code timed with it runs the
+ * same on every host. hal_shim_reset() goes back to the host clock.
+ *
+ * @param manual true to drive the counter by hand
+ */
+void hal_shim_dwt_manual(bool manual);
+
+/**
+ * @brief Advance a manual cycle counter
+ *
+ * Does nothing while the counter is not enabled (CYCCNTENA and TRCENA).
+ *
+ * @param cycles Number of cycles to add
+ */
+void hal_shim_advance_cycles(uint32_t cycles);
+
+/**
+ * @brief Install a hook run by HAL_Delay() for every elapsed millisecond
+ *
+ * @param hook Hook function, or NULL to remove
+ */
+void hal_shim_set_delay_hook(hal_shim_delay_hook_t hook);
+
+/**
+ * @brief Act as the ADC and its DMA engine for one or more conversions
+ *
+ * Regular group values go into the buffer passed to HAL_ADC_Start_DMA() at
+ * the current transfer position, wrapping in circular mode, raising the
+ * half and full transfer callbacks where the DMA controller would (unless
+ * disabled with __HAL_DMA_DISABLE_IT()).
+ *
+ * Once an injected group is configured, values come in whole triggers:
+ * the injected ranks, then the regular ranks. Each trigger fills the
+ * injected data registers and raises the injected conversion complete
+ * callback if HAL_ADCEx_InjectedStart_IT() was called. The chip converts
+ * the injected group first; the shim converts a trigger at once.
+ *
+ * @param values Converted samples in rank order
+ * @param count Number of samples
+ * @return 0 on success, -1 if the ADC is not running or count is not a
+ *         whole number of triggers
+ */
+int hal_shim_adc_push(const uint16_t *values, uint32_t count);
+
+/**
+ * @brief Check whether ADC DMA has been started
+ *
+ * @return true if HAL_ADC_Start_DMA() is active
+ */
+bool hal_shim_adc_running(void);
+
+/**
+ * @brief Check whether a PWM channel output is enabled
+ *
+ * @param htim Timer handle
+ * @param channel TIM_CHANNEL_x
+ * @return true if HAL_TIM_PWM_Start() was called for the channel
+ */
+bool hal_shim_pwm_enabled(TIM_HandleTypeDef *htim, uint32_t channel);
+
+/**
+ * @brief Raise the period elapsed interrupt of a timer
+ *
+ * @param htim Timer handle; ignored unless HAL_TIM_Base_Start_IT() was called
+ */
+void hal_shim_tim_elapse(TIM_HandleTypeDef *htim);
+
+/**
+ * @brief Counter writes while the timer was running
+ *
+ * A running counter keeps counting between writes, so timers written one
+ * after the other end up out of step.
+ *
+ * @param htim Timer handle
+ * @return Number of __HAL_TIM_SET_COUNTER() calls with CEN set
+ */
+uint32_t hal_shim_tim_running_writes(TIM_HandleTypeDef *htim);
+
+/**
+ * @brief Attach a fake register-mapped device to an I2C bus
+ *
+ * One device per bus; its 256 byte register file starts zeroed and is read
+ * by HAL_I2C_Mem_Read() and HAL_I2C_Mem_Read_IT() with auto-increment.
+ *
+ * @param hi2c I2C handle
+ * @param addr 7-bit device address, or 0 to detach
+ */
+void hal_shim_i2c_attach(I2C_HandleTypeDef *hi2c, uint8_t addr);
+
+/**
+ * @brief Set a register of the device attached to an I2C bus
+ *
+ * @param hi2c I2C handle
+ * @param reg Register address
+ * @param value Register value
+ */
+void hal_shim_i2c_set_reg(I2C_HandleTypeDef *hi2c, uint8_t reg, uint8_t value);
+
+/**
+ * @brief Finish the interrupt-driven transfer in flight on a bus
+ *
+ * Plays the I2C event interrupt: copies the registers into the buffer given
+ * to HAL_I2C_Mem_Read_IT() and raises HAL_I2C_MemRxCpltCallback(), or
+ * HAL_I2C_ErrorCallback() with HAL_I2C_ERROR_AF if no device answered.
+ *
+ * @param hi2c I2C handle
+ * @return true if a transfer was completed
+ */
+bool hal_shim_i2c_complete(I2C_HandleTypeDef *hi2c);
+
+/**
+ * @brief Number of I2C transactions issued on a bus since reset
+ *
+ * @param hi2c I2C handle
+ * @return Transaction count, including failed ones
+ */
+uint32_t hal_shim_i2c_transactions(I2C_HandleTypeDef *hi2c);
+
+/**
+ * @brief Finish the DMA transmit in flight on a UART
+ *
+ * Plays the DMA controller and the USART transmit complete interrupt: the
+ * bytes given to HAL_UART_Transmit_DMA() are appended to the captured
+ * output and HAL_UART_TxCpltCallback() is raised.
+ *
+ * @param huart UART handle
+ * @return true if a transfer was completed
+ */
+bool hal_shim_uart_tx_complete(UART_HandleTypeDef *huart);
+
+/**
+ * @brief Number of bytes in the DMA transmit in flight on a UART
+ *
+ * @param huart UART handle
+ * @return Transfer length, 0 if the transmitter is idle
+ */
+uint32_t hal_shim_uart_tx_pending(UART_HandleTypeDef *huart);
+
+/**
+ * @brief Receive bytes on a UART, followed by an idle line
+ *
+ * Plays the circular RX DMA channel: bytes are written into the buffer given
+ * to HAL_UARTEx_ReceiveToIdle_DMA(), raising HAL_UARTEx_RxEventCallback() at
+ * the half and full transfer points and once more for the idle line, with
+ * the same Size values the HAL reports.
+ *
+ * @param huart UART handle
+ * @param data Bytes arriving on the line
+ * @param len Number of bytes
+ * @return Number of bytes received, 0 if reception is not running
+ */
+uint32_t hal_shim_uart_rx_push(UART_HandleTypeDef *huart, const uint8_t *data, uint32_t len);
+
+/**
+ * @brief Raise a receive error on a UART
+ *
+ * As the HAL does in DMA mode, reception is aborted (RxState back to ready)
+ * before HAL_UART_ErrorCallback() runs with the given error code.
+ *
+ * @param huart UART handle
+ * @param error HAL_UART_ERROR_x flags
+ */
+void hal_shim_uart_rx_error(UART_HandleTypeDef *huart, uint32_t error);
+
+/**
+ * @brief Take the bytes a UART has sent so far
+ *
+ * Output of both blocking and DMA transmits is captured, up to 64 KiB.
+ *
+ * @param huart UART handle
+ * @param buf Buffer to store the bytes
+ * @param size Buffer size
+ * @return Number of bytes copied; they are removed from the capture
+ */
+uint32_t hal_shim_uart_take_output(UART_HandleTypeDef *huart, uint8_t *buf, uint32_t size);
+
+/**
+ * @brief Reset the emulated store flash, optionally backed by a file
+ *
+ * Replaces Src/drv/flash.c on the host. Without a file the region starts
+ * erased and lives in RAM. With one, an existing image is loaded (a new
+ * file starts erased) and every erase and program is written through, so
+ * the contents survive the process like flash survives a reset. The
+ * region is not touched by hal_shim_reset().
+ *
+ * @param path Image file, or NULL
+ * @return 0 on success, -1 if the file cannot be opened or written
+ */
+int hal_shim_flash_open(const char *path);
+
+/**
+ * @brief Cut the power to the store flash after some operations
+ *
+ * After @p ops more page erases or double word programs every further
+ * one fails; a multi-word flash_program() is left partly written.
+ *
+ * @param ops Operations that still succeed, -1 for no limit
+ */
+void hal_shim_flash_fail_after(int32_t ops);
+
+/**
+ * @brief Number of times a store page was erased since hal_shim_flash_open()
+ *
+ * @param page Page index
+ * @return Erase count
+ */
+uint32_t hal_shim_flash_erase_count(uint32_t page);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HAL_SHIM_H */
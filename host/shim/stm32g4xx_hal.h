@@ -0,0 +1,467 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef STM32G4XX_HAL_H
+#define STM32G4XX_HAL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Host-side stand-in for the STM32G4 HAL
+ *
+ * Only the types, macros and functions used by the control core are
+ * provided. Peripheral "registers" are plain structs in RAM so tests can
+ * inspect what the firmware wrote; see hal_shim.h for the test-side API.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define ENABLE   1U
+#define DISABLE  0U
+
+#define UNUSED(x) ((void)(x))
+
+typedef enum {
+	HAL_OK      = 0x00U,
+	HAL_ERROR   = 0x01U,
+	HAL_BUSY    = 0x02U,
+	HAL_TIMEOUT = 0x03U,
+} HAL_StatusTypeDef;
+
+/* ------------------------------------------------------------------------ */
+/* Timers                                                                    */
+/* ------------------------------------------------------------------------ */
+
+typedef struct {
+	volatile uint32_t CR1;
+	volatile uint32_t DIER;
+	volatile uint32_t CNT;
+	volatile uint32_t CCER;
+	volatile uint32_t PSC;
+	volatile uint32_t ARR;
+	volatile uint32_t CCR1;
+	volatile uint32_t CCR2;
+	volatile uint32_t CCR3;
+	volatile uint32_t CCR4;
+} TIM_TypeDef;
+
+extern TIM_TypeDef hal_shim_tim2;
+extern TIM_TypeDef hal_shim_tim3;
+
+#define TIM2 (&hal_shim_tim2)
+#define TIM3 (&hal_shim_tim3)
+
+typedef struct {
+	uint32_t Prescaler;
+	uint32_t CounterMode;
+	uint32_t Period;
+	uint32_t ClockDivision;
+	uint32_t RepetitionCounter;
+	uint32_t AutoReloadPreload;
+} TIM_Base_InitTypeDef;
+
+typedef struct {
+	TIM_TypeDef *Instance;
+	TIM_Base_InitTypeDef Init;
+} TIM_HandleTypeDef;
+
+typedef struct {
+	uint32_t OCMode;
+	uint32_t Pulse;
+	uint32_t OCPolarity;
+	uint32_t OCNPolarity;
+	uint32_t OCFastMode;
+	uint32_t OCIdleState;
+	uint32_t OCNIdleState;
+} TIM_OC_InitTypeDef;
+
+typedef struct {
+	uint32_t MasterOutputTrigger;
+	uint32_t MasterOutputTrigger2;
+	uint32_t MasterSlaveMode;
+} TIM_MasterConfigTypeDef;
+
+#define TIM_CHANNEL_1                 0x00000000U
+#define TIM_CHANNEL_2                 0x00000004U
+#define TIM_CHANNEL_3                 0x00000008U
+#define TIM_CHANNEL_4                 0x0000000CU
+
+#define TIM_CR1_CEN                   0x00000001U
+#define TIM_CCER_CCxE_MASK            0x00111111U
+#define TIM_CCER_CCxNE_MASK           0x00004444U
+
+#define TIM_COUNTERMODE_UP            0x00000000U
+#define TIM_COUNTERMODE_CENTERALIGNED1 0x00000020U
+#define TIM_CLOCKDIVISION_DIV1        0x00000000U
+#define TIM_AUTORELOAD_PRELOAD_DISABLE 0x00000000U
+#define TIM_AUTORELOAD_PRELOAD_ENABLE 0x00000080U
+#define TIM_OCMODE_TIMING             0x00000000U
+#define TIM_OCMODE_PWM1               0x00000060U
+#define TIM_OCMODE_PWM2               0x00000070U
+#define TIM_OCPOLARITY_HIGH           0x00000000U
+#define TIM_OCFAST_DISABLE            0x00000000U
+#define TIM_TRGO_RESET                0x00000000U
+#define TIM_TRGO_UPDATE               0x00000020U
+#define TIM_TRGO_OC4REF               0x00000070U
+#define TIM_TRGO2_RESET               0x00000000U
+#define TIM_MASTERSLAVEMODE_DISABLE   0x00000000U
+
+static inline volatile uint32_t *hal_shim_tim_ccr(TIM_TypeDef *tim, uint32_t channel)
+{
+	switch (channel) {
+	case TIM_CHANNEL_1: return &tim->CCR1;
+	case TIM_CHANNEL_2: return &tim->CCR2;
+	case TIM_CHANNEL_3: return &tim->CCR3;
+	default:            return &tim->CCR4;
+	}
+}
+
+#define __HAL_TIM_SET_COMPARE(__HANDLE__, __CHANNEL__, __COMPARE__) \
+	(*hal_shim_tim_ccr((__HANDLE__)->Instance, (__CHANNEL__)) = (__COMPARE__))
+#define __HAL_TIM_GET_COMPARE(__HANDLE__, __CHANNEL__) \
+	(*hal_shim_tim_ccr((__HANDLE__)->Instance, (__CHANNEL__)))
+#define __HAL_TIM_GET_AUTORELOAD(__HANDLE__) ((__HANDLE__)->Instance->ARR)
+#define __HAL_TIM_GET_COUNTER(__HANDLE__)    ((__HANDLE__)->Instance->CNT)
+void hal_shim_tim_set_counter(TIM_TypeDef *tim, uint32_t counter);
+#define __HAL_TIM_SET_COUNTER(__HANDLE__, __COUNTER__) \
+	hal_shim_tim_set_counter((__HANDLE__)->Instance, (__COUNTER__))
+#define __HAL_TIM_ENABLE(__HANDLE__)  ((__HANDLE__)->Instance->CR1 |= TIM_CR1_CEN)
+/* As the HAL: the counter keeps running while any output is enabled */
+#define __HAL_TIM_DISABLE(__HANDLE__) \
+	do { \
+		if (((__HANDLE__)->Instance->CCER & TIM_CCER_CCxE_MASK) == 0U && \
+		    ((__HANDLE__)->Instance->CCER & TIM_CCER_CCxNE_MASK) == 0U) { \
+			(__HANDLE__)->Instance->CR1 &= ~TIM_CR1_CEN; \
+		} \
+	} while (0)
+
+HAL_StatusTypeDef HAL_TIM_Base_Init(TIM_HandleTypeDef *htim);
+HAL_StatusTypeDef HAL_TIM_Base_Start(TIM_HandleTypeDef *htim);
+HAL_StatusTypeDef HAL_TIM_Base_Stop(TIM_HandleTypeDef *htim);
+HAL_StatusTypeDef HAL_TIM_Base_Start_IT(TIM_HandleTypeDef *htim);
+HAL_StatusTypeDef HAL_TIM_PWM_Init(TIM_HandleTypeDef *htim);
+HAL_StatusTypeDef HAL_TIM_PWM_ConfigChannel(TIM_HandleTypeDef *htim,
+                                            const TIM_OC_InitTypeDef *sConfig,
+                                            uint32_t Channel);
+HAL_StatusTypeDef HAL_TIM_PWM_Start(TIM_HandleTypeDef *htim, uint32_t Channel);
+HAL_StatusTypeDef HAL_TIM_PWM_Stop(TIM_HandleTypeDef *htim, uint32_t Channel);
+HAL_StatusTypeDef HAL_TIMEx_MasterConfigSynchronization(TIM_HandleTypeDef *htim,
+                                                        const TIM_MasterConfigTypeDef *sMasterConfig);
+void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim);
+
+/* ------------------------------------------------------------------------ */
+/* DMA / ADC                                                                 */
+/* ------------------------------------------------------------------------ */
+
+typedef struct {
+	uint32_t Request;
+	uint32_t Direction;
+	uint32_t PeriphInc;
+	uint32_t MemInc;
+	uint32_t PeriphDataAlignment;
+	uint32_t MemDataAlignment;
+	uint32_t Mode;
+	uint32_t Priority;
+} DMA_InitTypeDef;
+
+typedef struct {
+	void *Instance;
+	DMA_InitTypeDef Init;
+} DMA_HandleTypeDef;
+
+/* Remaining transfers of a channel (CNDTR) */
+uint32_t hal_shim_dma_get_counter(DMA_HandleTypeDef *hdma);
+#define __HAL_DMA_GET_COUNTER(__HANDLE__) hal_shim_dma_get_counter(__HANDLE__)
+
+/* Channel interrupt enables, set by the HAL_xxx_Start_DMA() functions */
+void hal_shim_dma_disable_it(DMA_HandleTypeDef *hdma, uint32_t it);
+#define __HAL_DMA_DISABLE_IT(__HANDLE__, __INTERRUPT__) \
+	hal_shim_dma_disable_it((__HANDLE__), (__INTERRUPT__))
+
+#define DMA_IT_TC     0x00000002U
+#define DMA_IT_HT     0x00000004U
+
+#define DMA_NORMAL    0x00000000U
+#define DMA_CIRCULAR  0x00000020U
+
+typedef struct {
+	uint32_t unused;
+} ADC_TypeDef;
+
+extern ADC_TypeDef hal_shim_adc2;
+#define ADC2 (&hal_shim_adc2)
+
+typedef struct {
+	uint32_t Ratio;
+	uint32_t RightBitShift;
+	uint32_t TriggeredMode;
+	uint32_t OversamplingStopReset;
+} ADC_OversamplingTypeDef;
+
+typedef struct {
+	uint32_t ClockPrescaler;
+	uint32_t Resolution;
+	uint32_t DataAlign;
+	uint32_t GainCompensation;
+	uint32_t ScanConvMode;
+	uint32_t EOCSelection;
+	uint32_t LowPowerAutoWait;
+	uint32_t ContinuousConvMode;
+	uint32_t NbrOfConversion;
+	uint32_t DiscontinuousConvMode;
+	uint32_t NbrOfDiscConversion;
+	uint32_t ExternalTrigConv;
+	uint32_t ExternalTrigConvEdge;
+	uint32_t SamplingMode;
+	uint32_t DMAContinuousRequests;
+	uint32_t Overrun;
+	uint32_t OversamplingMode;
+	ADC_OversamplingTypeDef Oversampling;
+} ADC_InitTypeDef;
+
+typedef struct {
+	ADC_TypeDef *Instance;
+	ADC_InitTypeDef Init;
+	DMA_HandleTypeDef *DMA_Handle;
+} ADC_HandleTypeDef;
+
+typedef struct {
+	uint32_t Channel;
+	uint32_t Rank;
+	uint32_t SamplingTime;
+	uint32_t SingleDiff;
+	uint32_t OffsetNumber;
+	uint32_t Offset;
+} ADC_ChannelConfTypeDef;
+
+#define ADC_CHANNEL_1                        1U
+#define ADC_CHANNEL_2                        2U
+#define ADC_CHANNEL_3                        3U
+#define ADC_CHANNEL_4                        4U
+#define ADC_CHANNEL_12                       12U
+
+#define ADC_REGULAR_RANK_1                   1U
+#define ADC_REGULAR_RANK_2                   2U
+#define ADC_REGULAR_RANK_3                   3U
+#define ADC_REGULAR_RANK_4                   4U
+#define ADC_REGULAR_RANK_5                   5U
+#define ADC_INJECTED_RANK_1                  1U
+#define ADC_INJECTED_RANK_2                  2U
+#define ADC_INJECTED_RANK_3                  3U
+#define ADC_INJECTED_RANK_4                  4U
+
+#define ADC_CLOCK_SYNC_PCLK_DIV4             0U
+#define ADC_RESOLUTION_12B                   0U
+#define ADC_DATAALIGN_RIGHT                  0U
+#define ADC_SCAN_DISABLE                     0U
+#define ADC_SCAN_ENABLE                      1U
+#define ADC_EOC_SINGLE_CONV                  0U
+#define ADC_EOC_SEQ_CONV                     1U
+#define ADC_SOFTWARE_START                   0U
+#define ADC_EXTERNALTRIG_T2_TRGO             1U
+#define ADC_EXTERNALTRIGCONVEDGE_NONE        0U
+#define ADC_EXTERNALTRIGCONVEDGE_RISING      1U
+#define ADC_EXTERNALTRIGINJEC_T2_TRGO        1U
+#define ADC_EXTERNALTRIGINJECCONV_EDGE_RISING 1U
+#define ADC_OVR_DATA_PRESERVED               0U
+#define ADC_OVR_DATA_OVERWRITTEN             1U
+#define ADC_OVERSAMPLING_RATIO_4             4U
+#define ADC_RIGHTBITSHIFT_2                  2U
+#define ADC_TRIGGEREDMODE_SINGLE_TRIGGER     0U
+#define ADC_REGOVERSAMPLING_CONTINUED_MODE   0U
+#define ADC_SAMPLETIME_2CYCLES_5             0U
+#define ADC_SAMPLETIME_12CYCLES_5            2U
+#define ADC_SAMPLETIME_47CYCLES_5            5U
+#define ADC_SINGLE_ENDED                     0U
+#define ADC_OFFSET_NONE                      0U
+
+typedef struct {
+	uint32_t InjectedChannel;
+	uint32_t InjectedRank;
+	uint32_t InjectedSamplingTime;
+	uint32_t InjectedSingleDiff;
+	uint32_t InjectedOffsetNumber;
+	uint32_t InjectedOffset;
+	uint32_t InjectedNbrOfConversion;
+	uint32_t InjectedDiscontinuousConvMode;
+	uint32_t AutoInjectedConv;
+	uint32_t QueueInjectedContext;
+	uint32_t ExternalTrigInjecConv;
+	uint32_t ExternalTrigInjecConvEdge;
+	uint32_t InjecOversamplingMode;
+} ADC_InjectionConfTypeDef;
+
+HAL_StatusTypeDef HAL_ADC_Init(ADC_HandleTypeDef *hadc);
+HAL_StatusTypeDef HAL_ADC_ConfigChannel(ADC_HandleTypeDef *hadc,
+                                        const ADC_ChannelConfTypeDef *sConfig);
+HAL_StatusTypeDef HAL_ADCEx_Calibration_Start(ADC_HandleTypeDef *hadc, uint32_t SingleDiff);
+HAL_StatusTypeDef HAL_ADC_Start_DMA(ADC_HandleTypeDef *hadc, uint32_t *pData, uint32_t Length);
+HAL_StatusTypeDef HAL_ADC_Stop_DMA(ADC_HandleTypeDef *hadc);
+void HAL_ADC_ConvHalfCpltCallback(ADC_HandleTypeDef *hadc);
+void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef *hadc);
+HAL_StatusTypeDef HAL_ADCEx_InjectedConfigChannel(ADC_HandleTypeDef *hadc,
+                                                  const ADC_InjectionConfTypeDef *pConfigInjected);
+HAL_StatusTypeDef HAL_ADCEx_InjectedStart_IT(ADC_HandleTypeDef *hadc);
+HAL_StatusTypeDef HAL_ADCEx_InjectedStop_IT(ADC_HandleTypeDef *hadc);
+uint32_t HAL_ADCEx_InjectedGetValue(const ADC_HandleTypeDef *hadc, uint32_t InjectedRank);
+void HAL_ADCEx_InjectedConvCpltCallback(ADC_HandleTypeDef *hadc);
+
+/* ------------------------------------------------------------------------ */
+/* I2C                                                                       */
+/* ------------------------------------------------------------------------ */
+
+typedef struct {
+	uint32_t unused;
+} I2C_TypeDef;
+
+extern I2C_TypeDef hal_shim_i2c1;
+extern I2C_TypeDef hal_shim_i2c2;
+#define I2C1 (&hal_shim_i2c1)
+#define I2C2 (&hal_shim_i2c2)
+
+typedef struct {
+	uint32_t Timing;
+	uint32_t OwnAddress1;
+	uint32_t AddressingMode;
+	uint32_t DualAddressMode;
+	uint32_t OwnAddress2;
+	uint32_t OwnAddress2Masks;
+	uint32_t GeneralCallMode;
+	uint32_t NoStretchMode;
+} I2C_InitTypeDef;
+
+typedef struct {
+	I2C_TypeDef *Instance;
+	I2C_InitTypeDef Init;
+	volatile uint32_t ErrorCode;
+} I2C_HandleTypeDef;
+
+#define I2C_MEMADD_SIZE_8BIT  0x00000001U
+
+#define HAL_I2C_ERROR_NONE    0x00000000U
+#define HAL_I2C_ERROR_AF      0x00000004U
+
+HAL_StatusTypeDef HAL_I2C_Mem_Read(I2C_HandleTypeDef *hi2c, uint16_t DevAddress,
+                                   uint16_t MemAddress, uint16_t MemAddSize,
+                                   uint8_t *pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_I2C_Mem_Read_IT(I2C_HandleTypeDef *hi2c, uint16_t DevAddress,
+                                      uint16_t MemAddress, uint16_t MemAddSize,
+                                      uint8_t *pData, uint16_t Size);
+HAL_StatusTypeDef HAL_I2C_IsDeviceReady(I2C_HandleTypeDef *hi2c, uint16_t DevAddress,
+                                        uint32_t Trials, uint32_t Timeout);
+uint32_t HAL_I2C_GetError(I2C_HandleTypeDef *hi2c);
+void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef *hi2c);
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c);
+
+/* ------------------------------------------------------------------------ */
+/* UART                                                                      */
+/* ------------------------------------------------------------------------ */
+
+typedef struct {
+	uint32_t unused;
+} USART_TypeDef;
+
+extern USART_TypeDef hal_shim_usart2;
+#define USART2 (&hal_shim_usart2)
+
+typedef struct {
+	uint32_t BaudRate;
+	uint32_t WordLength;
+	uint32_t StopBits;
+	uint32_t Parity;
+	uint32_t Mode;
+	uint32_t HwFlowCtl;
+	uint32_t OverSampling;
+} UART_InitTypeDef;
+
+typedef enum {
+	HAL_UART_STATE_RESET   = 0x00U,
+	HAL_UART_STATE_READY   = 0x20U,
+	HAL_UART_STATE_BUSY_TX = 0x21U,
+	HAL_UART_STATE_BUSY_RX = 0x22U,
+} HAL_UART_StateTypeDef;
+
+typedef struct {
+	USART_TypeDef *Instance;
+	UART_InitTypeDef Init;
+	DMA_HandleTypeDef *hdmatx;
+	DMA_HandleTypeDef *hdmarx;
+	volatile HAL_UART_StateTypeDef gState;
+	volatile HAL_UART_StateTypeDef RxState;
+	volatile uint32_t ErrorCode;
+} UART_HandleTypeDef;
+
+#define HAL_UART_ERROR_NONE   0x00000000U
+#define HAL_UART_ERROR_PE     0x00000001U
+#define HAL_UART_ERROR_NE     0x00000002U
+#define HAL_UART_ERROR_FE     0x00000004U
+#define HAL_UART_ERROR_ORE    0x00000008U
+#define HAL_UART_ERROR_DMA    0x00000010U
+
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart, const uint8_t *pData,
+                                    uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart, const uint8_t *pData,
+                                        uint16_t Size);
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_DMA(UART_HandleTypeDef *huart, uint8_t *pData,
+                                               uint16_t Size);
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart);
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size);
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart);
+
+/* ------------------------------------------------------------------------ */
+/* Core                                                                      */
+/* ------------------------------------------------------------------------ */
+
+/*
+ * The host has no interrupt masking: tests run interrupt handlers by hand,
+ * on the same thread, so critical sections are no-ops and the caller is
+ * never in handler mode.
+ */
+static inline uint32_t __get_PRIMASK(void) { return 0; }
+static inline void __set_PRIMASK(uint32_t primask) { (void)primask; }
+static inline void __disable_irq(void) {}
+static inline void __enable_irq(void) {}
+static inline uint32_t __get_IPSR(void) { return 0; }
+
+/*
+ * Cycle counter. CYCCNT follows the host monotonic clock scaled to
+ * SystemCoreClock while CYCCNTENA is set; writes to it set the count.
+ */
+typedef struct {
+	volatile uint32_t CTRL;
+	volatile uint32_t CYCCNT;
+} DWT_Type;
+
+typedef struct {
+	volatile uint32_t DEMCR;
+} CoreDebug_Type;
+
+#define DWT_CTRL_CYCCNTENA_Msk      0x00000001U
+#define CoreDebug_DEMCR_TRCENA_Msk  0x01000000U
+
+extern CoreDebug_Type hal_shim_core_debug;
+DWT_Type *hal_shim_dwt(void);
+#define DWT (hal_shim_dwt())
+#define CoreDebug (&hal_shim_core_debug)
+
+extern uint32_t SystemCoreClock;
+
+/* ------------------------------------------------------------------------ */
+/* System                                                                    */
+/* ------------------------------------------------------------------------ */
+
+uint32_t HAL_GetTick(void);
+void HAL_Delay(uint32_t Delay);
+void Error_Handler(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* STM32G4XX_HAL_H */
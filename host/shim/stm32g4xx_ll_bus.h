@@ -0,0 +1,13 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef STM32G4XX_LL_BUS_H
+#define STM32G4XX_LL_BUS_H
+
+/* Included by main.h; the control core does not use the LL API on the host. */
+#include "stm32g4xx_hal.h"
+
+#endif /* STM32G4XX_LL_BUS_H */
@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "pmsm.h"
+#include <math.h>
+#include <string.h>
+
+#define TWO_PI_F    6.28318530717958647692f
+#define SQRT3_F     1.73205080756887729353f
+
+const struct pmsm_params pmsm_default_params = {
+	.rs = 5.0f,
+	.ls = 0.002f,
+	.flux = 0.005f,
+	.pole_pairs = 7,
+	.inertia = 2.0e-5f,
+	.friction = 1.0e-5f,
+	.coulomb = 1.0e-4f,
+	.load_torque = 0.0f,
+	.vbus = 12.0f,
+	.substeps = 10,
+};
+
+static float wrap_2pi(float angle)
+{
+	angle = fmodf(angle, TWO_PI_F);
+	if (angle < 0.0f) {
+		angle += TWO_PI_F;
+	}
+	return angle;
+}
+
+void pmsm_init(struct pmsm *motor, const struct pmsm_params *params)
+{
+	memset(motor, 0, sizeof(*motor));
+	motor->params = *params;
+	if (motor->params.substeps == 0) {
+		motor->params.substeps = 1;
+	}
+}
+
+void pmsm_step(struct pmsm *motor, const float duty[3], float dt)
+{
+	const struct pmsm_params *p = &motor->params;
+	struct pmsm_state *s = &motor->state;
+	float h = dt / (float)p->substeps;
+	float va, vb, vc, v_alpha, v_beta;
+
+	/* Phase-to-ground voltages; Clarke removes the common mode */
+	va = duty[0] * p->vbus;
+	vb = duty[1] * p->vbus;
+	vc = duty[2] * p->vbus;
+	v_alpha = (2.0f * va - vb - vc) / 3.0f;
+	v_beta = (vb - vc) / SQRT3_F;
+
+	for (uint8_t i = 0; i < p->substeps; i++) {
+		float c = cosf(s->theta_e);
+		float sn = sinf(s->theta_e);
+		float omega_e = s->omega_m * (float)p->pole_pairs;
+		float did, diq, net;
+
+		s->vd = v_alpha * c + v_beta * sn;
+		s->vq = -v_alpha * sn + v_beta * c;
+
+		did = (s->vd - p->rs * s->id + omega_e * p->ls * s->iq) / p->ls;
+		diq = (s->vq - p->rs * s->iq - omega_e * p->ls * s->id - omega_e * p->flux) / p->ls;
+		s->id += did * h;
+		s->iq += diq * h;
+
+		s->torque = 1.5f * (float)p->pole_pairs * p->flux * s->iq;
+
+		net = s->torque - p->friction * s->omega_m - p->load_torque;
+		if (s->omega_m == 0.0f && fabsf(net) <= p->coulomb) {
+			/* Static friction holds the rotor */
+			net = 0.0f;
+		} else if (s->omega_m > 0.0f || (s->omega_m == 0.0f && net > 0.0f)) {
+			net -= p->coulomb;
+		} else {
+			net += p->coulomb;
+		}
+
+		float omega_next = s->omega_m + net / p->inertia * h;
+
+		/* Coulomb friction stops the rotor instead of reversing it */
+		if ((s->omega_m > 0.0f && omega_next < 0.0f) ||
+		    (s->omega_m < 0.0f && omega_next > 0.0f)) {
+			omega_next = 0.0f;
+		}
+
+		s->theta_m = wrap_2pi(s->theta_m + 0.5f * (s->omega_m + omega_next) * h);
+		s->omega_m = omega_next;
+		s->theta_e = wrap_2pi(s->theta_m * (float)p->pole_pairs);
+	}
+
+	/* Phase currents from the dq state */
+	{
+		float c = cosf(s->theta_e);
+		float sn = sinf(s->theta_e);
+		float i_alpha = s->id * c - s->iq * sn;
+		float i_beta = s->id * sn + s->iq * c;
+
+		s->ia = i_alpha;
+		s->ib = -0.5f * i_alpha + 0.5f * SQRT3_F * i_beta;
+		s->ic = -s->ia - s->ib;
+	}
+}
+
+float pmsm_rpm(const struct pmsm *motor)
+{
+	return motor->state.omega_m * 60.0f / TWO_PI_F;
+}
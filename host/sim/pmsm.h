@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef PMSM_H
+#define PMSM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/**
+ * @brief Permanent-magnet synchronous motor plant model
+ *
+ * dq-frame electrical model (surface magnets, Ld = Lq) with a rigid-body
+ * mechanical model, driven by the three inverter duty cycles. The rotor
+ * d-axis is aligned with the phase A winding at electrical angle 0, which
+ * matches the firmware convention of phase A voltage = cos(angle).
+ */
+
+/**
+ * @brief Motor and inverter parameters
+ */
+struct pmsm_params {
+	float rs;                    /* Phase resistance (Ohm) */
+	float ls;                    /* Phase inductance (H) */
+	float flux;                  /* Permanent-magnet flux linkage (Wb) */
+	uint8_t pole_pairs;          /* Number of pole pairs */
+	float inertia;               /* Rotor + load inertia (kg m^2) */
+	float friction;              /* Viscous friction (N m s/rad) */
+	float coulomb;               /* Coulomb friction (N m) */
+	float load_torque;           /* External load torque (N m), opposes +speed */
+	float vbus;                  /* DC bus voltage (V) */
+	uint8_t substeps;            /* Integration substeps per step */
+};
+
+/**
+ * @brief Motor state
+ */
+struct pmsm_state {
+	float id;                    /* d-axis current (A) */
+	float iq;                    /* q-axis current (A) */
+	float ia;                    /* Phase A current (A) */
+	float ib;                    /* Phase B current (A) */
+	float ic;                    /* Phase C current (A) */
+	float omega_m;               /* Mechanical speed (rad/s) */
+	float theta_m;               /* Mechanical angle (rad, 0-2pi) */
+	float theta_e;               /* Electrical angle (rad, 0-2pi) */
+	float torque;                /* Electromagnetic torque (N m) */
+	float vd;                    /* Applied d-axis voltage (V) */
+	float vq;                    /* Applied q-axis voltage (V) */
+};
+
+/**
+ * @brief PMSM instance
+ */
+struct pmsm {
+	struct pmsm_params params;
+	struct pmsm_state state;
+};
+
+/**
+ * @brief Default parameters: 2204-class gimbal motor on a 12 V bus
+ */
+extern const struct pmsm_params pmsm_default_params;
+
+/**
+ * @brief Initialize a motor at standstill
+ *
+ * @param motor Pointer to PMSM instance
+ * @param params Motor parameters (copied)
+ */
+void pmsm_init(struct pmsm *motor, const struct pmsm_params *params);
+
+/**
+ * @brief Advance the model with constant inverter duty cycles
+ *
+ * @param motor Pointer to PMSM instance
+ * @param duty Duty cycle of phases A, B, C (0-1)
+ * @param dt Step length in seconds
+ */
+void pmsm_step(struct pmsm *motor, const float duty[3], float dt);
+
+/**
+ * @brief Mechanical speed in RPM
+ *
+ * @param motor Pointer to PMSM instance
+ * @return Speed in RPM
+ */
+float pmsm_rpm(const struct pmsm *motor);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PMSM_H */
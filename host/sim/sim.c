@@ -0,0 +1,285 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "sim.h"
+#include "foc.h"
+#include "drv/adc_dma.h"
+#include "drv/pwm.h"
+#include <math.h>
+#include <string.h>
+#include <time.h>
+
+#define TWO_PI_F     6.28318530717958647692f
+#define ADC_FULL     4095.0f
+#define VBUS_INDEX   4
+
+const struct sim_sensor_params sim_default_sensor_params = {
+	.current_sensitivity = 1.2f,
+	.current_offset = 1.65f,
+	.vbus_divider = 0.1f,
+};
+
+static struct sim_motor sim_motors[SIM_NUM_MOTORS];
+static mt6701_t sim_encoders[SIM_NUM_MOTORS];
+static struct sim_sensor_params sensor;
+static struct sim_stats stats;
+static sim_control_fn control = foc_task;
+
+static double now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static uint16_t volts_to_raw(float volts)
+{
+	float raw = volts / ((float)ADC_VREF_MV / 1000.0f) * 4096.0f;
+
+	if (raw < 0.0f) {
+		raw = 0.0f;
+	} else if (raw > ADC_FULL) {
+		raw = ADC_FULL;
+	}
+	return (uint16_t)lrintf(raw);
+}
+
+static void encoder_publish(struct sim_motor *m)
+{
+	float angle = m->plant.state.theta_m + m->encoder_offset;
+	uint16_t raw;
+
+	angle = fmodf(angle, TWO_PI_F);
+	if (angle < 0.0f) {
+		angle += TWO_PI_F;
+	}
+	raw = (uint16_t)(angle / TWO_PI_F * (float)MT6701_ANGLE_RESOLUTION) &
+	      (MT6701_ANGLE_RESOLUTION - 1);
+
+	/* Angle[13:6] in 0x03, Angle[5:0] in bits [7:2] of 0x04 */
+	hal_shim_i2c_set_reg(m->hi2c, MT6701_REG_ANGLE_H, (uint8_t)(raw >> 6));
+	hal_shim_i2c_set_reg(m->hi2c, MT6701_REG_ANGLE_L, (uint8_t)((raw & 0x3F) << 2));
+}
+
+static void adc_sample(void)
+{
+	uint16_t values[ADC_DMA_NUM_CHANNELS];
+	double t0;
+
+	for (int i = 0; i < ADC_DMA_NUM_CHANNELS; i++) {
+		values[i] = volts_to_raw(sensor.current_offset);
+	}
+
+	for (int i = 0; i < SIM_NUM_MOTORS; i++) {
+		struct sim_motor *m = &sim_motors[i];
+
+		values[m->adc_channel_a] = volts_to_raw(sensor.current_offset +
+		                                        m->plant.state.ia * sensor.current_sensitivity);
+		values[m->adc_channel_b] = volts_to_raw(sensor.current_offset +
+		                                        m->plant.state.ib * sensor.current_sensitivity);
+	}
+	values[VBUS_INDEX] = volts_to_raw(sim_motors[0].plant.params.vbus * sensor.vbus_divider);
+
+	t0 = now_ns();
+	hal_shim_adc_push(values, ADC_DMA_NUM_CHANNELS);
+	t0 = now_ns() - t0;
+
+	stats.isr_ns_total += t0;
+	if (t0 > stats.isr_ns_max) {
+		stats.isr_ns_max = t0;
+	}
+}
+
+static void plant_step(struct sim_motor *m)
+{
+	/* Centre-aligned: the phase is high for CCR of ARR ticks each way */
+	float period = (float)__HAL_TIM_GET_AUTORELOAD(m->htim);
+
+	for (int p = 0; p < 3; p++) {
+		float duty = 0.0f;
+
+		if (hal_shim_pwm_enabled(m->htim, m->channel[p])) {
+			duty = (float)__HAL_TIM_GET_COMPARE(m->htim, m->channel[p]) / period;
+			if (duty > 1.0f) {
+				duty = 1.0f;
+			}
+		}
+		m->duty[p] = duty;
+	}
+
+	pmsm_step(&m->plant, m->duty, 1.0f / (float)SIM_PWM_HZ);
+	encoder_publish(m);
+}
+
+/* ADC conversion complete interrupt: the board runs the current loop here */
+static void adc_callback(uint16_t *values, uint8_t num_channels)
+{
+	foc_current_task();
+}
+
+static void delay_hook(void)
+{
+	for (int i = 0; i < SIM_STEPS_PER_MS; i++) {
+		sim_step();
+	}
+}
+
+void sim_init(const struct pmsm_params *params, const struct sim_sensor_params *sensor_params)
+{
+	hal_shim_reset();
+
+	sensor = sensor_params ? *sensor_params : sim_default_sensor_params;
+	memset(&stats, 0, sizeof(stats));
+	memset(sim_motors, 0, sizeof(sim_motors));
+	control = foc_task;
+
+	for (int i = 0; i < SIM_NUM_MOTORS; i++) {
+		pmsm_init(&sim_motors[i].plant, params ? params : &pmsm_default_params);
+	}
+
+	/* Wiring as on the board (pwm.c, foc.c, main.c) */
+	sim_motors[0].htim = &htim2;
+	sim_motors[0].channel[0] = TIM_CHANNEL_1;
+	sim_motors[0].channel[1] = TIM_CHANNEL_2;
+	sim_motors[0].channel[2] = TIM_CHANNEL_3;
+	sim_motors[0].adc_channel_a = 0;
+	sim_motors[0].adc_channel_b = 1;
+	sim_motors[0].hi2c = &hi2c2;
+
+	sim_motors[1].htim = &htim3;
+	sim_motors[1].channel[0] = TIM_CHANNEL_2;
+	sim_motors[1].channel[1] = TIM_CHANNEL_3;
+	sim_motors[1].channel[2] = TIM_CHANNEL_4;
+	sim_motors[1].adc_channel_a = 2;
+	sim_motors[1].adc_channel_b = 3;
+	sim_motors[1].hi2c = &hi2c1;
+
+	for (int i = 0; i < SIM_NUM_MOTORS; i++) {
+		hal_shim_i2c_attach(sim_motors[i].hi2c, MT6701_I2C_ADDR);
+		encoder_publish(&sim_motors[i]);
+	}
+
+	hal_shim_set_delay_hook(delay_hook);
+}
+
+int sim_boot(void)
+{
+	struct pwm_device *pwm[2];
+
+	if (adc_dma_init(&hadc2, &hdma_adc2, &htim2) != 0) {
+		return -1;
+	}
+	adc_dma_set_callback(adc_callback);
+
+	pwm[0] = pwm_get_device("pwm_motor0");
+	pwm[1] = pwm_get_device("pwm_motor1");
+	if (pwm_init(pwm[0]) != 0 || pwm_init(pwm[1]) != 0) {
+		return -1;
+	}
+
+	mt6701_init(&sim_encoders[0], &hi2c2, MT6701_I2C_ADDR, "encoder_motor0");
+	mt6701_init(&sim_encoders[1], &hi2c1, MT6701_I2C_ADDR, "encoder_motor1");
+
+	/* foc.c state outlives a simulation run; start from reset like main() */
+	for (int i = 0; i < SIM_NUM_MOTORS; i++) {
+		struct foc_motor *motor = foc_get_motor(i == 0 ? "motor0" : "motor1");
+
+		foc_velocity_disable(motor);
+		foc_encoder_attach(motor, &sim_encoders[i], 0.0f);
+	}
+
+	if (pwm_start(pwm[0]) != 0 || pwm_start(pwm[1]) != 0) {
+		return -1;
+	}
+
+	if (pwm_sync(pwm, 2) != 0) {
+		return -1;
+	}
+
+	if (adc_dma_start() != 0) {
+		return -1;
+	}
+
+	/* A first sample set before anybody reads one */
+	adc_sample();
+	return 0;
+}
+
+struct sim_motor *sim_get_motor(int index)
+{
+	if (index < 0 || index >= SIM_NUM_MOTORS) {
+		return NULL;
+	}
+	return &sim_motors[index];
+}
+
+mt6701_t *sim_get_encoder(int index)
+{
+	if (index < 0 || index >= SIM_NUM_MOTORS) {
+		return NULL;
+	}
+	return &sim_encoders[index];
+}
+
+void sim_set_control(sim_control_fn fn)
+{
+	control = fn;
+}
+
+void sim_step(void)
+{
+	/* Encoder reads started last period have finished by now */
+	for (int i = 0; i < SIM_NUM_MOTORS; i++) {
+		hal_shim_i2c_complete(sim_motors[i].hi2c);
+	}
+
+	/* ADC is triggered at the top of the count by TIM2 TRGO */
+	adc_sample();
+
+	for (int i = 0; i < SIM_NUM_MOTORS; i++) {
+		plant_step(&sim_motors[i]);
+	}
+
+	stats.steps++;
+}
+
+void sim_run_ms(uint32_t ms)
+{
+	for (uint32_t t = 0; t < ms; t++) {
+		/* 1 kHz encoder task: start the encoder reads as main.c does */
+		foc_encoder_start();
+
+		for (int i = 0; i < SIM_STEPS_PER_MS; i++) {
+			sim_step();
+		}
+
+		hal_shim_advance_ms(1);
+
+		if (control) {
+			double t0 = now_ns();
+
+			control();
+			t0 = now_ns() - t0;
+
+			stats.control_calls++;
+			stats.control_ns_total += t0;
+			if (t0 > stats.control_ns_max) {
+				stats.control_ns_max = t0;
+			}
+		}
+	}
+}
+
+double sim_time(void)
+{
+	return (double)stats.steps / (double)SIM_PWM_HZ;
+}
+
+const struct sim_stats *sim_get_stats(void)
+{
+	return &stats;
+}
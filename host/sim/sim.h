@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef SIM_H
+#define SIM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "hal_shim.h"
+#include "pmsm.h"
+#include "drv/mt6701.h"
+#include <stdbool.h>
+
+/**
+ * @brief Closed-loop simulation of the firmware against two PMSM plants
+ *
+ * Every PWM period the harness samples the plant currents into the ADC DMA
+ * buffer (raising the same callbacks as the DMA controller), publishes the
+ * rotor angle in the fake MT6701 registers and then integrates the plants
+ * with the duty cycles found in the compare registers. Encoder reads are
+ * started at the top of every millisecond (the scheduler's encoder task)
+ * and complete one PWM period later. The firmware control function runs
+ * once per millisecond, as the 1 kHz main-loop tasks do.
+ */
+
+#define SIM_NUM_MOTORS     2
+#define SIM_PWM_HZ         20000
+#define SIM_STEPS_PER_MS   (SIM_PWM_HZ / 1000)
+
+/**
+ * @brief Control function run at 1 kHz (foc_task by default)
+ */
+typedef void (*sim_control_fn)(void);
+
+/**
+ * @brief Sensor front-end parameters shared by both motors
+ */
+struct sim_sensor_params {
+	float current_sensitivity;   /* Current amplifier output (V/A) */
+	float current_offset;        /* Current amplifier output at 0 A (V) */
+	float vbus_divider;          /* Bus voltage divider ratio (ADC V / bus V) */
+};
+
+/**
+ * @brief One simulated motor and the peripherals it is wired to
+ */
+struct sim_motor {
+	struct pmsm plant;
+	TIM_HandleTypeDef *htim;     /* PWM timer */
+	uint32_t channel[3];         /* Phase A, B, C timer channels */
+	uint8_t adc_channel_a;       /* DMA buffer index of phase A current */
+	uint8_t adc_channel_b;       /* DMA buffer index of phase B current */
+	I2C_HandleTypeDef *hi2c;     /* Encoder bus */
+	float encoder_offset;        /* Encoder zero vs rotor d-axis (mech. rad) */
+	float duty[3];               /* Duty cycles applied in the last step */
+};
+
+/**
+ * @brief Run statistics
+ */
+struct sim_stats {
+	uint64_t steps;              /* PWM periods simulated */
+	uint64_t control_calls;      /* Control function invocations */
+	double control_ns_total;     /* Host time spent in the control function */
+	double control_ns_max;
+	double isr_ns_total;         /* Host time spent in ADC DMA callbacks */
+	double isr_ns_max;
+};
+
+/**
+ * @brief Default sensor front-end matching the foc.c current configuration
+ */
+extern const struct sim_sensor_params sim_default_sensor_params;
+
+/**
+ * @brief Reset the fake hardware and create both motor plants
+ *
+ * Also installs a HAL_Delay() hook so the plants keep running while the
+ * firmware blocks.
+ *
+ * @param params Motor parameters for both plants (NULL for defaults)
+ * @param sensor Sensor front-end parameters (NULL for defaults)
+ */
+void sim_init(const struct pmsm_params *params, const struct sim_sensor_params *sensor);
+
+/**
+ * @brief Bring up the control core the way main() does
+ *
+ * Initializes ADC DMA, both PWM devices and both encoders, attaches the
+ * encoders to the FOC motors (offset 0), then starts PWM and ADC DMA.
+ *
+ * @return 0 on success, negative value on failure
+ */
+int sim_boot(void);
+
+/**
+ * @brief Get a simulated motor
+ *
+ * @param index Motor index (0 or 1)
+ * @return Pointer to motor or NULL
+ */
+struct sim_motor *sim_get_motor(int index);
+
+/**
+ * @brief Get the MT6701 device wired to a simulated motor
+ *
+ * @param index Motor index (0 or 1)
+ * @return Pointer to encoder device or NULL
+ */
+mt6701_t *sim_get_encoder(int index);
+
+/**
+ * @brief Replace the 1 kHz control function
+ *
+ * @param fn Control function, or NULL to run no control
+ */
+void sim_set_control(sim_control_fn fn);
+
+/**
+ * @brief Simulate one PWM period without running the 1 kHz control
+ */
+void sim_step(void);
+
+/**
+ * @brief Simulate whole milliseconds, running the control function each one
+ *
+ * @param ms Number of milliseconds
+ */
+void sim_run_ms(uint32_t ms);
+
+/**
+ * @brief Simulated time since sim_init()
+ *
+ * @return Time in seconds
+ */
+double sim_time(void);
+
+/**
+ * @brief Get run statistics
+ *
+ * @return Pointer to statistics
+ */
+const struct sim_stats *sim_get_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SIM_H */
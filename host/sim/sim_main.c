@@ -0,0 +1,255 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * foc2_sim: run the control core against the PMSM plant faster than real time
+ * and report ramp tracking, overcurrent behaviour and control CPU cost.
+ *
+ * With --flash the configuration store lives in an image file, as it lives
+ * in flash on target: the first run calibrates and saves the offsets, later
+ * runs load them (and any saved gains) instead.
+ */
+
+#include "sim.h"
+#include "foc.h"
+#include "hal_shim.h"
+#include "log.h"
+#include "param.h"
+#include "store.h"
+#include <getopt.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+struct sim_options {
+	double seconds;
+	float rpm;
+	float amplitude;
+	float load;
+	float rs;
+	float sensitivity;
+	int motor;
+	bool closed_loop;
+	const char *csv;
+	const char *flash;
+};
+
+static void usage(const char *prog)
+{
+	printf("Usage: %s [options]\n"
+	       "  -t, --time SEC        simulated time (default 10)\n"
+	       "  -r, --rpm RPM         target speed (default 300)\n"
+	       "  -a, --amplitude PCT   PWM amplitude (closed loop: limit) in %% (default 30)\n"
+	       "  -l, --load NM         load torque in N m (default 0)\n"
+	       "  -R, --rs OHM          phase resistance (default 5)\n"
+	       "  -s, --sense V_PER_A   current amplifier gain (default 1.2)\n"
+	       "  -m, --motor N         motor index 0 or 1 (default 1)\n"
+	       "  -C, --closed-loop     align the encoder and run FOC_VELOCITY_CLOSED_LOOP\n"
+	       "  -c, --csv FILE        write a 1 kHz trace to FILE\n"
+	       "  -f, --flash FILE      keep the configuration store in FILE\n"
+	       "  -h, --help            show this help\n", prog);
+}
+
+static int parse_options(int argc, char **argv, struct sim_options *opt)
+{
+	static const struct option long_opts[] = {
+		{ "time",      required_argument, NULL, 't' },
+		{ "rpm",       required_argument, NULL, 'r' },
+		{ "amplitude", required_argument, NULL, 'a' },
+		{ "load",      required_argument, NULL, 'l' },
+		{ "rs",        required_argument, NULL, 'R' },
+		{ "sense",     required_argument, NULL, 's' },
+		{ "motor",     required_argument, NULL, 'm' },
+		{ "closed-loop", no_argument,     NULL, 'C' },
+		{ "csv",       required_argument, NULL, 'c' },
+		{ "flash",     required_argument, NULL, 'f' },
+		{ "help",      no_argument,       NULL, 'h' },
+		{ NULL, 0, NULL, 0 },
+	};
+	int c;
+
+	while ((c = getopt_long(argc, argv, "t:r:a:l:R:s:m:Cc:f:h", long_opts, NULL)) != -1) {
+		switch (c) {
+		case 't':
+			opt->seconds = atof(optarg);
+			break;
+		case 'r':
+			opt->rpm = (float)atof(optarg);
+			break;
+		case 'a':
+			opt->amplitude = (float)atof(optarg);
+			break;
+		case 'l':
+			opt->load = (float)atof(optarg);
+			break;
+		case 'R':
+			opt->rs = (float)atof(optarg);
+			break;
+		case 's':
+			opt->sensitivity = (float)atof(optarg);
+			break;
+		case 'm':
+			opt->motor = atoi(optarg);
+			break;
+		case 'C':
+			opt->closed_loop = true;
+			break;
+		case 'c':
+			opt->csv = optarg;
+			break;
+		case 'f':
+			opt->flash = optarg;
+			break;
+		case 'h':
+			usage(argv[0]);
+			exit(0);
+		default:
+			usage(argv[0]);
+			return -1;
+		}
+	}
+
+	if (opt->seconds <= 0.0 || opt->sensitivity <= 0.0f ||
+	    opt->motor < 0 || opt->motor >= SIM_NUM_MOTORS) {
+		usage(argv[0]);
+		return -1;
+	}
+
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	struct sim_options opt = {
+		.seconds = 10.0,
+		.rpm = 300.0f,
+		.amplitude = 30.0f,
+		.load = 0.0f,
+		.rs = pmsm_default_params.rs,
+		.sensitivity = sim_default_sensor_params.current_sensitivity,
+		.motor = 1,
+		.csv = NULL,
+	};
+	struct pmsm_params params = pmsm_default_params;
+	struct sim_sensor_params sensor = sim_default_sensor_params;
+	const struct sim_stats *stats;
+	struct foc_motor *motor;
+	struct sim_motor *m;
+	struct timespec t0, t1;
+	double err, err_sq = 0.0, err_max = 0.0, wall;
+	uint32_t ms, overcurrent_ms = 0;
+	char name[8];
+	FILE *csv = NULL;
+
+	if (parse_options(argc, argv, &opt) != 0) {
+		return 1;
+	}
+
+	params.rs = opt.rs;
+	params.load_torque = opt.load;
+	sensor.current_sensitivity = opt.sensitivity;
+	sim_init(&params, &sensor);
+	if (sim_boot() != 0) {
+		fprintf(stderr, "sim: boot failed\n");
+		return 1;
+	}
+
+	snprintf(name, sizeof(name), "motor%d", opt.motor);
+	motor = foc_get_motor(name);
+	m = sim_get_motor(opt.motor);
+
+	foc_current_config(motor, m->adc_channel_a, m->adc_channel_b,
+	                   sensor.current_sensitivity, 0.0f, 2.0f);
+
+	/* Saved settings replace the defaults and skip the calibrations */
+	if (opt.flash) {
+		if (hal_shim_flash_open(opt.flash) != 0 || store_init() != 0) {
+			fprintf(stderr, "sim: cannot use %s\n", opt.flash);
+			return 1;
+		}
+		printf("%d saved parameters loaded\n", param_load(motor, (uint8_t)opt.motor));
+		motor->current_cfg.offset_loaded =
+			param_saved((uint8_t)opt.motor, PARAM_CURRENT_OFFSET_A) &&
+			param_saved((uint8_t)opt.motor, PARAM_CURRENT_OFFSET_B);
+	}
+
+	foc_current_enable(motor);
+	while (foc_current_calibrating(motor)) {
+		sim_run_ms(1);
+	}
+	if (opt.closed_loop &&
+	    !(opt.flash && param_saved((uint8_t)opt.motor, PARAM_ENCODER_OFFSET))) {
+		foc_encoder_align(motor, 20.0f);
+	}
+
+	if (opt.flash) {
+		param_save(motor, (uint8_t)opt.motor, PARAM_CURRENT_OFFSET_A);
+		param_save(motor, (uint8_t)opt.motor, PARAM_CURRENT_OFFSET_B);
+		if (opt.closed_loop) {
+			param_save(motor, (uint8_t)opt.motor, PARAM_ENCODER_OFFSET);
+		}
+	}
+	foc_velocity_enable(motor, opt.closed_loop ? FOC_VELOCITY_CLOSED_LOOP : FOC_VELOCITY_OPEN_LOOP,
+	                    opt.rpm, opt.amplitude, 1000.0f, params.pole_pairs);
+
+	if (opt.csv) {
+		csv = fopen(opt.csv, "w");
+		if (!csv) {
+			perror(opt.csv);
+			return 1;
+		}
+		fprintf(csv, "t_ms,cmd_rpm,plant_rpm,ia,ib,ia_meas,ib_meas,amplitude,overcurrent\n");
+	}
+
+	ms = (uint32_t)(opt.seconds * 1000.0 + 0.5);
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+
+	for (uint32_t t = 0; t < ms; t++) {
+		sim_run_ms(1);
+		log_flush();
+
+		err = (double)motor->current_rpm - (double)pmsm_rpm(&m->plant);
+		err_sq += err * err;
+		if (fabs(err) > err_max) {
+			err_max = fabs(err);
+		}
+		if (motor->current_data.overcurrent) {
+			overcurrent_ms++;
+		}
+
+		if (csv) {
+			fprintf(csv, "%u,%.2f,%.2f,%.4f,%.4f,%.4f,%.4f,%.2f,%d\n",
+			        (unsigned)t, motor->current_rpm, pmsm_rpm(&m->plant),
+			        m->plant.state.ia, m->plant.state.ib,
+			        motor->current_data.phase_a_current,
+			        motor->current_data.phase_b_current,
+			        motor->amplitude, motor->current_data.overcurrent);
+		}
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	wall = (double)(t1.tv_sec - t0.tv_sec) + (double)(t1.tv_nsec - t0.tv_nsec) * 1e-9;
+
+	if (csv) {
+		fclose(csv);
+	}
+
+	stats = sim_get_stats();
+	printf("\n%s: %.1f s simulated in %.3f s (%.0fx real time)\n",
+	       name, sim_time(), wall, wall > 0.0 ? sim_time() / wall : 0.0);
+	printf("  ramp tracking: rms %.2f rpm, max %.2f rpm, final %.1f/%.1f rpm\n",
+	       sqrt(err_sq / (double)ms), err_max, motor->current_rpm, pmsm_rpm(&m->plant));
+	printf("  overcurrent:   %u ms, final amplitude %.1f%%\n",
+	       overcurrent_ms, opt.closed_loop ? motor->speed_pi.output : motor->amplitude);
+	printf("  foc_task:      mean %.0f ns, max %.0f ns (%llu calls)\n",
+	       stats->control_calls ? stats->control_ns_total / (double)stats->control_calls : 0.0,
+	       stats->control_ns_max, (unsigned long long)stats->control_calls);
+	printf("  adc isr:       mean %.0f ns, max %.0f ns (%llu samples)\n",
+	       stats->steps ? stats->isr_ns_total / (double)stats->steps : 0.0,
+	       stats->isr_ns_max, (unsigned long long)stats->steps);
+
+	return 0;
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef TEST_H
+#define TEST_H
+
+/**
+ * @brief Minimal assertion helpers for the host test runners
+ *
+ * Each runner is a single translation unit: it defines its test functions,
+ * calls them through RUN_TEST() from main() and returns TEST_RESULT().
+ */
+
+#include <stdio.h>
+#include <math.h>
+
+static int test_failures;
+static int test_checks;
+
+#define TEST_ASSERT(cond) do { \
+	test_checks++; \
+	if (!(cond)) { \
+		printf("  FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+		test_failures++; \
+	} \
+} while (0)
+
+#define TEST_ASSERT_EQ(a, b) do { \
+	long long _a = (long long)(a), _b = (long long)(b); \
+	test_checks++; \
+	if (_a != _b) { \
+		printf("  FAIL %s:%d: %s == %s (%lld != %lld)\n", \
+		       __FILE__, __LINE__, #a, #b, _a, _b); \
+		test_failures++; \
+	} \
+} while (0)
+
+#define TEST_ASSERT_NEAR(a, b, tol) do { \
+	double _a = (double)(a), _b = (double)(b); \
+	test_checks++; \
+	if (!(fabs(_a - _b) <= (double)(tol))) { \
+		printf("  FAIL %s:%d: %s ~= %s (%g vs %g, tol %g)\n", \
+		       __FILE__, __LINE__, #a, #b, _a, _b, (double)(tol)); \
+		test_failures++; \
+	} \
+} while (0)
+
+#define RUN_TEST(fn) do { \
+	int _before = test_failures; \
+	fn(); \
+	printf("%s %s\n", test_failures == _before ? "PASS" : "FAIL", #fn); \
+} while (0)
+
+#define TEST_RESULT() \
+	(printf("%d checks, %d failures\n", test_checks, test_failures), \
+	 test_failures ? 1 : 0)
+
+#endif /* TEST_H */
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Event mailbox: overrun accounting, and posters racing the taker on
+ * separate threads without any post going unaccounted for.
+ */
+
+#include "test.h"
+#include "event.h"
+#include <pthread.h>
+#include <sched.h>
+
+#define POSTS_PER_THREAD 200000U
+
+static void test_post_take(void)
+{
+	struct event_stats stats;
+
+	event_reset();
+	TEST_ASSERT_EQ(event_pending(), 0);
+	TEST_ASSERT(!event_take(EVENT_SCHED));
+
+	TEST_ASSERT_EQ(event_post(EVENT_SCHED), 0);
+	TEST_ASSERT_EQ(event_post(EVENT_UART_RX), 0);
+	TEST_ASSERT_EQ(event_pending(), EVENT_BIT(EVENT_SCHED) | EVENT_BIT(EVENT_UART_RX));
+
+	/* Posting again before the take is an overrun, still one pending event */
+	TEST_ASSERT_EQ(event_post(EVENT_SCHED), -1);
+	TEST_ASSERT(event_take(EVENT_SCHED));
+	TEST_ASSERT(!event_take(EVENT_SCHED));
+	TEST_ASSERT_EQ(event_pending(), EVENT_BIT(EVENT_UART_RX));
+
+	event_get_stats(EVENT_SCHED, &stats);
+	TEST_ASSERT_EQ(stats.posted, 2);
+	TEST_ASSERT_EQ(stats.overruns, 1);
+
+	TEST_ASSERT_EQ(event_take_all(), EVENT_BIT(EVENT_UART_RX));
+	TEST_ASSERT_EQ(event_pending(), 0);
+
+	TEST_ASSERT_EQ(event_post(EVENT_NUM), -1);
+	TEST_ASSERT(!event_take(EVENT_NUM));
+}
+
+static void *poster(void *arg)
+{
+	enum event_id id = (enum event_id)(uintptr_t)arg;
+
+	for (uint32_t i = 0; i < POSTS_PER_THREAD; i++) {
+		event_post(id);
+		if ((i & 63U) == 0) {
+			sched_yield();
+		}
+	}
+	return NULL;
+}
+
+static void test_concurrent(void)
+{
+	static const enum event_id ids[2] = {EVENT_SCHED, EVENT_UART_RX};
+	pthread_t threads[2];
+	uint32_t taken[2] = {0, 0};
+	struct event_stats stats;
+	uint32_t mask;
+
+	event_reset();
+
+	for (int t = 0; t < 2; t++) {
+		pthread_create(&threads[t], NULL, poster, (void *)(uintptr_t)ids[t]);
+	}
+
+	/*
+	 * Take one event by bit and the other by mask, as the main loop may.
+	 * A lost update on either side would break posted == taken + overruns.
+	 */
+	for (uint32_t spin = 0; spin < 4U * POSTS_PER_THREAD; spin++) {
+		if (event_take(EVENT_SCHED)) {
+			taken[0]++;
+		}
+		mask = event_take_all();
+		if (mask & EVENT_BIT(EVENT_SCHED)) {
+			taken[0]++;
+		}
+		if (mask & EVENT_BIT(EVENT_UART_RX)) {
+			taken[1]++;
+		}
+	}
+
+	for (int t = 0; t < 2; t++) {
+		pthread_join(threads[t], NULL);
+	}
+
+	mask = event_take_all();
+	taken[0] += (mask & EVENT_BIT(EVENT_SCHED)) ? 1U : 0U;
+	taken[1] += (mask & EVENT_BIT(EVENT_UART_RX)) ? 1U : 0U;
+
+	for (int t = 0; t < 2; t++) {
+		event_get_stats(ids[t], &stats);
+		TEST_ASSERT_EQ(stats.posted, POSTS_PER_THREAD);
+		TEST_ASSERT_EQ(taken[t] + stats.overruns, POSTS_PER_THREAD);
+	}
+}
+
+int main(void)
+{
+	RUN_TEST(test_post_take);
+	RUN_TEST(test_concurrent);
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,582 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Motor control against the HAL shim: PWM start and sync, compare values
+ * from foc_task(), ADC DMA channels and captures, overcurrent protection
+ * and current offset calibration.
+ */
+
+#include "test.h"
+#include "hal_shim.h"
+#include "foc.h"
+#include "drv/pwm.h"
+#include "drv/adc_dma.h"
+#include "param.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define PI_D 3.14159265358979323846
+
+static struct pwm_device *pwm0;
+static struct pwm_device *pwm1;
+static struct foc_motor *motor0;
+static struct foc_motor *motor1;
+
+static void push_adc(uint16_t a0, uint16_t a1, uint16_t a2, uint16_t a3, uint16_t vbus)
+{
+	const uint16_t values[ADC_DMA_NUM_CHANNELS] = { a0, a1, a2, a3, vbus };
+
+	hal_shim_adc_push(values, ADC_DMA_NUM_CHANNELS);
+}
+
+static void setup(void)
+{
+	hal_shim_reset();
+
+	adc_dma_init(&hadc2, &hdma_adc2, &htim2);
+
+	pwm0 = pwm_get_device("pwm_motor0");
+	pwm1 = pwm_get_device("pwm_motor1");
+	pwm_init(pwm0);
+	pwm_init(pwm1);
+	pwm_start(pwm0);
+	pwm_start(pwm1);
+
+	adc_dma_start();
+	push_adc(2048, 2048, 2048, 2048, 2048);
+
+	motor0 = foc_get_motor("motor0");
+	motor1 = foc_get_motor("motor1");
+	foc_velocity_disable(motor0);
+	foc_velocity_disable(motor1);
+	foc_current_disable(motor0);
+	foc_current_disable(motor1);
+}
+
+/* Reference SVPWM: phase voltages U*cos(theta - k*120deg) with min/max
+ * common-mode injection, as fractions of the PWM period.
+ */
+static void svpwm_reference(double angle_deg, double amplitude, double duty[3])
+{
+	double u = amplitude / 100.0 / sqrt(3.0);
+	double th = angle_deg * PI_D / 180.0;
+	double v[3] = {
+		u * cos(th),
+		u * cos(th - 2.0 * PI_D / 3.0),
+		u * cos(th + 2.0 * PI_D / 3.0),
+	};
+	double vmax = fmax(v[0], fmax(v[1], v[2]));
+	double vmin = fmin(v[0], fmin(v[1], v[2]));
+
+	for (int i = 0; i < 3; i++) {
+		duty[i] = 0.5 + v[i] - (vmax + vmin) / 2.0;
+	}
+}
+
+static void test_pwm_init_state(void)
+{
+	setup();
+
+	TEST_ASSERT_EQ(__HAL_TIM_GET_AUTORELOAD(&htim2), PWM_TIMER_PERIOD);
+	TEST_ASSERT_EQ(__HAL_TIM_GET_AUTORELOAD(&htim3), PWM_TIMER_PERIOD);
+	TEST_ASSERT_EQ(htim2.Init.CounterMode, TIM_COUNTERMODE_CENTERALIGNED1);
+	TEST_ASSERT_EQ(htim3.Init.CounterMode, TIM_COUNTERMODE_CENTERALIGNED1);
+	TEST_ASSERT(hal_shim_pwm_enabled(&htim2, TIM_CHANNEL_1));
+	TEST_ASSERT(hal_shim_pwm_enabled(&htim2, TIM_CHANNEL_2));
+	TEST_ASSERT(hal_shim_pwm_enabled(&htim2, TIM_CHANNEL_3));
+	TEST_ASSERT(hal_shim_pwm_enabled(&htim3, TIM_CHANNEL_2));
+	TEST_ASSERT(hal_shim_pwm_enabled(&htim3, TIM_CHANNEL_3));
+	TEST_ASSERT(hal_shim_pwm_enabled(&htim3, TIM_CHANNEL_4));
+	TEST_ASSERT(!hal_shim_pwm_enabled(&htim3, TIM_CHANNEL_1));
+
+	/* The ADC trigger channel drives no pin */
+	TEST_ASSERT(!hal_shim_pwm_enabled(&htim2, TIM_CHANNEL_4));
+	TEST_ASSERT(__HAL_TIM_GET_COMPARE(&htim2, TIM_CHANNEL_4) < PWM_TIMER_PERIOD);
+}
+
+static void test_pwm_sync(void)
+{
+	struct pwm_device *devs[2];
+
+	setup();
+	devs[0] = pwm0;
+	devs[1] = pwm1;
+
+	htim2.Instance->CNT = 1234;
+	htim3.Instance->CNT = 17;
+	TEST_ASSERT(hal_shim_pwm_enabled(&htim2, TIM_CHANNEL_1));
+	TEST_ASSERT_EQ(pwm_sync(devs, 2), 0);
+	TEST_ASSERT_EQ(__HAL_TIM_GET_COUNTER(&htim2), 0);
+	TEST_ASSERT_EQ(__HAL_TIM_GET_COUNTER(&htim3), 0);
+
+	/* Both counters were stopped while zeroed, despite the enabled outputs */
+	TEST_ASSERT_EQ(hal_shim_tim_running_writes(&htim2), 0);
+	TEST_ASSERT_EQ(hal_shim_tim_running_writes(&htim3), 0);
+	TEST_ASSERT(htim2.Instance->CR1 & TIM_CR1_CEN);
+	TEST_ASSERT(htim3.Instance->CR1 & TIM_CR1_CEN);
+}
+
+static void test_disabled_motor_is_idle(void)
+{
+	setup();
+
+	for (int i = 0; i < 100; i++) {
+		foc_task();
+	}
+
+	TEST_ASSERT_EQ(htim2.Instance->CCR1, 0);
+	TEST_ASSERT_EQ(htim2.Instance->CCR2, 0);
+	TEST_ASSERT_EQ(htim2.Instance->CCR3, 0);
+	TEST_ASSERT_EQ(htim3.Instance->CCR2, 0);
+	TEST_ASSERT_EQ(htim3.Instance->CCR3, 0);
+	TEST_ASSERT_EQ(htim3.Instance->CCR4, 0);
+}
+
+static void test_velocity_ramp(void)
+{
+	float rpm = -1.0f;
+
+	setup();
+	TEST_ASSERT_EQ(foc_velocity_enable(motor0, FOC_VELOCITY_OPEN_LOOP,
+	                                   60.0f, 20.0f, 1000.0f, 7), 0);
+
+	/* 1000 RPM/s at 1 kHz: 1 RPM per update */
+	for (int i = 0; i < 30; i++) {
+		foc_task();
+	}
+	foc_velocity_get_current(motor0, &rpm);
+	TEST_ASSERT_NEAR(rpm, 30.0f, 1e-3);
+
+	for (int i = 0; i < 100; i++) {
+		foc_task();
+	}
+	foc_velocity_get_current(motor0, &rpm);
+	TEST_ASSERT_NEAR(rpm, 60.0f, 1e-6);
+
+	/* Reverse through zero */
+	foc_velocity_set_target(motor0, -20.0f);
+	for (int i = 0; i < 80; i++) {
+		foc_task();
+	}
+	foc_velocity_get_current(motor0, &rpm);
+	TEST_ASSERT_NEAR(rpm, -20.0f, 1e-3);
+	TEST_ASSERT(motor0->electrical_angle >= 0.0f && motor0->electrical_angle < 360.0f);
+
+	/* Motor 1 was never enabled */
+	TEST_ASSERT_EQ(htim3.Instance->CCR2, 0);
+}
+
+static void test_svpwm_compare_values(void)
+{
+	const uint32_t period = PWM_TIMER_PERIOD;
+	int worst = 0;
+
+	setup();
+	foc_velocity_enable(motor0, FOC_VELOCITY_OPEN_LOOP, 300.0f, 40.0f, 1000.0f, 7);
+
+	/* 2 s covers many electrical revolutions at all ramp speeds */
+	for (int i = 0; i < 2000; i++) {
+		double duty[3];
+		uint32_t ccr[3];
+
+		foc_task();
+
+		svpwm_reference(motor0->electrical_angle, motor0->amplitude, duty);
+		ccr[0] = htim2.Instance->CCR1;
+		ccr[1] = htim2.Instance->CCR2;
+		ccr[2] = htim2.Instance->CCR3;
+
+		for (int p = 0; p < 3; p++) {
+			int err = abs((int)ccr[p] - (int)(duty[p] * period));
+
+			if (err > worst) {
+				worst = err;
+			}
+		}
+
+		/* Zero-sequence injection centres the vector in the period */
+		uint32_t hi = ccr[0] > ccr[1] ? (ccr[0] > ccr[2] ? ccr[0] : ccr[2])
+		                              : (ccr[1] > ccr[2] ? ccr[1] : ccr[2]);
+		uint32_t lo = ccr[0] < ccr[1] ? (ccr[0] < ccr[2] ? ccr[0] : ccr[2])
+		                              : (ccr[1] < ccr[2] ? ccr[1] : ccr[2]);
+		TEST_ASSERT_NEAR((double)(hi + lo), (double)period, 2.0);
+	}
+
+	TEST_ASSERT(worst <= 1);
+}
+
+static void test_amplitude_is_line_to_line(void)
+{
+	const double period = PWM_TIMER_PERIOD;
+	double max_ll = 0.0;
+
+	setup();
+	foc_velocity_enable(motor0, FOC_VELOCITY_OPEN_LOOP, 60.0f, 50.0f, 1000.0f, 7);
+
+	for (int i = 0; i < 2000; i++) {
+		foc_task();
+		double ll = ((double)htim2.Instance->CCR1 - (double)htim2.Instance->CCR2) / period;
+		if (ll > max_ll) {
+			max_ll = ll;
+		}
+	}
+
+	/* amplitude is the peak line-to-line voltage as % of the bus */
+	TEST_ASSERT_NEAR(max_ll, 0.50, 0.005);
+}
+
+static void test_adc_dma_channels(void)
+{
+	uint16_t value = 0;
+	uint16_t all[ADC_DMA_NUM_CHANNELS] = {0};
+
+	setup();
+	push_adc(100, 200, 300, 400, 500);
+
+	TEST_ASSERT_EQ(adc_dma_get_channel(0, &value), 0);
+	TEST_ASSERT_EQ(value, 100);
+	TEST_ASSERT_EQ(adc_dma_get_channel(4, &value), 0);
+	TEST_ASSERT_EQ(value, 500);
+	TEST_ASSERT(adc_dma_get_channel(ADC_DMA_NUM_CHANNELS, &value) != 0);
+
+	TEST_ASSERT_EQ(adc_dma_get_all_channels(all, ADC_DMA_NUM_CHANNELS), 0);
+	TEST_ASSERT_EQ(all[1], 200);
+	TEST_ASSERT_EQ(all[3], 400);
+
+	TEST_ASSERT_EQ(adc_dma_raw_to_mv(4096), ADC_VREF_MV);
+	TEST_ASSERT_EQ(adc_dma_raw_to_mv(2048), ADC_VREF_MV / 2);
+}
+
+static void test_adc_dma_snapshot(void)
+{
+	struct adc_dma_snapshot snap, prev;
+	uint16_t all[ADC_DMA_NUM_CHANNELS] = {0};
+	uint32_t seq;
+
+	setup();
+	TEST_ASSERT_EQ(adc_dma_get_snapshot(&prev), 0);
+	seq = prev.seq;
+	TEST_ASSERT(seq > 0);
+
+	/* Each sample set lands in the other slot and bumps seq */
+	push_adc(100, 200, 300, 400, 500);
+	TEST_ASSERT_EQ(adc_dma_get_snapshot(&snap), 0);
+	TEST_ASSERT_EQ(snap.seq, seq + 1);
+	TEST_ASSERT(snap.values != prev.values);
+	TEST_ASSERT_EQ(snap.values[0], 100);
+	TEST_ASSERT_EQ(snap.values[4], 500);
+
+	/* Half a set never completes the injected sequence */
+	push_adc(1, 2, 3, 4, 5);
+	TEST_ASSERT(hal_shim_adc_push(all, 2) != 0);
+	TEST_ASSERT_EQ(adc_dma_get_snapshot(&snap), 0);
+	TEST_ASSERT_EQ(snap.seq, seq + 2);
+	TEST_ASSERT_EQ(snap.values[0], 1);
+	TEST_ASSERT_EQ(snap.values[1], 2);
+	TEST_ASSERT_EQ(adc_dma_get_all_channels(all, ADC_DMA_NUM_CHANNELS), 0);
+	TEST_ASSERT_EQ(all[0], 1);
+	TEST_ASSERT_EQ(all[4], 5);
+
+	/* seq keeps counting across a restart */
+	adc_dma_stop();
+	adc_dma_start();
+	push_adc(7, 7, 7, 7, 7);
+	TEST_ASSERT_EQ(adc_dma_get_snapshot(&snap), 0);
+	TEST_ASSERT(snap.seq > seq + 2);
+	TEST_ASSERT_EQ(snap.values[0], 7);
+	TEST_ASSERT(adc_dma_get_snapshot(NULL) != 0);
+}
+
+static struct {
+	const uint16_t *samples[4];
+	uint32_t num_samples;
+	int calls;
+} capture_log;
+
+static void capture_callback(const uint16_t *samples, uint32_t num_samples)
+{
+	if (capture_log.calls < 4) {
+		capture_log.samples[capture_log.calls] = samples;
+	}
+	capture_log.num_samples = num_samples;
+	capture_log.calls++;
+}
+
+static void test_adc_dma_capture_oneshot(void)
+{
+	uint16_t buf[4 * ADC_DMA_NUM_CHANNELS];
+	struct adc_dma_snapshot snap;
+	uint32_t seq;
+
+	setup();
+	memset(&capture_log, 0, sizeof(capture_log));
+	push_adc(100, 200, 300, 400, 500);
+	adc_dma_get_snapshot(&snap);
+	seq = snap.seq;
+
+	TEST_ASSERT(adc_dma_capture_start(NULL, 4, false, capture_callback) != 0);
+	TEST_ASSERT(adc_dma_capture_start(buf, 3, true, capture_callback) != 0);
+	TEST_ASSERT(adc_dma_capture_start(buf, ADC_DMA_CAPTURE_MAX + 1, false, NULL) != 0);
+	TEST_ASSERT_EQ(adc_dma_capture_start(buf, 4, false, capture_callback), 0);
+	TEST_ASSERT(adc_dma_capture_active());
+	TEST_ASSERT(adc_dma_capture_start(buf, 4, false, capture_callback) != 0);
+
+	/* Samples go to the buffer, and to the snapshot as usual */
+	for (uint16_t i = 0; i < 3; i++) {
+		push_adc(i, i + 10, i + 20, i + 30, i + 40);
+	}
+	TEST_ASSERT_EQ(capture_log.calls, 0);
+	adc_dma_get_snapshot(&snap);
+	TEST_ASSERT_EQ(snap.seq, seq + 3);
+	TEST_ASSERT_EQ(snap.values[0], 2);
+
+	push_adc(3, 13, 23, 33, 43);
+	TEST_ASSERT_EQ(capture_log.calls, 1);
+	TEST_ASSERT(capture_log.samples[0] == buf);
+	TEST_ASSERT_EQ(capture_log.num_samples, 4);
+	TEST_ASSERT(!adc_dma_capture_active());
+	for (int i = 0; i < 4; i++) {
+		TEST_ASSERT_EQ(buf[i * ADC_DMA_NUM_CHANNELS], i);
+		TEST_ASSERT_EQ(buf[i * ADC_DMA_NUM_CHANNELS + 4], i + 40);
+	}
+
+	/* The buffer is left alone afterwards */
+	push_adc(7, 7, 7, 7, 7);
+	TEST_ASSERT_EQ(buf[0], 0);
+	adc_dma_get_snapshot(&snap);
+	TEST_ASSERT_EQ(snap.seq, seq + 5);
+	TEST_ASSERT_EQ(snap.values[0], 7);
+	TEST_ASSERT(adc_dma_capture_stop() != 0);
+}
+
+static void test_adc_dma_capture_circular(void)
+{
+	uint16_t buf[4 * ADC_DMA_NUM_CHANNELS];
+	uint16_t value;
+
+	setup();
+	memset(&capture_log, 0, sizeof(capture_log));
+
+	TEST_ASSERT_EQ(adc_dma_capture_start(buf, 4, true, capture_callback), 0);
+
+	/* Halves in turn, until stopped */
+	for (uint16_t i = 0; i < 8; i++) {
+		push_adc(i, i, i, i, i);
+	}
+	TEST_ASSERT_EQ(capture_log.calls, 4);
+	TEST_ASSERT_EQ(capture_log.num_samples, 2);
+	TEST_ASSERT(capture_log.samples[0] == buf);
+	TEST_ASSERT(capture_log.samples[1] == &buf[2 * ADC_DMA_NUM_CHANNELS]);
+	TEST_ASSERT(capture_log.samples[2] == buf);
+	TEST_ASSERT_EQ(buf[0], 4);
+	TEST_ASSERT_EQ(buf[3 * ADC_DMA_NUM_CHANNELS], 7);
+	TEST_ASSERT(adc_dma_capture_active());
+
+	TEST_ASSERT_EQ(adc_dma_capture_stop(), 0);
+	TEST_ASSERT(!adc_dma_capture_active());
+	push_adc(9, 9, 9, 9, 9);
+	TEST_ASSERT_EQ(capture_log.calls, 4);
+	TEST_ASSERT_EQ(adc_dma_get_channel(0, &value), 0);
+	TEST_ASSERT_EQ(value, 9);
+}
+
+static void test_overcurrent_reduces_amplitude(void)
+{
+	float current = 0.0f;
+
+	setup();
+
+	/* Calibrate with both motor1 channels at mid-scale (1650 mV) */
+	TEST_ASSERT_EQ(foc_current_enable(motor1), 0);
+	for (uint32_t i = 0; i < FOC_OFFSET_SETTLE + FOC_OFFSET_SAMPLES; i++) {
+		push_adc(2048, 2048, 2048, 2048, 2048);
+		foc_current_task();
+	}
+	TEST_ASSERT_NEAR(motor1->current_cfg.current_offset[0], 1.65f, 0.01f);
+	TEST_ASSERT_NEAR(motor1->current_cfg.current_offset[1], 1.65f, 0.01f);
+	foc_current_set_limit(motor1, 1.0f);
+	foc_velocity_enable(motor1, FOC_VELOCITY_OPEN_LOOP, 60.0f, 50.0f, 1000.0f, 7);
+
+	/* In range: +0.5 A on phase A, -0.5 A on phase B */
+	push_adc(2048, 2048, 2048 + 745, 2048 - 745, 2048);
+	foc_current_task();
+	foc_task();
+	foc_current_get(motor1, &current);
+	TEST_ASSERT(!foc_current_is_overcurrent(motor1));
+	TEST_ASSERT_NEAR(motor1->current_data.phase_a_current, 0.5f, 0.01f);
+	TEST_ASSERT_NEAR(motor1->current_data.phase_b_current, -0.5f, 0.01f);
+	TEST_ASSERT_NEAR(motor1->current_data.phase_c_current, 0.0f, 0.01f);
+	TEST_ASSERT_NEAR(current, 0.408f, 0.01f);
+	TEST_ASSERT_NEAR(motor1->amplitude, 50.0f, 1e-6);
+
+	/* Over the limit: flagged on the sample itself, amplitude backs off
+	 * by 10% per protection update */
+	push_adc(2048, 2048, 4095, 0, 2048);
+	foc_current_task();
+	TEST_ASSERT(foc_current_is_overcurrent(motor1));
+	TEST_ASSERT_NEAR(motor1->amplitude, 50.0f, 1e-6);
+	foc_task();
+	TEST_ASSERT(foc_current_is_overcurrent(motor1));
+	TEST_ASSERT_NEAR(motor1->amplitude, 45.0f, 1e-4);
+	foc_task();
+	TEST_ASSERT_NEAR(motor1->amplitude, 40.5f, 1e-4);
+
+	/* Back in range clears the flag but keeps the reduced amplitude */
+	push_adc(2048, 2048, 2048, 2048, 2048);
+	foc_current_task();
+	foc_task();
+	TEST_ASSERT(!foc_current_is_overcurrent(motor1));
+	TEST_ASSERT_NEAR(motor1->amplitude, 40.5f, 1e-4);
+
+	/* Motor 0 sensing is disabled and must not react */
+	TEST_ASSERT(!foc_current_is_overcurrent(motor0));
+}
+
+static mt6701_t dummy_encoder;
+
+/* Motor 1 phases: 1600 mV and 1700 mV at 0 A, +-2 counts of noise */
+static void push_offsets(uint32_t n, uint16_t a, uint16_t b)
+{
+	for (uint32_t i = 0; i < n; i++) {
+		uint16_t noise = (uint16_t)(i & 3);
+
+		push_adc(2048, 2048, a - 2 + noise, b + 2 - noise, 2048);
+		foc_current_task();
+	}
+}
+
+static void test_offset_calibration(void)
+{
+	const uint16_t raw_a = 1986, raw_b = 2110;   /* 1600 mV, 1700 mV */
+	struct foc_current_config *cfg;
+
+	setup();
+	cfg = &motor1->current_cfg;
+	cfg->offset_loaded = false;
+
+	/* Only with the motor stopped */
+	foc_velocity_enable(motor1, FOC_VELOCITY_OPEN_LOOP, 60.0f, 20.0f, 1000.0f, 7);
+	TEST_ASSERT(foc_current_enable(motor1) != 0);
+	foc_velocity_disable(motor1);
+
+	/* Returns at once with a 50% zero vector on the outputs */
+	pwm_set_duty(pwm1, 10.0f, 20.0f, 30.0f);
+	TEST_ASSERT_EQ(foc_current_enable(motor1), 0);
+	TEST_ASSERT(foc_current_calibrating(motor1));
+	TEST_ASSERT(!cfg->enabled);
+	TEST_ASSERT_EQ(__HAL_TIM_GET_COMPARE(&htim3, TIM_CHANNEL_2), PWM_TIMER_PERIOD / 2);
+	TEST_ASSERT_EQ(__HAL_TIM_GET_COMPARE(&htim3, TIM_CHANNEL_4), PWM_TIMER_PERIOD / 2);
+
+	/* No drive until the offsets are known */
+	TEST_ASSERT(foc_velocity_enable(motor1, FOC_VELOCITY_OPEN_LOOP,
+					60.0f, 20.0f, 1000.0f, 7) != 0);
+	TEST_ASSERT(foc_torque_enable(motor1, 6.0f, 15000.0f, 12.0f) != 0);
+	TEST_ASSERT_EQ(motor1->velocity_cfg.mode, FOC_VELOCITY_DISABLED);
+	TEST_ASSERT(!motor1->torque_cfg.enabled);
+
+	/* Anything but a zero vector restarts the average */
+	push_offsets(FOC_OFFSET_SETTLE + FOC_OFFSET_SAMPLES - 1, raw_a, raw_b);
+	pwm_set_duty(pwm1, 50.0f, 55.0f, 50.0f);
+	push_offsets(1, 4095, 0);
+	pwm_set_duty(pwm1, 50.0f, 50.0f, 50.0f);
+
+	/* So does a rotor still turning, and the currents settle first */
+	motor1->encoder.dev = &dummy_encoder;
+	motor1->encoder.valid = true;
+	motor1->encoder.measured_rpm = 100.0f;
+	push_offsets(FOC_OFFSET_SETTLE + FOC_OFFSET_SAMPLES, 4095, 0);
+	motor1->encoder.measured_rpm = 0.0f;
+	push_offsets(FOC_OFFSET_SETTLE, 4095, 0);
+	motor1->encoder.dev = NULL;
+	motor1->encoder.valid = false;
+	push_offsets(FOC_OFFSET_SAMPLES - 1, raw_a, raw_b);
+	TEST_ASSERT(foc_current_calibrating(motor1));
+	push_offsets(1, raw_a, raw_b);
+
+	/* One offset per phase, then sensing starts */
+	TEST_ASSERT(!foc_current_calibrating(motor1));
+	TEST_ASSERT(cfg->enabled);
+	TEST_ASSERT_NEAR(cfg->current_offset[0], 1.6f, 0.001f);
+	TEST_ASSERT_NEAR(cfg->current_offset[1], 1.7f, 0.001f);
+	TEST_ASSERT_NEAR(cfg->bias[1], -cfg->current_offset[1] / cfg->current_sensitivity, 1e-5);
+
+	/* No tracking unless asked for */
+	push_offsets(FOC_OFFSET_SAMPLES, raw_a + 12, raw_b);
+	TEST_ASSERT_NEAR(cfg->current_offset[0], 1.6f, 0.001f);
+
+	/* Drift: a fraction of each new average, only while idle */
+	TEST_ASSERT_EQ(foc_current_track_offset(motor1, true), 0);
+	push_offsets(FOC_OFFSET_SETTLE + FOC_OFFSET_SAMPLES, raw_a + 124, raw_b);
+	TEST_ASSERT_NEAR(cfg->current_offset[0], 1.6f + 0.1f * FOC_OFFSET_TRACK_GAIN, 0.001f);
+	TEST_ASSERT_NEAR(cfg->current_offset[1], 1.7f, 0.001f);
+	for (int i = 0; i < 200; i++) {
+		push_offsets(FOC_OFFSET_SAMPLES, raw_a + 124, raw_b);
+	}
+	TEST_ASSERT_NEAR(cfg->current_offset[0], 1.7f, 0.002f);
+
+	foc_velocity_enable(motor1, FOC_VELOCITY_OPEN_LOOP, 60.0f, 20.0f, 1000.0f, 7);
+	push_offsets(FOC_OFFSET_SAMPLES, 0, 0);
+	TEST_ASSERT_NEAR(cfg->current_offset[0], 1.7f, 0.002f);
+
+	/* Stopping leaves the outputs at a zero vector, ready for the next average */
+	foc_velocity_disable(motor1);
+	TEST_ASSERT(pwm_is_zero_vector(pwm1));
+
+	foc_current_track_offset(motor1, false);
+	foc_current_disable(motor1);
+}
+
+static void test_current_scale(void)
+{
+	uint16_t raw[ADC_DMA_NUM_CHANNELS] = {0, 1000, 2048, 3000, 4095};
+	float scale[ADC_DMA_NUM_CHANNELS], bias[ADC_DMA_NUM_CHANNELS];
+	float amps[ADC_DMA_NUM_CHANNELS];
+	struct foc_current_config *cfg;
+
+	setup();
+	cfg = &motor1->current_cfg;
+
+	/* Same as (mV / 1000 - offset) / sensitivity, without the divides */
+	TEST_ASSERT_EQ(foc_current_config(motor1, 2, 3, 0.2f, 1.65f, 2.0f), 0);
+	for (int i = 0; i < ADC_DMA_NUM_CHANNELS; i++) {
+		scale[i] = cfg->scale[i & 1];
+		bias[i] = cfg->bias[i & 1];
+	}
+	foc_current_convert(raw, scale, bias, amps, ADC_DMA_NUM_CHANNELS);
+	for (int i = 0; i < ADC_DMA_NUM_CHANNELS; i++) {
+		double ref = ((double)raw[i] * ADC_VREF_MV / 4096000.0 - 1.65) / 0.2;
+
+		TEST_ASSERT_NEAR(amps[i], ref, 1e-4);
+	}
+
+	/* Parameter writes refresh the folded values */
+	TEST_ASSERT_EQ(param_set(motor1, PARAM_CURRENT_OFFSET_A, 1.5f), 0);
+	TEST_ASSERT_NEAR(cfg->bias[0], -1.5f / 0.2f, 1e-5);
+	TEST_ASSERT_EQ(param_set(motor1, PARAM_CURRENT_SENSITIVITY, 0.4f), 0);
+	TEST_ASSERT_NEAR(cfg->scale[1], ADC_VREF_MV / 4096000.0 / 0.4, 1e-9);
+	TEST_ASSERT_NEAR(cfg->bias[0], -1.5f / 0.4f, 1e-5);
+	TEST_ASSERT_NEAR(cfg->bias[1], -1.65f / 0.4f, 1e-5);
+
+	TEST_ASSERT_EQ(foc_current_config(motor1, 2, 3, 1.2f, 0.0f, 2.0f), 0);
+}
+
+int main(void)
+{
+	RUN_TEST(test_pwm_init_state);
+	RUN_TEST(test_pwm_sync);
+	RUN_TEST(test_disabled_motor_is_idle);
+	RUN_TEST(test_velocity_ramp);
+	RUN_TEST(test_svpwm_compare_values);
+	RUN_TEST(test_amplitude_is_line_to_line);
+	RUN_TEST(test_adc_dma_channels);
+	RUN_TEST(test_adc_dma_snapshot);
+	RUN_TEST(test_adc_dma_capture_oneshot);
+	RUN_TEST(test_adc_dma_capture_circular);
+	RUN_TEST(test_overcurrent_reduces_amplitude);
+	RUN_TEST(test_offset_calibration);
+	RUN_TEST(test_current_scale);
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Load and jitter monitor: histogram binning around the nominal period,
+ * the CAN report layout, and idle accounting on a cycle counter driven by
+ * the test through the same loop pass for calibration and measurement.
+ */
+
+#include "test.h"
+#include "hal_shim.h"
+#include "event.h"
+#include "monitor.h"
+#include <stdbool.h>
+
+#define PERIOD 8500U
+
+/* Cycles of one main loop pass: nothing pending, or handling an event */
+#define IDLE_PASS 40U
+#define BUSY_PASS 100U
+
+static int calib_done;
+
+static void calib_notify(void)
+{
+	calib_done++;
+}
+
+/* One pass of the main loop, as main() runs it */
+static void loop_pass(void)
+{
+	if (event_pending() == 0) {
+		monitor_idle();
+		hal_shim_advance_cycles(IDLE_PASS);
+		return;
+	}
+	event_take_all();
+	hal_shim_advance_cycles(BUSY_PASS);
+}
+
+static void calibrate(void)
+{
+	calib_done = 0;
+	TEST_ASSERT_EQ(monitor_calibrate(calib_notify), 0);
+	while (monitor_calibrating()) {
+		loop_pass();
+	}
+	TEST_ASSERT_EQ(calib_done, 1);
+}
+
+static void setup(void)
+{
+	hal_shim_reset();
+	hal_shim_dwt_manual(true);
+	event_take_all();
+	calibrate();
+	monitor_set_period(PERIOD);
+	monitor_reset();
+}
+
+static void test_jitter_histogram(void)
+{
+	/* Start near the top so the counter wraps during the run */
+	uint32_t t = UINT32_MAX - 20000U;
+	struct monitor_jitter j;
+	const int32_t errs[] = {0, 64, -64, -1, 10000, -10000, 63};
+
+	setup();
+	monitor_tick(t);
+	for (size_t i = 0; i < sizeof(errs) / sizeof(errs[0]); i++) {
+		t += PERIOD + (uint32_t)errs[i];
+		monitor_tick(t);
+	}
+
+	monitor_get_jitter(&j);
+	TEST_ASSERT_EQ(j.period, PERIOD);
+	TEST_ASSERT_EQ(j.ticks, 7);
+	TEST_ASSERT_EQ(j.min, -10000);
+	TEST_ASSERT_EQ(j.max, 10000);
+
+	/* Bin 8 holds [0, 64) cycles late, bin 7 [-64, 0), outer bins the rest */
+	TEST_ASSERT_EQ(j.hist[8], 2);
+	TEST_ASSERT_EQ(j.hist[9], 1);
+	TEST_ASSERT_EQ(j.hist[7], 2);
+	TEST_ASSERT_EQ(j.hist[0], 1);
+	TEST_ASSERT_EQ(j.hist[MONITOR_JITTER_BINS - 1], 1);
+
+	/* A new period restarts the interval, no bogus first sample */
+	monitor_set_period(PERIOD / 2);
+	monitor_tick(0);
+	monitor_get_jitter(&j);
+	TEST_ASSERT_EQ(j.ticks, 7);
+
+	monitor_reset();
+	monitor_get_jitter(&j);
+	TEST_ASSERT_EQ(j.ticks, 0);
+	TEST_ASSERT_EQ(j.period, PERIOD / 2);
+}
+
+static void test_can_report(void)
+{
+	uint8_t data[MONITOR_CAN_LEN];
+	uint32_t cycles_per_us = SystemCoreClock / 1000000U;
+
+	setup();
+
+	/* One tick 1 us early, one 2 us late */
+	monitor_tick(0);
+	monitor_tick(PERIOD - cycles_per_us);
+	monitor_tick(2 * PERIOD - cycles_per_us + 2 * cycles_per_us);
+	monitor_pack_can(data);
+
+	TEST_ASSERT_EQ((int16_t)(data[4] | data[5] << 8), -1000);
+	TEST_ASSERT_EQ((int16_t)(data[6] | data[7] << 8), 2000);
+
+	/* Saturated beyond the s16 range */
+	monitor_tick(3 * PERIOD + 100U * cycles_per_us);
+	monitor_pack_can(data);
+	TEST_ASSERT_EQ((int16_t)(data[6] | data[7] << 8), INT16_MAX);
+}
+
+static void test_calibration(void)
+{
+	setup();
+	TEST_ASSERT_EQ(monitor_get_baseline(), IDLE_PASS << 8);
+
+	/* Refused while running; an interrupted round does not count */
+	TEST_ASSERT_EQ(monitor_calibrate(NULL), 0);
+	TEST_ASSERT(monitor_calibrate(NULL) != 0);
+	for (uint32_t i = 0; i < MONITOR_CALIB_SPINS + 10U; i++) {
+		if (i == MONITOR_CALIB_SPINS + 5U) {
+			hal_shim_advance_cycles(5000);
+		}
+		loop_pass();
+	}
+	TEST_ASSERT(monitor_calibrating());
+	while (monitor_calibrating()) {
+		loop_pass();
+	}
+	TEST_ASSERT_EQ(monitor_get_baseline(), IDLE_PASS << 8);
+
+	/* Every round interrupted: the baseline moves up */
+	calib_done = 0;
+	TEST_ASSERT_EQ(monitor_calibrate(calib_notify), 0);
+	while (monitor_calibrating()) {
+		hal_shim_advance_cycles(1);
+		loop_pass();
+	}
+	TEST_ASSERT_EQ(calib_done, 1);
+	TEST_ASSERT_EQ(monitor_get_baseline(), (IDLE_PASS + 1U) << 8);
+}
+
+/* Main loop passes for a window, events pending after idle_percent of it */
+static void run_window(uint32_t cycles, uint32_t idle_percent)
+{
+	uint32_t start = DWT->CYCCNT;
+	uint32_t idle_until = cycles / 100U * idle_percent;
+
+	while (DWT->CYCCNT - start < cycles) {
+		if (DWT->CYCCNT - start >= idle_until) {
+			event_post(EVENT_SCHED);
+		}
+		loop_pass();
+	}
+}
+
+static void test_load(void)
+{
+	uint32_t window = SystemCoreClock / 100U;  /* 10 ms */
+	struct monitor_load load;
+	uint16_t idle, busy, half;
+
+	setup();
+
+	run_window(window, 100);
+	idle = monitor_update();
+	run_window(window, 0);
+	busy = monitor_update();
+	run_window(window, 50);
+	half = monitor_update();
+
+	TEST_ASSERT_EQ(idle, 0);
+	TEST_ASSERT_EQ(busy, 1000);
+	TEST_ASSERT_EQ(half, 500);
+
+	monitor_get_load(&load);
+	TEST_ASSERT_EQ(load.windows, 3);
+	TEST_ASSERT_EQ(load.load, half);
+	TEST_ASSERT_EQ(load.peak, busy);
+}
+
+int main(void)
+{
+	RUN_TEST(test_jitter_histogram);
+	RUN_TEST(test_can_report);
+	RUN_TEST(test_calibration);
+	RUN_TEST(test_load);
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * MT6701 burst reads: blocking and interrupt-driven acquisition into the
+ * double-buffered sample slot.
+ */
+
+#include "test.h"
+#include "hal_shim.h"
+#include "drv/mt6701.h"
+
+static mt6701_t enc;
+
+static void set_angle(uint16_t raw)
+{
+	hal_shim_i2c_set_reg(&hi2c2, MT6701_REG_ANGLE_H, (uint8_t)(raw >> 6));
+	/* Status bits [1:0] must be ignored */
+	hal_shim_i2c_set_reg(&hi2c2, MT6701_REG_ANGLE_L, (uint8_t)(((raw & 0x3F) << 2) | 0x3));
+}
+
+static void setup(void)
+{
+	hal_shim_reset();
+	hal_shim_i2c_attach(&hi2c2, MT6701_I2C_ADDR);
+	mt6701_init(&enc, &hi2c2, MT6701_I2C_ADDR, "enc");
+}
+
+static void test_blocking_burst(void)
+{
+	uint16_t raw;
+	uint32_t before;
+
+	setup();
+	set_angle(0x2A5B);
+
+	before = hal_shim_i2c_transactions(&hi2c2);
+	TEST_ASSERT_EQ(mt6701_read_angle_raw(&enc, &raw), 0);
+	TEST_ASSERT_EQ(raw, 0x2A5B);
+	/* Both registers in one transaction */
+	TEST_ASSERT_EQ(hal_shim_i2c_transactions(&hi2c2) - before, 1);
+}
+
+static void test_async_sample(void)
+{
+	mt6701_sample_t s;
+
+	setup();
+	TEST_ASSERT_EQ(mt6701_get_sample(&enc, &s), -1);
+
+	set_angle(1000);
+	TEST_ASSERT_EQ(mt6701_start_read(&enc, 41), 0);
+	/* Nothing published until the transfer completes */
+	TEST_ASSERT_EQ(mt6701_get_sample(&enc, &s), -1);
+	/* The bus is ours until then */
+	TEST_ASSERT_EQ(mt6701_start_read(&enc, 42), -1);
+	TEST_ASSERT_EQ(enc.overruns, 1);
+
+	TEST_ASSERT(hal_shim_i2c_complete(&hi2c2));
+	TEST_ASSERT_EQ(mt6701_get_sample(&enc, &s), 0);
+	TEST_ASSERT_EQ(s.angle, 1000);
+	TEST_ASSERT_EQ(s.timestamp, 41);
+	TEST_ASSERT_EQ(s.seq, 1);
+
+	/* The registers change after the read: the sample is what the bus saw */
+	set_angle(2000);
+	TEST_ASSERT_EQ(mt6701_get_sample(&enc, &s), 0);
+	TEST_ASSERT_EQ(s.angle, 1000);
+
+	for (uint32_t i = 0; i < 5; i++) {
+		set_angle((uint16_t)(3000 + i));
+		TEST_ASSERT_EQ(mt6701_start_read(&enc, 100 + i), 0);
+		hal_shim_i2c_complete(&hi2c2);
+
+		TEST_ASSERT_EQ(mt6701_get_sample(&enc, &s), 0);
+		TEST_ASSERT_EQ(s.angle, 3000 + i);
+		TEST_ASSERT_EQ(s.timestamp, 100 + i);
+		TEST_ASSERT_EQ(s.seq, 2 + i);
+	}
+	TEST_ASSERT_EQ(enc.errors, 0);
+}
+
+static void test_async_error_keeps_sample(void)
+{
+	mt6701_sample_t s;
+
+	setup();
+	set_angle(777);
+	mt6701_start_read(&enc, 1);
+	hal_shim_i2c_complete(&hi2c2);
+
+	/* Device gone: the transfer NACKs, the last good sample stays */
+	hal_shim_i2c_attach(&hi2c2, 0);
+	TEST_ASSERT_EQ(mt6701_start_read(&enc, 2), 0);
+	TEST_ASSERT(hal_shim_i2c_complete(&hi2c2));
+	TEST_ASSERT_EQ(enc.errors, 1);
+	TEST_ASSERT(!enc.busy);
+
+	TEST_ASSERT_EQ(mt6701_get_sample(&enc, &s), 0);
+	TEST_ASSERT_EQ(s.angle, 777);
+	TEST_ASSERT_EQ(s.timestamp, 1);
+	TEST_ASSERT_EQ(s.seq, 1);
+
+	/* Blocking reads fail fast and are counted, without a message */
+	TEST_ASSERT_EQ(mt6701_read_angle_raw(&enc, &s.angle), -1);
+	TEST_ASSERT_EQ(enc.errors, 2);
+}
+
+int main(void)
+{
+	RUN_TEST(test_blocking_burst);
+	RUN_TEST(test_async_sample);
+	RUN_TEST(test_async_error_keeps_sample);
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Parameter registry: lookup, reads and writes landing in the right motor
+ * fields, range, type and mode checks, all-or-nothing group writes, and
+ * saving to and loading from the configuration store.
+ */
+
+#include "test.h"
+#include "hal_shim.h"
+#include "param.h"
+#include "store.h"
+#include <string.h>
+
+static struct foc_motor *motor;
+
+static void setup(void)
+{
+	motor = foc_get_motor("motor0");
+	motor->velocity_cfg.mode = FOC_VELOCITY_DISABLED;
+}
+
+static void test_lookup(void)
+{
+	const struct param_info *p;
+
+	TEST_ASSERT_EQ(param_find("speed_kp"), PARAM_SPEED_KP);
+	TEST_ASSERT_EQ(param_find("pole_pairs"), PARAM_POLE_PAIRS);
+	TEST_ASSERT_EQ(param_find("nope"), -1);
+
+	p = param_info(PARAM_CURRENT_LIMIT);
+	TEST_ASSERT(p != NULL);
+	TEST_ASSERT(strcmp(p->name, "current_limit") == 0);
+	TEST_ASSERT_EQ(p->type, PARAM_F32);
+	TEST_ASSERT(param_info(PARAM_NUM) == NULL);
+
+	/* Names are unique */
+	for (int i = 0; i < PARAM_NUM; i++) {
+		TEST_ASSERT_EQ(param_find(param_info(i)->name), i);
+	}
+}
+
+static void test_fields(void)
+{
+	struct foc_motor *other = foc_get_motor("motor1");
+	uint8_t other_pole_pairs = other->velocity_cfg.pole_pairs;
+	float v;
+
+	setup();
+
+	TEST_ASSERT_EQ(param_set(motor, PARAM_SPEED_KP, 0.25f), 0);
+	TEST_ASSERT_NEAR(motor->speed_pi.kp, 0.25f, 0.0f);
+	TEST_ASSERT_EQ(param_set(motor, PARAM_CURRENT_KI, 300.0f), 0);
+	TEST_ASSERT_NEAR(motor->torque_cfg.ki, 300.0f, 0.0f);
+	TEST_ASSERT_EQ(param_set(motor, PARAM_ENCODER_OFFSET, 12.5f), 0);
+	TEST_ASSERT_NEAR(motor->encoder.offset_deg, 12.5f, 0.0f);
+	TEST_ASSERT_EQ(param_set(motor, PARAM_POLE_PAIRS, 11.0f), 0);
+	TEST_ASSERT_EQ(motor->velocity_cfg.pole_pairs, 11);
+
+	motor->current_cfg.current_limit_a = 7.5f;
+	TEST_ASSERT_EQ(param_get(motor, PARAM_CURRENT_LIMIT, &v), 0);
+	TEST_ASSERT_NEAR(v, 7.5f, 0.0f);
+	TEST_ASSERT_EQ(param_get(motor, PARAM_POLE_PAIRS, &v), 0);
+	TEST_ASSERT_NEAR(v, 11.0f, 0.0f);
+	TEST_ASSERT_EQ(param_get(motor, PARAM_NUM, &v), -1);
+
+	/* The other motor is untouched */
+	TEST_ASSERT_EQ(other->velocity_cfg.pole_pairs, other_pole_pairs);
+}
+
+static void test_rejects(void)
+{
+	setup();
+	motor->current_cfg.current_limit_a = 5.0f;
+
+	TEST_ASSERT_EQ(param_set(motor, PARAM_CURRENT_LIMIT, 0.0f), -1);
+	TEST_ASSERT_EQ(param_set(motor, PARAM_CURRENT_LIMIT, 51.0f), -1);
+	TEST_ASSERT_EQ(param_set(motor, PARAM_CURRENT_LIMIT, NAN), -1);
+	TEST_ASSERT_EQ(param_set(motor, PARAM_CURRENT_LIMIT, INFINITY), -1);
+	TEST_ASSERT_NEAR(motor->current_cfg.current_limit_a, 5.0f, 0.0f);
+
+	TEST_ASSERT_EQ(param_set(motor, PARAM_VELOCITY_RATE, 0.0f), -1);
+	TEST_ASSERT_EQ(param_set(motor, PARAM_POLE_PAIRS, 7.5f), -1);
+	TEST_ASSERT_EQ(param_set(motor, PARAM_NUM, 1.0f), -1);
+
+	/* Pole pairs only change while velocity control is off */
+	motor->velocity_cfg.mode = FOC_VELOCITY_OPEN_LOOP;
+	TEST_ASSERT_EQ(param_set(motor, PARAM_POLE_PAIRS, 7.0f), -2);
+	TEST_ASSERT_EQ(param_set(motor, PARAM_SPEED_KI, 1.0f), 0);
+	motor->velocity_cfg.mode = FOC_VELOCITY_DISABLED;
+	TEST_ASSERT_EQ(param_set(motor, PARAM_POLE_PAIRS, 7.0f), 0);
+}
+
+static void test_set_many(void)
+{
+	const struct param_value good[] = {
+		{PARAM_SPEED_KP, 0.5f},
+		{PARAM_SPEED_KI, 2.0f},
+	};
+	const struct param_value bad[] = {
+		{PARAM_SPEED_KP, 0.75f},
+		{PARAM_VBUS, 100.0f},
+	};
+
+	setup();
+
+	TEST_ASSERT_EQ(param_set_many(motor, good, 2), 0);
+	TEST_ASSERT_NEAR(motor->speed_pi.kp, 0.5f, 0.0f);
+	TEST_ASSERT_NEAR(motor->speed_pi.ki, 2.0f, 0.0f);
+
+	/* One bad value and nothing is stored */
+	TEST_ASSERT_EQ(param_set_many(motor, bad, 2), -1);
+	TEST_ASSERT_NEAR(motor->speed_pi.kp, 0.5f, 0.0f);
+
+	TEST_ASSERT_EQ(param_set_many(motor, NULL, 0), 0);
+	TEST_ASSERT_EQ(param_set_many(NULL, good, 2), -1);
+}
+
+static void test_save_load(void)
+{
+	setup();
+	hal_shim_flash_open(NULL);
+	TEST_ASSERT_EQ(store_init(), 0);
+
+	TEST_ASSERT_EQ(param_set(motor, PARAM_SPEED_KP, 0.3f), 0);
+	TEST_ASSERT_EQ(param_set(motor, PARAM_ENCODER_OFFSET, 90.0f), 0);
+	TEST_ASSERT_EQ(param_save_all(motor, 0), 0);
+	TEST_ASSERT(param_saved(0, PARAM_SPEED_KP));
+	TEST_ASSERT(!param_saved(1, PARAM_SPEED_KP));
+	TEST_ASSERT(!param_saved(0, PARAM_VELOCITY_RATE));
+	TEST_ASSERT_EQ(param_save(motor, 0, PARAM_VELOCITY_RATE), -1);
+
+	/* Out of range values are not saved */
+	motor->torque_cfg.vbus = 0.0f;
+	TEST_ASSERT_EQ(param_save(motor, 0, PARAM_VBUS), -1);
+	TEST_ASSERT(!param_saved(0, PARAM_VBUS));
+
+	/* Reset: defaults come back, then the saved values */
+	motor->speed_pi.kp = 1.0f;
+	motor->encoder.offset_deg = 0.0f;
+	TEST_ASSERT_EQ(store_init(), 0);
+	TEST_ASSERT(param_load(motor, 0) > 0);
+	TEST_ASSERT_NEAR(motor->speed_pi.kp, 0.3f, 0.0f);
+	TEST_ASSERT_NEAR(motor->encoder.offset_deg, 90.0f, 0.0f);
+
+	/* One value saved alone */
+	motor->current_cfg.current_offset[0] = 1.6f;
+	TEST_ASSERT_EQ(param_save(motor, 1, PARAM_CURRENT_OFFSET_A), 0);
+	TEST_ASSERT(param_saved(1, PARAM_CURRENT_OFFSET_A));
+	TEST_ASSERT(!param_saved(1, PARAM_CURRENT_OFFSET_B));
+	TEST_ASSERT(!param_saved(1, PARAM_SPEED_KI));
+}
+
+int main(void)
+{
+	RUN_TEST(test_lookup);
+	RUN_TEST(test_fields);
+	RUN_TEST(test_rejects);
+	RUN_TEST(test_set_many);
+	RUN_TEST(test_save_load);
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Profiling probes: statistics, spans measured against the host clock and
+ * probes in the firmware modules. Also built with PROF_ENABLE=0, where the
+ * probes in this file must record nothing.
+ */
+
+#include "test.h"
+#include "hal_shim.h"
+#include "prof.h"
+#include "drv/pwm.h"
+#include <string.h>
+#include <time.h>
+
+static void setup(void)
+{
+	hal_shim_reset();
+	prof_init();
+}
+
+static void test_statistics(void)
+{
+	struct prof_stats s;
+	uint32_t base;
+
+	setup();
+	TEST_ASSERT_EQ(prof_get(PROF_SVPWM, &s), 0);
+	TEST_ASSERT_EQ(s.count, 0);
+
+	prof_record(PROF_SVPWM, 10000);
+	prof_record(PROF_SVPWM, 30000);
+	prof_record(PROF_SVPWM, 20000);
+	prof_get(PROF_SVPWM, &s);
+
+	/* All samples are reduced by the same empty-probe overhead */
+	base = s.min;
+	TEST_ASSERT(base <= 10000 && base > 9000);
+	TEST_ASSERT_EQ(s.count, 3);
+	TEST_ASSERT_EQ(s.max, base + 20000);
+	TEST_ASSERT_EQ(s.last, base + 10000);
+	TEST_ASSERT_EQ(s.total / s.count, base + 10000);
+
+	/* Other probes are untouched; invalid IDs are ignored */
+	prof_get(PROF_TORQUE_UPDATE, &s);
+	TEST_ASSERT_EQ(s.count, 0);
+	prof_record(PROF_NUM_IDS, 1);
+	TEST_ASSERT_EQ(prof_get(PROF_NUM_IDS, &s), -1);
+	TEST_ASSERT(prof_name(PROF_NUM_IDS) == NULL);
+	TEST_ASSERT(strcmp(prof_name(PROF_SVPWM), "pwm_set_vector_svpwm") == 0);
+
+	prof_reset();
+	prof_get(PROF_SVPWM, &s);
+	TEST_ASSERT_EQ(s.count, 0);
+}
+
+static void test_span(void)
+{
+	struct timespec ts = {0, 2000000L};
+	struct prof_stats s;
+
+	setup();
+
+	PROF_START(PROF_VELOCITY_UPDATE);
+	nanosleep(&ts, NULL);
+	PROF_STOP(PROF_VELOCITY_UPDATE);
+
+	prof_get(PROF_VELOCITY_UPDATE, &s);
+#if PROF_ENABLE
+	/* At least the 2 ms slept, in core clock cycles */
+	TEST_ASSERT_EQ(s.count, 1);
+	TEST_ASSERT(s.last >= 2000U * (SystemCoreClock / 1000000U));
+	TEST_ASSERT(s.last < 1000000U * (SystemCoreClock / 1000000U));
+#else
+	TEST_ASSERT_EQ(s.count, 0);
+#endif
+}
+
+static void test_firmware_probe(void)
+{
+	struct pwm_device *pwm0;
+	struct prof_stats s;
+
+	setup();
+	htim2.Init.Period = 8499;
+	HAL_TIM_Base_Init(&htim2);
+	pwm0 = pwm_get_device("pwm_motor0");
+	pwm_init(pwm0);
+
+	/* Compiled into foc2_core with probes on, whatever this file uses */
+	for (int i = 0; i < 100; i++) {
+		pwm_set_vector_svpwm(pwm0, (float)i * 3.6f, 50.0f);
+	}
+	prof_get(PROF_SVPWM, &s);
+	TEST_ASSERT_EQ(s.count, 100);
+	TEST_ASSERT(s.min <= s.total / s.count && s.total / s.count <= s.max);
+
+	prof_dump();
+}
+
+int main(void)
+{
+	RUN_TEST(test_statistics);
+	RUN_TEST(test_span);
+	RUN_TEST(test_firmware_probe);
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,412 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Binary protocol: CRC and COBS, request/response round trips through a
+ * port and the host client, repeated sequence numbers, error replies,
+ * console text next to frames, the interrupt receive ring, refused
+ * responses and responses still in flight.
+ */
+
+#include "test.h"
+#include "proto.h"
+#include "proto_client.h"
+
+static float speed = 12.5f;
+static uint16_t raw = 4095;
+static bool flag = true;
+
+static const struct scope_signal regs[] = {
+	{"speed", SCOPE_F32, &speed},
+	{"raw", SCOPE_U16, &raw},
+	{"flag", SCOPE_BOOL, &flag},
+};
+
+/* Fake transport */
+static uint8_t wire[4096];
+static size_t wire_len;
+static int write_result;
+
+/* Asynchronous transport: the transfer from sent_buf has not finished */
+static const uint8_t *sent_buf;
+static bool in_flight;
+
+static bool fake_busy(const uint8_t *buf)
+{
+	return in_flight && buf == sent_buf;
+}
+
+static int fake_write(const uint8_t *buf, uint16_t len)
+{
+	if (write_result != 0) {
+		return write_result;
+	}
+	sent_buf = buf;
+	memcpy(&wire[wire_len], buf, len);
+	wire_len += len;
+	return 0;
+}
+
+/* Console keys */
+static char text[64];
+static size_t text_len;
+
+static void fake_text(uint8_t ch)
+{
+	text[text_len++] = (char)ch;
+}
+
+/* Application handler: records the last SET_TARGET */
+static int handler_calls;
+static uint8_t last_axis, last_mode;
+static float last_value;
+
+static uint8_t fake_handler(uint8_t cmd, const uint8_t *req, uint16_t len, uint8_t *resp,
+                            uint16_t *resp_len)
+{
+	handler_calls++;
+	if (cmd != PROTO_CMD_SET_TARGET) {
+		return PROTO_ERR_CMD;
+	}
+	if (len != 6) {
+		return PROTO_ERR_LEN;
+	}
+	last_axis = req[0];
+	last_mode = req[1];
+	last_value = proto_get_f32(&req[2]);
+	resp[0] = 0xAB;
+	*resp_len = 1;
+	return PROTO_OK;
+}
+
+static struct proto_port port;
+static struct proto_client client;
+
+static void reset(proto_text_t text_fn)
+{
+	proto_port_init(&port, fake_write, text_fn);
+	proto_client_init(&client, 1);
+	proto_set_handler(fake_handler);
+	proto_set_registers(regs, 3);
+	wire_len = 0;
+	write_result = 0;
+	sent_buf = NULL;
+	in_flight = false;
+	text_len = 0;
+	handler_calls = 0;
+}
+
+/* Send a request, return 1 with the response if one came back */
+static int transact(const uint8_t *req, uint32_t len, struct proto_response *resp)
+{
+	wire_len = 0;
+	proto_port_receive(&port, req, len);
+	return proto_client_feed(&client, wire, wire_len, NULL, resp);
+}
+
+static void test_crc_cobs(void)
+{
+	static const uint8_t check[] = "123456789";
+	static const uint8_t in[] = {0x11, 0x22, 0x00, 0x33};
+	static const uint8_t expect[] = {0x03, 0x11, 0x22, 0x02, 0x33};
+	static const uint8_t bad_code[] = {0x02, 0x11, 0x00};
+	static const uint8_t bad_len[] = {0x05, 0x11, 0x22};
+	static uint8_t data[600], enc[610];
+	uint8_t out[8];
+	uint32_t n;
+	bool ok = true;
+
+	TEST_ASSERT_EQ(proto_crc16(check, 9), 0x29B1);
+
+	n = proto_cobs_encode(in, sizeof(in), out);
+	TEST_ASSERT_EQ(n, sizeof(expect));
+	TEST_ASSERT(memcmp(out, expect, sizeof(expect)) == 0);
+	TEST_ASSERT_EQ(proto_cobs_decode(out, n, out), sizeof(in));
+	TEST_ASSERT(memcmp(out, in, sizeof(in)) == 0);
+
+	n = proto_cobs_encode(in + 2, 1, out);
+	TEST_ASSERT_EQ(n, 2);
+	TEST_ASSERT(out[0] == 1 && out[1] == 1);
+
+	/* Runs longer than 254, a zero at the end, decoded in place */
+	for (uint32_t i = 0; i < sizeof(data); i++) {
+		data[i] = (i % 300 == 299) ? 0 : (uint8_t)(i * 7 + 1) | 1;
+	}
+	n = proto_cobs_encode(data, sizeof(data), enc);
+	TEST_ASSERT(n <= sizeof(data) + sizeof(data) / 254 + 1);
+	for (uint32_t i = 0; i < n; i++) {
+		ok &= enc[i] != 0;
+	}
+	TEST_ASSERT(ok);
+	TEST_ASSERT_EQ(proto_cobs_decode(enc, n, enc), sizeof(data));
+	TEST_ASSERT(memcmp(enc, data, sizeof(data)) == 0);
+
+	TEST_ASSERT_EQ(proto_cobs_decode(bad_code, sizeof(bad_code), out), -1);
+	TEST_ASSERT_EQ(proto_cobs_decode(bad_len, sizeof(bad_len), out), -1);
+}
+
+static void test_registers(void)
+{
+	static const uint8_t ids[] = {2, 0, 1};
+	uint8_t req[PROTO_CLIENT_REQUEST_SIZE];
+	struct proto_response resp;
+
+	reset(NULL);
+
+	TEST_ASSERT(transact(req, proto_client_ping(&client, req), &resp));
+	TEST_ASSERT_EQ(resp.status, PROTO_OK);
+	TEST_ASSERT_EQ(resp.len, 2);
+	TEST_ASSERT_EQ(resp.payload[0], PROTO_VERSION);
+	TEST_ASSERT_EQ(resp.payload[1], 3);
+
+	TEST_ASSERT(transact(req, proto_client_read_regs(&client, ids, 3, req), &resp));
+	TEST_ASSERT_EQ(resp.status, PROTO_OK);
+	TEST_ASSERT_EQ(resp.len, 12);
+	TEST_ASSERT_EQ(proto_client_reg_value(&resp, 0), 1.0f);
+	TEST_ASSERT_EQ(proto_client_reg_value(&resp, 1) * 10.0f, 125);
+	TEST_ASSERT_EQ(proto_client_reg_value(&resp, 2), 4095);
+
+	TEST_ASSERT(transact(req, proto_client_reg_info(&client, 1, req), &resp));
+	TEST_ASSERT_EQ(resp.len, 4);
+	TEST_ASSERT_EQ(resp.payload[0], SCOPE_U16);
+	TEST_ASSERT(memcmp(&resp.payload[1], "raw", 3) == 0);
+
+	TEST_ASSERT_EQ(port.stats.requests, 3);
+	TEST_ASSERT_EQ(handler_calls, 0);
+}
+
+static void test_repeat(void)
+{
+	uint8_t req[PROTO_CLIENT_REQUEST_SIZE];
+	uint8_t first[sizeof(wire)];
+	struct proto_response resp;
+	size_t first_len;
+	uint32_t len;
+
+	reset(NULL);
+
+	len = proto_client_set_target(&client, 1, PROTO_TARGET_VELOCITY, -120.0f, req);
+	TEST_ASSERT(transact(req, len, &resp));
+	TEST_ASSERT_EQ(resp.status, PROTO_OK);
+	TEST_ASSERT_EQ(resp.len, 1);
+	TEST_ASSERT_EQ(resp.payload[0], 0xAB);
+	TEST_ASSERT_EQ(handler_calls, 1);
+	TEST_ASSERT_EQ(last_axis, 1);
+	TEST_ASSERT_EQ(last_mode, PROTO_TARGET_VELOCITY);
+	TEST_ASSERT_EQ(last_value, -120);
+	memcpy(first, wire, wire_len);
+	first_len = wire_len;
+
+	/* Response lost, host sends the same bytes again: not run twice */
+	TEST_ASSERT(transact(req, len, &resp));
+	TEST_ASSERT_EQ(handler_calls, 1);
+	TEST_ASSERT_EQ(port.stats.repeats, 1);
+	TEST_ASSERT_EQ(wire_len, first_len);
+	TEST_ASSERT(memcmp(wire, first, first_len) == 0);
+
+	/* Next request, next seq: runs */
+	len = proto_client_set_target(&client, 0, PROTO_TARGET_STOP, 0.0f, req);
+	TEST_ASSERT(transact(req, len, &resp));
+	TEST_ASSERT_EQ(handler_calls, 2);
+	TEST_ASSERT_EQ(last_axis, 0);
+}
+
+static void test_errors(void)
+{
+	static const uint8_t too_many[PROTO_MAX_PAYLOAD / 4 + 1];
+	static const uint8_t bad_reg = 3;
+	static const uint8_t garbage[] = {0x00, 0x05, 0x01, 0x00};
+	uint8_t req[PROTO_CLIENT_REQUEST_SIZE];
+	struct proto_response resp;
+	uint32_t len;
+
+	reset(NULL);
+
+	TEST_ASSERT(transact(req, proto_client_read_regs(&client, &bad_reg, 1, req), &resp));
+	TEST_ASSERT_EQ(resp.status, PROTO_ERR_ARG);
+	TEST_ASSERT_EQ(resp.len, 0);
+
+	len = proto_client_read_regs(&client, too_many, sizeof(too_many), req);
+	TEST_ASSERT(transact(req, len, &resp));
+	TEST_ASSERT_EQ(resp.status, PROTO_ERR_LEN);
+
+	TEST_ASSERT(transact(req, proto_client_request(&client, 0x55, NULL, 0, req), &resp));
+	TEST_ASSERT_EQ(resp.status, PROTO_ERR_CMD);
+
+	proto_set_handler(NULL);
+	len = proto_client_set_target(&client, 0, PROTO_TARGET_STOP, 0.0f, req);
+	TEST_ASSERT(transact(req, len, &resp));
+	TEST_ASSERT_EQ(resp.status, PROTO_ERR_CMD);
+
+	/* A flipped bit: no response, counted */
+	len = proto_client_ping(&client, req);
+	req[3] ^= 0x10;
+	TEST_ASSERT(!transact(req, len, &resp));
+	TEST_ASSERT_EQ(wire_len, 0);
+	TEST_ASSERT_EQ(port.stats.crc_errors, 1);
+
+	TEST_ASSERT(!transact(garbage, sizeof(garbage), &resp));
+	TEST_ASSERT_EQ(port.stats.frame_errors, 1);
+	TEST_ASSERT_EQ(proto_client_request(&client, 1, too_many, PROTO_MAX_PAYLOAD + 1, req), 0);
+}
+
+static void test_console_text(void)
+{
+	static const uint8_t noise[] = {'x', 0x00, 'j', 'u', 'n', 'k', 0x00};
+	uint8_t req[PROTO_CLIENT_REQUEST_SIZE];
+	uint8_t stream[3 * PROTO_CLIENT_REQUEST_SIZE];
+	struct proto_response resp;
+	size_t n = 0;
+
+	reset(fake_text);
+
+	/* Keys around a frame */
+	stream[n++] = '+';
+	stream[n++] = 'i';
+	n += proto_client_ping(&client, req);
+	memcpy(&stream[2], req, n - 2);
+	stream[n++] = '-';
+	TEST_ASSERT(transact(stream, n, &resp));
+	TEST_ASSERT_EQ(text_len, 3);
+	TEST_ASSERT(memcmp(text, "+i-", 3) == 0);
+
+	/* A broken frame does not swallow the next good one */
+	n = sizeof(noise);
+	memcpy(stream, noise, n);
+	n += proto_client_ping(&client, &stream[n]);
+	stream[n++] = 'p';
+	TEST_ASSERT(transact(stream, n, &resp));
+	TEST_ASSERT_EQ(resp.status, PROTO_OK);
+	TEST_ASSERT_EQ(port.stats.frame_errors + port.stats.crc_errors, 1);
+	TEST_ASSERT_EQ(text_len, 5);
+	TEST_ASSERT(memcmp(text, "+i-xp", 5) == 0);
+}
+
+static void test_ring_and_retry(void)
+{
+	static uint8_t flood[PROTO_RX_RING_SIZE + 44];
+	uint8_t req[PROTO_CLIENT_REQUEST_SIZE];
+	struct proto_response resp;
+	uint32_t len;
+
+	reset(NULL);
+
+	/* Bytes arrive from an interrupt in pieces */
+	len = proto_client_ping(&client, req);
+	TEST_ASSERT_EQ(proto_port_push(&port, req, 3), 3);
+	proto_port_poll(&port);
+	TEST_ASSERT_EQ(wire_len, 0);
+	TEST_ASSERT_EQ(proto_port_push(&port, &req[3], len - 3), len - 3);
+	proto_port_poll(&port);
+	TEST_ASSERT(proto_client_feed(&client, wire, wire_len, NULL, &resp));
+
+	/* Full ring: the rest is dropped and counted */
+	TEST_ASSERT_EQ(proto_port_push(&port, flood, sizeof(flood)), PROTO_RX_RING_SIZE - 1);
+	TEST_ASSERT_EQ(port.stats.dropped, 45);
+	proto_port_poll(&port);
+
+	/* Transport busy: the response waits for the next poll */
+	wire_len = 0;
+	write_result = -1;
+	len = proto_client_ping(&client, req);
+	proto_port_push(&port, req, len);
+	proto_port_poll(&port);
+	TEST_ASSERT_EQ(port.stats.tx_errors, 1);
+	TEST_ASSERT_EQ(wire_len, 0);
+
+	write_result = 0;
+	proto_port_poll(&port);
+	TEST_ASSERT(proto_client_feed(&client, wire, wire_len, NULL, &resp));
+	TEST_ASSERT_EQ(resp.status, PROTO_OK);
+}
+
+static void test_tx_in_flight(void)
+{
+	uint8_t req[2 * PROTO_CLIENT_REQUEST_SIZE];
+	uint8_t sent[sizeof(port.tx)];
+	struct proto_response resp;
+	uint32_t len;
+
+	reset(NULL);
+	proto_port_set_busy(&port, fake_busy);
+
+	/* Two requests at once: the second waits for the first response */
+	len = proto_client_ping(&client, req);
+	len += proto_client_reg_info(&client, 1, &req[len]);
+	proto_port_push(&port, req, len);
+	in_flight = true;
+	proto_port_poll(&port);
+	TEST_ASSERT_EQ(port.stats.requests, 1);
+	memcpy(sent, port.tx, port.tx_len);
+	proto_port_poll(&port);
+	TEST_ASSERT_EQ(port.stats.requests, 1);
+	TEST_ASSERT(memcmp(sent, port.tx, port.tx_len) == 0);
+
+	in_flight = false;
+	wire_len = 0;
+	proto_port_poll(&port);
+	TEST_ASSERT_EQ(port.stats.requests, 2);
+	TEST_ASSERT(proto_client_feed(&client, wire, wire_len, NULL, &resp));
+	TEST_ASSERT_EQ(resp.len, 4);
+	TEST_ASSERT(memcmp(&resp.payload[1], "raw", 3) == 0);
+
+	/* A refused response holds off the next request as well */
+	wire_len = 0;
+	write_result = -1;
+	len = proto_client_ping(&client, req);
+	len += proto_client_ping(&client, &req[len]);
+	proto_port_push(&port, req, len);
+	proto_port_poll(&port);
+	TEST_ASSERT_EQ(port.stats.requests, 3);
+	TEST_ASSERT_EQ(port.stats.tx_errors, 1);
+
+	write_result = 0;
+	proto_port_poll(&port);
+	TEST_ASSERT_EQ(port.stats.requests, 4);
+	TEST_ASSERT_EQ(wire_len, 2U * port.tx_len);
+}
+
+static void test_client_skips(void)
+{
+	static const uint8_t noise[] = {'h', 'e', 'l', 'l', 'o', '\n', 0x00, 0x54, 0x4D, 0x00};
+	uint8_t req[PROTO_CLIENT_REQUEST_SIZE];
+	uint8_t stream[512];
+	struct proto_response resp;
+	size_t n = 0, used;
+
+	reset(NULL);
+
+	/* A stale response to an older request, then text, then ours */
+	proto_port_receive(&port, req, proto_client_ping(&client, req));
+	memcpy(stream, wire, wire_len);
+	n = wire_len;
+	memcpy(&stream[n], noise, sizeof(noise));
+	n += sizeof(noise);
+
+	wire_len = 0;
+	proto_port_receive(&port, req, proto_client_reg_info(&client, 0, req));
+	memcpy(&stream[n], wire, wire_len);
+	n += wire_len;
+	stream[n++] = 'x';
+
+	TEST_ASSERT(proto_client_feed(&client, stream, n, &used, &resp));
+	TEST_ASSERT_EQ(used, n - 1);
+	TEST_ASSERT_EQ(resp.len, 6);
+	TEST_ASSERT(memcmp(&resp.payload[1], "speed", 5) == 0);
+	TEST_ASSERT_EQ(client.skipped, 3);
+}
+
+int main(void)
+{
+	RUN_TEST(test_crc_cobs);
+	RUN_TEST(test_registers);
+	RUN_TEST(test_repeat);
+	RUN_TEST(test_errors);
+	RUN_TEST(test_console_text);
+	RUN_TEST(test_ring_and_retry);
+	RUN_TEST(test_tx_in_flight);
+	RUN_TEST(test_client_skips);
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,263 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Equivalence of the two SVPWM implementations over the whole
+ * angle/amplitude range, and the Q15 compare fast path.
+ */
+
+#include "test.h"
+#include "hal_shim.h"
+#include "drv/pwm.h"
+#include <stdlib.h>
+
+#define PI_D 3.14159265358979323846
+
+static struct pwm_device *pwm0;
+
+static void setup(void)
+{
+	hal_shim_reset();
+
+	/* TIM2 base is normally set up by adc_dma_init() */
+	htim2.Init.Period = 8499;
+	HAL_TIM_Base_Init(&htim2);
+
+	pwm0 = pwm_get_device("pwm_motor0");
+	pwm_init(pwm0);
+	pwm_start(pwm0);
+}
+
+static void read_compare(uint32_t compare[3])
+{
+	compare[0] = __HAL_TIM_GET_COMPARE(&htim2, TIM_CHANNEL_1);
+	compare[1] = __HAL_TIM_GET_COMPARE(&htim2, TIM_CHANNEL_2);
+	compare[2] = __HAL_TIM_GET_COMPARE(&htim2, TIM_CHANNEL_3);
+}
+
+/* Exact compare value (before truncation) of the ideal SVPWM waveform */
+static void svpwm_exact(double angle_deg, double amplitude, double compare[3])
+{
+	double u = amplitude / 100.0 / sqrt(3.0);
+	double th = angle_deg * PI_D / 180.0;
+	double v[3] = {
+		u * cos(th),
+		u * cos(th - 2.0 * PI_D / 3.0),
+		u * cos(th + 2.0 * PI_D / 3.0),
+	};
+	double vmax = fmax(v[0], fmax(v[1], v[2]));
+	double vmin = fmin(v[0], fmin(v[1], v[2]));
+
+	for (int i = 0; i < 3; i++) {
+		compare[i] = (0.5 + v[i] - (vmax + vmin) / 2.0) * 8499.0;
+	}
+}
+
+static void test_mode_select(void)
+{
+	setup();
+
+	TEST_ASSERT_EQ(pwm0->data->svpwm_mode, PWM_SVPWM_SECTOR);
+	TEST_ASSERT_EQ(pwm_set_svpwm_mode(pwm0, PWM_SVPWM_MINMAX), 0);
+	TEST_ASSERT_EQ(pwm0->data->svpwm_mode, PWM_SVPWM_MINMAX);
+	TEST_ASSERT_EQ(pwm_set_svpwm_mode(pwm0, (enum pwm_svpwm_mode)7), -1);
+	TEST_ASSERT_EQ(pwm0->data->svpwm_mode, PWM_SVPWM_MINMAX);
+	TEST_ASSERT_EQ(pwm_set_svpwm_mode(pwm0, PWM_SVPWM_SECTOR), 0);
+}
+
+static void test_minmax_matches_sector(void)
+{
+	uint32_t sector[3], minmax[3];
+	uint32_t total = 0, exact = 0;
+	double ideal[3], err_min = 0.0, err_max = 0.0;
+	int worst = 0;
+
+	setup();
+
+	/* 0-360 deg in 0.1 deg steps, 0-100 % in 1 % steps */
+	for (int amp = 0; amp <= 100; amp++) {
+		for (int i = 0; i < 3600; i++) {
+			float angle = (float)i * 0.1f;
+			bool same = true;
+
+			pwm_set_svpwm_mode(pwm0, PWM_SVPWM_SECTOR);
+			pwm_set_vector_svpwm(pwm0, angle, (float)amp);
+			read_compare(sector);
+
+			pwm_set_svpwm_mode(pwm0, PWM_SVPWM_MINMAX);
+			pwm_set_vector_svpwm(pwm0, angle, (float)amp);
+			read_compare(minmax);
+
+			svpwm_exact(angle, amp, ideal);
+
+			for (int p = 0; p < 3; p++) {
+				int d = abs((int)sector[p] - (int)minmax[p]);
+
+				if (d > worst) worst = d;
+				if (d) same = false;
+
+				/* Truncation alone would give an error in [0, 1) */
+				err_min = fmin(err_min, fmin(ideal[p] - sector[p], ideal[p] - minmax[p]));
+				err_max = fmax(err_max, fmax(ideal[p] - sector[p], ideal[p] - minmax[p]));
+			}
+			total++;
+			exact += same;
+		}
+	}
+
+	printf("  %u/%u vectors bit-identical (%.2f%%), worst difference %d count\n",
+	       exact, total, 100.0 * exact / total, worst);
+	printf("  ideal - compare in [%.3f, %.3f] counts\n", err_min, err_max);
+
+	/* Same waveform, but the sector method looks up the angle within the
+	 * sector and min/max the absolute angle, so the 16-bit angle rounding
+	 * differs: outputs may straddle a truncation boundary, never more.
+	 */
+	TEST_ASSERT(worst <= 1);
+	TEST_ASSERT(err_min > -0.5);
+	TEST_ASSERT(err_max < 1.5);
+
+	pwm_set_svpwm_mode(pwm0, PWM_SVPWM_SECTOR);
+}
+
+static void test_minmax_line_voltage(void)
+{
+	uint32_t c[3];
+
+	setup();
+	pwm_set_svpwm_mode(pwm0, PWM_SVPWM_MINMAX);
+
+	/* Full amplitude at 0 deg: A to B/C spans 1.5 * Uout = sqrt(3)/2 of the bus,
+	 * with the vector centred in the carrier.
+	 */
+	pwm_set_vector_svpwm(pwm0, 0.0f, 100.0f);
+	read_compare(c);
+	TEST_ASSERT_NEAR((double)c[0] - (double)c[1], 8499.0 * 0.8660254, 1.0);
+	TEST_ASSERT_EQ(c[1], c[2]);
+	TEST_ASSERT_NEAR(((double)c[0] + (double)c[1]) / 2.0, 8499.0 / 2.0, 1.0);
+
+	/* Zero amplitude sits at 50 % */
+	pwm_set_vector_svpwm(pwm0, 123.0f, 0.0f);
+	read_compare(c);
+	TEST_ASSERT_EQ(c[0], 4249);
+	TEST_ASSERT_EQ(c[1], 4249);
+	TEST_ASSERT_EQ(c[2], 4249);
+
+	pwm_set_svpwm_mode(pwm0, PWM_SVPWM_SECTOR);
+}
+
+static void test_vector_ab(void)
+{
+	uint32_t ab[3], ref[3];
+	int worst = 0;
+
+	setup();
+	pwm_set_svpwm_mode(pwm0, PWM_SVPWM_MINMAX);
+
+	/* Same vector as angle/amplitude: amplitude 100 % is |v| = 1/sqrt(3) */
+	for (int i = 0; i < 360; i++) {
+		double th = i * PI_D / 180.0;
+		double u = 0.8 / sqrt(3.0);
+
+		pwm_set_vector_svpwm(pwm0, (float)i, 80.0f);
+		read_compare(ref);
+		pwm_set_vector_ab(pwm0, (float)(u * cos(th)), (float)(u * sin(th)));
+		read_compare(ab);
+
+		for (int p = 0; p < 3; p++) {
+			int d = abs((int)ab[p] - (int)ref[p]);
+
+			if (d > worst) worst = d;
+		}
+	}
+	TEST_ASSERT(worst <= 1);
+
+	/* Over-long vectors are scaled back onto the linear-region circle */
+	pwm_set_vector_svpwm(pwm0, 30.0f, 100.0f);
+	read_compare(ref);
+	pwm_set_vector_ab(pwm0, 2.0f * 0.8660254f, 2.0f * 0.5f);
+	read_compare(ab);
+	for (int p = 0; p < 3; p++) {
+		TEST_ASSERT_NEAR(ab[p], ref[p], 1);
+	}
+
+	pwm_set_svpwm_mode(pwm0, PWM_SVPWM_SECTOR);
+}
+
+static void test_duty_q15(void)
+{
+	uint32_t c[3];
+
+	setup();
+	TEST_ASSERT_EQ(pwm0->data->period, 8499);
+
+	TEST_ASSERT_EQ(pwm_set_duty_q15(pwm0, 0, PWM_DUTY_Q15_ONE / 2, PWM_DUTY_Q15_ONE), 0);
+	read_compare(c);
+	TEST_ASSERT_EQ(c[0], 0);
+	TEST_ASSERT_EQ(c[1], 4249);
+	TEST_ASSERT_EQ(c[2], 8499);
+
+	/* Out of range clamps to 100 % */
+	pwm_set_duty_q15(pwm0, 0xFFFF, PWM_DUTY_Q15_ONE + 1, 1);
+	read_compare(c);
+	TEST_ASSERT_EQ(c[0], 8499);
+	TEST_ASSERT_EQ(c[1], 8499);
+	TEST_ASSERT_EQ(c[2], 0);
+
+	/* Every Q15 value lands within one count of the exact product */
+	for (uint32_t q = 0; q <= PWM_DUTY_Q15_ONE; q++) {
+		double exact = (double)q * 8499.0 / 32768.0;
+
+		pwm_set_duty_q15(pwm0, (uint16_t)q, 0, 0);
+		read_compare(c);
+		if (fabs((double)c[0] - exact) >= 1.0) {
+			TEST_ASSERT_NEAR(c[0], exact, 1.0);
+			break;
+		}
+	}
+}
+
+static void test_duty_percent_wrapper(void)
+{
+	uint32_t c[3];
+
+	setup();
+
+	TEST_ASSERT_EQ(pwm_set_duty(pwm0, 25.0f, 50.0f, 150.0f), 0);
+	read_compare(c);
+	TEST_ASSERT_EQ(c[0], 2124);
+	TEST_ASSERT_EQ(c[1], 4249);
+	TEST_ASSERT_EQ(c[2], 8499);
+
+	TEST_ASSERT_EQ(pwm_set_phase_duty(pwm0, 1, 10.0f), 0);
+	TEST_ASSERT_EQ(__HAL_TIM_GET_COMPARE(&htim2, TIM_CHANNEL_2), 849);
+	TEST_ASSERT_EQ(pwm_set_phase_duty(pwm0, 3, 10.0f), -1);
+}
+
+static void test_uninitialized_rejected(void)
+{
+	struct pwm_device *pwm1 = pwm_get_device("pwm_motor1");
+
+	hal_shim_reset();
+	pwm1->data->initialized = false;
+
+	TEST_ASSERT_EQ(pwm_set_duty(pwm1, 10.0f, 10.0f, 10.0f), -1);
+#ifdef DEBUG
+	/* The fast path only checks in DEBUG builds */
+	TEST_ASSERT_EQ(pwm_set_duty_q15(pwm1, 0, 0, 0), -1);
+#endif
+}
+
+int main(void)
+{
+	RUN_TEST(test_mode_select);
+	RUN_TEST(test_minmax_matches_sector);
+	RUN_TEST(test_minmax_line_voltage);
+	RUN_TEST(test_vector_ab);
+	RUN_TEST(test_duty_q15);
+	RUN_TEST(test_duty_percent_wrapper);
+	RUN_TEST(test_uninitialized_rejected);
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Static scheduler: release rates and offsets, interrupt versus main loop
+ * tasks, overruns when the main loop falls behind and deadline misses.
+ */
+
+#include "test.h"
+#include "hal_shim.h"
+#include "scheduler.h"
+
+static uint32_t fast_runs;
+static uint32_t fast_first_tick;
+static uint32_t slow_runs;
+static uint32_t slow_first_tick;
+static uint32_t isr_runs;
+static uint32_t notify_count;
+static uint32_t sleep_us;
+
+static void fast_task(void)
+{
+	if (fast_runs++ == 0) {
+		fast_first_tick = sched_get_ticks();
+	}
+}
+
+static void slow_task(void)
+{
+	if (slow_runs++ == 0) {
+		slow_first_tick = sched_get_ticks();
+	}
+}
+
+static void isr_task(void)
+{
+	isr_runs++;
+}
+
+/* Takes sleep_us on the cycle counter, whatever the host does meanwhile */
+static void sleepy_task(void)
+{
+	hal_shim_advance_cycles(sleep_us * (SystemCoreClock / 1000000U));
+}
+
+static void notify(void)
+{
+	notify_count++;
+}
+
+static void reset(void)
+{
+	hal_shim_reset();
+	hal_shim_dwt_manual(true);
+	fast_runs = 0;
+	fast_first_tick = 0;
+	slow_runs = 0;
+	slow_first_tick = 0;
+	isr_runs = 0;
+	notify_count = 0;
+	sleep_us = 0;
+}
+
+static void test_rates_and_offsets(void)
+{
+	struct sched_task tasks[] = {
+		SCHED_TASK("isr",  isr_task,  SCHED_TICK_HZ, 0, SCHED_ISR),
+		SCHED_TASK("fast", fast_task, 2000, 1, SCHED_MAIN),
+		SCHED_TASK("slow", slow_task, 100, 4, SCHED_MAIN),
+	};
+
+	reset();
+	TEST_ASSERT_EQ(sched_init(tasks, 3, notify), 0);
+
+	/* One second of base ticks, main loop keeping up */
+	for (uint32_t i = 0; i < SCHED_TICK_HZ; i++) {
+		sched_tick();
+		sched_run();
+	}
+
+	TEST_ASSERT_EQ(isr_runs, SCHED_TICK_HZ);
+	TEST_ASSERT_EQ(fast_runs, 2000);
+	TEST_ASSERT_EQ(slow_runs, 100);
+	TEST_ASSERT_EQ(fast_first_tick, 2);
+	TEST_ASSERT_EQ(slow_first_tick, 5);
+
+	/* Notified for each tick releasing something, never for ISR-only ticks */
+	TEST_ASSERT_EQ(notify_count, 2000 + 100);
+
+	TEST_ASSERT_EQ(sched_get_task(0)->runs, SCHED_TICK_HZ);
+	TEST_ASSERT_EQ(sched_get_task(1)->overruns, 0);
+	TEST_ASSERT_EQ(sched_get_task(2)->overruns, 0);
+	TEST_ASSERT(sched_get_task(3) == NULL);
+}
+
+static void test_main_tasks_wait_for_run(void)
+{
+	struct sched_task tasks[] = {
+		SCHED_TASK("isr",  isr_task,  SCHED_TICK_HZ, 0, SCHED_ISR),
+		SCHED_TASK("fast", fast_task, SCHED_TICK_HZ / 2, 0, SCHED_MAIN),
+	};
+
+	reset();
+	TEST_ASSERT_EQ(sched_init(tasks, 2, notify), 0);
+
+	/* Main loop stalled for 10 ticks: one release pending, four skipped */
+	for (int i = 0; i < 10; i++) {
+		sched_tick();
+	}
+	TEST_ASSERT_EQ(isr_runs, 10);
+	TEST_ASSERT_EQ(fast_runs, 0);
+	TEST_ASSERT_EQ(tasks[1].overruns, 4);
+
+	TEST_ASSERT_EQ(sched_run(), 1);
+	TEST_ASSERT_EQ(sched_run(), 0);
+	TEST_ASSERT_EQ(fast_runs, 1);
+	TEST_ASSERT_EQ(tasks[1].runs, 1);
+}
+
+static void test_deadline_miss(void)
+{
+	struct sched_task tasks[] = {
+		SCHED_TASK("sleepy", sleepy_task, 1000, 0, SCHED_MAIN),
+	};
+
+	reset();
+	tasks[0].deadline_us = 200;
+	TEST_ASSERT_EQ(sched_init(tasks, 1, NULL), 0);
+	TEST_ASSERT_EQ(tasks[0].deadline, 200U * (SystemCoreClock / 1000000U));
+
+	sched_tick();
+	sched_run();
+	TEST_ASSERT_EQ(tasks[0].misses, 0);
+
+	sleep_us = 2000;
+	for (uint32_t i = 0; i < SCHED_TICK_HZ / 1000; i++) {
+		sched_tick();
+	}
+	sched_run();
+	TEST_ASSERT_EQ(tasks[0].runs, 2);
+	TEST_ASSERT_EQ(tasks[0].misses, 1);
+	TEST_ASSERT_EQ(sched_cycles_to_us(tasks[0].exec_last), 2000);
+	TEST_ASSERT(tasks[0].exec_max >= tasks[0].exec_last);
+}
+
+static void test_invalid_table(void)
+{
+	struct sched_task bad_offset[] = {
+		SCHED_TASK("late", fast_task, 1000, SCHED_TICK_HZ / 1000, SCHED_MAIN),
+	};
+	struct sched_task bad_rate[] = {
+		SCHED_TASK("fast", fast_task, 2 * SCHED_TICK_HZ, 0, SCHED_MAIN),
+	};
+
+	reset();
+	TEST_ASSERT_EQ(sched_init(bad_offset, 1, NULL), -1);
+	TEST_ASSERT_EQ(sched_init(bad_rate, 1, NULL), -1);
+}
+
+int main(void)
+{
+	RUN_TEST(test_rates_and_offsets);
+	RUN_TEST(test_main_tasks_wait_for_run);
+	RUN_TEST(test_deadline_miss);
+	RUN_TEST(test_invalid_table);
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Scope capture: pre-trigger window around edges after the ring has
+ * wrapped, forced and automatic triggers, decimation and signal types.
+ */
+
+#include "test.h"
+#include "scope.h"
+
+static float counter;
+static bool flag;
+static uint16_t raw16;
+static uint32_t raw32;
+
+static const struct scope_signal sig_counter = {"counter", SCOPE_F32, &counter};
+static const struct scope_signal sig_flag = {"flag", SCOPE_BOOL, &flag};
+static const struct scope_signal sig_raw16 = {"raw16", SCOPE_U16, &raw16};
+static const struct scope_signal sig_raw32 = {"raw32", SCOPE_U32, &raw32};
+
+/* One control tick: the signals change, then the scope samples */
+static void tick(uint32_t n, uint32_t flag_at)
+{
+	for (uint32_t i = 0; i < n; i++) {
+		counter += 1.0f;
+		flag = (uint32_t)counter >= flag_at;
+		scope_sample();
+	}
+}
+
+static void test_edge_with_pre_trigger(void)
+{
+	struct scope_config cfg = {
+		.channels = {&sig_counter},
+		.num_channels = 1,
+		.depth = 100,
+		.pre_trigger = 10,
+		.mode = SCOPE_TRIG_RISING,
+		.trigger = &sig_flag,
+		.level = 0.5f,
+	};
+	uint32_t depth, pre;
+	float v;
+
+	counter = 0.0f;
+	TEST_ASSERT_EQ(scope_configure(&cfg), 0);
+	TEST_ASSERT_EQ(scope_arm(), 0);
+	TEST_ASSERT_EQ(scope_configure(&cfg), -1);
+
+	/* Ring wraps several times before the edge at counter == 1000 */
+	tick(999, 1000);
+	TEST_ASSERT_EQ(scope_get_state(), SCOPE_ARMED);
+	TEST_ASSERT_EQ(scope_read(0, &v), -1);
+	tick(1, 1000);
+	TEST_ASSERT_EQ(scope_get_state(), SCOPE_TRIGGERED);
+	tick(88, 1000);
+	TEST_ASSERT_EQ(scope_get_state(), SCOPE_TRIGGERED);
+	tick(1, 1000);
+	TEST_ASSERT_EQ(scope_get_state(), SCOPE_DONE);
+
+	/* Stopped: later ticks leave the window alone */
+	tick(50, 1000);
+
+	TEST_ASSERT_EQ(scope_get_window(&depth, &pre), 1);
+	TEST_ASSERT_EQ(depth, 100);
+	TEST_ASSERT_EQ(pre, 10);
+	for (uint32_t i = 0; i < depth; i++) {
+		scope_read(i, &v);
+		TEST_ASSERT_EQ(v, 990 + i);
+	}
+	TEST_ASSERT_EQ(scope_read(100, &v), -1);
+	TEST_ASSERT(scope_get_channel(0) == &sig_counter);
+	TEST_ASSERT(scope_get_channel(1) == NULL);
+
+	scope_release();
+	TEST_ASSERT_EQ(scope_get_state(), SCOPE_IDLE);
+	TEST_ASSERT_EQ(scope_read(0, &v), -1);
+}
+
+static void test_early_edge_and_force(void)
+{
+	struct scope_config cfg = {
+		.channels = {&sig_counter},
+		.num_channels = 1,
+		.depth = 20,
+		.pre_trigger = 10,
+		.mode = SCOPE_TRIG_RISING,
+		.trigger = &sig_flag,
+		.level = 0.5f,
+	};
+	float v;
+
+	counter = 0.0f;
+	TEST_ASSERT_EQ(scope_configure(&cfg), 0);
+	TEST_ASSERT_EQ(scope_arm(), 0);
+
+	/* Edge at the 3rd sample, pre-trigger not full yet: ignored */
+	tick(30, 3);
+	TEST_ASSERT_EQ(scope_get_state(), SCOPE_ARMED);
+
+	scope_force();
+	tick(1, 3);
+	TEST_ASSERT_EQ(scope_get_state(), SCOPE_TRIGGERED);
+	tick(9, 3);
+	TEST_ASSERT_EQ(scope_get_state(), SCOPE_DONE);
+
+	scope_read(10, &v);
+	TEST_ASSERT_EQ(v, 31);
+	scope_read(0, &v);
+	TEST_ASSERT_EQ(v, 21);
+	scope_release();
+}
+
+static void test_auto_decimated_types(void)
+{
+	struct scope_config cfg = {
+		.channels = {&sig_counter, &sig_flag, &sig_raw16, &sig_raw32},
+		.num_channels = 4,
+		.decimation = 4,
+		.depth = 0,
+		.pre_trigger = 0,
+		.mode = SCOPE_TRIG_AUTO,
+	};
+	uint32_t depth;
+	float row[SCOPE_MAX_CHANNELS];
+
+	counter = 0.0f;
+	raw16 = 16383;
+	raw32 = 8499;
+	TEST_ASSERT_EQ(scope_configure(&cfg), 0);
+	TEST_ASSERT_EQ(scope_get_window(&depth, NULL), 4);
+	TEST_ASSERT_EQ(depth, SCOPE_BUFFER_SAMPLES / 4);
+
+	TEST_ASSERT_EQ(scope_arm(), 0);
+	tick(4 * depth, 100);
+	TEST_ASSERT_EQ(scope_get_state(), SCOPE_DONE);
+
+	/* Every 4th tick, starting with the 4th */
+	scope_read(0, row);
+	TEST_ASSERT_EQ(row[0], 4);
+	TEST_ASSERT_EQ(row[1], 0);
+	TEST_ASSERT_EQ(row[2], 16383);
+	TEST_ASSERT_EQ(row[3], 8499);
+	scope_read(depth - 1, row);
+	TEST_ASSERT_EQ(row[0], 4 * depth);
+	TEST_ASSERT_EQ(row[1], 1);
+
+	/* Re-arming a completed capture starts over */
+	TEST_ASSERT_EQ(scope_arm(), 0);
+	TEST_ASSERT_EQ(scope_get_state(), SCOPE_ARMED);
+	scope_release();
+}
+
+static void test_invalid(void)
+{
+	struct scope_config cfg = {
+		.channels = {&sig_counter},
+		.num_channels = 1,
+		.depth = 10,
+		.pre_trigger = 10,
+		.mode = SCOPE_TRIG_AUTO,
+	};
+
+	TEST_ASSERT_EQ(scope_configure(NULL), -1);
+	TEST_ASSERT_EQ(scope_configure(&cfg), -1);
+
+	cfg.pre_trigger = 0;
+	cfg.depth = SCOPE_BUFFER_SAMPLES + 1;
+	TEST_ASSERT_EQ(scope_configure(&cfg), -1);
+
+	cfg.depth = 10;
+	cfg.mode = SCOPE_TRIG_FALLING;
+	TEST_ASSERT_EQ(scope_configure(&cfg), -1);
+
+	cfg.num_channels = 0;
+	cfg.mode = SCOPE_TRIG_AUTO;
+	TEST_ASSERT_EQ(scope_configure(&cfg), -1);
+}
+
+int main(void)
+{
+	RUN_TEST(test_edge_with_pre_trigger);
+	RUN_TEST(test_early_edge_and_force);
+	RUN_TEST(test_auto_decimated_types);
+	RUN_TEST(test_invalid);
+
+	return TEST_RESULT();
+}
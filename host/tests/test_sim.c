@@ -0,0 +1,361 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Runs foc_task() in closed loop against the PMSM plant simulator.
+ */
+
+#include "test.h"
+#include "sim.h"
+#include "foc.h"
+#include "drv/adc_dma.h"
+#include "drv/mt6701.h"
+
+#define PI_D 3.14159265358979323846
+
+static struct foc_motor *motor0;
+
+static void setup(void)
+{
+	sim_init(NULL, NULL);
+	sim_boot();
+
+	motor0 = foc_get_motor("motor0");
+	foc_velocity_disable(motor0);
+	foc_current_disable(motor0);
+	foc_current_disable(foc_get_motor("motor1"));
+	foc_current_config(motor0, 0, 1, sim_default_sensor_params.current_sensitivity,
+	                   0.0f, 2.0f);
+}
+
+/* Offsets are measured in the background: run the plant until they are */
+static void current_enable(struct foc_motor *motor)
+{
+	TEST_ASSERT_EQ(foc_current_enable(motor), 0);
+	for (int ms = 0; ms < 100 && foc_current_calibrating(motor); ms++) {
+		sim_run_ms(1);
+	}
+	TEST_ASSERT(motor->current_cfg.enabled);
+}
+
+static void test_open_loop_sync(void)
+{
+	struct sim_motor *m;
+
+	setup();
+	m = sim_get_motor(0);
+
+	foc_velocity_enable(motor0, FOC_VELOCITY_OPEN_LOOP, 60.0f, 20.0f, 1000.0f, 7);
+	sim_run_ms(1000);
+
+	/* The rotor follows the rotating field */
+	TEST_ASSERT_NEAR(motor0->current_rpm, 60.0f, 1e-3);
+	TEST_ASSERT_NEAR(pmsm_rpm(&m->plant), 60.0f, 6.0f);
+	TEST_ASSERT_NEAR(sim_time(), 1.0, 1e-9);
+	TEST_ASSERT_EQ(sim_get_stats()->control_calls, 1000);
+}
+
+static void test_encoder_reads_plant(void)
+{
+	struct sim_motor *m;
+	float angle_deg;
+	double expected, diff;
+
+	setup();
+	m = sim_get_motor(0);
+
+	foc_velocity_enable(motor0, FOC_VELOCITY_OPEN_LOOP, 60.0f, 20.0f, 1000.0f, 7);
+	sim_run_ms(300);
+
+	for (int i = 0; i < 10; i++) {
+		sim_run_ms(7);
+
+		TEST_ASSERT_EQ(mt6701_read_angle_deg(sim_get_encoder(0), &angle_deg), 0);
+		expected = m->plant.state.theta_m * 180.0 / PI_D;
+		diff = fmod(angle_deg - expected + 540.0, 360.0) - 180.0;
+		/* One LSB of 14 bits is 0.022 deg */
+		TEST_ASSERT_NEAR(diff, 0.0, 0.05);
+	}
+}
+
+static void test_current_sense_reads_plant(void)
+{
+	struct sim_motor *m;
+
+	setup();
+	m = sim_get_motor(0);
+
+	current_enable(motor0);
+	/* Offsets calibrated at standstill with the plant running */
+	TEST_ASSERT_NEAR(motor0->current_cfg.current_offset[0],
+	                 sim_default_sensor_params.current_offset, 0.002);
+	TEST_ASSERT_NEAR(motor0->current_cfg.current_offset[1],
+	                 sim_default_sensor_params.current_offset, 0.002);
+
+	foc_velocity_enable(motor0, FOC_VELOCITY_OPEN_LOOP, 60.0f, 20.0f, 1000.0f, 7);
+	for (int i = 0; i < 200; i++) {
+		sim_run_ms(1);
+		/* 12-bit ADC at 1.2 V/A resolves ~0.7 mA; mV truncation costs ~1 mA */
+		TEST_ASSERT_NEAR(motor0->current_data.phase_a_current, m->plant.state.ia, 0.005);
+		TEST_ASSERT_NEAR(motor0->current_data.phase_b_current, m->plant.state.ib, 0.005);
+	}
+	TEST_ASSERT(!foc_current_is_overcurrent(motor0));
+}
+
+static void test_overcurrent_on_stall(void)
+{
+	struct pmsm_params params = pmsm_default_params;
+	struct sim_sensor_params sensor = sim_default_sensor_params;
+
+	/* Lower resistance so a held rotor draws more than the 2 A limit, and a
+	 * 200 mV/A front-end: at 1.2 V/A the ADC clips at +-1.375 A, so the
+	 * computed magnitude can never reach 2 A.
+	 */
+	params.rs = 0.5f;
+	sensor.current_sensitivity = 0.2f;
+	sim_init(&params, &sensor);
+	sim_boot();
+
+	motor0 = foc_get_motor("motor0");
+	foc_velocity_disable(motor0);
+	foc_current_config(motor0, 0, 1, sensor.current_sensitivity, 0.0f, 2.0f);
+	current_enable(motor0);
+
+	foc_velocity_enable(motor0, FOC_VELOCITY_OPEN_LOOP, 0.0f, 60.0f, 1000.0f, 7);
+	sim_run_ms(50);
+
+	/* Protection backs the amplitude off until the current is within limit */
+	TEST_ASSERT(motor0->amplitude < 60.0f);
+	TEST_ASSERT(!foc_current_is_overcurrent(motor0));
+	TEST_ASSERT(motor0->current_data.magnitude <= 2.0f);
+}
+
+static void test_torque_loop_step(void)
+{
+	struct sim_motor *m;
+	uint32_t updates;
+
+	setup();
+	m = sim_get_motor(0);
+
+	TEST_ASSERT_EQ(foc_torque_enable(motor0, 6.0f, 15000.0f, 12.0f), -1);
+	current_enable(motor0);
+	/* ~500 Hz bandwidth for Ls = 2 mH, Rs = 5 Ohm */
+	TEST_ASSERT_EQ(foc_torque_enable(motor0, 6.0f, 15000.0f, 12.0f), 0);
+
+	/* Angle held at 0: a d-axis step aligns the rotor with phase A */
+	foc_torque_set_target(motor0, 0.5f, 0.0f);
+	updates = motor0->torque_data.updates;
+	sim_run_ms(2);
+
+	/* The loop runs on every ADC sample set, not at the 1 kHz tick */
+	TEST_ASSERT_EQ(motor0->torque_data.updates - updates, 2 * SIM_STEPS_PER_MS);
+	TEST_ASSERT_NEAR(motor0->torque_data.id, 0.5f, 0.05f);
+	TEST_ASSERT_NEAR(motor0->torque_data.iq, 0.0f, 0.05f);
+	TEST_ASSERT_NEAR(m->plant.state.ia, 0.5f, 0.05f);
+
+	sim_run_ms(200);
+	TEST_ASSERT_NEAR(motor0->torque_data.id, 0.5f, 0.01f);
+	TEST_ASSERT_NEAR(m->plant.state.id, 0.5f, 0.02f);
+
+	foc_torque_disable(motor0);
+	sim_run_ms(20);
+	TEST_ASSERT_NEAR(m->plant.state.ia, 0.0f, 0.01f);
+}
+
+static void test_torque_voltage_limit(void)
+{
+	const float v_limit = 12.0f / sqrtf(3.0f);
+	struct foc_torque_data *data;
+	float mag;
+
+	setup();
+	data = &motor0->torque_data;
+	current_enable(motor0);
+	foc_torque_enable(motor0, 6.0f, 15000.0f, 12.0f);
+
+	/* 2 A through 5 Ohm needs more than the bus gives on both axes */
+	foc_torque_set_target(motor0, 2.0f, 2.0f);
+	sim_run_ms(50);
+
+	/* d first: it takes the whole circle, q and its integrator get none */
+	mag = sqrtf(data->vd * data->vd + data->vq * data->vq);
+	TEST_ASSERT(mag <= v_limit * 1.0001f);
+	TEST_ASSERT_NEAR(data->vd, v_limit, 1e-3);
+	TEST_ASSERT_NEAR(data->vq, 0.0f, 1e-3);
+	TEST_ASSERT_NEAR(data->iq_integral, 0.0f, 1e-3);
+
+	/* Within reach on d, q is limited to the rest of the circle */
+	foc_torque_set_target(motor0, 0.5f, 2.0f);
+	sim_run_ms(50);
+	mag = sqrtf(data->vd * data->vd + data->vq * data->vq);
+	TEST_ASSERT_NEAR(mag, v_limit, 1e-3);
+	TEST_ASSERT(fabsf(data->iq_integral) <= sqrtf(v_limit * v_limit - data->vd * data->vd) + 1e-3f);
+	TEST_ASSERT_NEAR(data->id, 0.5f, 0.05f);
+
+	foc_torque_disable(motor0);
+}
+
+static void test_torque_open_loop_current(void)
+{
+	struct sim_motor *m;
+	double rpm_sum = 0.0;
+	float mag;
+
+	setup();
+	m = sim_get_motor(0);
+
+	current_enable(motor0);
+	foc_torque_enable(motor0, 6.0f, 15000.0f, 12.0f);
+	foc_torque_set_target(motor0, 0.0f, 0.3f);
+
+	/* Velocity mode now only advances the angle; the loop holds 0.3 A */
+	foc_velocity_enable(motor0, FOC_VELOCITY_OPEN_LOOP, 60.0f, 20.0f, 1000.0f, 7);
+	sim_run_ms(500);
+
+	/* Current-fed open loop has no back-EMF damping, so the rotor swings
+	 * around synchronous speed; it must stay locked on average.
+	 */
+	for (int i = 0; i < 1000; i++) {
+		sim_run_ms(1);
+		rpm_sum += pmsm_rpm(&m->plant);
+	}
+
+	mag = sqrtf(m->plant.state.id * m->plant.state.id + m->plant.state.iq * m->plant.state.iq);
+	TEST_ASSERT_NEAR(mag, 0.3f, 0.02f);
+	TEST_ASSERT_NEAR(rpm_sum / 1000.0, 60.0, 3.0);
+
+	foc_torque_disable(motor0);
+	foc_velocity_disable(motor0);
+}
+
+/* Electrical angle the firmware derives from the encoder, minus the plant's */
+static double encoder_angle_error(struct sim_motor *m)
+{
+	uint16_t raw;
+	double est, diff;
+
+	mt6701_read_angle_raw(sim_get_encoder(0), &raw);
+	est = raw * 360.0 / MT6701_ANGLE_RESOLUTION * 7.0 + motor0->encoder.offset_deg;
+	diff = est - m->plant.state.theta_e * 180.0 / PI_D;
+	return fmod(fmod(diff, 360.0) + 540.0, 360.0) - 180.0;
+}
+
+static void test_encoder_align(void)
+{
+	struct sim_motor *m;
+
+	setup();
+	m = sim_get_motor(0);
+	/* Encoder zero well away from the rotor d-axis */
+	m->encoder_offset = 1.0f;
+
+	/* Alignment owns the PWM outputs, so velocity control must be off */
+	foc_velocity_enable(motor0, FOC_VELOCITY_OPEN_LOOP, 0.0f, 0.0f, 1000.0f, 7);
+	TEST_ASSERT_EQ(foc_encoder_align(motor0, 20.0f), -1);
+	foc_velocity_disable(motor0);
+	TEST_ASSERT_EQ(foc_encoder_align(motor0, 20.0f), 0);
+	TEST_ASSERT_NEAR(encoder_angle_error(m), 0.0, 2.0);
+
+	/* Still right once the rotor has turned */
+	foc_velocity_enable(motor0, FOC_VELOCITY_OPEN_LOOP, 60.0f, 20.0f, 1000.0f, 7);
+	sim_run_ms(777);
+	TEST_ASSERT_NEAR(encoder_angle_error(m), 0.0, 2.0);
+	foc_velocity_disable(motor0);
+}
+
+static void test_closed_loop_voltage(void)
+{
+	struct sim_motor *m;
+	float rpm, no_load;
+	uint32_t i2c_before;
+
+	setup();
+	m = sim_get_motor(0);
+	m->encoder_offset = 1.0f;
+
+	TEST_ASSERT_EQ(foc_encoder_attach(motor0, NULL, 0.0f), 0);
+	TEST_ASSERT_EQ(foc_velocity_enable(motor0, FOC_VELOCITY_CLOSED_LOOP, 300.0f, 60.0f,
+	                                   1000.0f, 7), -1);
+	foc_encoder_attach(motor0, sim_get_encoder(0), 0.0f);
+	foc_encoder_align(motor0, 20.0f);
+
+	TEST_ASSERT_EQ(foc_velocity_enable(motor0, FOC_VELOCITY_CLOSED_LOOP, 300.0f, 60.0f,
+	                                   1000.0f, 7), 0);
+	sim_run_ms(1400);
+
+	/* One timer-started burst per millisecond; the loop itself never waits on I2C */
+	i2c_before = hal_shim_i2c_transactions(&hi2c2);
+	sim_run_ms(100);
+	TEST_ASSERT_EQ(hal_shim_i2c_transactions(&hi2c2) - i2c_before, 100);
+	TEST_ASSERT_EQ(sim_get_encoder(0)->errors, 0);
+
+	/* Reported speed is the measurement, not the ramp */
+	TEST_ASSERT_EQ(foc_velocity_get_current(motor0, &rpm), 0);
+	TEST_ASSERT_NEAR(rpm, 300.0f, 10.0f);
+	TEST_ASSERT_NEAR(pmsm_rpm(&m->plant), 300.0f, 10.0f);
+
+	/* Only the voltage the load needs, not the 60 % ceiling */
+	no_load = motor0->speed_pi.output;
+	TEST_ASSERT(no_load > 0.0f && no_load < 40.0f);
+
+	m->plant.params.load_torque = 0.01f;
+	sim_run_ms(1500);
+	foc_velocity_get_current(motor0, &rpm);
+	TEST_ASSERT_NEAR(rpm, 300.0f, 10.0f);
+	TEST_ASSERT(motor0->speed_pi.output > no_load + 5.0f);
+
+	foc_velocity_disable(motor0);
+}
+
+static void test_closed_loop_torque(void)
+{
+	struct sim_motor *m;
+	/* 1.5 * pole pairs * flux linkage */
+	const float kt = 1.5f * 7.0f * 0.005f;
+	float rpm;
+
+	setup();
+	m = sim_get_motor(0);
+	m->encoder_offset = 1.0f;
+
+	foc_encoder_align(motor0, 20.0f);
+	current_enable(motor0);
+	foc_torque_enable(motor0, 6.0f, 15000.0f, 12.0f);
+	TEST_ASSERT_EQ(foc_velocity_set_gains(motor0, 0.002f, 0.05f), 0);
+
+	TEST_ASSERT_EQ(foc_velocity_enable(motor0, FOC_VELOCITY_CLOSED_LOOP, 300.0f, 0.0f,
+	                                   1000.0f, 7), 0);
+	m->plant.params.load_torque = 0.01f;
+	sim_run_ms(2000);
+
+	foc_velocity_get_current(motor0, &rpm);
+	TEST_ASSERT_NEAR(rpm, 300.0f, 10.0f);
+	TEST_ASSERT_NEAR(pmsm_rpm(&m->plant), 300.0f, 10.0f);
+
+	/* The current reference carries the load (plus a little friction) */
+	TEST_ASSERT_NEAR(motor0->torque_data.iq_ref, 0.01f / kt, 0.03f);
+	TEST_ASSERT_NEAR(m->plant.state.iq, 0.01f / kt, 0.05f);
+	TEST_ASSERT_NEAR(m->plant.state.id, 0.0f, 0.05f);
+
+	foc_velocity_disable(motor0);
+	TEST_ASSERT_EQ(motor0->torque_data.iq_ref, 0.0f);
+	foc_torque_disable(motor0);
+}
+
+int main(void)
+{
+	RUN_TEST(test_open_loop_sync);
+	RUN_TEST(test_encoder_reads_plant);
+	RUN_TEST(test_current_sense_reads_plant);
+	RUN_TEST(test_overcurrent_on_stall);
+	RUN_TEST(test_torque_loop_step);
+	RUN_TEST(test_torque_voltage_limit);
+	RUN_TEST(test_torque_open_loop_current);
+	RUN_TEST(test_encoder_align);
+	RUN_TEST(test_closed_loop_voltage);
+	RUN_TEST(test_closed_loop_torque);
+
+	return TEST_RESULT();
+}
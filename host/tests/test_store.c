@@ -0,0 +1,266 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Configuration store on the emulated flash: values across resets
+ * (store_init() again), sector copies and erase wear, torn writes and
+ * copies, foreign versions and the file-backed image.
+ */
+
+#include "test.h"
+#include "hal_shim.h"
+#include "store.h"
+#include "drv/flash.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+struct calib {
+	float offset_a;
+	float offset_b;
+	uint32_t samples;
+};
+
+/* Fresh erased flash and an empty store */
+static void setup(void)
+{
+	hal_shim_flash_open(NULL);
+	TEST_ASSERT_EQ(store_init(), 0);
+}
+
+static void test_empty(void)
+{
+	struct store_stats stats;
+	float v;
+
+	setup();
+
+	TEST_ASSERT_EQ(store_get(1, &v, sizeof(v)), -1);
+	store_get_stats(&stats);
+	TEST_ASSERT_EQ(stats.keys, 0);
+	TEST_ASSERT_EQ(stats.used, 0);
+	TEST_ASSERT_EQ(stats.size, FLASH_STORE_SIZE / 2);
+
+	TEST_ASSERT_EQ(store_set(STORE_KEY_NONE, &v, sizeof(v)), -1);
+	TEST_ASSERT_EQ(store_set(1, &v, STORE_MAX_VALUE + 1), -1);
+}
+
+static void test_set_get(void)
+{
+	struct calib c = {1.61f, 1.67f, 1000}, r;
+	float v = 0.125f, w = 0.0f;
+
+	setup();
+
+	TEST_ASSERT_EQ(store_set(1, &v, sizeof(v)), 0);
+	TEST_ASSERT_EQ(store_set(2, &c, sizeof(c)), 0);
+	TEST_ASSERT_EQ(store_get(1, &w, sizeof(w)), 0);
+	TEST_ASSERT_NEAR(w, 0.125f, 0.0f);
+
+	/* The size is part of the value */
+	TEST_ASSERT_EQ(store_get(2, &w, sizeof(w)), -1);
+
+	/* Reset: everything is found again, the newest record wins */
+	v = 0.5f;
+	TEST_ASSERT_EQ(store_set(1, &v, sizeof(v)), 0);
+	TEST_ASSERT_EQ(store_init(), 0);
+	TEST_ASSERT_EQ(store_get(1, &w, sizeof(w)), 0);
+	TEST_ASSERT_NEAR(w, 0.5f, 0.0f);
+	memset(&r, 0, sizeof(r));
+	TEST_ASSERT_EQ(store_get(2, &r, sizeof(r)), 0);
+	TEST_ASSERT_NEAR(r.offset_b, 1.67f, 0.0f);
+	TEST_ASSERT_EQ(r.samples, 1000);
+}
+
+static void test_unchanged(void)
+{
+	struct store_stats before, after;
+	float v = 3.0f;
+
+	setup();
+
+	TEST_ASSERT_EQ(store_set(7, &v, sizeof(v)), 0);
+	store_get_stats(&before);
+	TEST_ASSERT_EQ(store_set(7, &v, sizeof(v)), 0);
+	store_get_stats(&after);
+	TEST_ASSERT_EQ(after.used, before.used);
+}
+
+static void test_wear(void)
+{
+	struct store_stats stats;
+	uint32_t min = UINT32_MAX, max = 0;
+	float v;
+
+	setup();
+
+	/* Many more writes than fit in one sector */
+	for (int i = 0; i < 2000; i++) {
+		v = (float)i;
+		TEST_ASSERT_EQ(store_set((uint16_t)(i % 3), &v, sizeof(v)), 0);
+	}
+
+	TEST_ASSERT_EQ(store_init(), 0);
+	for (int k = 0; k < 3; k++) {
+		TEST_ASSERT_EQ(store_get((uint16_t)k, &v, sizeof(v)), 0);
+		TEST_ASSERT_NEAR(v, (float)(1999 - (1999 - k) % 3), 0.0f);
+	}
+	store_get_stats(&stats);
+	TEST_ASSERT_EQ(stats.keys, 3);
+	TEST_ASSERT(stats.generation > 5);
+	TEST_ASSERT_EQ(stats.bad_records, 0);
+
+	/* The sectors take turns */
+	for (uint32_t p = 0; p < FLASH_STORE_PAGES; p++) {
+		uint32_t n = hal_shim_flash_erase_count(p);
+
+		min = n < min ? n : min;
+		max = n > max ? n : max;
+	}
+	TEST_ASSERT(min > 0);
+	TEST_ASSERT(max - min <= 1);
+}
+
+static void test_torn_record(void)
+{
+	struct calib c = {1.0f, 2.0f, 3}, r;
+	struct store_stats stats;
+
+	setup();
+
+	TEST_ASSERT_EQ(store_set(5, &c, sizeof(c)), 0);
+
+	/* Power lost after the first double word of the new record */
+	c.samples = 4;
+	hal_shim_flash_fail_after(1);
+	TEST_ASSERT_EQ(store_set(5, &c, sizeof(c)), -1);
+	hal_shim_flash_fail_after(-1);
+
+	TEST_ASSERT_EQ(store_init(), 0);
+	TEST_ASSERT_EQ(store_get(5, &r, sizeof(r)), 0);
+	TEST_ASSERT_EQ(r.samples, 3);
+	store_get_stats(&stats);
+	TEST_ASSERT_EQ(stats.bad_records, 1);
+
+	/* Writing goes on after the torn record */
+	TEST_ASSERT_EQ(store_set(5, &c, sizeof(c)), 0);
+	TEST_ASSERT_EQ(store_init(), 0);
+	TEST_ASSERT_EQ(store_get(5, &r, sizeof(r)), 0);
+	TEST_ASSERT_EQ(r.samples, 4);
+}
+
+static void test_torn_copy(void)
+{
+	struct store_stats stats;
+	uint32_t gen;
+	float v;
+	int i;
+
+	setup();
+
+	v = 42.0f;
+	TEST_ASSERT_EQ(store_set(100, &v, sizeof(v)), 0);
+
+	/* Fill the sector up to the point where the next write copies */
+	store_get_stats(&stats);
+	gen = stats.generation;
+	for (i = 0; stats.used + 16U <= stats.size; i++) {
+		v = (float)i;
+		TEST_ASSERT_EQ(store_set(1, &v, sizeof(v)), 0);
+		store_get_stats(&stats);
+	}
+	TEST_ASSERT_EQ(stats.generation, gen);
+
+	/* Power lost in the middle of the copy: erases done, records half written */
+	hal_shim_flash_fail_after(FLASH_STORE_PAGES / 2 + 1);
+	v = -1.0f;
+	TEST_ASSERT_EQ(store_set(1, &v, sizeof(v)), -1);
+	hal_shim_flash_fail_after(-1);
+
+	TEST_ASSERT_EQ(store_init(), 0);
+	store_get_stats(&stats);
+	TEST_ASSERT_EQ(stats.generation, gen);
+	TEST_ASSERT_EQ(store_get(100, &v, sizeof(v)), 0);
+	TEST_ASSERT_NEAR(v, 42.0f, 0.0f);
+	TEST_ASSERT_EQ(store_get(1, &v, sizeof(v)), 0);
+	TEST_ASSERT_NEAR(v, (float)(i - 1), 0.0f);
+
+	/* The copy is redone on the next write */
+	v = -1.0f;
+	TEST_ASSERT_EQ(store_set(1, &v, sizeof(v)), 0);
+	store_get_stats(&stats);
+	TEST_ASSERT_EQ(stats.generation, gen + 1);
+	TEST_ASSERT_EQ(store_get(100, &v, sizeof(v)), 0);
+	TEST_ASSERT_NEAR(v, 42.0f, 0.0f);
+}
+
+static void test_version(void)
+{
+	/* A sector header of another layout version */
+	const uint8_t header[16] = {
+		0x46, 0x4F, 0x43, 0x53, STORE_VERSION + 1, 0, 0, 0, 1, 0, 0, 0,
+	};
+	float v = 1.0f;
+
+	hal_shim_flash_open(NULL);
+	TEST_ASSERT_EQ(flash_program(0, header, sizeof(header)), 0);
+
+	TEST_ASSERT_EQ(store_init(), 0);
+	TEST_ASSERT_EQ(store_get(1, &v, sizeof(v)), -1);
+	TEST_ASSERT_EQ(store_set(1, &v, sizeof(v)), 0);
+	TEST_ASSERT_EQ(store_init(), 0);
+	TEST_ASSERT_EQ(store_get(1, &v, sizeof(v)), 0);
+}
+
+static void test_clear(void)
+{
+	float v = 1.0f;
+
+	setup();
+
+	TEST_ASSERT_EQ(store_set(1, &v, sizeof(v)), 0);
+	TEST_ASSERT_EQ(store_clear(), 0);
+	TEST_ASSERT_EQ(store_get(1, &v, sizeof(v)), -1);
+	TEST_ASSERT_EQ(store_init(), 0);
+	TEST_ASSERT_EQ(store_get(1, &v, sizeof(v)), -1);
+}
+
+static void test_file(void)
+{
+	char path[] = "/tmp/foc2_flash_XXXXXX";
+	int fd = mkstemp(path);
+	float v = 2.5f;
+
+	TEST_ASSERT(fd >= 0);
+	close(fd);
+
+	TEST_ASSERT_EQ(hal_shim_flash_open(path), 0);
+	TEST_ASSERT_EQ(store_init(), 0);
+	TEST_ASSERT_EQ(store_set(9, &v, sizeof(v)), 0);
+
+	/* Next "power up" reads the image back */
+	v = 0.0f;
+	TEST_ASSERT_EQ(hal_shim_flash_open(path), 0);
+	TEST_ASSERT_EQ(store_init(), 0);
+	TEST_ASSERT_EQ(store_get(9, &v, sizeof(v)), 0);
+	TEST_ASSERT_NEAR(v, 2.5f, 0.0f);
+
+	hal_shim_flash_open(NULL);
+	unlink(path);
+}
+
+int main(void)
+{
+	RUN_TEST(test_empty);
+	RUN_TEST(test_set_get);
+	RUN_TEST(test_unchanged);
+	RUN_TEST(test_wear);
+	RUN_TEST(test_torn_record);
+	RUN_TEST(test_torn_copy);
+	RUN_TEST(test_version);
+	RUN_TEST(test_clear);
+	RUN_TEST(test_file);
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,292 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Telemetry stream: packet framing, double buffering against a slow
+ * transport, drops when both buffers are taken, decimation, a shared
+ * transport, and the host reader round trip with resync and gap counts.
+ */
+
+#include "test.h"
+#include "telemetry.h"
+#include "telemetry_reader.h"
+#include <string.h>
+
+/* Samples per packet and packet length with two channels */
+#define SPP      ((TELEMETRY_PACKET_SIZE - TELEMETRY_HEADER_SIZE) / (2 * 4))
+#define PKT_LEN  (TELEMETRY_HEADER_SIZE + SPP * 2 * 4)
+
+static float counter;
+static uint16_t raw16;
+
+static const struct scope_signal sig_counter = {"counter", SCOPE_F32, &counter};
+static const struct scope_signal sig_raw16 = {"raw16", SCOPE_U16, &raw16};
+static const struct scope_signal *const chans[] = {&sig_counter, &sig_raw16};
+
+/* Fake transport: records what was sent, completes on demand */
+static uint8_t *in_flight;
+static int sends;
+static int send_result;
+static uint8_t wire[16 * TELEMETRY_PACKET_SIZE];
+static size_t wire_len;
+
+static int fake_send(uint8_t *buf, uint16_t len)
+{
+	if (send_result != 0) {
+		return send_result;
+	}
+	in_flight = buf;
+	sends++;
+	if (wire_len + len <= sizeof(wire)) {
+		memcpy(wire + wire_len, buf, len);
+		wire_len += len;
+	}
+
+	return 0;
+}
+
+static void complete(void)
+{
+	uint8_t *buf = in_flight;
+
+	in_flight = NULL;
+	telemetry_tx_complete(buf);
+}
+
+static void tick(uint32_t n)
+{
+	for (uint32_t i = 0; i < n; i++) {
+		counter += 1.0f;
+		raw16 = (uint16_t)counter * 2U;
+		telemetry_sample();
+	}
+}
+
+static void start(uint16_t decimation)
+{
+	telemetry_stop();
+	if (in_flight) {
+		complete();
+	}
+	in_flight = NULL;
+	sends = 0;
+	send_result = 0;
+	wire_len = 0;
+	counter = 0.0f;
+
+	TEST_ASSERT_EQ(telemetry_configure(chans, 2, decimation), 0);
+	TEST_ASSERT_EQ(telemetry_start(), 0);
+	TEST_ASSERT(telemetry_running());
+}
+
+static void test_framing(void)
+{
+	struct telemetry_stats stats;
+	float v;
+
+	start(1);
+	tick(SPP - 1);
+	TEST_ASSERT_EQ(sends, 0);
+	tick(1);
+	TEST_ASSERT_EQ(sends, 1);
+	TEST_ASSERT_EQ(wire_len, PKT_LEN);
+
+	/* Header */
+	TEST_ASSERT_EQ(wire[0] | (wire[1] << 8), TELEMETRY_MAGIC);
+	TEST_ASSERT_EQ(wire[2], TELEMETRY_VERSION);
+	TEST_ASSERT_EQ(wire[3], 2);
+	TEST_ASSERT_EQ(wire[4] | (wire[5] << 8), 0);
+	TEST_ASSERT_EQ(wire[6] | (wire[7] << 8), SPP);
+	TEST_ASSERT_EQ(wire[8] | (wire[9] << 8) | (wire[10] << 16), 0);
+
+	/* Second row: counter 2, raw16 4 */
+	memcpy(&v, &wire[TELEMETRY_HEADER_SIZE + 8], 4);
+	TEST_ASSERT_EQ(v, 2);
+	memcpy(&v, &wire[TELEMETRY_HEADER_SIZE + 12], 4);
+	TEST_ASSERT_EQ(v, 4);
+
+	telemetry_get_stats(&stats);
+	TEST_ASSERT_EQ(stats.packets, 1);
+	TEST_ASSERT_EQ(stats.samples, SPP);
+	TEST_ASSERT_EQ(stats.dropped, 0);
+
+	/* Cannot reconfigure while streaming */
+	TEST_ASSERT_EQ(telemetry_configure(chans, 1, 1), -1);
+	telemetry_stop();
+	TEST_ASSERT(!telemetry_running());
+}
+
+static void test_double_buffering(void)
+{
+	struct telemetry_stats stats;
+	uint8_t *first;
+
+	start(1);
+	tick(SPP);
+	first = in_flight;
+	TEST_ASSERT(first != NULL);
+
+	/* Transport still busy: the second packet waits */
+	tick(SPP);
+	TEST_ASSERT_EQ(sends, 1);
+
+	/* Both buffers taken: samples are dropped */
+	tick(10);
+	telemetry_get_stats(&stats);
+	TEST_ASSERT_EQ(stats.dropped, 10);
+
+	/* Completion starts the waiting packet from the other buffer */
+	complete();
+	TEST_ASSERT_EQ(sends, 2);
+	TEST_ASSERT(in_flight != NULL && in_flight != first);
+	TEST_ASSERT_EQ(wire[PKT_LEN + 4], 1);
+
+	/* The freed buffer fills again; its index shows the gap */
+	tick(SPP);
+	complete();
+	TEST_ASSERT_EQ(sends, 3);
+	TEST_ASSERT_EQ(in_flight, first);
+
+	telemetry_get_stats(&stats);
+	TEST_ASSERT_EQ(stats.packets, 3);
+	TEST_ASSERT_EQ(stats.samples, 3 * SPP);
+	TEST_ASSERT_EQ(stats.dropped, 10);
+	telemetry_stop();
+}
+
+static void test_shared_transport(void)
+{
+	static uint8_t other[64];
+
+	start(1);
+	tick(SPP);
+	tick(SPP);
+	TEST_ASSERT_EQ(sends, 1);
+
+	/* A completion for somebody else's buffer changes nothing */
+	telemetry_tx_complete(other);
+	telemetry_tx_complete(NULL);
+	TEST_ASSERT_EQ(sends, 1);
+
+	complete();
+	TEST_ASSERT_EQ(sends, 2);
+	telemetry_stop();
+}
+
+static void test_send_error(void)
+{
+	struct telemetry_stats stats;
+
+	start(1);
+	send_result = -1;
+	tick(SPP);
+	telemetry_get_stats(&stats);
+	TEST_ASSERT_EQ(stats.errors, 1);
+	TEST_ASSERT_EQ(stats.dropped, SPP);
+
+	/* The buffer is free again */
+	send_result = 0;
+	tick(SPP);
+	TEST_ASSERT_EQ(sends, 1);
+	telemetry_stop();
+}
+
+static void test_decimation(void)
+{
+	float v;
+
+	start(4);
+	tick(4 * SPP);
+	TEST_ASSERT_EQ(sends, 1);
+
+	/* Every 4th tick, starting with the 4th */
+	memcpy(&v, &wire[TELEMETRY_HEADER_SIZE], 4);
+	TEST_ASSERT_EQ(v, 4);
+	memcpy(&v, &wire[TELEMETRY_HEADER_SIZE + 8], 4);
+	TEST_ASSERT_EQ(v, 8);
+	telemetry_stop();
+}
+
+static void test_reader(void)
+{
+	static struct telemetry_reader r;
+	static const uint8_t garbage[] = {0x54, 0x4D, 0x07, 0x00, 0x12, 0x54};
+	static uint8_t stream[sizeof(garbage) + sizeof(wire)];
+	struct telemetry_packet pkt;
+	size_t len, off, n;
+	uint32_t packets = 0, samples = 0;
+	bool values_ok = true;
+
+	/* Packets 0 and 1, 10 samples dropped, 2, 3 lost on the way, 4 */
+	start(1);
+	tick(SPP);
+	tick(SPP);
+	tick(10);
+	complete();
+	tick(SPP);
+	complete();
+	complete();
+	tick(SPP);
+	wire_len -= PKT_LEN;
+	complete();
+	tick(SPP);
+	complete();
+	telemetry_stop();
+
+	/* Garbage in front, then fed in odd-sized chunks */
+	memcpy(stream, garbage, sizeof(garbage));
+	memcpy(stream + sizeof(garbage), wire, wire_len);
+	len = sizeof(garbage) + wire_len;
+
+	telemetry_reader_init(&r);
+	for (off = 0; off < len; off += n) {
+		n = len - off < 37 ? len - off : 37;
+		n = telemetry_reader_feed(&r, stream + off, n);
+		while (telemetry_reader_next(&r, &pkt)) {
+			TEST_ASSERT_EQ(pkt.num_channels, 2);
+			TEST_ASSERT_EQ(pkt.num_samples, SPP);
+			for (uint16_t s = 0; s < pkt.num_samples; s++) {
+				float c = telemetry_packet_value(&pkt, s, 0);
+
+				values_ok &= c == pkt.first_sample + s + 1;
+				values_ok &= telemetry_packet_value(&pkt, s, 1) == 2 * c;
+			}
+			packets++;
+			samples += pkt.num_samples;
+		}
+	}
+
+	TEST_ASSERT(values_ok);
+	TEST_ASSERT_EQ(packets, 4);
+	TEST_ASSERT_EQ(samples, 4 * SPP);
+	TEST_ASSERT_EQ(r.skipped_bytes, sizeof(garbage));
+	TEST_ASSERT_EQ(r.lost_packets, 1);
+	TEST_ASSERT_EQ(r.lost_samples, 10 + SPP);
+}
+
+static void test_invalid(void)
+{
+	const struct scope_signal *none[] = {NULL};
+
+	TEST_ASSERT_EQ(telemetry_configure(chans, 0, 1), -1);
+	TEST_ASSERT_EQ(telemetry_configure(chans, TELEMETRY_MAX_CHANNELS + 1, 1), -1);
+	TEST_ASSERT_EQ(telemetry_configure(none, 1, 1), -1);
+	TEST_ASSERT_EQ(telemetry_configure(NULL, 1, 1), -1);
+}
+
+int main(void)
+{
+	TEST_ASSERT_EQ(telemetry_start(), -1);
+	telemetry_init(fake_send);
+
+	RUN_TEST(test_framing);
+	RUN_TEST(test_double_buffering);
+	RUN_TEST(test_shared_transport);
+	RUN_TEST(test_send_error);
+	RUN_TEST(test_decimation);
+	RUN_TEST(test_reader);
+	RUN_TEST(test_invalid);
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Checks the trig table against libm and the modulators against a libm
+ * reference, one timer count being the accuracy budget.
+ */
+
+#include "test.h"
+#include "hal_shim.h"
+#include "trig.h"
+#include "drv/pwm.h"
+#include <stdlib.h>
+
+#define PI_D 3.14159265358979323846
+
+static struct pwm_device *pwm0;
+
+static void setup(void)
+{
+	hal_shim_reset();
+
+	/* TIM2 base is normally set up by adc_dma_init() */
+	htim2.Init.Period = 8499;
+	HAL_TIM_Base_Init(&htim2);
+
+	pwm0 = pwm_get_device("pwm_motor0");
+	pwm_init(pwm0);
+	pwm_start(pwm0);
+}
+
+static void test_error_bound(void)
+{
+	double err_max = 0.0, norm_max = 0.0;
+	float s, c;
+
+	for (uint32_t a = 0; a < TRIG_ANGLE_TURN; a++) {
+		double th = (double)a * 2.0 * PI_D / (double)TRIG_ANGLE_TURN;
+
+		trig_sincos((uint16_t)a, &s, &c);
+		err_max = fmax(err_max, fabs(s - sin(th)));
+		err_max = fmax(err_max, fabs(c - cos(th)));
+		norm_max = fmax(norm_max, fabs((double)s * s + (double)c * c - 1.0));
+	}
+
+	printf("  max abs error %.3g, max |s^2+c^2-1| %.3g\n", err_max, norm_max);
+	TEST_ASSERT(err_max < 5e-6);
+	TEST_ASSERT(norm_max < 1e-5);
+
+	/* Worst case at full scale on an 8500-count period stays far below 1 LSB */
+	TEST_ASSERT(err_max * 8500.0 < 0.1);
+}
+
+static void test_exact_points(void)
+{
+	TEST_ASSERT_NEAR(trig_sin(0x0000), 0.0f, 0.0f);
+	TEST_ASSERT_NEAR(trig_cos(0x0000), 1.0f, 0.0f);
+	TEST_ASSERT_NEAR(trig_sin(0x4000), 1.0f, 0.0f);
+	TEST_ASSERT_NEAR(trig_cos(0x4000), 0.0f, 0.0f);
+	TEST_ASSERT_NEAR(trig_sin(0x8000), 0.0f, 0.0f);
+	TEST_ASSERT_NEAR(trig_cos(0x8000), -1.0f, 0.0f);
+	TEST_ASSERT_NEAR(trig_sin(0xC000), -1.0f, 0.0f);
+	TEST_ASSERT_NEAR(trig_cos(0xC000), 0.0f, 0.0f);
+}
+
+static void test_deg_to_angle(void)
+{
+	TEST_ASSERT_EQ(trig_deg_to_angle(0.0f), 0x0000);
+	TEST_ASSERT_EQ(trig_deg_to_angle(90.0f), 0x4000);
+	TEST_ASSERT_EQ(trig_deg_to_angle(180.0f), 0x8000);
+	TEST_ASSERT_EQ(trig_deg_to_angle(360.0f), 0x0000);
+	TEST_ASSERT_EQ(trig_deg_to_angle(-90.0f), 0xC000);
+	TEST_ASSERT_EQ(trig_deg_to_angle(450.0f), 0x4000);
+}
+
+/* Sinusoidal modulator as it was computed with sinf() */
+static void sine_reference(double angle_deg, double amplitude, uint32_t period,
+                           uint32_t compare[3])
+{
+	double th = angle_deg * PI_D / 180.0;
+	double s[3] = {
+		sin(th),
+		sin(th - 2.0 * PI_D / 3.0),
+		sin(th + 2.0 * PI_D / 3.0),
+	};
+
+	for (int i = 0; i < 3; i++) {
+		compare[i] = (uint32_t)((50.0 + s[i] * amplitude / 2.0) / 100.0 * period);
+	}
+}
+
+static void test_sine_modulator_within_one_count(void)
+{
+	const float amplitudes[] = { 10.0f, 50.0f, 100.0f };
+	uint32_t ref[3];
+	int worst = 0;
+
+	setup();
+
+	for (int k = 0; k < 3; k++) {
+		for (int i = 0; i < 3600; i++) {
+			float angle = (float)i * 0.1f;
+
+			pwm_set_vector(pwm0, angle, amplitudes[k]);
+			sine_reference(angle, amplitudes[k], 8499, ref);
+
+			int da = abs((int)__HAL_TIM_GET_COMPARE(&htim2, TIM_CHANNEL_1) - (int)ref[0]);
+			int db = abs((int)__HAL_TIM_GET_COMPARE(&htim2, TIM_CHANNEL_2) - (int)ref[1]);
+			int dc = abs((int)__HAL_TIM_GET_COMPARE(&htim2, TIM_CHANNEL_3) - (int)ref[2]);
+
+			if (da > worst) worst = da;
+			if (db > worst) worst = db;
+			if (dc > worst) worst = dc;
+		}
+	}
+
+	TEST_ASSERT(worst <= 1);
+}
+
+int main(void)
+{
+	RUN_TEST(test_error_bound);
+	RUN_TEST(test_exact_points);
+	RUN_TEST(test_deg_to_angle);
+	RUN_TEST(test_sine_modulator_within_one_count);
+
+	return TEST_RESULT();
+}
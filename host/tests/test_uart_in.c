@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Circular DMA UART input: chunks published on half/full transfer and idle
+ * line, receive buffer overflow accounting and recovery from line errors.
+ */
+
+#include "test.h"
+#include "hal_shim.h"
+#include "drv/uart_in.h"
+#include <string.h>
+
+static uint8_t pattern[1024];
+static uint32_t callback_count;
+
+/* On target main.c dispatches the shared USART2 error callback */
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
+{
+	uart_in_error_handler(huart);
+}
+
+static void count_callback(uint8_t ch)
+{
+	(void)ch;
+	callback_count++;
+}
+
+static void setup(void)
+{
+	hal_shim_reset();
+	uart_in_set_callback(NULL);
+	uart_in_init(&huart2);
+
+	for (uint32_t i = 0; i < sizeof(pattern); i++) {
+		pattern[i] = (uint8_t)(i * 13 + i / 256);
+	}
+}
+
+static void test_idle_chunk(void)
+{
+	struct uart_in_stats stats;
+	uint8_t buf[16];
+
+	setup();
+	TEST_ASSERT_EQ(huart2.RxState, HAL_UART_STATE_BUSY_RX);
+
+	/* A short command is published as soon as the line goes idle */
+	TEST_ASSERT_EQ(hal_shim_uart_rx_push(&huart2, (const uint8_t *)"help\r", 5), 5);
+	TEST_ASSERT_EQ(uart_in_available(), 5);
+	TEST_ASSERT_EQ(uart_in_read(buf, sizeof(buf)), 5);
+	TEST_ASSERT(memcmp(buf, "help\r", 5) == 0);
+	TEST_ASSERT_EQ(uart_in_available(), 0);
+
+	uart_in_get_stats(&stats);
+	TEST_ASSERT_EQ(stats.received, 5);
+	TEST_ASSERT_EQ(stats.dropped, 0);
+}
+
+static void test_stream_across_dma_wrap(void)
+{
+	uint8_t buf[sizeof(pattern)];
+	uint32_t got = 0;
+
+	setup();
+	uart_in_set_callback(count_callback);
+	callback_count = 0;
+
+	/* Odd-sized bursts so the idle, half and full events all interleave */
+	for (uint32_t sent = 0; sent < sizeof(pattern); ) {
+		uint32_t n = sizeof(pattern) - sent < 37 ? sizeof(pattern) - sent : 37;
+
+		hal_shim_uart_rx_push(&huart2, &pattern[sent], n);
+		sent += n;
+		got += uart_in_read(&buf[got], sizeof(buf) - got);
+	}
+
+	TEST_ASSERT_EQ(got, sizeof(pattern));
+	TEST_ASSERT(memcmp(buf, pattern, sizeof(pattern)) == 0);
+	TEST_ASSERT_EQ(callback_count, sizeof(pattern));
+}
+
+static void test_overflow_is_counted(void)
+{
+	struct uart_in_stats stats;
+	uint8_t buf[UART_IN_BUFFER_SIZE];
+	uint32_t got;
+
+	setup();
+
+	/* Nobody reads: the receive buffer keeps the oldest bytes */
+	hal_shim_uart_rx_push(&huart2, pattern, sizeof(pattern));
+
+	got = uart_in_read(buf, sizeof(buf));
+	TEST_ASSERT_EQ(got, UART_IN_BUFFER_SIZE - 1);
+	TEST_ASSERT(memcmp(buf, pattern, got) == 0);
+
+	uart_in_get_stats(&stats);
+	TEST_ASSERT_EQ(stats.received, sizeof(pattern));
+	TEST_ASSERT_EQ(stats.dropped, sizeof(pattern) - got);
+	TEST_ASSERT_EQ(stats.overruns, 0);
+
+	hal_shim_uart_rx_push(&huart2, pattern, 10);
+	uart_in_flush();
+	TEST_ASSERT_EQ(uart_in_available(), 0);
+}
+
+static void test_error_restarts_reception(void)
+{
+	struct uart_in_stats stats;
+	uint8_t buf[8];
+
+	setup();
+	hal_shim_uart_rx_push(&huart2, pattern, 100);
+	uart_in_flush();
+
+	hal_shim_uart_rx_error(&huart2, HAL_UART_ERROR_ORE);
+	hal_shim_uart_rx_error(&huart2, HAL_UART_ERROR_FE | HAL_UART_ERROR_NE);
+	TEST_ASSERT_EQ(huart2.RxState, HAL_UART_STATE_BUSY_RX);
+
+	uart_in_get_stats(&stats);
+	TEST_ASSERT_EQ(stats.overruns, 1);
+	TEST_ASSERT_EQ(stats.errors, 1);
+
+	/* Nothing replayed from the old DMA position, new input still arrives */
+	TEST_ASSERT_EQ(uart_in_available(), 0);
+	hal_shim_uart_rx_push(&huart2, (const uint8_t *)"ok", 2);
+	TEST_ASSERT_EQ(uart_in_read(buf, sizeof(buf)), 2);
+	TEST_ASSERT(memcmp(buf, "ok", 2) == 0);
+}
+
+int main(void)
+{
+	RUN_TEST(test_idle_chunk);
+	RUN_TEST(test_stream_across_dma_wrap);
+	RUN_TEST(test_overflow_is_counted);
+	RUN_TEST(test_error_restarts_reception);
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * DMA-driven UART output: chunking around the buffer end, the drop and
+ * block overflow policies and their counters.
+ */
+
+#include "test.h"
+#include "hal_shim.h"
+#include "drv/uart_out.h"
+#include <string.h>
+
+static uint8_t pattern[3 * UART_OUT_BUFFER_SIZE];
+static uint8_t output[4 * UART_OUT_BUFFER_SIZE];
+
+static void drain(void)
+{
+	while (hal_shim_uart_tx_complete(&huart2)) {
+	}
+}
+
+static void drain_hook(void)
+{
+	hal_shim_uart_tx_complete(&huart2);
+}
+
+static void setup(void)
+{
+	/* Finish whatever the previous test left in flight */
+	drain();
+	hal_shim_reset();
+	uart_out_init(&huart2);
+	uart_out_set_policy(UART_OUT_DROP);
+
+	for (uint32_t i = 0; i < sizeof(pattern); i++) {
+		pattern[i] = (uint8_t)(i * 7 + i / 251);
+	}
+}
+
+static void test_output_before_init(void)
+{
+	/* Start-up messages are kept until the driver has its UART */
+	TEST_ASSERT_EQ(uart_out_write((const uint8_t *)"boot\n", 5), 5);
+	TEST_ASSERT_EQ(hal_shim_uart_tx_pending(&huart2), 0);
+
+	hal_shim_reset();
+	TEST_ASSERT_EQ(uart_out_init(&huart2), 0);
+	TEST_ASSERT_EQ(hal_shim_uart_tx_pending(&huart2), 5);
+
+	drain();
+	TEST_ASSERT_EQ(hal_shim_uart_take_output(&huart2, output, sizeof(output)), 5);
+	TEST_ASSERT(memcmp(output, "boot\n", 5) == 0);
+	TEST_ASSERT_EQ(uart_out_init(NULL), -1);
+}
+
+static void test_write_returns_at_once(void)
+{
+	struct uart_out_stats before, after;
+
+	setup();
+	uart_out_get_stats(&before);
+
+	TEST_ASSERT_EQ(uart_out_write((const uint8_t *)"hello", 5), 5);
+	TEST_ASSERT_EQ(hal_shim_uart_tx_pending(&huart2), 5);
+
+	/* Queued behind the transfer in flight */
+	TEST_ASSERT_EQ(uart_out_write((const uint8_t *)" world", 6), 6);
+	TEST_ASSERT_EQ(uart_out_pending(), 11);
+	TEST_ASSERT_EQ(hal_shim_uart_take_output(&huart2, output, sizeof(output)), 0);
+
+	/* The TX complete interrupt starts the next transfer */
+	TEST_ASSERT(hal_shim_uart_tx_complete(&huart2));
+	TEST_ASSERT_EQ(hal_shim_uart_tx_pending(&huart2), 6);
+	TEST_ASSERT(hal_shim_uart_tx_complete(&huart2));
+	TEST_ASSERT(!hal_shim_uart_tx_complete(&huart2));
+
+	TEST_ASSERT_EQ(uart_out_pending(), 0);
+	TEST_ASSERT_EQ(hal_shim_uart_take_output(&huart2, output, sizeof(output)), 11);
+	TEST_ASSERT(memcmp(output, "hello world", 11) == 0);
+
+	uart_out_get_stats(&after);
+	TEST_ASSERT_EQ(after.written - before.written, 11);
+	TEST_ASSERT_EQ(after.transfers - before.transfers, 2);
+	TEST_ASSERT_EQ(after.dropped - before.dropped, 0);
+}
+
+static void test_wrap(void)
+{
+	struct uart_out_stats stats;
+	uint32_t first;
+
+	setup();
+
+	/* Move the buffer position (bytes written so far) to 10 before the end */
+	uart_out_get_stats(&stats);
+	first = (UART_OUT_BUFFER_SIZE - 10 - stats.written) & (UART_OUT_BUFFER_SIZE - 1);
+	uart_out_write(pattern, first);
+	drain();
+	hal_shim_uart_take_output(&huart2, output, sizeof(output));
+
+	/* DMA needs contiguous memory: the run is split at the end */
+	uart_out_write(pattern, 25);
+	TEST_ASSERT_EQ(hal_shim_uart_tx_pending(&huart2), 10);
+	hal_shim_uart_tx_complete(&huart2);
+	TEST_ASSERT_EQ(hal_shim_uart_tx_pending(&huart2), 15);
+	drain();
+
+	TEST_ASSERT_EQ(hal_shim_uart_take_output(&huart2, output, sizeof(output)), 25);
+	TEST_ASSERT(memcmp(output, pattern, 25) == 0);
+}
+
+static void test_drop_policy(void)
+{
+	struct uart_out_stats before, after;
+	uint32_t queued;
+
+	setup();
+	uart_out_get_stats(&before);
+
+	/* Nothing drains while we write: the buffer fills and the rest is lost */
+	queued = uart_out_write(pattern, 2 * UART_OUT_BUFFER_SIZE);
+	TEST_ASSERT_EQ(queued, UART_OUT_BUFFER_SIZE);
+	TEST_ASSERT_EQ(uart_out_write(pattern, 1), 0);
+	TEST_ASSERT_EQ(HAL_GetTick(), 0);
+
+	uart_out_get_stats(&after);
+	TEST_ASSERT_EQ(after.written - before.written, UART_OUT_BUFFER_SIZE);
+	TEST_ASSERT_EQ(after.dropped - before.dropped, UART_OUT_BUFFER_SIZE + 1);
+
+	/* What was accepted goes out intact */
+	drain();
+	TEST_ASSERT_EQ(hal_shim_uart_take_output(&huart2, output, sizeof(output)),
+	               UART_OUT_BUFFER_SIZE);
+	TEST_ASSERT(memcmp(output, pattern, UART_OUT_BUFFER_SIZE) == 0);
+}
+
+static void test_block_policy(void)
+{
+	struct uart_out_stats before, after;
+
+	setup();
+	uart_out_set_policy(UART_OUT_BLOCK);
+	uart_out_get_stats(&before);
+
+	/* The DMA completes a transfer every millisecond the writer waits */
+	hal_shim_set_delay_hook(drain_hook);
+	TEST_ASSERT_EQ(uart_out_write(pattern, sizeof(pattern)), sizeof(pattern));
+	TEST_ASSERT(HAL_GetTick() > 0);
+	hal_shim_set_delay_hook(NULL);
+
+	TEST_ASSERT_EQ(uart_out_flush(0), -1);
+	drain();
+	TEST_ASSERT_EQ(uart_out_flush(0), 0);
+	TEST_ASSERT_EQ(hal_shim_uart_take_output(&huart2, output, sizeof(output)),
+	               sizeof(pattern));
+	TEST_ASSERT(memcmp(output, pattern, sizeof(pattern)) == 0);
+
+	uart_out_get_stats(&after);
+	TEST_ASSERT_EQ(after.dropped - before.dropped, 0);
+
+	/* A stuck transmitter costs at most the timeout, then drops */
+	hal_shim_set_tick(0);
+	TEST_ASSERT_EQ(uart_out_write(pattern, UART_OUT_BUFFER_SIZE + 8), UART_OUT_BUFFER_SIZE);
+	TEST_ASSERT_EQ(HAL_GetTick(), UART_OUT_BLOCK_TIMEOUT_MS);
+
+	uart_out_get_stats(&after);
+	TEST_ASSERT_EQ(after.dropped - before.dropped, 8);
+}
+
+int main(void)
+{
+	RUN_TEST(test_output_before_init);
+	RUN_TEST(test_write_returns_at_once);
+	RUN_TEST(test_wrap);
+	RUN_TEST(test_drop_policy);
+	RUN_TEST(test_block_policy);
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,501 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Send one binary protocol command to the firmware.
+ *
+ *   foc_cmd [-a axis] [-t timeout_ms] device command [args]
+ *
+ *   ping                        protocol version and register count
+ *   regs                        list the registers
+ *   read reg...                 read registers (names or numbers) at once
+ *   state                       state of the axis
+ *   target stop|vel|closed|amp [value]
+ *   gains speed|current kp ki
+ *   params                      list the parameters of the axis
+ *   get param...                read parameters (names or numbers)
+ *   set param value...          write parameters, all at once
+ *   save                        save the axis' parameters to flash
+ *
+ * device is the USB CDC port or the console UART (e.g. /dev/ttyACM0,
+ * /dev/ttyUSB0, put in raw mode). Requests are retried on timeout with
+ * the same sequence number, so a set command never runs twice.
+ */
+
+#include "param.h"
+#include "proto_client.h"
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#define RETRIES 3
+
+static const char *const status_names[] = {
+	[PROTO_OK] = "ok",
+	[PROTO_ERR_CMD] = "unknown command",
+	[PROTO_ERR_LEN] = "bad length",
+	[PROTO_ERR_ARG] = "bad argument",
+	[PROTO_ERR_STATE] = "not possible now",
+};
+
+static int fd = -1;
+static int timeout_ms = 200;
+static struct proto_client client;
+
+static void usage(const char *prog)
+{
+	fprintf(stderr, "usage: %s [-a axis] [-t timeout_ms] device "
+	        "ping|regs|read|state|target|gains|params|get|set|save [args]\n", prog);
+	exit(2);
+}
+
+static int64_t now_ms(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/**
+ * @brief Send a request and wait for its response, retrying on timeout
+ *
+ * @return -1 if there was no response, else the response status
+ */
+static int exchange(const uint8_t *req, uint32_t len, struct proto_response *resp)
+{
+	uint8_t buf[512];
+
+	for (int attempt = 0; attempt < RETRIES; attempt++) {
+		int64_t deadline = now_ms() + timeout_ms;
+
+		if (write(fd, req, len) != (ssize_t)len) {
+			perror("write");
+			return -1;
+		}
+
+		while (now_ms() < deadline) {
+			struct pollfd pfd = {.fd = fd, .events = POLLIN};
+			ssize_t n;
+
+			if (poll(&pfd, 1, (int)(deadline - now_ms())) <= 0) {
+				continue;
+			}
+			n = read(fd, buf, sizeof(buf));
+			if (n <= 0) {
+				perror("read");
+				return -1;
+			}
+			if (proto_client_feed(&client, buf, (size_t)n, NULL, resp)) {
+				return resp->status;
+			}
+		}
+	}
+
+	return -1;
+}
+
+/**
+ * @brief exchange(), reporting failures
+ *
+ * @return 0 on PROTO_OK, else -1
+ */
+static int transact(const uint8_t *req, uint32_t len, struct proto_response *resp)
+{
+	int ret = exchange(req, len, resp);
+
+	if (ret < 0) {
+		fprintf(stderr, "no response\n");
+	} else if (ret != PROTO_OK) {
+		fprintf(stderr, "error: %s\n", ret < 5 ? status_names[ret] : "?");
+	}
+	return ret == PROTO_OK ? 0 : -1;
+}
+
+static int reg_count(void)
+{
+	uint8_t req[PROTO_CLIENT_REQUEST_SIZE];
+	struct proto_response resp;
+
+	if (transact(req, proto_client_ping(&client, req), &resp) != 0 || resp.len < 2) {
+		return -1;
+	}
+	return resp.payload[1];
+}
+
+static int reg_name(uint8_t reg, char *name, size_t size)
+{
+	uint8_t req[PROTO_CLIENT_REQUEST_SIZE];
+	struct proto_response resp;
+	size_t n;
+
+	if (transact(req, proto_client_reg_info(&client, reg, req), &resp) != 0 || resp.len < 1) {
+		return -1;
+	}
+	n = resp.len - 1U < size - 1 ? resp.len - 1U : size - 1;
+	memcpy(name, &resp.payload[1], n);
+	name[n] = '\0';
+	return 0;
+}
+
+static int cmd_read(int argc, char **argv)
+{
+	uint8_t req[PROTO_CLIENT_REQUEST_SIZE];
+	uint8_t regs[PROTO_MAX_PAYLOAD / 4];
+	char names[PROTO_MAX_PAYLOAD / 4][32];
+	struct proto_response resp;
+	int count = 0;
+
+	if (argc < 1 || argc > (int)sizeof(regs)) {
+		fprintf(stderr, "read: 1 to %u registers\n", (unsigned)sizeof(regs));
+		return -1;
+	}
+
+	for (int i = 0; i < argc; i++) {
+		char *end;
+		long r = strtol(argv[i], &end, 0);
+
+		if (*end == '\0') {
+			regs[i] = (uint8_t)r;
+			snprintf(names[i], sizeof(names[i]), "%ld", r);
+			continue;
+		}
+
+		/* Look the name up */
+		if (count == 0 && (count = reg_count()) <= 0) {
+			return -1;
+		}
+		for (r = 0; r < count; r++) {
+			if (reg_name((uint8_t)r, names[i], sizeof(names[i])) != 0) {
+				return -1;
+			}
+			if (strcmp(names[i], argv[i]) == 0) {
+				break;
+			}
+		}
+		if (r == count) {
+			fprintf(stderr, "no register %s\n", argv[i]);
+			return -1;
+		}
+		regs[i] = (uint8_t)r;
+	}
+
+	if (transact(req, proto_client_read_regs(&client, regs, (uint8_t)argc, req), &resp) != 0) {
+		return -1;
+	}
+	for (int i = 0; i < argc; i++) {
+		printf("%s %g\n", names[i], proto_client_reg_value(&resp, (uint8_t)i));
+	}
+	return 0;
+}
+
+static int cmd_regs(void)
+{
+	char name[32];
+	int count = reg_count();
+
+	for (int r = 0; r < count; r++) {
+		if (reg_name((uint8_t)r, name, sizeof(name)) != 0) {
+			return -1;
+		}
+		printf("%3d %s\n", r, name);
+	}
+	return count < 0 ? -1 : 0;
+}
+
+static int cmd_state(uint8_t axis)
+{
+	uint8_t req[PROTO_CLIENT_REQUEST_SIZE];
+	struct proto_response resp;
+	struct proto_state s;
+
+	if (transact(req, proto_client_read_state(&client, axis, req), &resp) != 0 ||
+	    resp.len != PROTO_STATE_SIZE) {
+		return -1;
+	}
+	proto_unpack_state(resp.payload, &s);
+
+	printf("mode %u%s%s%s\n", s.mode,
+	       s.flags & PROTO_STATE_OVERCURRENT ? " overcurrent" : "",
+	       s.flags & PROTO_STATE_TORQUE ? " torque" : "",
+	       s.flags & PROTO_STATE_ENCODER ? " encoder" : "");
+	printf("target %g rpm, ramp %g rpm, measured %g rpm\n",
+	       s.target_rpm, s.ramp_rpm, s.measured_rpm);
+	printf("amplitude %g %%, angle %g deg\n", s.amplitude, s.electrical_angle);
+	printf("ia %g A, ib %g A, id %g A, iq %g A\n", s.ia, s.ib, s.id, s.iq);
+	return 0;
+}
+
+static int cmd_target(uint8_t axis, int argc, char **argv)
+{
+	static const char *const modes[] = {
+		[PROTO_TARGET_STOP] = "stop",
+		[PROTO_TARGET_VELOCITY] = "vel",
+		[PROTO_TARGET_VELOCITY_CLOSED] = "closed",
+		[PROTO_TARGET_AMPLITUDE] = "amp",
+	};
+	uint8_t req[PROTO_CLIENT_REQUEST_SIZE];
+	struct proto_response resp;
+
+	for (unsigned m = 0; argc >= 1 && m < sizeof(modes) / sizeof(modes[0]); m++) {
+		if (strcmp(argv[0], modes[m]) != 0) {
+			continue;
+		}
+		if (m != PROTO_TARGET_STOP && argc < 2) {
+			break;
+		}
+		return transact(req, proto_client_set_target(&client, axis, m,
+		                argc >= 2 ? strtof(argv[1], NULL) : 0.0f, req), &resp);
+	}
+
+	fprintf(stderr, "target stop|vel|closed|amp [value]\n");
+	return -1;
+}
+
+static int cmd_gains(uint8_t axis, int argc, char **argv)
+{
+	uint8_t req[PROTO_CLIENT_REQUEST_SIZE];
+	struct proto_response resp;
+	enum proto_loop loop;
+
+	if (argc != 3) {
+		fprintf(stderr, "gains speed|current kp ki\n");
+		return -1;
+	}
+	loop = strcmp(argv[0], "current") == 0 ? PROTO_LOOP_CURRENT : PROTO_LOOP_SPEED;
+
+	return transact(req, proto_client_set_gains(&client, axis, loop, strtof(argv[1], NULL),
+	                strtof(argv[2], NULL), req), &resp);
+}
+
+/* Parameter table, read from the firmware with PARAM_INFO */
+static struct {
+	char name[32];
+	uint8_t flags;
+	float min;
+	float max;
+} params[256];
+static int num_params = -1;
+
+static int load_params(void)
+{
+	uint8_t req[PROTO_CLIENT_REQUEST_SIZE];
+	struct proto_response resp;
+
+	if (num_params >= 0) {
+		return num_params;
+	}
+
+	/* IDs are dense: the first one out of range ends the table */
+	for (num_params = 0; num_params < 256; num_params++) {
+		int ret = exchange(req, proto_client_param_info(&client, (uint8_t)num_params, req),
+		                   &resp);
+		size_t n;
+
+		if (ret == PROTO_ERR_ARG) {
+			break;
+		}
+		if (ret != PROTO_OK || resp.len < 10) {
+			fprintf(stderr, "cannot read the parameter table\n");
+			return -1;
+		}
+		n = resp.len - 10U < sizeof(params[0].name) - 1 ? resp.len - 10U :
+		    sizeof(params[0].name) - 1;
+		params[num_params].flags = resp.payload[1];
+		params[num_params].min = proto_get_f32(&resp.payload[2]);
+		params[num_params].max = proto_get_f32(&resp.payload[6]);
+		memcpy(params[num_params].name, &resp.payload[10], n);
+		params[num_params].name[n] = '\0';
+	}
+
+	return num_params;
+}
+
+static int param_lookup(const char *name)
+{
+	char *end;
+	long id = strtol(name, &end, 0);
+
+	if (load_params() < 0) {
+		return -1;
+	}
+	if (*end == '\0' && id >= 0 && id < num_params) {
+		return (int)id;
+	}
+	for (int i = 0; i < num_params; i++) {
+		if (strcmp(params[i].name, name) == 0) {
+			return i;
+		}
+	}
+
+	fprintf(stderr, "no parameter %s\n", name);
+	return -1;
+}
+
+static int cmd_get(uint8_t axis, int argc, char **argv)
+{
+	uint8_t req[PROTO_CLIENT_REQUEST_SIZE];
+	uint8_t ids[PROTO_MAX_PAYLOAD / 4];
+	struct proto_response resp;
+
+	if (argc < 1 || argc > (int)sizeof(ids)) {
+		fprintf(stderr, "get: 1 to %u parameters\n", (unsigned)sizeof(ids));
+		return -1;
+	}
+	for (int i = 0; i < argc; i++) {
+		int id = param_lookup(argv[i]);
+
+		if (id < 0) {
+			return -1;
+		}
+		ids[i] = (uint8_t)id;
+	}
+
+	if (transact(req, proto_client_get_params(&client, axis, ids, (uint8_t)argc, req),
+	             &resp) != 0) {
+		return -1;
+	}
+	for (int i = 0; i < argc; i++) {
+		printf("%s %g\n", params[ids[i]].name, proto_client_reg_value(&resp, (uint8_t)i));
+	}
+	return 0;
+}
+
+static int cmd_set(uint8_t axis, int argc, char **argv)
+{
+	uint8_t req[PROTO_CLIENT_REQUEST_SIZE];
+	uint8_t ids[(PROTO_MAX_PAYLOAD - 1) / 5];
+	float values[(PROTO_MAX_PAYLOAD - 1) / 5];
+	struct proto_response resp;
+	int count = argc / 2;
+
+	if (argc < 2 || argc % 2 != 0 || count > (int)sizeof(ids)) {
+		fprintf(stderr, "set: 1 to %u name value pairs\n", (unsigned)sizeof(ids));
+		return -1;
+	}
+	for (int i = 0; i < count; i++) {
+		int id = param_lookup(argv[2 * i]);
+
+		if (id < 0) {
+			return -1;
+		}
+		ids[i] = (uint8_t)id;
+		values[i] = strtof(argv[2 * i + 1], NULL);
+	}
+
+	return transact(req, proto_client_set_params(&client, axis, ids, values, (uint8_t)count,
+	                req), &resp);
+}
+
+static int cmd_params(uint8_t axis)
+{
+	uint8_t req[PROTO_CLIENT_REQUEST_SIZE];
+	uint8_t ids[PROTO_MAX_PAYLOAD / 4];
+	struct proto_response resp;
+
+	if (load_params() < 0) {
+		return -1;
+	}
+
+	for (int first = 0; first < num_params; first += (int)sizeof(ids)) {
+		int n = num_params - first < (int)sizeof(ids) ? num_params - first : (int)sizeof(ids);
+
+		for (int i = 0; i < n; i++) {
+			ids[i] = (uint8_t)(first + i);
+		}
+		if (transact(req, proto_client_get_params(&client, axis, ids, (uint8_t)n, req),
+		             &resp) != 0) {
+			return -1;
+		}
+		for (int i = 0; i < n; i++) {
+			int id = first + i;
+
+			printf("%3d %-20s %12g  [%g, %g]%s%s\n", id, params[id].name,
+			       proto_client_reg_value(&resp, (uint8_t)i), params[id].min, params[id].max,
+			       params[id].flags & PARAM_READONLY ? " read-only" : "",
+			       params[id].flags & PARAM_STOPPED ? " when stopped" : "");
+		}
+	}
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	uint8_t req[PROTO_CLIENT_REQUEST_SIZE];
+	struct proto_response resp;
+	struct termios tio;
+	const char *prog = argv[0];
+	const char *cmd;
+	uint8_t axis = 0;
+	int opt, ret;
+
+	while ((opt = getopt(argc, argv, "a:t:h")) != -1) {
+		switch (opt) {
+		case 'a':
+			axis = (uint8_t)atoi(optarg);
+			break;
+		case 't':
+			timeout_ms = atoi(optarg);
+			break;
+		default:
+			usage(prog);
+		}
+	}
+	if (argc - optind < 2) {
+		usage(prog);
+	}
+
+	fd = open(argv[optind], O_RDWR | O_NOCTTY);
+	if (fd < 0) {
+		perror(argv[optind]);
+		return 1;
+	}
+	if (isatty(fd) && tcgetattr(fd, &tio) == 0) {
+		cfmakeraw(&tio);
+		tcsetattr(fd, TCSANOW, &tio);
+	}
+
+	/* Differ from whatever the last run left as the firmware's last seq */
+	proto_client_init(&client, (uint8_t)(now_ms() ^ getpid()));
+
+	cmd = argv[optind + 1];
+	argc -= optind + 2;
+	argv += optind + 2;
+
+	if (strcmp(cmd, "ping") == 0) {
+		ret = transact(req, proto_client_ping(&client, req), &resp);
+		if (ret == 0 && resp.len >= 2) {
+			printf("version %u, %u registers\n", resp.payload[0], resp.payload[1]);
+		}
+	} else if (strcmp(cmd, "regs") == 0) {
+		ret = cmd_regs();
+	} else if (strcmp(cmd, "read") == 0) {
+		ret = cmd_read(argc, argv);
+	} else if (strcmp(cmd, "state") == 0) {
+		ret = cmd_state(axis);
+	} else if (strcmp(cmd, "target") == 0) {
+		ret = cmd_target(axis, argc, argv);
+	} else if (strcmp(cmd, "gains") == 0) {
+		ret = cmd_gains(axis, argc, argv);
+	} else if (strcmp(cmd, "params") == 0) {
+		ret = cmd_params(axis);
+	} else if (strcmp(cmd, "get") == 0) {
+		ret = cmd_get(axis, argc, argv);
+	} else if (strcmp(cmd, "set") == 0) {
+		ret = cmd_set(axis, argc, argv);
+	} else if (strcmp(cmd, "save") == 0) {
+		ret = transact(req, proto_client_save_params(&client, axis, req), &resp);
+	} else {
+		usage(prog);
+		ret = -1;
+	}
+
+	close(fd);
+	return ret == 0 ? 0 : 1;
+}
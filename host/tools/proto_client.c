@@ -0,0 +1,186 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "proto_client.h"
+#include <string.h>
+
+void proto_client_init(struct proto_client *c, uint8_t seq)
+{
+	memset(c, 0, sizeof(*c));
+	c->seq = seq - 1U;
+}
+
+uint32_t proto_client_request(struct proto_client *c, uint8_t cmd, const uint8_t *payload,
+                              uint16_t len, uint8_t *out)
+{
+	uint8_t frame[PROTO_MAX_FRAME];
+
+	if (len > PROTO_MAX_PAYLOAD) {
+		return 0;
+	}
+
+	c->seq++;
+	c->cmd = cmd;
+	c->rx_len = 0;
+	c->rx_overflow = false;
+
+	frame[0] = c->seq;
+	frame[1] = cmd;
+	if (len) {
+		memcpy(&frame[2], payload, len);
+	}
+
+	return proto_frame_encode(frame, 2U + len, out);
+}
+
+/**
+ * @brief Check a complete frame, true if it answers the request in flight
+ */
+static bool proto_client_frame(struct proto_client *c, struct proto_response *resp)
+{
+	int32_t n;
+
+	if (c->rx_overflow || c->rx_len == 0) {
+		return false;
+	}
+
+	n = proto_cobs_decode(c->rx, c->rx_len, c->frame);
+	if (n < 5 || proto_crc16(c->frame, n - 2) != proto_get_u16(&c->frame[n - 2])) {
+		return false;
+	}
+	if (c->frame[0] != c->seq || c->frame[1] != (c->cmd | PROTO_RESPONSE)) {
+		return false;
+	}
+
+	resp->status = c->frame[2];
+	resp->payload = &c->frame[3];
+	resp->len = (uint16_t)(n - 5);
+	return true;
+}
+
+int proto_client_feed(struct proto_client *c, const uint8_t *data, size_t len, size_t *used,
+                      struct proto_response *resp)
+{
+	for (size_t i = 0; i < len; i++) {
+		bool done;
+
+		if (data[i] != 0) {
+			if (c->rx_len < sizeof(c->rx)) {
+				c->rx[c->rx_len++] = data[i];
+			} else {
+				c->rx_overflow = true;
+			}
+			continue;
+		}
+
+		done = proto_client_frame(c, resp);
+		if (!done && (c->rx_len || c->rx_overflow)) {
+			c->skipped++;
+		}
+		c->rx_len = 0;
+		c->rx_overflow = false;
+
+		if (done) {
+			if (used) {
+				*used = i + 1;
+			}
+			return 1;
+		}
+	}
+
+	if (used) {
+		*used = len;
+	}
+	return 0;
+}
+
+uint32_t proto_client_ping(struct proto_client *c, uint8_t *out)
+{
+	return proto_client_request(c, PROTO_CMD_PING, NULL, 0, out);
+}
+
+uint32_t proto_client_set_target(struct proto_client *c, uint8_t axis,
+                                 enum proto_target_mode mode, float value, uint8_t *out)
+{
+	uint8_t p[6];
+
+	p[0] = axis;
+	p[1] = mode;
+	proto_put_f32(&p[2], value);
+	return proto_client_request(c, PROTO_CMD_SET_TARGET, p, sizeof(p), out);
+}
+
+uint32_t proto_client_set_gains(struct proto_client *c, uint8_t axis, enum proto_loop loop,
+                                float kp, float ki, uint8_t *out)
+{
+	uint8_t p[10];
+
+	p[0] = axis;
+	p[1] = loop;
+	proto_put_f32(&p[2], kp);
+	proto_put_f32(&p[6], ki);
+	return proto_client_request(c, PROTO_CMD_SET_GAINS, p, sizeof(p), out);
+}
+
+uint32_t proto_client_read_state(struct proto_client *c, uint8_t axis, uint8_t *out)
+{
+	return proto_client_request(c, PROTO_CMD_READ_STATE, &axis, 1, out);
+}
+
+uint32_t proto_client_read_regs(struct proto_client *c, const uint8_t *regs, uint8_t count,
+                                uint8_t *out)
+{
+	return proto_client_request(c, PROTO_CMD_READ_REGS, regs, count, out);
+}
+
+uint32_t proto_client_reg_info(struct proto_client *c, uint8_t reg, uint8_t *out)
+{
+	return proto_client_request(c, PROTO_CMD_REG_INFO, &reg, 1, out);
+}
+
+uint32_t proto_client_get_params(struct proto_client *c, uint8_t axis, const uint8_t *ids,
+                                 uint8_t count, uint8_t *out)
+{
+	uint8_t p[PROTO_MAX_PAYLOAD];
+
+	if (count > PROTO_MAX_PAYLOAD / 4U) {
+		return 0;
+	}
+	p[0] = axis;
+	memcpy(&p[1], ids, count);
+	return proto_client_request(c, PROTO_CMD_GET_PARAMS, p, 1U + count, out);
+}
+
+uint32_t proto_client_set_params(struct proto_client *c, uint8_t axis, const uint8_t *ids,
+                                 const float *values, uint8_t count, uint8_t *out)
+{
+	uint8_t p[PROTO_MAX_PAYLOAD];
+
+	if (1U + count * 5U > PROTO_MAX_PAYLOAD) {
+		return 0;
+	}
+	p[0] = axis;
+	for (uint8_t i = 0; i < count; i++) {
+		p[1U + i * 5U] = ids[i];
+		proto_put_f32(&p[2U + i * 5U], values[i]);
+	}
+	return proto_client_request(c, PROTO_CMD_SET_PARAMS, p, 1U + count * 5U, out);
+}
+
+uint32_t proto_client_param_info(struct proto_client *c, uint8_t id, uint8_t *out)
+{
+	return proto_client_request(c, PROTO_CMD_PARAM_INFO, &id, 1, out);
+}
+
+uint32_t proto_client_save_params(struct proto_client *c, uint8_t axis, uint8_t *out)
+{
+	return proto_client_request(c, PROTO_CMD_SAVE_PARAMS, &axis, 1, out);
+}
+
+float proto_client_reg_value(const struct proto_response *resp, uint8_t index)
+{
+	return proto_get_f32(&resp->payload[index * 4U]);
+}
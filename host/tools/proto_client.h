@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef PROTO_CLIENT_H
+#define PROTO_CLIENT_H
+
+/**
+ * @brief Host side of the binary command protocol
+ *
+ * Builds request frames ready to write to the transport and picks the
+ * matching response out of the received bytes; I/O is up to the caller.
+ * One request is in flight at a time. To retry after a timeout, write
+ * the same request bytes again: the firmware recognises the sequence
+ * number and answers without running the command twice. Text, telemetry
+ * packets and stale responses in the byte stream are skipped. Frame
+ * format and payloads: see Inc/proto.h.
+ */
+
+#include "proto.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Room for one encoded request */
+#define PROTO_CLIENT_REQUEST_SIZE (PROTO_MAX_ENCODED + 2U)
+
+struct proto_client {
+	uint8_t seq;                 /* Of the request in flight */
+	uint8_t cmd;
+	uint8_t rx[PROTO_MAX_ENCODED];
+	uint16_t rx_len;
+	bool rx_overflow;
+	uint8_t frame[PROTO_MAX_ENCODED];
+	uint32_t skipped;            /* Frames that were not the expected response */
+};
+
+/**
+ * @brief A response, valid until the next feed or request
+ */
+struct proto_response {
+	uint8_t status;              /* enum proto_status */
+	const uint8_t *payload;
+	uint16_t len;
+};
+
+/**
+ * @brief Reset a client
+ *
+ * @param c Client
+ * @param seq First sequence number (e.g. random, so a restarted client
+ *            does not repeat the previous run's last one)
+ */
+void proto_client_init(struct proto_client *c, uint8_t seq);
+
+/**
+ * @brief Build a request with the next sequence number
+ *
+ * @param c Client
+ * @param cmd Command
+ * @param payload Payload (may be NULL if len is 0)
+ * @param len Payload size, up to PROTO_MAX_PAYLOAD
+ * @param out Buffer for PROTO_CLIENT_REQUEST_SIZE bytes
+ * @return Bytes to send, 0 if the payload is too large
+ */
+uint32_t proto_client_request(struct proto_client *c, uint8_t cmd, const uint8_t *payload,
+                              uint16_t len, uint8_t *out);
+
+/**
+ * @brief Look for the response to the last request
+ *
+ * @param c Client
+ * @param data Received bytes
+ * @param len Number of bytes
+ * @param used Bytes consumed; the rest belongs after the response
+ * @param resp Response
+ * @return 1 if the response is complete, 0 if more bytes are needed
+ */
+int proto_client_feed(struct proto_client *c, const uint8_t *data, size_t len, size_t *used,
+                      struct proto_response *resp);
+
+/* Request builders, same return value and out buffer as proto_client_request() */
+uint32_t proto_client_ping(struct proto_client *c, uint8_t *out);
+uint32_t proto_client_set_target(struct proto_client *c, uint8_t axis,
+                                 enum proto_target_mode mode, float value, uint8_t *out);
+uint32_t proto_client_set_gains(struct proto_client *c, uint8_t axis, enum proto_loop loop,
+                                float kp, float ki, uint8_t *out);
+uint32_t proto_client_read_state(struct proto_client *c, uint8_t axis, uint8_t *out);
+uint32_t proto_client_read_regs(struct proto_client *c, const uint8_t *regs, uint8_t count,
+                                uint8_t *out);
+uint32_t proto_client_reg_info(struct proto_client *c, uint8_t reg, uint8_t *out);
+uint32_t proto_client_get_params(struct proto_client *c, uint8_t axis, const uint8_t *ids,
+                                 uint8_t count, uint8_t *out);
+uint32_t proto_client_set_params(struct proto_client *c, uint8_t axis, const uint8_t *ids,
+                                 const float *values, uint8_t count, uint8_t *out);
+uint32_t proto_client_param_info(struct proto_client *c, uint8_t id, uint8_t *out);
+uint32_t proto_client_save_params(struct proto_client *c, uint8_t axis, uint8_t *out);
+
+/**
+ * @brief Get one value of a READ_REGS or GET_PARAMS response
+ *
+ * @param resp Response
+ * @param index Position in the request's list
+ * @return Value
+ */
+float proto_client_reg_value(const struct proto_response *resp, uint8_t index);
+
+#endif /* PROTO_CLIENT_H */
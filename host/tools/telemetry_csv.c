@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Convert the firmware's binary telemetry stream to CSV.
+ *
+ *   telemetry_csv [-r rate_hz] [-n name,name,...] [input]
+ *
+ * input is a capture file or the USB CDC device (e.g. /dev/ttyACM0, put in
+ * raw mode); standard input if omitted. One row per sample goes to
+ * standard output: the sample index (or the time in seconds with -r),
+ * then the channels, named by -n or ch0, ch1, ... Losses are reported on
+ * standard error at the end.
+ */
+
+#include "telemetry_reader.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+static void usage(const char *prog)
+{
+	fprintf(stderr, "usage: %s [-r rate_hz] [-n name,name,...] [input]\n", prog);
+	exit(2);
+}
+
+static void print_header(uint8_t num_channels, const char *names, double rate)
+{
+	char *list = names ? strdup(names) : NULL;
+	char *save = NULL;
+	char *name = list ? strtok_r(list, ",", &save) : NULL;
+
+	printf("%s", rate > 0.0 ? "time" : "sample");
+	for (uint8_t c = 0; c < num_channels; c++) {
+		if (name) {
+			printf(",%s", name);
+			name = strtok_r(NULL, ",", &save);
+		} else {
+			printf(",ch%u", c);
+		}
+	}
+	printf("\n");
+	free(list);
+}
+
+int main(int argc, char **argv)
+{
+	static struct telemetry_reader reader;
+	struct telemetry_packet pkt;
+	const char *names = NULL;
+	double rate = 0.0;
+	uint8_t buf[4096];
+	uint8_t channels = 0;
+	uint64_t rows = 0;
+	ssize_t n;
+	int fd = STDIN_FILENO;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "r:n:h")) != -1) {
+		switch (opt) {
+		case 'r':
+			rate = atof(optarg);
+			break;
+		case 'n':
+			names = optarg;
+			break;
+		default:
+			usage(argv[0]);
+		}
+	}
+	if (optind < argc) {
+		fd = open(argv[optind], O_RDONLY | O_NOCTTY);
+		if (fd < 0) {
+			perror(argv[optind]);
+			return 1;
+		}
+	}
+
+	if (isatty(fd)) {
+		struct termios tio;
+
+		if (tcgetattr(fd, &tio) == 0) {
+			cfmakeraw(&tio);
+			tcsetattr(fd, TCSANOW, &tio);
+		}
+	}
+
+	telemetry_reader_init(&reader);
+
+	while ((n = read(fd, buf, sizeof(buf))) > 0) {
+		size_t off = 0;
+
+		while (off < (size_t)n) {
+			off += telemetry_reader_feed(&reader, buf + off, (size_t)n - off);
+
+			while (telemetry_reader_next(&reader, &pkt)) {
+				if (channels == 0) {
+					channels = pkt.num_channels;
+					print_header(channels, names, rate);
+				} else if (pkt.num_channels != channels) {
+					fprintf(stderr, "channel count changed (%u -> %u), stopping\n",
+					        channels, pkt.num_channels);
+					goto done;
+				}
+
+				for (uint16_t s = 0; s < pkt.num_samples; s++) {
+					uint32_t index = pkt.first_sample + s;
+
+					if (rate > 0.0) {
+						printf("%.6f", index / rate);
+					} else {
+						printf("%u", index);
+					}
+					for (uint8_t c = 0; c < channels; c++) {
+						printf(",%g", telemetry_packet_value(&pkt, s, c));
+					}
+					printf("\n");
+					rows++;
+				}
+			}
+		}
+	}
+
+done:
+	fprintf(stderr, "%llu samples, %u lost samples, %u lost packets, %u bytes skipped\n",
+	        (unsigned long long)rows, reader.lost_samples, reader.lost_packets,
+	        reader.skipped_bytes);
+
+	return 0;
+}
@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "telemetry_reader.h"
+#include <string.h>
+
+static inline uint16_t get_u16(const uint8_t *p)
+{
+	return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t get_u32(const uint8_t *p)
+{
+	return get_u16(p) | ((uint32_t)get_u16(p + 2) << 16);
+}
+
+void telemetry_reader_init(struct telemetry_reader *r)
+{
+	memset(r, 0, sizeof(*r));
+}
+
+/**
+ * @brief Drop bytes from the front of the buffer
+ */
+static void discard(struct telemetry_reader *r, size_t n)
+{
+	memmove(r->buf, r->buf + n, r->len - n);
+	r->len -= n;
+}
+
+size_t telemetry_reader_feed(struct telemetry_reader *r, const uint8_t *data, size_t len)
+{
+	size_t room;
+
+	if (r->consumed) {
+		discard(r, r->consumed);
+		r->consumed = 0;
+	}
+
+	room = sizeof(r->buf) - r->len;
+	if (len > room) {
+		len = room;
+	}
+	memcpy(r->buf + r->len, data, len);
+	r->len += len;
+
+	return len;
+}
+
+/**
+ * @brief Check a header, return the packet length or 0 if it is not one
+ */
+static size_t header_length(const uint8_t *p)
+{
+	size_t len;
+
+	if (get_u16(p) != TELEMETRY_MAGIC || p[2] != TELEMETRY_VERSION) {
+		return 0;
+	}
+	if (p[3] == 0 || p[3] > TELEMETRY_MAX_CHANNELS || get_u16(p + 6) == 0) {
+		return 0;
+	}
+
+	len = TELEMETRY_HEADER_SIZE + (size_t)get_u16(p + 6) * p[3] * 4U;
+	return len <= TELEMETRY_PACKET_SIZE ? len : 0;
+}
+
+int telemetry_reader_next(struct telemetry_reader *r, struct telemetry_packet *pkt)
+{
+	size_t len;
+
+	if (r->consumed) {
+		discard(r, r->consumed);
+		r->consumed = 0;
+	}
+
+	for (;;) {
+		if (r->len < TELEMETRY_HEADER_SIZE) {
+			return 0;
+		}
+		len = header_length(r->buf);
+		if (len) {
+			break;
+		}
+		discard(r, 1);
+		r->skipped_bytes++;
+	}
+	if (r->len < len) {
+		return 0;
+	}
+
+	pkt->num_channels = r->buf[3];
+	pkt->seq = get_u16(r->buf + 4);
+	pkt->num_samples = get_u16(r->buf + 6);
+	pkt->first_sample = get_u32(r->buf + 8);
+	pkt->values = r->buf + TELEMETRY_HEADER_SIZE;
+
+	/* Going backwards means the stream was restarted: not a loss */
+	if (r->started && (int16_t)(pkt->seq - r->next_seq) > 0) {
+		r->lost_packets += (uint16_t)(pkt->seq - r->next_seq);
+	}
+	if (r->started && (int32_t)(pkt->first_sample - r->next_sample) > 0) {
+		r->lost_samples += pkt->first_sample - r->next_sample;
+	}
+	r->started = true;
+	r->next_seq = pkt->seq + 1U;
+	r->next_sample = pkt->first_sample + pkt->num_samples;
+	r->consumed = len;
+
+	return 1;
+}
+
+float telemetry_packet_value(const struct telemetry_packet *pkt, uint16_t sample,
+                             uint8_t channel)
+{
+	uint32_t u = get_u32(pkt->values + ((size_t)sample * pkt->num_channels + channel) * 4U);
+	float v;
+
+	memcpy(&v, &u, sizeof(v));
+	return v;
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2025 FOC2 Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef TELEMETRY_READER_H
+#define TELEMETRY_READER_H
+
+/**
+ * @brief Host-side parser for the firmware telemetry stream
+ *
+ * Bytes are fed in as they arrive, in chunks of any size; complete packets
+ * come out of telemetry_reader_next(). The reader resynchronises on the
+ * packet magic after garbage or a cut-off packet and counts samples lost
+ * by the firmware (gaps in first_sample) and packets lost on the way
+ * (gaps in seq). Packet format: see Inc/telemetry.h.
+ */
+
+#include "telemetry.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief One decoded packet, valid until the next telemetry_reader_next()
+ */
+struct telemetry_packet {
+	uint8_t num_channels;
+	uint16_t seq;
+	uint16_t num_samples;
+	uint32_t first_sample;
+	const uint8_t *values;       /* num_samples x num_channels float32 LE */
+};
+
+struct telemetry_reader {
+	uint8_t buf[2 * TELEMETRY_PACKET_SIZE];
+	size_t len;                  /* Bytes in buf */
+	size_t consumed;             /* Bytes of the packet last returned */
+	bool started;                /* A packet has been seen */
+	uint16_t next_seq;
+	uint32_t next_sample;
+	uint32_t lost_samples;       /* Dropped by the firmware or lost in transit */
+	uint32_t lost_packets;       /* Sequence numbers skipped */
+	uint32_t skipped_bytes;      /* Garbage discarded while resynchronising */
+};
+
+/**
+ * @brief Reset a reader
+ *
+ * @param r Reader
+ */
+void telemetry_reader_init(struct telemetry_reader *r);
+
+/**
+ * @brief Append received bytes
+ *
+ * @param r Reader
+ * @param data Bytes
+ * @param len Number of bytes
+ * @return Number of bytes taken; call telemetry_reader_next() and feed the
+ *         rest if less than len
+ */
+size_t telemetry_reader_feed(struct telemetry_reader *r, const uint8_t *data, size_t len);
+
+/**
+ * @brief Get the next complete packet
+ *
+ * @param r Reader
+ * @param pkt Packet (points into the reader's buffer)
+ * @return 1 if a packet was returned, 0 if more bytes are needed
+ */
+int telemetry_reader_next(struct telemetry_reader *r, struct telemetry_packet *pkt);
+
+/**
+ * @brief Get one value of a packet
+ *
+ * @param pkt Packet
+ * @param sample Sample within the packet
+ * @param channel Channel
+ * @return Value
+ */
+float telemetry_packet_value(const struct telemetry_packet *pkt, uint16_t sample,
+                             uint8_t channel);
+
+#endif /* TELEMETRY_READER_H */